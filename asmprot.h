@@ -7,6 +7,8 @@
 #ifndef _ASMPROT_H_
 #define _ASMPROT_H_
 
+#include <inttypes.h>
+
 void
 convolver_sse_convolve_add(void *input_cbuf,
 			   void *coeffs,
@@ -19,6 +21,402 @@ convolver_sse2_convolve_add(void *input_cbuf,
                             void *output_cbuf,
                             int loop_counter);
 
+void
+convolver_avx_convolve_addf(void *input_cbuf,
+                            void *coeffs,
+                            void *output_cbuf,
+                            int loop_counter);
+
+void
+convolver_avx_convolvef(void *input_cbuf,
+                        void *coeffs,
+                        void *output_cbuf,
+                        int loop_counter);
+
+void
+convolver_avx_convolve_sumf(void *input_cbufs[],
+                            void *coeffs[],
+                            int n_pairs,
+                            void *output_cbuf,
+                            int loop_counter);
+
+void
+convolver_avx_dirac_convolvef(void *input_cbuf,
+                              void *output_cbuf,
+                              double fraction,
+                              int loop_counter);
+
+void
+convolver_avx_mixnscale_inputf(void *input_cbufs[],
+                               void *output_cbuf,
+                               double scales[],
+                               int n_bufs,
+                               int loop_counter);
+
+void
+convolver_avx_mixnscale_outputf(void *input_cbufs[],
+                                void *output_cbuf,
+                                double scales[],
+                                int n_bufs,
+                                int loop_counter);
+
+void
+convolver_avx_convolve_addd(void *input_cbuf,
+                            void *coeffs,
+                            void *output_cbuf,
+                            int loop_counter);
+
+void
+convolver_avx_convolved(void *input_cbuf,
+                        void *coeffs,
+                        void *output_cbuf,
+                        int loop_counter);
+
+void
+convolver_avx_convolve_sumd(void *input_cbufs[],
+                            void *coeffs[],
+                            int n_pairs,
+                            void *output_cbuf,
+                            int loop_counter);
+
+void
+convolver_avx_dirac_convolved(void *input_cbuf,
+                              void *output_cbuf,
+                              double fraction,
+                              int loop_counter);
+
+void
+convolver_avx_mixnscale_inputd(void *input_cbufs[],
+                               void *output_cbuf,
+                               double scales[],
+                               int n_bufs,
+                               int loop_counter);
+
+void
+convolver_avx_mixnscale_outputd(void *input_cbufs[],
+                                void *output_cbuf,
+                                double scales[],
+                                int n_bufs,
+                                int loop_counter);
+
+void
+convolver_avx_complex_convolve_addf(void *input_cbuf,
+                                    void *coeffs,
+                                    void *output_cbuf,
+                                    int loop_counter);
+
+void
+convolver_avx_complex_convolvef(void *input_cbuf,
+                                void *coeffs,
+                                void *output_cbuf,
+                                int loop_counter);
+
+void
+convolver_avx_complex_convolve_sumf(void *input_cbufs[],
+                                    void *coeffs[],
+                                    int n_pairs,
+                                    void *output_cbuf,
+                                    int loop_counter);
+
+void
+convolver_avx_complex_convolve_addd(void *input_cbuf,
+                                    void *coeffs,
+                                    void *output_cbuf,
+                                    int loop_counter);
+
+void
+convolver_avx_complex_convolved(void *input_cbuf,
+                                void *coeffs,
+                                void *output_cbuf,
+                                int loop_counter);
+
+void
+convolver_avx_complex_convolve_sumd(void *input_cbufs[],
+                                    void *coeffs[],
+                                    int n_pairs,
+                                    void *output_cbuf,
+                                    int loop_counter);
+
+void
+convolver_avx_convolve_sum_mixedf(void *input_cbufs[],
+                                  void *coeffs[],
+                                  int n_pairs,
+                                  void *output_cbuf,
+                                  int loop_counter);
+
+void
+convolver_avx_complex_convolve_sum_mixedf(void *input_cbufs[],
+                                          void *coeffs[],
+                                          int n_pairs,
+                                          void *output_cbuf,
+                                          int loop_counter);
+
+void
+convolver_avx_widen_fp16f(void *input,
+                          void *output,
+                          double scale,
+                          int loop_counter);
+
+void
+convolver_avx_widen_bf16f(void *input,
+                          void *output,
+                          double scale,
+                          int loop_counter);
+
+void
+convolver_avx_direct_convolvef(void *input,
+                               void *coeffs,
+                               int n_taps,
+                               void *output,
+                               int n_samples);
+
+void
+convolver_avx_direct_convolved(void *input,
+                               void *coeffs,
+                               int n_taps,
+                               void *output,
+                               int n_samples);
+
+void
+convolver_avx512_convolve_addf(void *input_cbuf,
+                               void *coeffs,
+                               void *output_cbuf,
+                               int loop_counter);
+
+void
+convolver_avx512_convolvef(void *input_cbuf,
+                           void *coeffs,
+                           void *output_cbuf,
+                           int loop_counter);
+
+void
+convolver_avx512_convolve_sumf(void *input_cbufs[],
+                               void *coeffs[],
+                               int n_pairs,
+                               void *output_cbuf,
+                               int loop_counter);
+
+void
+convolver_avx512_mixnscale_inputf(void *input_cbufs[],
+                                  void *output_cbuf,
+                                  double scales[],
+                                  int n_bufs,
+                                  int loop_counter);
+
+void
+convolver_avx512_mixnscale_outputf(void *input_cbufs[],
+                                   void *output_cbuf,
+                                   double scales[],
+                                   int n_bufs,
+                                   int loop_counter);
+
+void
+convolver_avx512_convolve_addd(void *input_cbuf,
+                               void *coeffs,
+                               void *output_cbuf,
+                               int loop_counter);
+
+void
+convolver_avx512_convolved(void *input_cbuf,
+                           void *coeffs,
+                           void *output_cbuf,
+                           int loop_counter);
+
+void
+convolver_avx512_convolve_sumd(void *input_cbufs[],
+                               void *coeffs[],
+                               int n_pairs,
+                               void *output_cbuf,
+                               int loop_counter);
+
+void
+convolver_avx512_mixnscale_inputd(void *input_cbufs[],
+                                  void *output_cbuf,
+                                  double scales[],
+                                  int n_bufs,
+                                  int loop_counter);
+
+void
+convolver_avx512_mixnscale_outputd(void *input_cbufs[],
+                                   void *output_cbuf,
+                                   double scales[],
+                                   int n_bufs,
+                                   int loop_counter);
+
+void
+convolver_neon_convolve_addf(void *input_cbuf,
+                             void *coeffs,
+                             void *output_cbuf,
+                             int loop_counter);
+
+void
+convolver_neon_convolvef(void *input_cbuf,
+                         void *coeffs,
+                         void *output_cbuf,
+                         int loop_counter);
+
+void
+convolver_neon_convolve_sumf(void *input_cbufs[],
+                             void *coeffs[],
+                             int n_pairs,
+                             void *output_cbuf,
+                             int loop_counter);
+
+void
+convolver_neon_dirac_convolvef(void *input_cbuf,
+                               void *output_cbuf,
+                               double fraction,
+                               int loop_counter);
+
+void
+convolver_neon_mixnscale_inputf(void *input_cbufs[],
+                                void *output_cbuf,
+                                double scales[],
+                                int n_bufs,
+                                int loop_counter);
+
+void
+convolver_neon_mixnscale_outputf(void *input_cbufs[],
+                                 void *output_cbuf,
+                                 double scales[],
+                                 int n_bufs,
+                                 int loop_counter);
+
+void
+convolver_neon_convolve_addd(void *input_cbuf,
+                             void *coeffs,
+                             void *output_cbuf,
+                             int loop_counter);
+
+void
+convolver_neon_convolved(void *input_cbuf,
+                         void *coeffs,
+                         void *output_cbuf,
+                         int loop_counter);
+
+void
+convolver_neon_convolve_sumd(void *input_cbufs[],
+                             void *coeffs[],
+                             int n_pairs,
+                             void *output_cbuf,
+                             int loop_counter);
+
+void
+convolver_neon_dirac_convolved(void *input_cbuf,
+                               void *output_cbuf,
+                               double fraction,
+                               int loop_counter);
+
+void
+convolver_neon_mixnscale_inputd(void *input_cbufs[],
+                                void *output_cbuf,
+                                double scales[],
+                                int n_bufs,
+                                int loop_counter);
+
+void
+convolver_neon_mixnscale_outputd(void *input_cbufs[],
+                                 void *output_cbuf,
+                                 double scales[],
+                                 int n_bufs,
+                                 int loop_counter);
+
+void
+convolver_neon_complex_convolve_addf(void *input_cbuf,
+                                     void *coeffs,
+                                     void *output_cbuf,
+                                     int loop_counter);
+
+void
+convolver_neon_complex_convolvef(void *input_cbuf,
+                                 void *coeffs,
+                                 void *output_cbuf,
+                                 int loop_counter);
+
+void
+convolver_neon_complex_convolve_sumf(void *input_cbufs[],
+                                     void *coeffs[],
+                                     int n_pairs,
+                                     void *output_cbuf,
+                                     int loop_counter);
+
+void
+convolver_neon_complex_convolve_addd(void *input_cbuf,
+                                     void *coeffs,
+                                     void *output_cbuf,
+                                     int loop_counter);
+
+void
+convolver_neon_complex_convolved(void *input_cbuf,
+                                 void *coeffs,
+                                 void *output_cbuf,
+                                 int loop_counter);
+
+void
+convolver_neon_complex_convolve_sumd(void *input_cbufs[],
+                                     void *coeffs[],
+                                     int n_pairs,
+                                     void *output_cbuf,
+                                     int loop_counter);
+
+void
+convolver_neon_convolve_sum_mixedf(void *input_cbufs[],
+                                   void *coeffs[],
+                                   int n_pairs,
+                                   void *output_cbuf,
+                                   int loop_counter);
+
+void
+convolver_neon_complex_convolve_sum_mixedf(void *input_cbufs[],
+                                           void *coeffs[],
+                                           int n_pairs,
+                                           void *output_cbuf,
+                                           int loop_counter);
+
+void
+convolver_neon_widen_fp16f(void *input,
+                           void *output,
+                           double scale,
+                           int loop_counter);
+
+void
+convolver_neon_widen_bf16f(void *input,
+                           void *output,
+                           double scale,
+                           int loop_counter);
+
+void
+convolver_neon_direct_convolvef(void *input,
+                                void *coeffs,
+                                int n_taps,
+                                void *output,
+                                int n_samples);
+
+void
+convolver_neon_direct_convolved(void *input,
+                                void *coeffs,
+                                int n_taps,
+                                void *output,
+                                int n_samples);
+
+int
+convolver_neon_raw2realf(void *realbuf,
+                         void *rawbuf,
+                         int bytes,
+                         int isfloat,
+                         int spacing,
+                         int n_samples);
+
+int
+convolver_neon_real2rawf(void *rawbuf,
+                         void *realbuf,
+                         int bits,
+                         int bytes,
+                         int spacing,
+                         int n_samples,
+                         double limit,
+                         int32_t *intlargest);
+
 void
 convolver_3dnow_convolve_add(void *input_cbuf,
 			     void *coeffs,
@@ -67,6 +67,12 @@ struct coeff {
     int shm_blocks[BF_MAXCOEFFPARTS];
     int shm_elements;
     double scale;
+    /* time-domain coefficients read in advance, and for sets made by
+       combine_filter_chains() the two sets they are made of */
+    void *taps;
+    int n_taps;
+    bool_t combined;
+    int source[2];
 };
 
 struct filter {
@@ -76,6 +82,10 @@ struct filter {
     char *channel_name[2][BF_MAXCHANNELS];
     char *filter_name[2][BF_MAXCHANNELS];
     int process;
+    /* for a matrix, the coefficient set of each input of each output, output
+       by output */
+    char **matrix_coeff_name;
+    int *matrix_coeffs;
 };
 
 struct iodev {
@@ -205,7 +215,17 @@ monitor_rate: false;        # monitor sample rate\n\
 powersave: false;           # pause filtering when input is zero\n\
 lock_memory: true;          # try to lock memory if realtime prio is set\n\
 sdf_length: -1;             # subsample filter half length in samples\n\
-safety_limit: 20;           # if non-zero max dB in output before aborting\n"
+safety_limit: 20;           # if non-zero max dB in output before aborting\n\
+partitioning: \"uniform\";    # uniform or non-uniform filter partitions\n\
+cpu_optimisation: \"auto\";  # auto, none, sse, avx2, avx512 or neon\n\
+interleaved_partitions: false; # store filter partitions bin-major\n\
+spectrum_layout: \"halfcomplex\"; # halfcomplex (r2r) or complex (r2c) FFTs\n\
+double_accumulation: false; # sum float partitions in double precision\n\
+partition_threshold: false; # skip coeff partitions below this level (dB)\n\
+direct_convolution: false;  # max taps of filters convolved in time-domain\n\
+fft_threads: 1;             # threads per FFT, for offline processing\n\
+fft_backend: \"auto\";        # auto, fftw or radix4 (built-in FFT)\n\
+processing_margin: false;   # samples to process a block in, tail done ahead\n"
 #ifdef CONVOLVER_NEEDS_CONFIGFILE
 	    "convolver_config: \"~/.brutefir_convolver\"; # location of "
 	    "convolver config file\n"
@@ -219,6 +239,7 @@ coeff {\n\
 \tblocks: -1;         # how long in blocks\n\
 \tskip: 0;            # how many bytes to skip\n\
 \tshared_mem: false;  # allocate in shared memory\n\
+\tcompression: \"none\"; # \"fp32\", \"fp16\" or \"bf16\" to save memory\n\
 };\n\
 \n\
 ## INPUT DEFAULTS ##\n\
@@ -835,6 +856,22 @@ parse_coeff(bool_t parse_default,
 		get_token(REAL);
 		coeff->skip = make_integer(yylval.real);
 		get_token(EOS);
+	    } else if (strcmp(yylval.field, "compression") == 0) {
+		field_repeat_test(&bitset, 6);
+		get_token(STRING);
+		if (strcasecmp(yylval.string, "none") == 0) {
+		    coeff->coeff.compression = BF_COEFF_COMPRESSION_NONE;
+		} else if (strcasecmp(yylval.string, "fp16") == 0) {
+		    coeff->coeff.compression = BF_COEFF_COMPRESSION_FP16;
+		} else if (strcasecmp(yylval.string, "bf16") == 0) {
+		    coeff->coeff.compression = BF_COEFF_COMPRESSION_BF16;
+		} else if (strcasecmp(yylval.string, "fp32") == 0) {
+		    coeff->coeff.compression = BF_COEFF_COMPRESSION_FP32;
+		} else {
+		    parse_error("invalid compression, must be \"none\", "
+				"\"fp32\", \"fp16\" or \"bf16\".\n");
+		}
+		get_token(EOS);
 	    } else {
 		unrecognised_token("coeff field", yylval.field);
 	    }
@@ -877,6 +914,16 @@ parse_coeff(bool_t parse_default,
     if (!parse_default && coeff->shm_elements > 0) {
         coeff->coeff.is_shared = true;
     }    
+    /* modules write shared sets in place, which they can do as floats but
+       not in the 16 bit formats */
+    if (coeff->coeff.is_shared &&
+        coeff->coeff.compression != BF_COEFF_COMPRESSION_NONE &&
+        (coeff->coeff.compression != BF_COEFF_COMPRESSION_FP32 ||
+         coeff->shm_elements > 0))
+    {
+	parse_error("shared memory coefficients can only be compressed as "
+                    "\"fp32\", and not when given in shared memory.\n");
+    }
     return coeff;
 }
 
@@ -1000,6 +1047,7 @@ parse_filter(bool_t parse_default,
             memset(filter, 0, sizeof(struct filter));            
             filter->fctrl.coeff = -1;
             filter->process = -1;
+            filter->filter.double_accumulation = -1;
         }
 	if (get_string_or_int(filter->filter.name, BF_MAXOBJECTNAME,
 			      &filter->filter.intname))
@@ -1014,6 +1062,7 @@ parse_filter(bool_t parse_default,
 	memset(filter, 0, sizeof(struct filter));
 	filter->fctrl.coeff = -1;
         filter->process = -1;
+        filter->filter.double_accumulation = -1;
     }
 
     get_token(LBRACE);
@@ -1073,6 +1122,29 @@ parse_filter(bool_t parse_default,
 		get_token(BOOLEAN);
 		filter->filter.crossfade = yylval.boolean;
 		get_token(EOS);
+	    } else if (strcmp(yylval.field, "double_accumulation") == 0) {
+		field_repeat_test(&bitset, 8);
+		get_token(BOOLEAN);
+		filter->filter.double_accumulation = yylval.boolean;
+		get_token(EOS);
+	    } else if (strcmp(yylval.field, "float_bits") == 0) {
+		field_repeat_test(&bitset, 9);
+		get_token(REAL);
+		filter->filter.realsize = make_integer(yylval.real);
+		if (filter->filter.realsize != sizeof(float) * 8 &&
+		    filter->filter.realsize != sizeof(double) * 8)
+		{
+		    sprintf(msg, "invalid float_bits, must be %zd or %zd.\n",
+			    sizeof(float) * 8, sizeof(double) * 8);
+		    parse_error(msg);
+		}
+		filter->filter.realsize /= 8;
+		get_token(EOS);
+	    } else if (strcmp(yylval.field, "fixed") == 0) {
+		field_repeat_test(&bitset, 10);
+		get_token(BOOLEAN);
+		filter->filter.fixed = yylval.boolean;
+		get_token(EOS);
 	    } else {
 		unrecognised_token("filter field", yylval.field);
 	    }
@@ -1101,6 +1173,114 @@ parse_filter(bool_t parse_default,
     return filter;
 }
 
+/* A matrix is made into a single filter, which takes all inputs of the
+   matrix and outputs to each output the sum of the inputs convolved with the
+   coefficient sets of that output. */
+static struct filter *
+parse_matrix(void)
+{
+    struct filter *matrix;
+    char name[BF_MAXOBJECTNAME], msg[200];
+    char **coeff_names = NULL;
+    int *coeff_indexes = NULL;
+    int n_coeffs = 0, capacity = 0;
+    uint32_t bitset = 0;
+    int token, n;
+
+    matrix = emalloc(sizeof(struct filter));
+    memset(matrix, 0, sizeof(struct filter));
+    matrix->process = -1;
+    matrix->filter.double_accumulation = -1;
+    matrix->filter.matrix = true;
+    if (get_string_or_int(matrix->filter.name, BF_MAXOBJECTNAME, &n)) {
+        sprintf(matrix->filter.name, "%d", n);
+    }
+
+    get_token(LBRACE);
+
+    do {
+	switch (token = yylex()) {
+	case FIELD:
+	    if (strcmp(yylval.field, "process") == 0) {
+		field_repeat_test(&bitset, 0);
+		get_token(REAL);
+		matrix->process = make_integer(yylval.real);
+		if (matrix->process >= BF_MAXPROCESSES) {
+		    sprintf(msg, "process is less than 0 "
+			    "or larger than %d.\n", BF_MAXPROCESSES - 1);
+		    parse_error(msg);
+		}
+                if (matrix->process < 0) {
+                    matrix->process = -1;
+                }
+		get_token(EOS);
+	    } else if (strcmp(yylval.field, "coeff") == 0) {
+		field_repeat_test(&bitset, 1);
+                do {
+                    if (n_coeffs == capacity) {
+                        capacity += 64;
+                        coeff_names = erealloc(coeff_names,
+                                               capacity * sizeof(char *));
+                        coeff_indexes = erealloc(coeff_indexes,
+                                                 capacity * sizeof(int));
+                    }
+                    if (get_string_or_int(name, BF_MAXOBJECTNAME,
+                                          &coeff_indexes[n_coeffs]))
+                    {
+                        coeff_names[n_coeffs] = NULL;
+                    } else {
+                        coeff_names[n_coeffs] = estrdup(name);
+                    }
+                    n_coeffs++;
+                    if ((token = yylex()) != COMMA && token != EOS) {
+                        unexpected_token(EOS, token);
+                    }
+                } while (token != EOS);
+	    } else if (strcmp(yylval.field, "from_inputs") == 0 ||
+		       strcmp(yylval.field, "inputs") == 0)
+	    {
+		field_repeat_test(&bitset, 2);
+		parse_filter_io_array(matrix, false, IN, false);
+	    } else if (strcmp(yylval.field, "to_outputs") == 0 ||
+		       strcmp(yylval.field, "outputs") == 0)
+	    {
+		field_repeat_test(&bitset, 3);
+		parse_filter_io_array(matrix, false, OUT, false);
+	    } else if (strcmp(yylval.field, "double_accumulation") == 0) {
+		field_repeat_test(&bitset, 4);
+		get_token(BOOLEAN);
+		matrix->filter.double_accumulation = yylval.boolean;
+		get_token(EOS);
+	    } else {
+		unrecognised_token("matrix field", yylval.field);
+	    }
+	    break;
+	case RBRACE:
+	    break;
+	default:
+	    unexpected_token(FIELD, token);
+	}
+    } while (token != RBRACE);
+    get_token(EOS);
+
+    field_mandatory_test(bitset, 0xE, "matrix");
+    if (n_coeffs != matrix->filter.n_channels[IN] *
+        matrix->filter.n_channels[OUT])
+    {
+        parse_error("a matrix needs a coefficient set for each input of "
+                    "each output.\n");
+    }
+    matrix->matrix_coeff_name = coeff_names;
+    matrix->matrix_coeffs = coeff_indexes;
+    /* the first set is the coefficient set of the filter as seen from the
+       outside */
+    matrix->fctrl.coeff = coeff_indexes[0];
+    if (coeff_names[0] != NULL) {
+        strcpy(matrix->coeff_name, coeff_names[0]);
+    }
+    return matrix;
+}
+
 static struct iodev *
 parse_iodev(bool_t parse_default,
 	    int io,
@@ -1634,6 +1814,156 @@ parse_setting(char field[],
             exit(BF_EXIT_INVALID_CONFIG);
         }
 	get_token(EOS);
+    } else if (strcmp(field, "partitioning") == 0) {
+	field_repeat_test(repeat_bitset, 19);
+	get_token(STRING);
+        if (strcmp(yylval.string, "uniform") == 0) {
+            bfconf->nonuniform_partitions = false;
+        } else if (strcmp(yylval.string, "non-uniform") == 0) {
+            bfconf->nonuniform_partitions = true;
+        } else {
+            parse_error("invalid partitioning, expected \"uniform\" or "
+                        "\"non-uniform\".\n");
+        }
+	switch (token = yylex()) {
+	case EOS:
+	    bfconf->max_partition_length = 0;
+	    break;
+	case COMMA:
+	    get_token(REAL);
+	    bfconf->max_partition_length = make_integer(yylval.real);
+            if (log2_get(bfconf->max_partition_length) == -1) {
+                parse_error("max partition length is not a power of 2.\n");
+            }
+	    get_token(EOS);
+	    break;
+	default:
+	    unexpected_token(EOS, token);
+	    break;
+	}
+    } else if (strcmp(field, "cpu_optimisation") == 0) {
+	field_repeat_test(repeat_bitset, 20);
+	get_token(STRING);
+        if (strcmp(yylval.string, "auto") != 0 &&
+            strcmp(yylval.string, "none") != 0 &&
+            strcmp(yylval.string, "sse") != 0 &&
+            strcmp(yylval.string, "avx2") != 0 &&
+            strcmp(yylval.string, "avx512") != 0 &&
+            strcmp(yylval.string, "neon") != 0)
+        {
+            parse_error("invalid cpu_optimisation, expected \"auto\", "
+                        "\"none\", \"sse\", \"avx2\", \"avx512\" or "
+                        "\"neon\".\n");
+        }
+        efree(bfconf->cpu_optimisation);
+        bfconf->cpu_optimisation = estrdup(yylval.string);
+	get_token(EOS);
+    } else if (strcmp(field, "interleaved_partitions") == 0) {
+	field_repeat_test(repeat_bitset, 21);
+	get_token(BOOLEAN);
+	bfconf->interleaved_partitions = yylval.boolean;
+	get_token(EOS);
+    } else if (strcmp(field, "spectrum_layout") == 0) {
+	field_repeat_test(repeat_bitset, 22);
+	get_token(STRING);
+        if (strcmp(yylval.string, "halfcomplex") == 0) {
+            bfconf->complex_spectrum = false;
+        } else if (strcmp(yylval.string, "complex") == 0) {
+            bfconf->complex_spectrum = true;
+        } else {
+            parse_error("invalid spectrum_layout, expected \"halfcomplex\" "
+                        "or \"complex\".\n");
+        }
+	get_token(EOS);
+    } else if (strcmp(field, "double_accumulation") == 0) {
+	field_repeat_test(repeat_bitset, 23);
+	get_token(BOOLEAN);
+	bfconf->double_accumulation = yylval.boolean;
+	get_token(EOS);
+    } else if (strcmp(field, "partition_threshold") == 0) {
+	field_repeat_test(repeat_bitset, 24);
+	switch (token = yylex()) {
+	case REAL:
+            /* stored as energy ratio */
+            bfconf->partition_threshold = pow(10, yylval.real / 10.0);
+	    break;
+	case BOOLEAN:
+            if (yylval.boolean) {
+                parse_error("partition_threshold must be false or a level "
+                            "in dB.\n");
+            }
+            bfconf->partition_threshold = 0;
+	    break;
+	default:
+	    unexpected_token(REAL, token);
+	    break;
+	}
+        get_token(EOS);
+    } else if (strcmp(field, "direct_convolution") == 0) {
+	field_repeat_test(repeat_bitset, 25);
+	switch (token = yylex()) {
+	case REAL:
+            bfconf->direct_convolution = make_integer(yylval.real);
+            if (bfconf->direct_convolution <= 0) {
+                parse_error("direct_convolution must be false or a positive "
+                            "number of taps.\n");
+            }
+	    break;
+	case BOOLEAN:
+            if (yylval.boolean) {
+                parse_error("direct_convolution must be false or a number of "
+                            "taps.\n");
+            }
+            bfconf->direct_convolution = 0;
+	    break;
+	default:
+	    unexpected_token(REAL, token);
+	    break;
+	}
+        get_token(EOS);
+    } else if (strcmp(field, "fft_threads") == 0) {
+	field_repeat_test(repeat_bitset, 26);
+	get_token(REAL);
+	bfconf->fft_threads = make_integer(yylval.real);
+        if (bfconf->fft_threads < 1) {
+            parse_error("fft_threads must be at least 1.\n");
+        }
+	get_token(EOS);
+    } else if (strcmp(field, "fft_backend") == 0) {
+	field_repeat_test(repeat_bitset, 27);
+	get_token(STRING);
+        if (strcmp(yylval.string, "auto") != 0 &&
+            strcmp(yylval.string, "fftw") != 0 &&
+            strcmp(yylval.string, "radix4") != 0)
+        {
+            parse_error("invalid fft_backend, expected \"auto\", \"fftw\" "
+                        "or \"radix4\".\n");
+        }
+        efree(bfconf->fft_backend);
+        bfconf->fft_backend = estrdup(yylval.string);
+	get_token(EOS);
+    } else if (strcmp(field, "processing_margin") == 0) {
+	field_repeat_test(repeat_bitset, 28);
+	switch (token = yylex()) {
+	case REAL:
+            bfconf->processing_margin = make_integer(yylval.real);
+            if (bfconf->processing_margin <= 0) {
+                parse_error("processing_margin must be false or a "
+                            "positive number of samples.\n");
+            }
+	    break;
+	case BOOLEAN:
+            if (yylval.boolean) {
+                parse_error("processing_margin must be false or a number "
+                            "of samples.\n");
+            }
+            bfconf->processing_margin = 0;
+	    break;
+	default:
+	    unexpected_token(REAL, token);
+	    break;
+	}
+        get_token(EOS);
     } else {
 	parse_error("unrecognised setting name.\n");
     }
@@ -1864,16 +2194,10 @@ get_sharedmem(int shmid,
     return (void *)&((uint8_t *)buf)[offset];
 }
 
-static void *
-load_coeff(struct coeff *coeff,
-           int cindex,
-           int realsize)
+static FILE *
+open_coeff(struct coeff *coeff)
 {
-    void *coeffs, *zbuf = NULL;
     FILE *stream = NULL;
-    void **cbuf, *buf;
-    int n, i, j, len;
-    uint8_t *dest;
 
     if (coeff->shm_elements <= 0 &&
 	strcmp(coeff->filename, "dirac pulse") != 0)
@@ -1899,90 +2223,126 @@ load_coeff(struct coeff *coeff,
               "(skip only works on files).\n", coeff->coeff.name);
         exit(BF_EXIT_INVALID_CONFIG);
     }
+    return stream;
+}
 
-    cbuf = emalloc(coeff->coeff.n_blocks * sizeof(void **));
-    
+/* read a coefficient set which is given in the time-domain, that is any
+   set but those in the processed format */
+static void *
+read_coeff(struct coeff *coeff,
+           int realsize,
+           int *len)
+{
+    void *coeffs;
+    FILE *stream;
+
+    stream = open_coeff(coeff);
     if (strcmp(coeff->filename, "dirac pulse") == 0) {
-	len = coeff->coeff.n_blocks * bfconf->filter_length;
-	coeffs = emalloc(len * realsize);
-	memset(coeffs, 0, len * realsize);
+	*len = coeff->coeff.n_blocks * bfconf->filter_length;
+	coeffs = emalloc(*len * realsize);
+	memset(coeffs, 0, *len * realsize);
         if (realsize == 4) {
             ((float *)coeffs)[0] = 1.0;
         } else {
             ((double *)coeffs)[0] = 1.0;
         }
+        return coeffs;
+    }
+    switch (coeff->format) {
+    case COEFF_FORMAT_TEXT:
+        coeffs = real_read(stream, len, coeff->filename, realsize,
+                           coeff->coeff.n_blocks * bfconf->filter_length);
+        break;
+    case COEFF_FORMAT_RAW:
+        coeffs = raw_read(stream, len, &coeff->rawformat, realsize,
+                          coeff->coeff.n_blocks * bfconf->filter_length);
+        break;
+    default:
+        fprintf(stderr, "Invalid format: %d.\n", coeff->format);
+        exit(BF_EXIT_INVALID_CONFIG);
+    }
+    fclose(stream);
+    return coeffs;
+}
+
+static void *
+load_coeff(struct coeff *coeff,
+           int cindex,
+           int realsize)
+{
+    void *coeffs, *zbuf = NULL;
+    FILE *stream;
+    void **cbuf, *buf;
+    int n, i, j, len;
+    uint8_t *dest;
+
+    cbuf = emalloc(coeff->coeff.n_blocks * sizeof(void **));
+    
+    if (coeff->taps != NULL) {
+        /* read in advance, or made by combine_filter_chains() */
+        coeffs = coeff->taps;
+        len = coeff->n_taps;
+    } else if (coeff->format != COEFF_FORMAT_PROCESSED ||
+               strcmp(coeff->filename, "dirac pulse") == 0)
+    {
+        coeffs = read_coeff(coeff, realsize, &len);
     } else {
-	switch (coeff->format) {
-	case COEFF_FORMAT_TEXT:
-	    coeffs = real_read(stream, &len, coeff->filename, realsize,
-                               coeff->coeff.n_blocks * bfconf->filter_length);
-	    break;
-	case COEFF_FORMAT_RAW:
-	    coeffs = raw_read(stream, &len, &coeff->rawformat, realsize,
-                              coeff->coeff.n_blocks * bfconf->filter_length);
-	    break;
-	case COEFF_FORMAT_PROCESSED:
-	    if (coeff->shm_elements > 0) {
-		for (i = j = 0; i < coeff->shm_elements; i++) {
-		    j += coeff->shm_blocks[i];
-		}
-		if (j != coeff->coeff.n_blocks) {
-		    fprintf(stderr, "Shared memory block count mismatch in "
-			    "coeff %d.\n", coeff->coeff.intname);
-		    exit(BF_EXIT_INVALID_CONFIG);
-		}
-		for (i = j = 0; i < coeff->shm_elements; i++) {
-		    buf = get_sharedmem(coeff->shm_shmids[i],
-					coeff->shm_offsets[i]);
-		    for (n = 0; n < coeff->shm_blocks[i]; n++) {
-			cbuf[j++] =
-                            (void *)&((uint8_t *)buf)[n * convolver_cbufsize()];
-		    }
-		}
-	    } else {
-		buf =
-                    raw_read(stream, &len, &coeff->rawformat, realsize,
-                             coeff->coeff.n_blocks * convolver_cbufsize() + 1);
-		if (coeff->coeff.n_blocks * convolver_cbufsize() != len) {
-		    fprintf(stderr, "Length mismatch of file \"%s\", expected "
-			    "%d, got %d.\n",
-			    coeff->filename,
-			    coeff->coeff.n_blocks * convolver_cbufsize(), len);
-		    exit(BF_EXIT_INVALID_CONFIG);
-		}
-		for (n = 0; n < coeff->coeff.n_blocks; n++) {
-		    cbuf[n] =
+        stream = open_coeff(coeff);
+        if (coeff->shm_elements > 0) {
+            for (i = j = 0; i < coeff->shm_elements; i++) {
+                j += coeff->shm_blocks[i];
+            }
+            if (j != coeff->coeff.n_blocks) {
+                fprintf(stderr, "Shared memory block count mismatch in "
+                        "coeff %d.\n", coeff->coeff.intname);
+                exit(BF_EXIT_INVALID_CONFIG);
+            }
+            for (i = j = 0; i < coeff->shm_elements; i++) {
+                buf = get_sharedmem(coeff->shm_shmids[i],
+                                    coeff->shm_offsets[i]);
+                for (n = 0; n < coeff->shm_blocks[i]; n++) {
+                    cbuf[j++] =
                         (void *)&((uint8_t *)buf)[n * convolver_cbufsize()];
-		}
-	    }
-            if (!convolver_verify_cbuf(cbuf, coeff->coeff.n_blocks)) {
-                fprintf(stderr, "Coeff %d is invalid.\n", coeff->coeff.intname);
+                }
+            }
+        } else {
+            buf = raw_read(stream, &len, &coeff->rawformat, realsize,
+                           coeff->coeff.n_blocks * convolver_cbufsize() + 1);
+            if (coeff->coeff.n_blocks * convolver_cbufsize() != len) {
+                fprintf(stderr, "Length mismatch of file \"%s\", expected "
+                        "%d, got %d.\n",
+                        coeff->filename,
+                        coeff->coeff.n_blocks * convolver_cbufsize(), len);
                 exit(BF_EXIT_INVALID_CONFIG);
             }
-#if 0            
-            if (bfconf->debug) {
-                char filename[1024];                
-                sprintf(filename, "brutefir-%d-coeffs-%d.txt",
-                        getpid(), cindex);
-                convolver_debug_dump_cbuf(filename, cbuf,
-                                          coeff->coeff.n_blocks);
+            for (n = 0; n < coeff->coeff.n_blocks; n++) {
+                cbuf[n] = (void *)&((uint8_t *)buf)[n * convolver_cbufsize()];
             }
+        }
+        if (!convolver_verify_cbuf(cbuf, coeff->coeff.n_blocks)) {
+            fprintf(stderr, "Coeff %d is invalid.\n", coeff->coeff.intname);
+            exit(BF_EXIT_INVALID_CONFIG);
+        }
+#if 0            
+        if (bfconf->debug) {
+            char filename[1024];                
+            sprintf(filename, "brutefir-%d-coeffs-%d.txt",
+                    getpid(), cindex);
+            convolver_debug_dump_cbuf(filename, cbuf,
+                                      coeff->coeff.n_blocks);
+        }
 #endif            
-	    return cbuf;
-	default:
-	    fprintf(stderr, "Invalid format: %d.\n", coeff->format);
-	    exit(BF_EXIT_INVALID_CONFIG);
-	}
-	fclose(stream);
+        return cbuf;
     }
 
     if (len < coeff->coeff.n_blocks * bfconf->filter_length) {
 	zbuf = emalloc(bfconf->filter_length * realsize);
 	memset(zbuf, 0, bfconf->filter_length * realsize);
     }
-    if (coeff->coeff.is_shared) {
-        dest = shmalloc(2 * coeff->coeff.n_blocks * bfconf->filter_length *
-                        realsize);
+    if (coeff->coeff.is_shared &&
+        coeff->coeff.compression == BF_COEFF_COMPRESSION_NONE)
+    {
+        dest = shmalloc(coeff->coeff.n_blocks * convolver_cbufsize());
         if (dest == NULL) {
             exit(BF_EXIT_NO_MEMORY);
         }
@@ -2013,8 +2373,47 @@ load_coeff(struct coeff *coeff,
 		    coeff->filename);
 	    exit(BF_EXIT_OTHER);
 	}
-        if (coeff->coeff.is_shared) {
-            dest += 2 * bfconf->filter_length * realsize;
+        if (dest != NULL) {
+            dest += convolver_cbufsize();
+        }
+    }
+    /* short sets are also kept in the time-domain, for direct filters, with
+       leading zeros as a delay and trailing zeros dropped. Modules may change
+       shared coefficients, so those are not. */
+    if (bfconf->direct_convolution > 0 && !coeff->coeff.is_shared) {
+        for (i = len; i > 0; i--) {
+            if ((realsize == 4 && ((float *)coeffs)[i-1] != 0) ||
+                (realsize == 8 && ((double *)coeffs)[i-1] != 0))
+            {
+                break;
+            }
+        }
+        for (j = 0; j < i; j++) {
+            if ((realsize == 4 && ((float *)coeffs)[j] != 0) ||
+                (realsize == 8 && ((double *)coeffs)[j] != 0))
+            {
+                break;
+            }
+        }
+        /* a silent set is kept as a single zero */
+        if (i == 0) {
+            i = 1;
+        }
+        if (i - j <= bfconf->direct_convolution &&
+            i <= bfconf->filter_length)
+        {
+            bfconf->coeffs_n_taps[cindex] = i - j;
+            bfconf->coeffs_delay[cindex] = j;
+            bfconf->coeffs_time[cindex] = emallocaligned((i - j) * realsize);
+            for (n = 0; n < i - j; n++) {
+                if (realsize == 4) {
+                    ((float *)bfconf->coeffs_time[cindex])[n] =
+                        ((float *)coeffs)[j+n] * (float)coeff->scale;
+                } else {
+                    ((double *)bfconf->coeffs_time[cindex])[n] =
+                        ((double *)coeffs)[j+n] * coeff->scale;
+                }
+            }
         }
     }
     efree(zbuf);
@@ -2029,6 +2428,94 @@ load_coeff(struct coeff *coeff,
     return cbuf;
 }
 
+/* find the partitions of a coefficient set which are zero, or which have an
+   energy below partition_threshold relative to the whole set (these are
+   cleared), and mark them in 'zero' so they can be skipped. The spectrum
+   edges of the other partitions are trimmed as long as the energy removed
+   stays below the same level, and the bands are put in 'bands' if any is
+   narrower than the full spectrum. Returns the number of zero partitions. */
+static int
+find_zero_partitions(struct coeff *coeff,
+                     void **cbuf,
+                     uint32_t zero[],
+                     int **bands,
+                     int *n_limited,
+                     double *band_share)
+{
+    double energy[coeff->coeff.n_blocks], total = 0, share;
+    int band[coeff->coeff.n_blocks][2];
+    int n, count = 0;
+
+    for (n = 0; n < coeff->coeff.n_blocks; n++) {
+        energy[n] = convolver_cbuf_energy(cbuf[n]);
+        total += energy[n];
+    }
+    *n_limited = 0;
+    *band_share = 0;
+    for (n = 0; n < coeff->coeff.n_blocks; n++) {
+        if (energy[n] == 0 || energy[n] < total * bfconf->partition_threshold) {
+            memset(cbuf[n], 0, convolver_cbufsize());
+            bit_set(zero, n);
+            count++;
+            band[n][0] = band[n][1] = 0;
+            continue;
+        }
+        share = convolver_band_limit(cbuf[n], total *
+                                     bfconf->partition_threshold, band[n]);
+        if (share == 0) {
+            bit_set(zero, n);
+            count++;
+        } else if (share < 1.0) {
+            (*n_limited)++;
+            *band_share += share;
+        }
+    }
+    *bands = NULL;
+    if (*n_limited > 0) {
+        *band_share /= *n_limited;
+        *bands = emalloc(2 * coeff->coeff.n_blocks * sizeof(int));
+        memcpy(*bands, band, 2 * coeff->coeff.n_blocks * sizeof(int));
+    }
+    return count;
+}
+
+/* replace the partitions of a coefficient set with compressed versions, and
+   return the energy of the error relative to the energy of the set */
+static double
+compress_coeff(struct coeff *coeff,
+               void **cbuf)
+{
+    double signal_energy = 0, error_energy = 0;
+    void *processed_buf = NULL;
+    uint8_t *dest;
+    int n, size;
+
+    if (coeff->format == COEFF_FORMAT_PROCESSED) {
+        /* all partitions are in one buffer */
+        processed_buf = cbuf[0];
+    }
+    size = convolver_compressed_cbufsize(coeff->coeff.compression);
+    if (coeff->coeff.is_shared) {
+        /* the compressed set is the one modules write to */
+        if ((dest = shmalloc(coeff->coeff.n_blocks * size)) == NULL) {
+            exit(BF_EXIT_NO_MEMORY);
+        }
+    } else {
+        dest = emallocaligned(coeff->coeff.n_blocks * size);
+    }
+    for (n = 0; n < coeff->coeff.n_blocks; n++) {
+        convolver_compress_coeffs(cbuf[n], dest, coeff->coeff.compression,
+                                  &signal_energy, &error_energy);
+        if (processed_buf == NULL) {
+            efree(cbuf[n]);
+        }
+        cbuf[n] = dest;
+        dest += size;
+    }
+    efree(processed_buf);
+    return signal_energy > 0 ? error_energy / signal_energy : 0;
+}
+
 static bool_t
 filter_loop(int source_intname,
 	    int search_intname)
@@ -2047,6 +2534,280 @@ filter_loop(int source_intname,
     return false;
 }
 
+/* get the time-domain coefficients of a set, without trailing zeros, or NULL
+   if the set is not available in the time-domain before loading */
+static void *
+coeff_taps(struct coeff *coeff,
+           int *n_taps)
+{
+    int n;
+
+    if (coeff->coeff.is_shared || coeff->coeff.n_blocks > bfconf->n_blocks ||
+        (coeff->format == COEFF_FORMAT_PROCESSED &&
+         strcmp(coeff->filename, "dirac pulse") != 0))
+    {
+        return NULL;
+    }
+    if (coeff->taps == NULL) {
+        if (coeff->coeff.n_blocks <= 0) {
+            coeff->coeff.n_blocks = bfconf->n_blocks;
+        }
+        coeff->taps = read_coeff(coeff, bfconf->realsize, &coeff->n_taps);
+    }
+    for (n = coeff->n_taps; n > 1; n--) {
+        if ((bfconf->realsize == 4 && ((float *)coeff->taps)[n-1] != 0) ||
+            (bfconf->realsize == 8 && ((double *)coeff->taps)[n-1] != 0))
+        {
+            break;
+        }
+    }
+    *n_taps = n;
+    return n > 0 ? coeff->taps : NULL;
+}
+
+/* check if two filters in series, with the given coefficient sets (-1 is no
+   set) and delays, can be replaced by one which gives the same result */
+static bool_t
+can_combine_coeffs(struct coeff *coeffs[],
+                   int a,
+                   int delay_a,
+                   int b,
+                   int delay_b)
+{
+    int n, coeff[2], delay[2], n_taps[2];
+
+    if (delay_a + delay_b > bfconf->n_blocks - 1) {
+        return false;
+    }
+    coeff[0] = a;
+    coeff[1] = b;
+    delay[0] = delay_a;
+    delay[1] = delay_b;
+    for (n = 0; n < 2; n++) {
+        n_taps[n] = 1;
+        if (coeff[n] != -1 &&
+            coeff_taps(coeffs[coeff[n]], &n_taps[n]) == NULL)
+        {
+            return false;
+        }
+        /* a filter only convolves with the blocks its delay leaves over, so
+           sets which are cut are not combined */
+        if (n_taps[n] > (bfconf->n_blocks - delay[n]) * bfconf->filter_length)
+        {
+            return false;
+        }
+    }
+    if (a != -1 && b != -1 &&
+        coeffs[a]->coeff.compression != coeffs[b]->coeff.compression)
+    {
+        return false;
+    }
+    return n_taps[0] + n_taps[1] - 1 <=
+        (bfconf->n_blocks - delay_a - delay_b) * bfconf->filter_length;
+}
+
+/* get the coefficient set which is the convolution of sets 'a' and 'b' (-1
+   is no set), it is made if it does not exist already */
+static int
+combine_coeffs(struct coeff ***coeffs,
+               int *coeffs_capacity,
+               int a,
+               int b)
+{
+    struct coeff *coeff, *coeff_a, *coeff_b;
+    void *taps[2];
+    int n, n_taps[2];
+
+    if (a == -1 || b == -1) {
+        return a == -1 ? b : a;
+    }
+    for (n = 0; n < bfconf->n_coeffs; n++) {
+        if ((*coeffs)[n]->combined && (*coeffs)[n]->source[0] == a &&
+            (*coeffs)[n]->source[1] == b)
+        {
+            return n;
+        }
+    }
+    coeff_a = (*coeffs)[a];
+    coeff_b = (*coeffs)[b];
+    taps[0] = coeff_taps(coeff_a, &n_taps[0]);
+    taps[1] = coeff_taps(coeff_b, &n_taps[1]);
+    coeff = emalloc(sizeof(struct coeff));
+    memset(coeff, 0, sizeof(struct coeff));
+    sprintf(coeff->coeff.name, "%.*s*%.*s", BF_MAXOBJECTNAME / 2 - 1,
+            coeff_a->coeff.name, BF_MAXOBJECTNAME / 2 - 1,
+            coeff_b->coeff.name);
+    coeff->coeff.intname = bfconf->n_coeffs;
+    coeff->coeff.compression = coeff_a->coeff.compression;
+    strcpy(coeff->filename, coeff->coeff.name);
+    coeff->format = COEFF_FORMAT_RAW;
+    coeff->scale = 1.0;
+    coeff->n_taps = n_taps[0] + n_taps[1] - 1;
+    coeff->coeff.n_blocks = (coeff->n_taps + bfconf->filter_length - 1) /
+        bfconf->filter_length;
+    coeff->taps = convolver_combine_coeffs(taps[0], n_taps[0], coeff_a->scale,
+                                           taps[1], n_taps[1], coeff_b->scale);
+    coeff->combined = true;
+    coeff->source[0] = a;
+    coeff->source[1] = b;
+    if (bfconf->n_coeffs == *coeffs_capacity) {
+        *coeffs_capacity += 16;
+        *coeffs = erealloc(*coeffs, *coeffs_capacity * sizeof(void *));
+    }
+    (*coeffs)[bfconf->n_coeffs] = coeff;
+    return bfconf->n_coeffs++;
+}
+
+/* a filter combined into others keeps its index, so modules addressing
+   filters by index still hit the right one, but it is not processed */
+static void
+absorb_filter(struct filter *pfilters[],
+              int intname)
+{
+    FOR_IN_AND_OUT {
+        efree(pfilters[intname]->filter.channels[IO]);
+        efree(pfilters[intname]->filter.filters[IO]);
+        pfilters[intname]->filter.channels[IO] = NULL;
+        pfilters[intname]->filter.filters[IO] = NULL;
+        pfilters[intname]->filter.n_channels[IO] = 0;
+        pfilters[intname]->filter.n_filters[IO] = 0;
+    }
+    pfilters[intname]->filter.absorbed = true;
+}
+
+/* A filter which only feeds another filter is combined with it, so the pair
+   is convolved as one filter with the convolution of their coefficient sets,
+   if both have the fixed field set, that is their coefficients, scales and
+   delays cannot change in runtime. If all filters feeding a filter have
+   the same coefficient set and delay, the filter takes over their inputs,
+   otherwise if the filter only outputs to channels, each filter feeding it
+   takes over its outputs. This is repeated until no more filters can be
+   combined. */
+static void
+combine_filter_chains(struct filter *pfilters[],
+                      struct coeff ***coeffs,
+                      int *coeffs_capacity)
+{
+    int channels[BF_MAXCHANNELS], sources[BF_MAXFILTERS];
+    double scales[BF_MAXCHANNELS];
+    struct filter *dst, *src;
+    int n, i, j, k, n_sources, n_channels;
+    bool_t changed, same;
+
+    do {
+        changed = false;
+        for (n = 0; n < bfconf->n_filters && !changed; n++) {
+            dst = pfilters[n];
+            n_sources = dst->filter.n_filters[IN];
+            if (n_sources == 0 || dst->filter.n_channels[IN] > 0 ||
+                !dst->filter.fixed)
+            {
+                continue;
+            }
+            same = true;
+            for (i = 0; i < n_sources; i++) {
+                sources[i] = dst->filter.filters[IN][i];
+                src = pfilters[sources[i]];
+                if (!src->filter.fixed ||
+                    src->filter.n_filters[IN] != 0 ||
+                    src->filter.n_channels[OUT] != 0 ||
+                    src->filter.n_filters[OUT] != 1 ||
+                    src->filter.filters[OUT][0] != n ||
+                    src->process != dst->process ||
+                    src->filter.realsize != dst->filter.realsize ||
+                    !can_combine_coeffs(*coeffs, src->fctrl.coeff,
+                                        src->fctrl.delayblocks,
+                                        dst->fctrl.coeff,
+                                        dst->fctrl.delayblocks))
+                {
+                    break;
+                }
+                if (src->fctrl.coeff != pfilters[sources[0]]->fctrl.coeff ||
+                    src->fctrl.delayblocks !=
+                    pfilters[sources[0]]->fctrl.delayblocks)
+                {
+                    same = false;
+                }
+            }
+            if (i < n_sources ||
+                (!same && dst->filter.n_filters[OUT] > 0))
+            {
+                continue;
+            }
+            changed = true;
+            if (same) {
+                /* take over the inputs of the sources */
+                n_channels = 0;
+                for (i = 0; i < n_sources; i++) {
+                    src = pfilters[sources[i]];
+                    for (j = 0; j < src->filter.n_channels[IN]; j++) {
+                        for (k = 0; k < n_channels; k++) {
+                            if (channels[k] == src->filter.channels[IN][j]) {
+                                break;
+                            }
+                        }
+                        if (k == n_channels) {
+                            channels[n_channels] = src->filter.channels[IN][j];
+                            scales[n_channels++] = 0;
+                        }
+                        scales[k] += src->fctrl.scale[IN][j] *
+                            dst->fctrl.fscale[i];
+                    }
+                    dst->filter.double_accumulation |=
+                        src->filter.double_accumulation;
+                    pinfo("Filter \"%s\" is combined with filter \"%s\".\n",
+                          src->filter.name, dst->filter.name);
+                }
+                dst->filter.n_channels[IN] = n_channels;
+                dst->filter.channels[IN] = emalloc(n_channels * sizeof(int));
+                memcpy(dst->filter.channels[IN], channels,
+                       n_channels * sizeof(int));
+                memcpy(dst->fctrl.scale[IN], scales,
+                       n_channels * sizeof(double));
+                dst->filter.n_filters[IN] = 0;
+                efree(dst->filter.filters[IN]);
+                dst->filter.filters[IN] = NULL;
+                /* the sources all have the same coefficient set and delay */
+                src = pfilters[sources[0]];
+                dst->fctrl.coeff = combine_coeffs(coeffs, coeffs_capacity,
+                                                  src->fctrl.coeff,
+                                                  dst->fctrl.coeff);
+                dst->fctrl.delayblocks += src->fctrl.delayblocks;
+                for (i = 0; i < n_sources; i++) {
+                    absorb_filter(pfilters, sources[i]);
+                }
+                continue;
+            }
+            /* let each source take over the outputs */
+            for (i = 0; i < n_sources; i++) {
+                src = pfilters[sources[i]];
+                for (j = 0; j < src->filter.n_channels[IN]; j++) {
+                    src->fctrl.scale[IN][j] *= dst->fctrl.fscale[i];
+                }
+                src->filter.n_channels[OUT] = dst->filter.n_channels[OUT];
+                src->filter.channels[OUT] =
+                    emalloc(dst->filter.n_channels[OUT] * sizeof(int));
+                memcpy(src->filter.channels[OUT], dst->filter.channels[OUT],
+                       dst->filter.n_channels[OUT] * sizeof(int));
+                memcpy(src->fctrl.scale[OUT], dst->fctrl.scale[OUT],
+                       dst->filter.n_channels[OUT] * sizeof(double));
+                src->filter.n_filters[OUT] = 0;
+                efree(src->filter.filters[OUT]);
+                src->filter.filters[OUT] = NULL;
+                src->filter.double_accumulation |=
+                    dst->filter.double_accumulation;
+                src->fctrl.coeff = combine_coeffs(coeffs, coeffs_capacity,
+                                                  src->fctrl.coeff,
+                                                  dst->fctrl.coeff);
+                src->fctrl.delayblocks += dst->fctrl.delayblocks;
+                pinfo("Filter \"%s\" is combined with filter \"%s\".\n",
+                      dst->filter.name, src->filter.name);
+            }
+            absorb_filter(pfilters, n);
+        }
+    } while (changed);
+}
+
 static void *
 load_module_function(void *handle,
 		     const char modname[],
@@ -2238,7 +2999,7 @@ load_balance_filters(struct filter *pfilters[])
     process = 0;
     for (n = 0; n < bfconf->n_filters; n++) {
         set = false;
-        if (pfilters[n]->process != -1) {
+        if (pfilters[n]->process != -1 || pfilters[n]->filter.absorbed) {
             continue;
         }
         pfilters[n]->process = process;
@@ -2317,14 +3078,98 @@ load_balance_filters(struct filter *pfilters[])
     return process < bfconf->n_cpus ? process - 1 : bfconf->n_cpus - 1;
 }
 
+/* decide which filters are direct filters, that is convolved in the
+   time-domain. A filter qualifies if its coefficient set is kept in the
+   time-domain, it is not connected to other filters, and all other filters
+   using its input and output channels qualify too, so the FFTs of those
+   channels can be skipped. Modules which work in the frequency-domain, or
+   choose coefficients, rule out direct filters altogether. */
+static void
+find_direct_filters(void)
+{
+    struct bffilter *filter;
+    bool_t changed;
+    int n, i, coeff;
+
+    bfconf->direct_filter = emalloc(bfconf->n_filters * sizeof(bool_t));
+    memset(bfconf->direct_filter, 0, bfconf->n_filters * sizeof(bool_t));
+    for (n = 0; n < bfconf->n_coeffs; n++) {
+        bfconf->coeffs[n].time_domain = bfconf->coeffs_time[n] != NULL;
+    }
+    for (n = 0; n < bfconf->n_filters; n++) {
+        bfconf->filters[n].direct = false;
+    }
+    FOR_IN_AND_OUT {
+        bfconf->direct[IO] = emalloc(bfconf->n_channels[IO] * sizeof(bool_t));
+        memset(bfconf->direct[IO], 0, bfconf->n_channels[IO] * sizeof(bool_t));
+    }
+    if (bfconf->direct_convolution == 0) {
+        return;
+    }
+    for (n = 0; n < bfconf->n_logicmods; n++) {
+        if (bfconf->logicmods[n].bfevents.input_freqd != NULL ||
+            bfconf->logicmods[n].bfevents.output_freqd != NULL ||
+            bfconf->logicmods[n].bfevents.pre_convolve != NULL ||
+            bfconf->logicmods[n].bfevents.post_convolve != NULL ||
+            bfconf->logicmods[n].bfevents.coeff_final != NULL)
+        {
+            pinfo("Logic module \"%s\" works in the frequency-domain, no "
+                  "filters are direct.\n", bfconf->logicnames[n]);
+            return;
+        }
+    }
+    for (n = 0; n < bfconf->n_filters; n++) {
+        filter = &bfconf->filters[n];
+        coeff = bfconf->initfctrl[n].coeff;
+        bfconf->direct_filter[n] = bfconf->matrix_coeffs[n] == NULL &&
+            filter->n_filters[IN] == 0 && filter->n_filters[OUT] == 0 &&
+            filter->n_channels[IN] > 0 && filter->n_channels[OUT] > 0 &&
+            !filter->crossfade &&
+            (coeff < 0 || bfconf->coeffs_time[coeff] != NULL);
+        FOR_IN_AND_OUT {
+            for (i = 0; i < filter->n_channels[IO]; i++) {
+                bfconf->direct[IO][filter->channels[IO][i]] = true;
+            }
+        }
+    }
+    do {
+        changed = false;
+        for (n = 0; n < bfconf->n_filters; n++) {
+            filter = &bfconf->filters[n];
+            FOR_IN_AND_OUT {
+                for (i = 0; i < filter->n_channels[IO]; i++) {
+                    if (bfconf->direct_filter[n] !=
+                        bfconf->direct[IO][filter->channels[IO][i]])
+                    {
+                        bfconf->direct_filter[n] = false;
+                        bfconf->direct[IO][filter->channels[IO][i]] = false;
+                        changed = true;
+                    }
+                }
+            }
+        }
+    } while (changed);
+    for (n = 0; n < bfconf->n_filters; n++) {
+        bfconf->filters[n].direct = bfconf->direct_filter[n];
+        if (bfconf->direct_filter[n]) {
+            pinfo("Filter %d/\"%s\" is convolved in the time-domain.\n", n,
+                  bfconf->filters[n].name);
+        }
+    }
+}
+
 void
 bfconf_init(char filename[],
 	    bool_t quiet,
-            bool_t nodefault)
+            bool_t nodefault,
+            int plan)
 {
     struct iodev *iodevs[2][BF_MAXCHANNELS];
     struct filter *pfilters[BF_MAXFILTERS];
     struct coeff **coeffs = NULL;
+    double *coeffs_error;
+    int *coeffs_n_zero, *coeffs_n_limited;
+    double *coeffs_band_share;
     struct bffilter filters[BF_MAXFILTERS];
     struct dither_state *dither_state[BF_MAXCHANNELS];
     struct timeval tv1, tv2;
@@ -2364,6 +3209,9 @@ bfconf_init(char filename[],
     bfconf->quiet = quiet;
     bfconf->realsize = sizeof(float);
     bfconf->safety_limit = 0;
+    bfconf->direct_convolution = 0;
+    bfconf->fft_threads = 1;
+    bfconf->plan = plan;
 
     if (!nodefault) {
         get_defaults();
@@ -2426,6 +3274,14 @@ bfconf_init(char filename[],
 		parse_filter(false, bfconf->n_filters);
 	    bfconf->n_filters++;
 	    break;
+	case MATRIX:
+	    if (bfconf->n_filters == BF_MAXFILTERS) {
+		parse_error("too many filters.\n");
+	    }
+	    pfilters[bfconf->n_filters] = parse_matrix();
+	    pfilters[bfconf->n_filters]->filter.intname = bfconf->n_filters;
+	    bfconf->n_filters++;
+	    break;
 	case EOF:
 	    break;
 	default:
@@ -2543,6 +3399,15 @@ bfconf_init(char filename[],
 	}
     }
     
+    /* with 32 bit floats fp32 is no compression */
+    for (n = 0; n < bfconf->n_coeffs && bfconf->realsize == sizeof(float);
+         n++)
+    {
+        if (coeffs[n]->coeff.compression == BF_COEFF_COMPRESSION_FP32) {
+            coeffs[n]->coeff.compression = BF_COEFF_COMPRESSION_NONE;
+        }
+    }
+
     /* finish and sanity check filter structures */
     memset(used_channels, 0, sizeof(used_channels));
     memset(used_processes, 0, sizeof(used_processes));
@@ -2576,6 +3441,47 @@ bfconf_init(char filename[],
 	    }
 	}
 
+        /* the coefficient sets of a matrix, which are summed together and
+           therefore must be stored in the same way */
+        for (j = 0; pfilters[n]->matrix_coeffs != NULL &&
+                 j < pfilters[n]->filter.n_channels[IN] *
+                 pfilters[n]->filter.n_channels[OUT]; j++)
+        {
+            if (pfilters[n]->matrix_coeff_name[j] != NULL) {
+                pfilters[n]->matrix_coeffs[j] = -1;
+                for (i = 0; i < bfconf->n_coeffs; i++) {
+                    if (strcmp(coeffs[i]->coeff.name,
+                               pfilters[n]->matrix_coeff_name[j]) == 0)
+                    {
+                        pfilters[n]->matrix_coeffs[j] = i;
+                        break;
+                    }
+                }
+                if (pfilters[n]->matrix_coeffs[j] == -1) {
+                    fprintf(stderr, "Coeff with name \"%s\" (in filter "
+                            "%d/\"%s\") does not exist.\n",
+                            pfilters[n]->matrix_coeff_name[j],
+                            n, pfilters[n]->filter.name);
+                    exit(BF_EXIT_INVALID_CONFIG);
+                }
+                efree(pfilters[n]->matrix_coeff_name[j]);
+            } else if (pfilters[n]->matrix_coeffs[j] < 0 ||
+                       pfilters[n]->matrix_coeffs[j] >= bfconf->n_coeffs)
+            {
+		fprintf(stderr, "Coeff index %d in filter %d/\"%s\" is out of "
+			"range.\n", pfilters[n]->matrix_coeffs[j],
+                        n, pfilters[n]->filter.name);
+		exit(BF_EXIT_INVALID_CONFIG);
+            }
+            if (coeffs[pfilters[n]->matrix_coeffs[j]]->coeff.compression !=
+                coeffs[pfilters[n]->matrix_coeffs[0]]->coeff.compression)
+            {
+                fprintf(stderr, "The coefficient sets of filter %d/\"%s\" "
+                        "must have the same compression.\n",
+                        n, pfilters[n]->filter.name);
+		exit(BF_EXIT_INVALID_CONFIG);
+            }
+        }
         if (pfilters[n]->process == -1) {
             if (n > 0 && !load_balance) {
                 fprintf(stderr, "Cannot mix manual process settings with "
@@ -2692,6 +3598,32 @@ bfconf_init(char filename[],
 	    }	    
 	}
 
+	/* filters without their own setting use the global one */
+	if (pfilters[n]->filter.double_accumulation == -1) {
+	    pfilters[n]->filter.double_accumulation =
+                bfconf->double_accumulation;
+	}
+	if (pfilters[n]->filter.realsize == 0) {
+	    pfilters[n]->filter.realsize = bfconf->realsize;
+	}
+        if (pfilters[n]->filter.realsize > bfconf->realsize) {
+	    fprintf(stderr, "Filter %d/\"%s\" cannot use more float_bits than "
+                    "the global setting.\n", n, pfilters[n]->filter.name);
+	    exit(BF_EXIT_INVALID_CONFIG);
+        }
+        /* a filter with less precision cannot convolve with coefficients
+           stored in full precision */
+        if (pfilters[n]->filter.realsize < bfconf->realsize &&
+            pfilters[n]->fctrl.coeff >= 0 &&
+            coeffs[pfilters[n]->fctrl.coeff]->coeff.compression ==
+            BF_COEFF_COMPRESSION_NONE)
+        {
+	    fprintf(stderr, "The coefficients of filter %d/\"%s\" must be "
+                    "stored as \"fp32\", \"fp16\" or \"bf16\".\n",
+                    n, pfilters[n]->filter.name);
+	    exit(BF_EXIT_INVALID_CONFIG);
+        }
+	
 	/* finish delayblocks number */
 	if (pfilters[n]->fctrl.delayblocks > bfconf->n_blocks - 1) {
 	    fprintf(stderr, "Delay in filter %d/\"%s\" is too large (max "
@@ -2721,13 +3653,45 @@ bfconf_init(char filename[],
 	}
     }
 
+    if (bfconf->nonuniform_partitions &&
+        bfconf->max_partition_length != 0 &&
+        bfconf->max_partition_length < 2 * bfconf->filter_length)
+    {
+        fprintf(stderr, "The max partition length must be at least "
+                "2 x filter_length.\n");
+	exit(BF_EXIT_INVALID_CONFIG);
+    }
+    if (bfconf->processing_margin > bfconf->filter_length) {
+        fprintf(stderr, "The processing_margin must not exceed "
+                "filter_length.\n");
+	exit(BF_EXIT_INVALID_CONFIG);
+    }
+
+/*    if (convolver_init != NULL) {*/
+	/* initialise convolver */
+	if (!convolver_init(convolver_config, bfconf->filter_length,
+                            bfconf->realsize))
+        {
+	    fprintf(stderr, "Convolver initialisation failed.\n");
+	    exit(BF_EXIT_OTHER);
+	}
+	efree(convolver_config);
+/*    }*/
+    convolver_nu_init(bfconf->n_blocks, bfconf->nonuniform_partitions,
+                      bfconf->max_partition_length);
+
+    /* combine filters in series which cannot change in runtime */
+    combine_filter_chains(pfilters, &coeffs, &coeffs_capacity);
+
     /* fill in the filters and initfctrl array */
     bfconf->filters = emalloc(bfconf->n_filters * sizeof(struct bffilter));
     bfconf->initfctrl = emalloc(bfconf->n_filters *
 				sizeof(struct bffilter_control));
+    bfconf->matrix_coeffs = emalloc(bfconf->n_filters * sizeof(int *));
     for (n = 0; n < bfconf->n_filters; n++) {
 	bfconf->filters[n] = pfilters[n]->filter;
 	bfconf->initfctrl[n] = pfilters[n]->fctrl;
+        bfconf->matrix_coeffs[n] = pfilters[n]->matrix_coeffs;
     }
 
     /* check so filters are connected, that is that output to a filter shows
@@ -2781,17 +3745,6 @@ bfconf_init(char filename[],
         largest_process = load_balance_filters(pfilters);
     }
 
-/*    if (convolver_init != NULL) {*/
-	/* initialise convolver */
-	if (!convolver_init(convolver_config, bfconf->filter_length,
-                            bfconf->realsize))
-        {
-	    fprintf(stderr, "Convolver initialisation failed.\n");
-	    exit(BF_EXIT_OTHER);
-	}
-	efree(convolver_config);
-/*    }*/
-
     /* init subdelay */
     if (bfconf->sdf_length < 0) {
         bfconf->use_subdelay[IN] = false;
@@ -2817,12 +3770,22 @@ bfconf_init(char filename[],
 
     /* load coefficients */
     bfconf->coeffs_data = emalloc(bfconf->n_coeffs * sizeof(void **));
+    bfconf->coeffs_tail = emalloc(bfconf->n_coeffs * sizeof(void *));
     bfconf->coeffs = emalloc(bfconf->n_coeffs * sizeof(struct bfcoeff));
     if (bfconf->n_coeffs == 1) {
         pinfo("Loading coefficient set...");
     } else if (bfconf->n_coeffs > 1) {
         pinfo("Loading %d coefficient sets...", bfconf->n_coeffs);
     }
+    coeffs_error = emalloc(bfconf->n_coeffs * sizeof(double));
+    coeffs_n_zero = emalloc(bfconf->n_coeffs * sizeof(int));
+    bfconf->coeffs_zero = emalloc(bfconf->n_coeffs * sizeof(uint32_t *));
+    bfconf->coeffs_band = emalloc(bfconf->n_coeffs * sizeof(int *));
+    bfconf->coeffs_time = emalloc(bfconf->n_coeffs * sizeof(void *));
+    bfconf->coeffs_n_taps = emalloc(bfconf->n_coeffs * sizeof(int));
+    bfconf->coeffs_delay = emalloc(bfconf->n_coeffs * sizeof(int));
+    coeffs_n_limited = emalloc(bfconf->n_coeffs * sizeof(int));
+    coeffs_band_share = emalloc(bfconf->n_coeffs * sizeof(double));
     for (n = 0; n < bfconf->n_coeffs; n++) {
 	if (coeffs[n]->coeff.n_blocks <= 0) {
 	    coeffs[n]->coeff.n_blocks = bfconf->n_blocks;
@@ -2830,7 +3793,32 @@ bfconf_init(char filename[],
 	    fprintf(stderr, "Too many blocks in coeff %d.\n", n);
 	    exit(BF_EXIT_INVALID_CONFIG);
 	}
+        bfconf->coeffs_time[n] = NULL;
+        bfconf->coeffs_n_taps[n] = 0;
+        bfconf->coeffs_delay[n] = 0;
 	bfconf->coeffs_data[n] = load_coeff(coeffs[n], n, bfconf->realsize);
+        i = coeffs[n]->coeff.n_blocks / 32 + 1;
+        bfconf->coeffs_zero[n] = emalloc(i * sizeof(uint32_t));
+        memset(bfconf->coeffs_zero[n], 0, i * sizeof(uint32_t));
+        coeffs_n_zero[n] = 0;
+        coeffs_n_limited[n] = 0;
+        bfconf->coeffs_band[n] = NULL;
+        /* modules may change shared coefficients */
+        if (!coeffs[n]->coeff.is_shared) {
+            coeffs_n_zero[n] =
+                find_zero_partitions(coeffs[n], bfconf->coeffs_data[n],
+                                     bfconf->coeffs_zero[n],
+                                     &bfconf->coeffs_band[n],
+                                     &coeffs_n_limited[n],
+                                     &coeffs_band_share[n]);
+        }
+        bfconf->coeffs_tail[n] =
+            convolver_nu_coeffs(bfconf->coeffs_data[n],
+                                coeffs[n]->coeff.n_blocks);
+        if (coeffs[n]->coeff.compression != BF_COEFF_COMPRESSION_NONE) {
+            coeffs_error[n] = compress_coeff(coeffs[n],
+                                             bfconf->coeffs_data[n]);
+        }
 	bfconf->coeffs[n] = coeffs[n]->coeff;
 	efree(coeffs[n]);
     }
@@ -2838,6 +3826,41 @@ bfconf_init(char filename[],
         pinfo("finished.\n");
     }
     efree(coeffs);
+    for (n = 0; n < bfconf->n_coeffs; n++) {
+        if (coeffs_n_zero[n] > 0) {
+            pinfo("Coeff %d/\"%s\" has %d of %d partitions zero, they are "
+                  "skipped.\n", n, bfconf->coeffs[n].name, coeffs_n_zero[n],
+                  bfconf->coeffs[n].n_blocks);
+        }
+        if (coeffs_n_limited[n] > 0) {
+            pinfo("Coeff %d/\"%s\" has %d band-limited partitions, using "
+                  "%.0f%% of the spectrum on average.\n", n,
+                  bfconf->coeffs[n].name, coeffs_n_limited[n],
+                  100.0 * coeffs_band_share[n]);
+        }
+        switch (bfconf->coeffs[n].compression) {
+        case BF_COEFF_COMPRESSION_FP32:
+        case BF_COEFF_COMPRESSION_FP16:
+        case BF_COEFF_COMPRESSION_BF16:
+            pinfo("Coeff %d/\"%s\" is stored as %s, ", n,
+                  bfconf->coeffs[n].name,
+                  bfconf->coeffs[n].compression == BF_COEFF_COMPRESSION_FP32 ?
+                  "fp32" :
+                  bfconf->coeffs[n].compression == BF_COEFF_COMPRESSION_FP16 ?
+                  "fp16" : "bf16");
+            if (coeffs_error[n] > 0) {
+                pinfo("the error is %.1f dB.\n",
+                      10.0 * log10(coeffs_error[n]));
+            } else {
+                pinfo("without error.\n");
+            }
+            break;
+        }
+    }
+    efree(coeffs_error);
+    efree(coeffs_n_zero);
+    efree(coeffs_n_limited);
+    efree(coeffs_band_share);
 
     /* shorten mute array */
     FOR_IN_AND_OUT {
@@ -2857,7 +3880,7 @@ bfconf_init(char filename[],
 	n_channels[IN] = n_channels[OUT] = 0;
 	memset(used_channels, 0, sizeof(used_channels));
 	for (i = 0; i < bfconf->n_filters; i++) {
-	    if (pfilters[i]->process == n) {
+	    if (pfilters[i]->process == n && !pfilters[i]->filter.absorbed) {
 		filters[bfconf->fproc[n].n_filters] = pfilters[i]->filter;
 		bfconf->fproc[n].n_filters++;
 		FOR_IN_AND_OUT {
@@ -3024,6 +4047,7 @@ bfconf_init(char filename[],
 	fprintf(stderr, "Too many processes.\n");
 	exit(BF_EXIT_INVALID_CONFIG);
     }
+    find_direct_filters();
     
     /* load bfio modules */
     bfconf->iomods = emalloc(BF_MAXMODULES * sizeof(struct bfio_module));
@@ -50,6 +50,12 @@ struct bfconf {
     int n_coeffs;
     struct bfcoeff *coeffs;
     void ***coeffs_data;
+    void **coeffs_tail;
+    uint32_t **coeffs_zero;
+    int **coeffs_band;
+    void **coeffs_time;
+    int *coeffs_n_taps;
+    int *coeffs_delay;
     int n_channels[2];
     struct bfchannel *channels[2];
     int n_physical_channels[2];
@@ -77,6 +83,24 @@ struct bfconf {
     int sdf_length;
     double sdf_beta;
     double safety_limit;
+    bool_t nonuniform_partitions;
+    int max_partition_length;
+    char *cpu_optimisation;
+    bool_t interleaved_partitions;
+    bool_t complex_spectrum;
+    bool_t double_accumulation;
+    double partition_threshold;
+    int direct_convolution;
+    bool_t *direct_filter;
+    bool_t *direct[2];
+    int fft_threads;
+    char *fft_backend;
+    int processing_margin;
+    int **matrix_coeffs;
+#define BF_PLAN_NONE       0
+#define BF_PLAN_PATIENT    1
+#define BF_PLAN_EXHAUSTIVE 2
+    int plan;
 };
 
 extern struct bfconf *bfconf;
@@ -84,6 +108,7 @@ extern struct bfconf *bfconf;
 void
 bfconf_init(char filename[],
 	    bool_t quiet,
-            bool_t nodefault);
+            bool_t nodefault,
+            int plan);
 
 #endif
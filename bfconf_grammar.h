@@ -27,6 +27,7 @@
 #define INPUT   201
 #define OUTPUT  202
 #define FILTER  203
+#define MATRIX  204
 
 extern union bflexval yylval;
 extern FILE *yyin;
@@ -408,6 +408,24 @@ get_id(FILE *stream,
     return true;
 }
 
+/* fixed filters may have been combined with others at startup */
+static bool_t
+is_fixed(FILE *stream,
+         int filter)
+{
+    if (filters[filter].absorbed) {
+        fprintf(stream, "Filter %d is combined into other filters and cannot "
+                "be changed.\n", filter);
+        return true;
+    }
+    if (filters[filter].fixed) {
+        fprintf(stream, "Filter %d is fixed and cannot be changed.\n",
+                filter);
+        return true;
+    }
+    return false;
+}
+
 static bool_t
 parse_command(FILE *stream,
 	      char cmd[],
@@ -422,7 +440,9 @@ parse_command(FILE *stream,
     if (strcmp(cmd, "lf") == 0) {
 	fprintf(stream, "Filters:\n");
 	for (n = 0; n < n_filters; n++) {
-	    fprintf(stream, "  %d: \"%s\"\n", n, filters[n].name);
+	    fprintf(stream, "  %d: \"%s\"%s\n", n, filters[n].name,
+                    filters[n].absorbed ? " (combined into other filters)" :
+                    "");
 	    if (fctrl[n].coeff < 0) {
 		fprintf(stream, "      coeff set: %d (no filter)\n",
 			fctrl[n].coeff);
@@ -532,6 +552,7 @@ parse_command(FILE *stream,
 	}
     } else if (strstr(cmd, "cffa") == cmd) {
 	if (get_id(stream, cmd + 4, &cmd, &rid, FILTER_ID, -1) &&
+            !is_fixed(stream, rid) &&
 	    get_id(stream, cmd, &cmd, &id, FILTER_ID, rid))
 	{
             if (*cmd == 'M' || *cmd == 'm') {
@@ -559,6 +580,7 @@ parse_command(FILE *stream,
 	}
     } else if (strstr(cmd, "cfia") == cmd) {
 	if (get_id(stream, cmd + 4, &cmd, &rid, FILTER_ID, -1) &&
+            !is_fixed(stream, rid) &&
 	    get_id(stream, cmd, &cmd, &id, INPUT_ID, rid))
 	{
             if (*cmd == 'M' || *cmd == 'm') {
@@ -586,6 +608,7 @@ parse_command(FILE *stream,
 	}
     } else if (strstr(cmd, "cfoa") == cmd) {
 	if (get_id(stream, cmd + 4, &cmd, &rid, FILTER_ID, -1) &&
+            !is_fixed(stream, rid) &&
 	    get_id(stream, cmd, &cmd, &id, OUTPUT_ID, rid))
 	{
             if (*cmd == 'M' || *cmd == 'm') {
@@ -650,13 +673,31 @@ parse_command(FILE *stream,
 	}
     } else if (strstr(cmd, "cfc") == cmd) {
 	if (get_id(stream, cmd + 3, &cmd, &rid, FILTER_ID, -1) &&
+            !is_fixed(stream, rid) &&
 	    get_id(stream, cmd, &cmd, &id, COEFF_ID, rid))
 	{
-	    newstate.fctrl[rid].coeff = id;
-            newstate.fchanged[rid] = true;
+            if (filters[rid].matrix) {
+                fprintf(stream, "The coefficients of matrices cannot be "
+                        "changed.\n");
+            } else if (id >= 0 && filters[rid].realsize < bfaccess->realsize &&
+                       coeffs[id].compression == BF_COEFF_COMPRESSION_NONE)
+            {
+                fprintf(stream, "The filter has less float_bits than the "
+                        "coefficients, they must be compressed.\n");
+            } else if (id >= 0 && filters[rid].direct &&
+                       !coeffs[id].time_domain)
+            {
+                fprintf(stream, "The filter is convolved in the time-domain, "
+                        "and the coefficients are not kept there.\n");
+            } else {
+                newstate.fctrl[rid].coeff = id;
+                newstate.fchanged[rid] = true;
+            }
 	}
     } else if (strstr(cmd, "cfd") == cmd) {
-	if (get_id(stream, cmd + 3, &cmd, &rid, FILTER_ID, -1)) {
+	if (get_id(stream, cmd + 3, &cmd, &rid, FILTER_ID, -1) &&
+            !is_fixed(stream, rid))
+        {
 	    n = strtol(cmd, &p, 10);
 	    if (cmd == p || n < 0 || n > n_maxblocks - 1) {
 		fprintf(stream, "Invalid filter delay.\n");
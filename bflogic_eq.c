@@ -15,8 +15,6 @@
 #include <unistd.h>
 #include <sys/select.h>
 
-#include <fftw3.h>
-
 #define IS_BFLOGIC_MODULE
 #include "bfmod.h"
 #include "emalloc.h"
@@ -62,6 +60,8 @@ static char *debug_dump_filter_path = NULL;
 static int cmdpipe[2], cmdpipe_reply[2];
 static bool_t debug = false;
 static void *rbuf;
+/* coefficients stored as fp32 are rendered here and then narrowed */
+static void *wide_cbuf;
 
 #define real_t float
 #define REALSIZE 4
@@ -194,6 +194,13 @@ finalise_equaliser(struct realtime_eq *eq,
                 eq->coeff[0], eq->coeff[1]);
         return false;
     }
+    if (coeffs[eq->coeff[0]].compression !=
+        coeffs[eq->coeff[1]].compression)
+    {
+        fprintf(stderr, "EQ: Coefficient %d and %d must have the same "
+                "compression.\n", eq->coeff[0], eq->coeff[1]);
+        return false;
+    }
     return true;
 }
 
@@ -582,6 +589,7 @@ bflogic_init(struct bfaccess *_bfaccess,
         }
     }
     rbuf = emallocaligned(maxblocks * block_length * bfaccess->realsize);
+    wide_cbuf = emallocaligned(2 * block_length * bfaccess->realsize);
     
     for (n = 0; n < n_equalisers; n++) {
         equalisers[n].ifftplan =
@@ -16,7 +16,7 @@ extern "C" {
 #include <sys/time.h>
 #include <sched.h>
 
-#define BF_VERSION_MAJOR 2
+#define BF_VERSION_MAJOR 3
 #define BF_VERSION_MINOR 0
     
 /* limits */
@@ -86,6 +86,12 @@ extern "C" {
 #define BF_LEXVAL_STRING  102
 #define BF_LEXVAL_FIELD   103
 
+/* storage of coefficients */
+#define BF_COEFF_COMPRESSION_NONE 0
+#define BF_COEFF_COMPRESSION_FP16 1
+#define BF_COEFF_COMPRESSION_BF16 2
+#define BF_COEFF_COMPRESSION_FP32 3
+
 #define BF_SAMPLE_SLOTS 100
 #define BF_UNDEFINED_SUBDELAY (-BF_SAMPLE_SLOTS)
     
@@ -108,6 +114,9 @@ struct bfcoeff {
     char name[BF_MAXOBJECTNAME];
     int intname;
     int n_blocks;
+    int compression;
+    /* kept in the time-domain, so that direct filters can use it */
+    int time_domain;
 };
 
 struct bfchannel {
@@ -123,6 +132,21 @@ struct bffilter {
     int *channels[2];
     int n_filters[2];
     int *filters[2];
+    int double_accumulation;
+    /* size of the reals the filter is convolved with, may be smaller than
+       the realsize of the convolver */
+    int realsize;
+    /* matrix, with a coefficient set for each input of each output, which
+       cannot be changed in runtime */
+    int matrix;
+    /* coefficients, delay and scales must not be changed in runtime */
+    int fixed;
+    /* convolved in the time-domain, it can only use coefficient sets which
+       are kept there */
+    int direct;
+    /* combined into other filters at startup, it keeps its index but has no
+       inputs or outputs and is not processed */
+    int absorbed;
 };
 
 struct bffilter_control {
@@ -187,6 +211,10 @@ struct bfaccess {
                         int subdelay);
     int (*get_subdelay)(int io,
                         int channel);
+
+    void (*convolver_fft_execute)(void *plan,
+                                  void *input,
+                                  void *output);
 };
 
 struct bfevents {
@@ -204,6 +232,7 @@ struct bfevents {
 			int channel);
     void (*coeff_final)(int filter,
                         int *coeff);
+    /* the partitions are in the realsize of the filter */
     void (*pre_convolve)(void *buf,
 			 int filter);
     void (*post_convolve)(void *buf,
@@ -45,6 +45,10 @@
 #define DEBUG_MAX_DAI_LOOPS 32
 #define DEBUG_RING_BUFFER_SIZE 1024
 
+/* the number of blocks in the ring each input is staged in (see
+   filter_process()) */
+#define INPUT_RING_BLOCKS 8
+
 /* debug structs */
 struct debug_input_process {
     struct debug_input d[DEBUG_MAX_DAI_LOOPS];
@@ -111,6 +115,8 @@ struct intercomm_area {
     volatile int exit_status;
     volatile bool_t full_proc[BF_MAXPROCESSES];
     volatile bool_t ignore_rtprio;
+    volatile bool_t output_crossfade[BF_MAXCHANNELS];
+    volatile bool_t output_tail[BF_MAXCHANNELS];
 
     struct {
         uint64_t ts_start;
@@ -853,7 +859,7 @@ output_process(int filter_readfd,
 {
     char dummydata[bfconf->n_processes];
     uint32_t bufindex = 0;
-    int dbg_pos;
+    int dbg_pos, margin;
 
     if (bfconf->realtime_priority) {
         bf_make_realtime(0, bfconf->realtime_midprio, "output");
@@ -868,8 +874,15 @@ output_process(int filter_readfd,
     }
     /* verify if we need to write iodelay output */
     if (bfconf->synched_write) {
+        /* the second block of silence gives the filters a period to process
+           the first input in, with processing_margin they only get the
+           margin. Callback I/O makes its own fill, which is not changed. */
+        margin = bfconf->filter_length;
+        if (bfconf->processing_margin > 0 && !bfconf->callback_io) {
+            margin = bfconf->processing_margin;
+        }
         pinfo("Fixed I/O-delay is %d samples\n"
-              "Audio processing starts now\n", 2 * bfconf->filter_length +
+              "Audio processing starts now\n", bfconf->filter_length + margin +
             (bfconf->use_subdelay[IN] ? bfconf->sdf_length : 0) +
             (bfconf->use_subdelay[OUT] ? bfconf->sdf_length : 0));
         if (trigger_callback_io) {
@@ -880,7 +893,7 @@ output_process(int filter_readfd,
         {
             bf_exit(BF_EXIT_OTHER);
         }
-	dai_output(true, input_writefd,
+	dai_output(bfconf->filter_length, input_writefd,
                    icomm->debug.o[dbg_pos].d,
                    DEBUG_MAX_DAI_LOOPS,
                    &icomm->debug.o[dbg_pos].dai_loops);
@@ -893,7 +906,7 @@ output_process(int filter_readfd,
             bf_exit(BF_EXIT_OTHER);
         }
         timestamp(&icomm->debug.o[dbg_pos].w_input.ts_ret);
-	dai_output(true, -1,
+	dai_output(margin, -1,
                    icomm->debug.o[dbg_pos].d,
                    DEBUG_MAX_DAI_LOOPS,
                    &icomm->debug.o[dbg_pos].dai_loops);
@@ -940,7 +953,7 @@ output_process(int filter_readfd,
         timestamp(&icomm->debug.o[dbg_pos].w_input.ts_ret);
 
 	/* write output */
-	dai_output(false, -1,
+	dai_output(0, -1,
                    icomm->debug.o[dbg_pos].d,
                    DEBUG_MAX_DAI_LOOPS,
                    &icomm->debug.o[dbg_pos].dai_loops);
@@ -1005,12 +1018,195 @@ synch_filter_processes(int filter_readfd,
     }
 }
 
+/* Finds runs of consecutive virtual channels which can be transformed together
+   with one batched FFTW plan. For each channel in a run 'batch' is set to the
+   index of the first channel of the run, for other channels to -1. Returns
+   true if there is any run. */
+static bool_t
+find_batches(int n_channels,
+             int channels[],
+             bool_t direct[],
+             int batch[])
+{
+    bool_t found = false;
+    int n;
+
+    for (n = 0; n < n_channels; n++) {
+        batch[n] = -1;
+        if (direct[channels[n]]) {
+            continue;
+        }
+        if (n > 0 && batch[n-1] != -1 && channels[n] == channels[n-1] + 1) {
+            batch[n] = batch[n-1];
+        } else if (n < n_channels - 1 && !direct[channels[n+1]] &&
+                   channels[n+1] == channels[n] + 1)
+        {
+            batch[n] = n;
+            found = true;
+        }
+    }
+    return found;
+}
+
+/* a coefficient partition in full precision, compressed coefficients are
+   widened to a temporary buffer */
+static void *
+coeffs_part(int coeff,
+            int block)
+{
+    return convolver_widen_coeffs(bfconf->coeffs_data[coeff][block],
+                                  bfconf->coeffs[coeff].compression);
+}
+
+/* with processing_margin, filters which are neither direct, crossfading
+   nor matrices sum the partitions after the first one period ahead */
+static bool_t
+sums_ahead(struct bffilter *filter)
+{
+    return bfconf->processing_margin > 0 && bfconf->n_blocks > 1 &&
+        !bfconf->direct_filter[filter->intname] && !filter->crossfade &&
+        !filter->matrix;
+}
+
+/* the largest number of inputs of the matrices among the filters, at
+   least 1 */
+static int
+matrix_max_inputs(int n_filters,
+                  struct bffilter filters[])
+{
+    int n, max_inputs = 1;
+
+    for (n = 0; n < n_filters; n++) {
+        if (filters[n].matrix && filters[n].n_channels[IN] > max_inputs) {
+            max_inputs = filters[n].n_channels[IN];
+        }
+    }
+    return max_inputs;
+}
+
+/* A matrix keeps the past blocks of each input, scaled, in a ring of its
+   own, and has an output buffer for each output. The head partitions of
+   each input are listed in 'parts' each period, and 'coeffs' and 'bands'
+   have the coefficients of each of them for each output, output by output,
+   NULL where a set is shorter or the partition is zero. 'n_pairs' and
+   'n_skipped' count the products done and skipped for each partition. With
+   non-uniform partitioning each input and output has tail state as well. */
+struct matrix {
+    int n_inputs;
+    int n_outputs;
+    int n_parts;
+    int head_blocks;
+    int compression;
+    void **ring;
+    bool_t *ring_zero;
+    void **parts;
+    void **coeffs;
+    int **bands;
+    int *n_pairs;
+    int *n_skipped;
+    void **out;
+    bool_t *out_zero;
+    nu_conv_t **nu_in;
+    nu_conv_t **nu_out;
+    nu_coeffs_t **nu_coeffs;
+    void **nu_tail;
+};
+
+static struct matrix *
+matrix_new(struct bffilter *filter,
+           int head_blocks)
+{
+    int convbufsize = convolver_cbufsize();
+    int n_blocks = bfconf->n_blocks;
+    int *mcoeffs = bfconf->matrix_coeffs[filter->intname];
+    int n, o, k, i, p, coeff;
+    struct matrix *m;
+    uint8_t *memptr;
+
+    m = emalloc(sizeof(struct matrix));
+    m->n_inputs = filter->n_channels[IN];
+    m->n_outputs = filter->n_channels[OUT];
+    m->head_blocks = head_blocks;
+    m->n_parts = m->n_inputs * head_blocks;
+    m->compression = bfconf->coeffs[mcoeffs[0]].compression;
+
+    n = m->n_inputs * n_blocks + m->n_outputs;
+    memptr = emallocaligned(n * convbufsize);
+    memset(memptr, 0, n * convbufsize);
+    m->ring = emalloc(m->n_inputs * n_blocks * sizeof(void *));
+    m->ring_zero = emalloc(m->n_inputs * n_blocks * sizeof(bool_t));
+    for (n = 0; n < m->n_inputs * n_blocks; n++) {
+        m->ring[n] = memptr;
+        m->ring_zero[n] = true;
+        memptr += convbufsize;
+    }
+    m->out = emalloc(m->n_outputs * sizeof(void *));
+    m->out_zero = emalloc(m->n_outputs * sizeof(bool_t));
+    for (o = 0; o < m->n_outputs; o++) {
+        m->out[o] = memptr;
+        m->out_zero[o] = true;
+        memptr += convbufsize;
+    }
+
+    m->parts = emalloc(m->n_parts * sizeof(void *));
+    m->coeffs = emalloc(m->n_outputs * m->n_parts * sizeof(void *));
+    m->bands = emalloc(m->n_outputs * m->n_parts * sizeof(int *));
+    m->n_pairs = emalloc(m->n_parts * sizeof(int));
+    m->n_skipped = emalloc(m->n_parts * sizeof(int));
+    memset(m->n_pairs, 0, m->n_parts * sizeof(int));
+    memset(m->n_skipped, 0, m->n_parts * sizeof(int));
+    for (o = 0; o < m->n_outputs; o++) {
+        for (k = 0; k < m->n_inputs; k++) {
+            coeff = mcoeffs[o * m->n_inputs + k];
+            for (i = 0; i < head_blocks; i++) {
+                p = k * head_blocks + i;
+                n = o * m->n_parts + p;
+                m->coeffs[n] = NULL;
+                m->bands[n] = NULL;
+                if (i >= bfconf->coeffs[coeff].n_blocks) {
+                    continue;
+                }
+                if (bit_isset(bfconf->coeffs_zero[coeff], i)) {
+                    m->n_skipped[p]++;
+                    continue;
+                }
+                m->coeffs[n] = bfconf->coeffs_data[coeff][i];
+                if (bfconf->coeffs_band[coeff] != NULL) {
+                    m->bands[n] = &bfconf->coeffs_band[coeff][2 * i];
+                }
+                m->n_pairs[p]++;
+            }
+        }
+    }
+
+    m->nu_in = emalloc(m->n_inputs * sizeof(nu_conv_t *));
+    m->nu_out = emalloc(m->n_outputs * sizeof(nu_conv_t *));
+    m->nu_coeffs = emalloc(m->n_outputs * m->n_inputs *
+                           sizeof(nu_coeffs_t *));
+    m->nu_tail = emalloc(m->n_outputs * sizeof(void *));
+    for (k = 0; k < m->n_inputs; k++) {
+        m->nu_in[k] = convolver_nu_new(0);
+    }
+    for (o = 0; o < m->n_outputs; o++) {
+        m->nu_out[o] = convolver_nu_new(m->n_inputs);
+        m->nu_tail[o] = NULL;
+        for (k = 0; k < m->n_inputs; k++) {
+            m->nu_coeffs[o * m->n_inputs + k] =
+                bfconf->coeffs_tail[mcoeffs[o * m->n_inputs + k]];
+        }
+    }
+    return m;
+}
+
 static void
 filter_process(struct bfaccess *bfaccess,
                void *inbuf[2],
 	       void *outbuf[2],
 	       void *input_freqcbuf[],
 	       void *output_freqcbuf[],
+	       void *output_crossfadecbuf[],
+	       void *input_timebuf[],
+	       void *output_tailbuf[],
 	       int filter_readfd,
 	       int filter_writefd[],
 	       int input_readfd,
@@ -1034,16 +1230,56 @@ filter_process(struct bfaccess *bfaccess,
                bool_t has_cb_output_devs)
 {
     int convbufsize  = convolver_cbufsize();
+    int fconvbufsize[n_filters];
     int fragsize = bfconf->filter_length;
     int n_blocks = bfconf->n_blocks;
+    int head_blocks = convolver_nu_head_blocks();
     int curblock = 0;
     int curbuf = 0;
+    int ringpos = 0, ringblocks;
     
-    void *input_timecbuf[n_procinputs][2];
+    void *input_ring[n_procinputs];
+    void *input_timecbuf[n_procinputs];
+    void *output_timecbuf[n_procoutputs];
+    void *input_plan[n_procinputs];
+    void *output_plan[n_procoutputs];
+    int input_batch[n_procinputs];
+    int output_batch[n_procoutputs];
+    bool_t fft_pending[n_procinputs];
+    bool_t has_output_batches, output_batched = false;
+    void *timecbuf;
+    void *crossfade_ocbuf[n_filters];
+    void *crossfade_mixbufs[n_filters];
+    void *crossfade_timecbuf = NULL;
+    bool_t crossfading[n_filters];
+    bool_t crossfade, has_output_crossfade;
+    void *prevbuf;
     void **mixconvbuf_inputs[n_filters];
     void **mixconvbuf_filters[n_filters];
     void *cbuf[n_filters][n_blocks];
     void *ocbuf[n_filters];
+    void *imix;
+    void *sum_cbufs[n_blocks];
+    void *sum_coeffs[n_blocks];
+    int *sum_bands[n_blocks];
+    int sum_cbuf_indexes[n_blocks];
+    int sum_coeff_indexes[n_blocks];
+    void *icbuf[n_filters];
+    void *icoeffs[n_filters];
+    void *dbuf[n_filters];
+    bool_t dbuf_zero[n_filters][2 * n_blocks + 2];
+    void *aheadbuf[n_filters];
+    int ahead_coeff[n_filters];
+    int ahead_cblocks[n_filters];
+    int ahead_pairs[n_filters];
+    int ahead_skipped[n_filters];
+    struct matrix *mtx[n_filters], *m;
+    int icoeffs_set[n_filters];
+    nu_conv_t *nuconv[n_filters];
+    void *nu_tail[n_filters];
+    void *nu_mix[n_filters + BF_MAXCHANNELS];
+    void *nu_inbuf = NULL;
+    bool_t nu_freqd;
     void *evalbuf[n_filters];
     void *static_evalbuf = NULL;
     void *inbuf_copy = NULL;
@@ -1065,9 +1301,10 @@ filter_process(struct bfaccess *bfaccess,
     bool_t mixbuf_is_filled;
     int inbuf_copy_size;
   
-    int n, i, j, coeff, delay, cblocks, prevcblocks, physch, virtch;
+    int n, i, j, k, coeff, delay, cblocks, prevcblocks, physch, virtch, n_pairs;
+    int n_skipped, **bands, n_direct;
     struct buffer_format *bf, inbuf_copy_bf;
-    uint8_t *memptr, *baseptr;
+    uint8_t *memptr, *baseptr, *dmix;
     struct bfoverflow of;
     uint32_t dummydata32;
     char dummydata[1];
@@ -1085,13 +1322,14 @@ filter_process(struct bfaccess *bfaccess,
     uint32_t partial_proc[n_filters / 32 + 1];
     int *mixconvbuf_filters_map[n_filters];
     int outconvbuf_map[BF_MAXCHANNELS][n_filters];
+    int outconvbuf_pos[BF_MAXCHANNELS][n_filters];
     bool_t input_freqcbuf_zero[bfconf->n_channels[IN]];
     bool_t output_freqcbuf_zero[bfconf->n_channels[OUT]];
     bool_t cbuf_zero[n_filters][n_blocks];
     bool_t ocbuf_zero[n_filters];
     bool_t evalbuf_zero[n_filters];
     bool_t temp_buffer_zero;
-    bool_t iszero;    
+    bool_t iszero, ahead;
     
     struct timeval period_start, period_end, tv;
     int32_t period_length;
@@ -1099,6 +1337,11 @@ filter_process(struct bfaccess *bfaccess,
     uint64_t t1, t2, t3, t4;
     uint64_t t[10];
     uint32_t cc = 0;
+    /* partition products done and skipped due to zero coefficients */
+    uint32_t part_count[2];
+    /* the coefficient of direct filters using a dirac pulse */
+    float dirac_tapf = 1.0;
+    double dirac_tapd = 1.0;
 
     dummydata[0] = '\0';
     dbg_pos = 0;
@@ -1116,6 +1359,7 @@ filter_process(struct bfaccess *bfaccess,
     memset(evalbuf_zero, 0, n_filters * sizeof(bool_t));
     memset(ocbuf_zero, 0, n_filters * sizeof(bool_t));
     memset(cbuf_zero, 0, n_blocks * n_filters * sizeof(bool_t));
+    memset(dbuf_zero, 0, sizeof(dbuf_zero));
     memset(output_freqcbuf_zero, 0, bfconf->n_channels[OUT] * sizeof(bool_t));
     memset(input_freqcbuf_zero, 0, bfconf->n_channels[IN] * sizeof(bool_t));
     memset(crossfadebuf, 0, sizeof(crossfadebuf));
@@ -1207,13 +1451,46 @@ filter_process(struct bfaccess *bfaccess,
     
     /* find out if there is a need of evaluation buffers, and how many,
        and if there is a need for a crossfade buffer */
-    for (n = i = j = 0; n < n_filters; n++) {
+    for (n = i = j = n_direct = 0; n < n_filters; n++) {
 	if (filters[n].n_filters[IN] > 0) {
 	    i++;
 	}
         if (filters[n].crossfade) {
             need_crossfadebuf = true;
         }
+        if (bfconf->direct_filter[filters[n].intname]) {
+            n_direct++;
+        }
+    }
+
+    convolver_fft_threads_init();
+    /* matrices sum the partitions of all their inputs at once */
+    convolver_sum_init(n_blocks * matrix_max_inputs(n_filters, filters));
+
+    /* Inputs and outputs on consecutive virtual channels are transformed
+       with batched plans, which cannot be done when logic modules want to
+       access them one by one in the frequency-domain. Batched outputs are
+       transformed to buffers of their own. */
+    if (events.n_input_freqd > 0 ||
+        !find_batches(n_procinputs, procinputs, bfconf->direct[IN],
+                      input_batch))
+    {
+        for (n = 0; n < n_procinputs; n++) {
+            input_batch[n] = -1;
+        }
+    }
+    has_output_batches = events.n_output_freqd == 0 &&
+        find_batches(n_procoutputs, procoutputs, bfconf->direct[OUT],
+                     output_batch);
+    if (!has_output_batches) {
+        for (n = 0; n < n_procoutputs; n++) {
+            output_batch[n] = -1;
+        }
+    }
+
+    for (n = 0; n < n_filters; n++) {
+        mtx[n] = filters[n].matrix ? matrix_new(&filters[n], head_blocks) :
+            NULL;
     }
 
     /* allocate input/output/evaluation convolve buffers */
@@ -1224,15 +1501,75 @@ filter_process(struct bfaccess *bfaccess,
 	fprintf(stderr, "Unexpected buffer sizes.\n");
 	bf_exit(BF_EXIT_OTHER);
     }
+    /* filters convolved in float keep their partitions in float, when
+       n_blocks == 1 the partition is ocbuf */
+    for (n = 0; n < n_filters; n++) {
+        fconvbufsize[n] = n_blocks > 1 ?
+            convolver_realsize_cbufsize(filters[n].realsize) : convbufsize;
+    }
     if (n_blocks > 1) {
-	memsize = n_filters * n_blocks * convbufsize +
-	    n_filters * convbufsize +
+	memsize = n_filters * convbufsize +
 	    i * (convbufsize + convbufsize / 2) +
-	    2 * n_procinputs * convbufsize;
+	    n_procinputs * INPUT_RING_BLOCKS * fragsize * bfconf->realsize;
+        for (n = 0; n < n_filters; n++) {
+            if (mtx[n] != NULL) {
+                continue;
+            }
+            memsize += n_blocks * fconvbufsize[n];
+            if (bfconf->interleaved_partitions) {
+                memsize += 2 * n_blocks * fconvbufsize[n];
+            }
+        }
     } else {
 	memsize = n_filters * convbufsize +
 	    i * (convbufsize + convbufsize / 2) +
-	    2 * n_procinputs * convbufsize;
+	    n_procinputs * INPUT_RING_BLOCKS * fragsize * bfconf->realsize;
+    }
+    memsize += n_direct * (n_blocks + 1) * convbufsize;
+    if (has_output_batches) {
+        memsize += n_procoutputs * convbufsize;
+    }
+    /* Crossfading filters which only output to channels keep the output with
+       the previous coefficients in a buffer of their own, and are crossfaded
+       in the time-domain after the output transform, which then is done on
+       both the previous and the new output. This is not done if logic
+       modules look at the output in the frequency-domain. */
+    for (n = 0; n < n_filters; n++) {
+        crossfading[n] = false;
+        crossfade_ocbuf[n] = NULL;
+        if (filters[n].crossfade && filters[n].n_filters[OUT] == 0 &&
+            events.n_post_convolve == 0 && events.n_output_freqd == 0)
+        {
+            crossfading[n] = true;
+            memsize += convbufsize;
+        }
+    }
+    /* the fade is made by the process transforming the output channel */
+    has_output_crossfade = false;
+    for (n = 0; n < n_procoutputs; n++) {
+        if (output_crossfadecbuf[procoutputs[n]] != NULL) {
+            has_output_crossfade = true;
+        }
+    }
+    if (has_output_crossfade) {
+        memsize += convbufsize;
+    }
+    /* The tails of non-uniform partitioned filters take their input in the
+       time-domain, mixed to a buffer of their own, and their output is added
+       after the output transform. Logic modules which look at the spectra
+       get the tail input from the spectrum and the output added to it as
+       before. */
+    nu_freqd = events.n_input_freqd > 0 || events.n_pre_convolve > 0;
+    if (head_blocks < n_blocks) {
+        memsize += fragsize * bfconf->realsize;
+    }
+    /* With processing_margin, the partitions after the first of a filter
+       are summed one period ahead to a buffer of their own, see the end of
+       the main loop. Direct and crossfading filters are done as usual. */
+    for (n = 0; n < n_filters; n++) {
+        if (sums_ahead(&filters[n])) {
+            memsize += convbufsize;
+        }
     }
     if (i > 0) {
         memsize += convbufsize;
@@ -1247,6 +1584,9 @@ filter_process(struct bfaccess *bfaccess,
         }
     }
     memptr = emallocaligned(memsize);
+    /* the buffers may have padding after the data (see convolver_cbufsize())
+       which is expected to be zero */
+    memset(memptr, 0, memsize);
     baseptr = memptr;
     if (i > 0) {
         if (need_crossfadebuf) {
@@ -1273,8 +1613,12 @@ filter_process(struct bfaccess *bfaccess,
     if (n_blocks > 1) {
         for (n = 0; n < n_filters; n++) {
 	    for (i = 0; i < n_blocks; i++) {
+                if (mtx[n] != NULL) {
+                    cbuf[n][i] = NULL;
+                    continue;
+                }
 		cbuf[n][i] = memptr;
-		memptr += convbufsize;
+		memptr += fconvbufsize[n];
 	    }
 	    if (filters[n].n_filters[IN] > 0) {
 		evalbuf[n] = memptr;
@@ -1284,6 +1628,16 @@ filter_process(struct bfaccess *bfaccess,
 	    }
 	    ocbuf[n] = memptr;
 	    memptr += convbufsize;
+            /* bin-major copies of the input ring and the coefficients */
+            icoeffs_set[n] = -1;
+            if (bfconf->interleaved_partitions && mtx[n] == NULL) {
+                icbuf[n] = memptr;
+                memptr += n_blocks * fconvbufsize[n];
+                icoeffs[n] = memptr;
+                memptr += n_blocks * fconvbufsize[n];
+            } else {
+                icbuf[n] = icoeffs[n] = NULL;
+            }
 	}
     } else {
 	for (n = 0; n < n_filters; n++) {
@@ -1295,12 +1649,112 @@ filter_process(struct bfaccess *bfaccess,
 	    } else {
 		evalbuf[n] = NULL;
 	    }
+            icbuf[n] = icoeffs[n] = NULL;
 	}
     }
     inbuf_copy = ocbuf[0];
-    for (n = 0; n < n_procinputs; n++, memptr += 2 * convbufsize) {
-	input_timecbuf[n][0] = memptr;
-	input_timecbuf[n][1] = memptr + convbufsize;
+    /* each input is converted to a ring of blocks, where the previous and the
+       current block lie next to each other and are transformed in place,
+       so each sample is written once. At the end of the ring the last block
+       is copied to the start. FFTW requires the same alignment of the
+       buffers as planned for, if a block does not keep it the ring is only
+       two blocks and the copy is made every period. */
+    ringblocks = INPUT_RING_BLOCKS;
+    if ((fragsize * bfconf->realsize) % 64 != 0) {
+        ringblocks = 2;
+    }
+    for (n = 0; n < n_procinputs; n++) {
+	input_ring[n] = memptr;
+	input_timecbuf[n] = memptr;
+        memptr += INPUT_RING_BLOCKS * fragsize * bfconf->realsize;
+    }
+    /* the direct filters mix their inputs in the time-domain to a ring of
+       n_blocks + 1 buffers, each with the previous and the current block, so
+       the mixing can be done up to n_blocks - 1 blocks ahead for the filter
+       delay */
+    for (n = 0; n < n_filters; n++) {
+        if (bfconf->direct_filter[filters[n].intname]) {
+            dbuf[n] = memptr;
+            memptr += (n_blocks + 1) * convbufsize;
+        } else {
+            dbuf[n] = NULL;
+        }
+    }
+    for (n = 0; n < n_filters; n++) {
+        if (crossfading[n]) {
+            crossfade_ocbuf[n] = memptr;
+            memptr += convbufsize;
+            crossfading[n] = false;
+        }
+    }
+    if (has_output_crossfade) {
+        crossfade_timecbuf = memptr;
+        memptr += convbufsize;
+    }
+    for (n = 0; n < n_filters; n++) {
+        ahead_coeff[n] = -1;
+        if (sums_ahead(&filters[n])) {
+            aheadbuf[n] = memptr;
+            memptr += convbufsize;
+        } else {
+            aheadbuf[n] = NULL;
+        }
+    }
+    for (n = 0; n < n_procoutputs; n++) {
+        if (has_output_batches) {
+            output_timecbuf[n] = memptr;
+            memptr += convbufsize;
+        } else {
+            output_timecbuf[n] = NULL;
+        }
+    }
+    if (head_blocks < n_blocks) {
+        nu_inbuf = memptr;
+        memptr += fragsize * bfconf->realsize;
+    }
+    /* a run which FFTW cannot make a batched plan for is done channel by
+       channel */
+    for (n = 0; n < n_procinputs; n++) {
+        fft_pending[n] = false;
+        input_plan[n] = NULL;
+        if (input_batch[n] == n) {
+            for (i = n; i < n_procinputs && input_batch[i] == n; i++);
+            if ((input_plan[n] =
+                 convolver_batch_fftplan(i - n,
+                                         INPUT_RING_BLOCKS * fragsize *
+                                         bfconf->realsize,
+                                         convbufsize,
+                                         false)) == NULL)
+            {
+                for (i = n; i < n_procinputs && input_batch[i] == n; i++) {
+                    input_batch[i] = -1;
+                }
+            }
+        }
+    }
+    for (n = 0; n < n_procoutputs; n++) {
+        output_plan[n] = NULL;
+        if (output_batch[n] == n) {
+            for (i = n; i < n_procoutputs && output_batch[i] == n; i++);
+            if ((output_plan[n] = convolver_batch_fftplan(i - n,
+                                                          convbufsize,
+                                                          convbufsize,
+                                                          true)) == NULL)
+            {
+                for (i = n; i < n_procoutputs && output_batch[i] == n; i++) {
+                    output_batch[i] = -1;
+                }
+            }
+        }
+    }
+    /* allocate state for the tails of non-uniform partitioned filters.
+       Crossfading filters convolve all partitions uniformly, as the fade is
+       made on the output of the partitions and would miss the tail. Matrices
+       have tail state of their own. */
+    for (n = 0; n < n_filters; n++) {
+        nuconv[n] = filters[n].crossfade || mtx[n] != NULL ? NULL :
+            convolver_nu_new(1);
+        nu_tail[n] = NULL;
     }
     /* for each filter, find out which channel-inputs that are mixed */
     for (n = 0; n < n_filters; n++) {
@@ -1353,7 +1807,9 @@ filter_process(struct bfaccess *bfaccess,
 	    for (j = 0; j < filters[i].n_channels[OUT]; j++) {
 		if (filters[i].channels[OUT][j] == outputs[n]) {
                     outconvbuf_map[n][outconvbuf_n_filters[n]] = i;
-                    outconvbuf[n][outconvbuf_n_filters[n]] = ocbuf[i];
+                    outconvbuf_pos[n][outconvbuf_n_filters[n]] = j;
+                    outconvbuf[n][outconvbuf_n_filters[n]] =
+                        mtx[i] != NULL ? mtx[i]->out[j] : ocbuf[i];
 		    outscale[n][outconvbuf_n_filters[n]] =
 			       &icomm_fctrl[i].scale[OUT][j];
 		    outconvbuf_n_filters[n]++;
@@ -1388,7 +1844,9 @@ filter_process(struct bfaccess *bfaccess,
     memset(baseptr, 0, memsize);    
     for (n = 0; n < bfconf->n_coeffs; n++) {
         for (i = 0; i < bfconf->coeffs[n].n_blocks; i++) {
-            memcpy(ocbuf[0], bfconf->coeffs_data[n][i], convbufsize);
+            memcpy(ocbuf[0], bfconf->coeffs_data[n][i],
+                   convolver_compressed_cbufsize
+                   (bfconf->coeffs[n].compression));
         }
     }
     dummydata32 = 0;
@@ -1417,6 +1875,7 @@ filter_process(struct bfaccess *bfaccess,
     
     /* main filter loop starts here */
     memset(t, 0, sizeof(t));
+    memset(part_count, 0, sizeof(part_count));
     while (true) {
         gettimeofday(&period_end, NULL);
 
@@ -1499,10 +1958,17 @@ filter_process(struct bfaccess *bfaccess,
 	    bf = &dai_buffer_format[IN]->bf[physch];
             sd_params.subdelay = icomm_subdelay[IN][virtch];
             sd_params.rest = input_sd_rest[virtch];
+            if (ringpos == 0) {
+                memcpy(input_ring[n],
+                       (uint8_t *)input_ring[n] +
+                       (ringblocks - 1) * fragsize * bfconf->realsize,
+                       fragsize * bfconf->realsize);
+            }
+            input_timecbuf[n] = (uint8_t *)input_ring[n] +
+                ringpos * fragsize * bfconf->realsize;
 	    if (bfconf->n_virtperphys[IN][physch] == 1) {
                 convolver_raw2cbuf(inbuf[curbuf],
-                                   input_timecbuf[n][curbuf],
-                                   input_timecbuf[n][!curbuf],
+                                   input_timecbuf[n],
                                    bf,
                                    apply_subdelay,
                                    (void *)&sd_params);
@@ -1524,14 +1990,13 @@ filter_process(struct bfaccess *bfaccess,
 		}
                 inbuf_copy_bf.sf = bf->sf;
                 convolver_raw2cbuf(inbuf_copy,
-                                   input_timecbuf[n][curbuf],
-                                   input_timecbuf[n][!curbuf],
+                                   input_timecbuf[n],
                                    &inbuf_copy_bf,
                                    apply_subdelay,
                                    (void *)&sd_params);
 	    }
 	    for (i = 0; i < events.n_input_timed; i++) {
-		events.input_timed[i](input_timecbuf[n][curbuf], procinputs[n]);
+		events.input_timed[i](input_timecbuf[n], procinputs[n]);
 	    }
 	    timestamp(&t2);
 	    t[0] += t2 - t1;
@@ -1539,18 +2004,65 @@ filter_process(struct bfaccess *bfaccess,
 	    /* transform to frequency domain */
 	    timestamp(&t1);
             if (!powersave ||
-                !test_silent(input_timecbuf[n][curbuf], convbufsize,
+                !test_silent(input_timecbuf[n],
+                             2 * fragsize * bfconf->realsize,
                              bfconf->realsize,
                              bfconf->analog_powersave,
                              bf->sf.scale))
             {
-                convolver_time2freq(input_timecbuf[n][curbuf],
-                                    input_freqcbuf[procinputs[n]]);
+                if (bfconf->direct[IN][procinputs[n]]) {
+                    /* only direct filters use this input, they take the
+                       current block of samples as is */
+                    memcpy(input_freqcbuf[procinputs[n]],
+                           &((uint8_t *)input_timecbuf[n])
+                           [fragsize * bfconf->realsize],
+                           fragsize * bfconf->realsize);
+                } else if (input_batch[n] != -1) {
+                    /* transformed with the rest of its run below */
+                    fft_pending[n] = true;
+                } else {
+                    convolver_time2freq(input_timecbuf[n],
+                                        input_freqcbuf[procinputs[n]]);
+                }
+                if (input_timebuf[procinputs[n]] != NULL) {
+                    /* for the tails of non-uniform partitioned filters */
+                    memcpy(input_timebuf[procinputs[n]],
+                           &((uint8_t *)input_timecbuf[n])
+                           [fragsize * bfconf->realsize],
+                           fragsize * bfconf->realsize);
+                }
                 input_freqcbuf_zero[procinputs[n]] = false;
             } else if (!input_freqcbuf_zero[procinputs[n]]) {
                 memset(input_freqcbuf[procinputs[n]], 0, convbufsize);
+                if (input_timebuf[procinputs[n]] != NULL) {
+                    memset(input_timebuf[procinputs[n]], 0,
+                           fragsize * bfconf->realsize);
+                }
                 input_freqcbuf_zero[procinputs[n]] = true;
             }
+            if (input_batch[n] != -1 &&
+                (n == n_procinputs - 1 || input_batch[n+1] != input_batch[n]))
+            {
+                /* last of a run, all of it is transformed in one go unless
+                   some inputs are silent */
+                for (i = input_batch[n]; i <= n && fft_pending[i]; i++);
+                if (i > n) {
+                    i = input_batch[n];
+                    convolver_time2freq_batch(input_plan[i],
+                                              input_timecbuf[i],
+                                              input_freqcbuf[procinputs[i]]);
+                } else {
+                    for (i = input_batch[n]; i <= n; i++) {
+                        if (fft_pending[i]) {
+                            convolver_time2freq(input_timecbuf[i],
+                                                input_freqcbuf[procinputs[i]]);
+                        }
+                    }
+                }
+                for (i = input_batch[n]; i <= n; i++) {
+                    fft_pending[i] = false;
+                }
+            }
 	    for (i = 0; i < events.n_input_freqd; i++) {
 		events.input_freqd[i](input_freqcbuf[procinputs[n]],
 				      procinputs[n]);
@@ -1576,12 +2088,190 @@ filter_process(struct bfaccess *bfaccess,
                    coefficient */
 		events.coeff_final[0](filters[n].intname, &coeff);
 	    }
+            convolver_filter_realsize(filters[n].realsize);
+            if (filters[n].realsize < bfconf->realsize && coeff >= 0 &&
+                bfconf->coeffs[coeff].compression ==
+                BF_COEFF_COMPRESSION_NONE)
+            {
+                /* a filter convolved in float cannot use coefficients stored
+                   in full precision, the previous set is kept instead */
+                coeff = prevcoeff[n];
+            }
 	    delay = icomm_fctrl[n].delayblocks;
 	    if (delay < 0) {
 		delay = 0;
 	    } else if (delay > n_blocks - 1) {
 		delay = n_blocks - 1;
 	    }
+            if (mtx[n] != NULL) {
+                /* matrix, the inputs are scaled into the rings and the head
+                   partitions of all of them are summed for all outputs at
+                   once, see convolver_convolve_matrix(). The coefficient sets
+                   are fixed. */
+                m = mtx[n];
+                curblock = (int)((blockcounter + delay) %
+                                 (unsigned int)n_blocks);
+                n_pairs = 0;
+                for (k = 0; k < m->n_inputs; k++) {
+                    virtch = filters[n].channels[IN][k];
+                    j = k * n_blocks + curblock;
+                    if (!input_freqcbuf_zero[virtch] || !powersave) {
+                        scales[0] = icomm_fctrl[n].scale[IN][k] *
+                            virtscales[IN][virtch];
+                        convolver_mixnscale(&input_freqcbuf[virtch],
+                                            m->ring[j], scales, 1,
+                                            CONVOLVER_MIXMODE_INPUT);
+                        m->ring_zero[j] = false;
+                    } else if (!m->ring_zero[j]) {
+                        memset(m->ring[j], 0, convbufsize);
+                        m->ring_zero[j] = true;
+                    }
+                    for (i = 0; i < m->head_blocks; i++) {
+                        j = k * n_blocks +
+                            (int)((blockcounter + (unsigned int)
+                                   (n_blocks - i)) % (unsigned int)n_blocks);
+                        m->parts[k * m->head_blocks + i] = NULL;
+                        if (i >= n_blocks - delay) {
+                            continue;
+                        }
+                        part_count[1] += m->n_skipped[k * m->head_blocks + i];
+                        if (!m->ring_zero[j] || !powersave) {
+                            m->parts[k * m->head_blocks + i] = m->ring[j];
+                            part_count[0] +=
+                                m->n_pairs[k * m->head_blocks + i];
+                            n_pairs++;
+                        }
+                    }
+                    if (m->nu_in[k] == NULL) {
+                        continue;
+                    }
+                    /* the tail input, delayed as the head input */
+                    if (nu_freqd) {
+                        j = k * n_blocks +
+                            (int)(blockcounter % (unsigned int)n_blocks);
+                        dmix = m->ring_zero[j] && powersave ? NULL :
+                            convolver_nu_cbuf2time(m->nu_in[k], m->ring[j]);
+                        i = 0;
+                    } else if (input_freqcbuf_zero[virtch] && powersave) {
+                        dmix = NULL;
+                        i = delay;
+                    } else {
+                        convolver_mixnscale(&input_timebuf[virtch], nu_inbuf,
+                                            scales, 1,
+                                            CONVOLVER_MIXMODE_TIME);
+                        dmix = nu_inbuf;
+                        i = delay;
+                    }
+                    convolver_nu_input(m->nu_in[k], dmix, i);
+                }
+                if (n_pairs > 0) {
+                    convolver_convolve_matrix(m->parts, m->coeffs, m->bands,
+                                              m->n_parts, m->n_outputs,
+                                              m->out, m->compression,
+                                              filters[n].double_accumulation);
+                }
+                for (i = 0; i < m->n_outputs; i++) {
+                    if (n_pairs > 0) {
+                        m->out_zero[i] = false;
+                    } else if (!m->out_zero[i]) {
+                        memset(m->out[i], 0, convbufsize);
+                        m->out_zero[i] = true;
+                    }
+                    if (m->nu_out[i] == NULL) {
+                        continue;
+                    }
+                    m->nu_tail[i] = convolver_nu_sum(m->nu_out[i], m->nu_in,
+                                                     &m->nu_coeffs
+                                                     [i * m->n_inputs],
+                                                     m->n_inputs);
+                    if (m->nu_tail[i] != NULL && events.n_output_freqd > 0) {
+                        /* the output must be complete in the
+                           frequency-domain */
+                        convolver_nu_add(m->nu_out[i], m->out[i],
+                                         m->out_zero[i] && powersave);
+                        m->out_zero[i] = false;
+                        m->nu_tail[i] = NULL;
+                    }
+                }
+                timestamp(&t2);
+                t[3] += t2 - t1;
+                continue;
+            }
+            if (dbuf[n] != NULL) {
+                /* direct filter. Coefficient sets which are not kept in the
+                   time-domain cannot be used. The CLI refuses them, if
+                   another logic module chooses one the previous set is
+                   kept instead. */
+                if (coeff >= 0 && bfconf->coeffs_time[coeff] == NULL) {
+                    coeff = prevcoeff[n];
+                }
+                iszero = true;
+		for (i = 0; i < filters[n].n_channels[IN]; i++) {
+		    scales[i] = icomm_fctrl[n].scale[IN][i] *
+			virtscales[IN][filters[n].channels[IN][i]];
+                    if (!input_freqcbuf_zero[filters[n].channels[IN][i]]) {
+                        iszero = false;
+                    }
+		}
+                /* the mixed block is the current block of one buffer, and
+                   the previous block of the next */
+                i = (int)((blockcounter + delay) %
+                          (unsigned int)(n_blocks + 1));
+                j = (i + 1) % (n_blocks + 1);
+                dmix = (uint8_t *)dbuf[n] + i * convbufsize +
+                    fragsize * bfconf->realsize;
+                if (!iszero || !powersave) {
+                    convolver_mixnscale(mixconvbuf_inputs[n],
+                                        dmix,
+                                        scales,
+                                        filters[n].n_channels[IN],
+                                        CONVOLVER_MIXMODE_TIME);
+                    memcpy((uint8_t *)dbuf[n] + j * convbufsize, dmix,
+                           fragsize * bfconf->realsize);
+                    dbuf_zero[n][2 * i + 1] = false;
+                    dbuf_zero[n][2 * j] = false;
+                } else {
+                    if (!dbuf_zero[n][2 * i + 1]) {
+                        memset(dmix, 0, fragsize * bfconf->realsize);
+                        dbuf_zero[n][2 * i + 1] = true;
+                    }
+                    if (!dbuf_zero[n][2 * j]) {
+                        memset((uint8_t *)dbuf[n] + j * convbufsize, 0,
+                               fragsize * bfconf->realsize);
+                        dbuf_zero[n][2 * j] = true;
+                    }
+                }
+                timestamp(&t2);
+                t[2] += t2 - t1;
+
+                timestamp(&t1);
+                i = (int)(blockcounter % (unsigned int)(n_blocks + 1));
+                if (!dbuf_zero[n][2 * i] || !dbuf_zero[n][2 * i + 1] ||
+                    !powersave)
+                {
+                    if (coeff < 0) {
+                        convolver_direct_convolve
+                            ((uint8_t *)dbuf[n] + i * convbufsize,
+                             bfconf->realsize == 4 ?
+                             (void *)&dirac_tapf : (void *)&dirac_tapd,
+                             1, 0, ocbuf[n]);
+                    } else {
+                        convolver_direct_convolve
+                            ((uint8_t *)dbuf[n] + i * convbufsize,
+                             bfconf->coeffs_time[coeff],
+                             bfconf->coeffs_n_taps[coeff],
+                             bfconf->coeffs_delay[coeff], ocbuf[n]);
+                    }
+                    ocbuf_zero[n] = false;
+                } else if (!ocbuf_zero[n]) {
+                    memset(ocbuf[n], 0, convbufsize);
+                    ocbuf_zero[n] = true;
+                }
+                prevcoeff[n] = coeff;
+                timestamp(&t2);
+                t[3] += t2 - t1;
+                continue;
+            }
 	    if (coeff < 0 ||
 		bfconf->coeffs[coeff].n_blocks > n_blocks - delay)
 	    {
@@ -1596,8 +2286,20 @@ filter_process(struct bfaccess *bfaccess,
 	    } else {
 		prevcblocks = bfconf->coeffs[prevcoeff[n]].n_blocks;
 	    }
+            /* with non-uniform partitioning the tail is processed below */
+            if (nuconv[n] != NULL && cblocks > head_blocks) {
+                cblocks = head_blocks;
+            }
+            if (nuconv[n] != NULL && prevcblocks > head_blocks) {
+                prevcblocks = head_blocks;
+            }
 
 	    curblock = (int)((blockcounter + delay) % (unsigned int)(n_blocks));
+            /* a filter convolved in float has its inputs mixed in full
+               precision to ocbuf, which is free until the products, and then
+               converted to the partition */
+            imix = filters[n].realsize < bfconf->realsize ?
+                ocbuf[n] : cbuf[n][curblock];
 	    
 	    /* mix and scale inputs prior to convolution */
 	    if (filters[n].n_filters[IN] > 0) {
@@ -1649,13 +2351,13 @@ filter_process(struct bfaccess *bfaccess,
 		mixconvbuf_inputs[n][i] = static_evalbuf;
                 if (!iszero || !powersave) {
                     convolver_mixnscale(mixconvbuf_inputs[n],
-                                        cbuf[n][curblock],
+                                        imix,
                                         scales,
                                         filters[n].n_channels[IN] + 1,
                                         CONVOLVER_MIXMODE_INPUT);
                     cbuf_zero[n][curblock] = false;
                 } else if (!cbuf_zero[n][curblock]) {
-                    memset(cbuf[n][curblock], 0, convbufsize);
+                    memset(cbuf[n][curblock], 0, fconvbufsize[n]);
                     cbuf_zero[n][curblock] = true;
                 }
 	    } else {
@@ -1669,16 +2371,28 @@ filter_process(struct bfaccess *bfaccess,
 		}
                 if (!iszero || !powersave) {
                     convolver_mixnscale(mixconvbuf_inputs[n],
-                                        cbuf[n][curblock],
+                                        imix,
                                         scales,
                                         filters[n].n_channels[IN],
                                         CONVOLVER_MIXMODE_INPUT);
                     cbuf_zero[n][curblock] = false;
                 } else if (!cbuf_zero[n][curblock]) {
-                    memset(cbuf[n][curblock], 0, convbufsize);
+                    memset(cbuf[n][curblock], 0, fconvbufsize[n]);
                     cbuf_zero[n][curblock] = true;
                 }
 	    }
+            dmix = NULL;
+            if (filters[n].realsize < bfconf->realsize &&
+                (!iszero || !powersave))
+            {
+                if (nuconv[n] != NULL && nu_freqd) {
+                    /* the tail takes its input before it is converted */
+                    dmix = convolver_nu_cbuf2time(nuconv[n], imix);
+                }
+                convolver_convert_cbuf(imix, bfconf->realsize,
+                                       cbuf[n][curblock], filters[n].realsize);
+                ocbuf_zero[n] = false;
+            }
 	    timestamp(&t2);
 	    t[2] += t2 - t1;
 	    /* convolve (or not) */
@@ -1688,31 +2402,40 @@ filter_process(struct bfaccess *bfaccess,
 	    for (i = 0; i < events.n_pre_convolve; i++) {
 		events.pre_convolve[i](cbuf[n][curblock], n);
 	    }
+            if (icbuf[n] != NULL &&
+                (!cbuf_zero[n][curblock] || !powersave))
+            {
+                convolver_interleave(cbuf[n][curblock], icbuf[n], n_blocks,
+                                     curblock);
+            }
+            /* the output with the previous coefficients goes to prevbuf when
+               crossfading */
+            crossfade = filters[n].crossfade && prevcoeff[n] != coeff;
+            crossfading[n] = false;
+            prevbuf = crossfade_ocbuf[n] != NULL ?
+                crossfade_ocbuf[n] : crossfadebuf[0];
 	    if (coeff >= 0) {
 		if (n_blocks == 1) {
                     /* curblock is always zero when n_blocks == 1 */
                     if (!cbuf_zero[n][0] || !powersave) {
-                        if (filters[n].crossfade && prevcoeff[n] != coeff) {
+                        if (crossfade) {
                             if (prevcoeff[n] < 0) {
                                 convolver_dirac_convolve(cbuf[n][0],
-                                                         crossfadebuf[0]);
+                                                         prevbuf);
                             } else {
                                 convolver_convolve
                                     (cbuf[n][0],
-                                     bfconf->coeffs_data[prevcoeff[n]][0],
-                                     crossfadebuf[0]);
+                                     coeffs_part(prevcoeff[n], 0),
+                                     prevbuf);
                             }
                             convolver_convolve_inplace
                                 (cbuf[n][0],
-                                 bfconf->coeffs_data[coeff][0]);
-                            convolver_crossfade_inplace(cbuf[n][0],
-                                                        crossfadebuf[0],
-                                                        crossfadebuf[1]);
-                            temp_buffer_zero = false;
+                                 coeffs_part(coeff, 0));
+                            crossfading[n] = true;
                         } else {
                             convolver_convolve_inplace
                                 (cbuf[n][0],
-                                 bfconf->coeffs_data[coeff][0]);
+                                 coeffs_part(coeff, 0));
                         }
                         /* cbuf points at ocbuf when n_blocks == 1 */
                         ocbuf_zero[n] = false;
@@ -1722,47 +2445,101 @@ filter_process(struct bfaccess *bfaccess,
                         bit_set(partial_proc, n);
                     }
 		} else {
-                    if (!cbuf_zero[n][curblock] || !powersave) {
-                        if (filters[n].crossfade && prevcoeff[n] != coeff) {
-                            if (prevcoeff[n] < 0) {
-                                convolver_dirac_convolve(cbuf[n][curblock],
-                                                         crossfadebuf[0]);
-                            } else {
-                                convolver_convolve
-                                    (cbuf[n][curblock],
-                                     bfconf->coeffs_data[prevcoeff[n]][0],
-                                     crossfadebuf[0]);
+                    if (crossfade && (!cbuf_zero[n][curblock] || !powersave)) {
+                        if (prevcoeff[n] < 0) {
+                            convolver_dirac_convolve(cbuf[n][curblock],
+                                                     prevbuf);
+                        } else {
+                            convolver_convolve
+                                (cbuf[n][curblock],
+                                 coeffs_part(prevcoeff[n], 0),
+                                 prevbuf);
+                        }
+                    } else if (crossfade) {
+                        memset(prevbuf, 0, convbufsize);
+                    }
+                    if (icoeffs[n] != NULL && icoeffs_set[n] != coeff) {
+                        for (i = 0; i < bfconf->coeffs[coeff].n_blocks; i++) {
+                            convolver_interleave(coeffs_part(coeff, i),
+                                                 icoeffs[n], n_blocks, i);
+                        }
+                        icoeffs_set[n] = coeff;
+                    }
+                    /* with processing_margin the partitions after the first
+                       are usually summed already, unless the coefficients
+                       or their number of blocks changed */
+                    ahead = aheadbuf[n] != NULL && ahead_coeff[n] == coeff &&
+                        ahead_cblocks[n] == cblocks;
+                    ahead_coeff[n] = coeff;
+                    ahead_cblocks[n] = cblocks;
+                    /* all partitions are summed in one pass over ocbuf */
+                    n_pairs = 0;
+                    n_skipped = 0;
+		    for (i = 0; i < (ahead ? 1 : cblocks) &&
+                             i < procblocks[n]; i++)
+                    {
+			j = (int)((blockcounter - i) % (unsigned int)n_blocks);
+                        if (bit_isset(bfconf->coeffs_zero[coeff], i)) {
+                            n_skipped++;
+                        } else if (!cbuf_zero[n][j] || !powersave) {
+                            sum_cbufs[n_pairs] = cbuf[n][j];
+                            sum_coeffs[n_pairs] =
+                                bfconf->coeffs_data[coeff][i];
+                            if (bfconf->coeffs_band[coeff] != NULL) {
+                                sum_bands[n_pairs] =
+                                    &bfconf->coeffs_band[coeff][2 * i];
                             }
+                            sum_cbuf_indexes[n_pairs] = j;
+                            sum_coeff_indexes[n_pairs] = i;
+                            n_pairs++;
+                        }
+		    }
+                    bands = bfconf->coeffs_band[coeff] != NULL ?
+                        sum_bands : NULL;
+                    part_count[0] += n_pairs;
+                    part_count[1] += n_skipped;
+                    if (ahead) {
+                        part_count[0] += ahead_pairs[n];
+                        part_count[1] += ahead_skipped[n];
+                        n_skipped += ahead_skipped[n];
+                    }
+                    if (ahead && ahead_pairs[n] > 0) {
+                        memcpy(ocbuf[n], aheadbuf[n], convbufsize);
+                        if (n_pairs > 0) {
+                            convolver_convolve_add(sum_cbufs[0],
+                                                   coeffs_part(coeff, 0),
+                                                   ocbuf[n]);
                         }
-                        convolver_convolve(cbuf[n][curblock],
-                                           bfconf->coeffs_data[coeff][0],
-                                           ocbuf[n]);
+                        ocbuf_zero[n] = false;
+                    } else if (n_pairs > 0 && icbuf[n] != NULL) {
+                        convolver_convolve_sum_interleaved
+                            (icbuf[n], sum_cbuf_indexes, icoeffs[n],
+                             sum_coeff_indexes, bands, n_pairs, n_blocks,
+                             ocbuf[n], filters[n].double_accumulation);
+                        ocbuf_zero[n] = false;
+                    } else if (n_pairs > 0) {
+                        convolver_convolve_sum
+                            (sum_cbufs, sum_coeffs, bands, n_pairs, ocbuf[n],
+                             bfconf->coeffs[coeff].compression,
+                             filters[n].double_accumulation);
+                        ocbuf_zero[n] = false;
+                    } else if (n_skipped > 0) {
+                        /* the input is not zero even if the output is */
+                        memset(ocbuf[n], 0, convbufsize);
                         ocbuf_zero[n] = false;
                     } else if (!ocbuf_zero[n]) {
                         memset(ocbuf[n], 0, convbufsize);
                         ocbuf_zero[n] = true;
                     }
-		    for (i = 1; i < cblocks && i < procblocks[n]; i++) {
-			j = (int)((blockcounter - i) % (unsigned int)n_blocks);
-                        if (!cbuf_zero[n][j] || !powersave) {
-                            convolver_convolve_add
-                                (cbuf[n][j],
-                                 bfconf->coeffs_data[coeff][i],
-                                 ocbuf[n]);
-                            ocbuf_zero[n] = false;
-                        }
-		    }
-                    if (filters[n].crossfade && prevcoeff[n] != coeff &&
-                        prevcoeff[n] >= 0)
-                    {
+                    if (crossfade && prevcoeff[n] >= 0) {
                         for (i = 1; i < prevcblocks && i < procblocks[n]; i++) {
                             j = (int)((blockcounter - i) %
                                       (unsigned int)n_blocks);
                             if (!cbuf_zero[n][j] || !powersave) {
                                 convolver_convolve_add
                                     (cbuf[n][j],
-                                     bfconf->coeffs_data[prevcoeff[n]][i],
-                                     crossfadebuf[0]);
+                                     coeffs_part(prevcoeff[n], i),
+                                     prevbuf);
                             }
                             ocbuf_zero[n] = false;
                         }
@@ -1770,25 +2547,20 @@ filter_process(struct bfaccess *bfaccess,
                     if (ocbuf_zero[n]) {
                         procblocks[n] = 0;
                         bit_set(partial_proc, n);
-                    } else if (filters[n].crossfade && prevcoeff[n] != coeff) {
-                        convolver_crossfade_inplace(ocbuf[n], crossfadebuf[0],
-                                                    crossfadebuf[1]);
-                        temp_buffer_zero = false;
+                    } else if (crossfade) {
+                        crossfading[n] = true;
                     }
 		}
 	    } else {
 		if (n_blocks == 1) {
                     if (!cbuf_zero[n][0] || !powersave) {
-                        if (filters[n].crossfade && prevcoeff[n] != coeff) {
+                        if (crossfade) {
                             convolver_convolve
                                 (cbuf[n][0],
-                                 bfconf->coeffs_data[prevcoeff[n]][0],
-                                 crossfadebuf[0]);
+                                 coeffs_part(prevcoeff[n], 0),
+                                 prevbuf);
                             convolver_dirac_convolve_inplace(cbuf[n][0]);
-                            convolver_crossfade_inplace(cbuf[n][0],
-                                                        crossfadebuf[0],
-                                                        crossfadebuf[1]);
-                            temp_buffer_zero = false;
+                            crossfading[n] = true;
                         } else {
                             convolver_dirac_convolve_inplace(cbuf[n][0]);
                         }
@@ -1800,27 +2572,32 @@ filter_process(struct bfaccess *bfaccess,
                     }
 		} else {
                     if (!cbuf_zero[n][curblock] || !powersave) {
-                        if (filters[n].crossfade && prevcoeff[n] != coeff) {
+                        if (crossfade) {
                             convolver_convolve
                                 (cbuf[n][curblock],
-                                 bfconf->coeffs_data[prevcoeff[n]][0],
-                                 crossfadebuf[0]);
+                                 coeffs_part(prevcoeff[n], 0),
+                                 prevbuf);
                         }
                         convolver_dirac_convolve(cbuf[n][curblock], ocbuf[n]);
                         ocbuf_zero[n] = false;
-                    } else if (!ocbuf_zero[n]) {
-                        memset(ocbuf[n], 0, convbufsize);
-                        ocbuf_zero[n] = true;
+                    } else {
+                        if (crossfade) {
+                            memset(prevbuf, 0, convbufsize);
+                        }
+                        if (!ocbuf_zero[n]) {
+                            memset(ocbuf[n], 0, convbufsize);
+                            ocbuf_zero[n] = true;
+                        }
                     }
-                    if (filters[n].crossfade && prevcoeff[n] != coeff) {
+                    if (crossfade) {
                         for (i = 1; i < prevcblocks && i < procblocks[n]; i++) {
                             j = (int)((blockcounter - i) %
                                       (unsigned int)n_blocks);
                             if (!cbuf_zero[n][j] || !powersave) {
                                 convolver_convolve_add
                                     (cbuf[n][j],
-                                     bfconf->coeffs_data[prevcoeff[n]][i],
-                                     crossfadebuf[0]);
+                                     coeffs_part(prevcoeff[n], i),
+                                     prevbuf);
                             }
                             ocbuf_zero[n] = false;
                         }
@@ -1828,13 +2605,74 @@ filter_process(struct bfaccess *bfaccess,
                     if (ocbuf_zero[n]) {
                         procblocks[n] = 0;
                         bit_set(partial_proc, n);
-                    } else if (filters[n].crossfade && prevcoeff[n] != coeff) {
-                        convolver_crossfade_inplace(ocbuf[n], crossfadebuf[0],
-                                                    crossfadebuf[1]);
-                        temp_buffer_zero = false;
+                    } else if (crossfade) {
+                        crossfading[n] = true;
                     }
 		}
 	    }
+            if (filters[n].realsize < bfconf->realsize) {
+                /* back to full precision for the output */
+                if (!ocbuf_zero[n]) {
+                    convolver_convert_cbuf(ocbuf[n], filters[n].realsize,
+                                           ocbuf[n], bfconf->realsize);
+                }
+                if (crossfading[n]) {
+                    convolver_convert_cbuf(prevbuf, filters[n].realsize,
+                                           prevbuf, bfconf->realsize);
+                }
+                convolver_filter_realsize(bfconf->realsize);
+            }
+            if (crossfading[n] && crossfade_ocbuf[n] == NULL) {
+                convolver_crossfade_inplace(ocbuf[n], crossfadebuf[0],
+                                            crossfadebuf[1]);
+                temp_buffer_zero = false;
+                crossfading[n] = false;
+            }
+            if (nuconv[n] != NULL) {
+                /* the tail input is the same mix as the head input, in the
+                   time-domain */
+                i = (int)((blockcounter + delay) % (unsigned int)n_blocks);
+                if (nu_freqd && filters[n].realsize < bfconf->realsize) {
+                    /* made from the mix before it was converted, above */
+                    i = delay;
+                } else if (nu_freqd) {
+                    dmix = cbuf_zero[n][curblock] && powersave ? NULL :
+                        convolver_nu_cbuf2time(nuconv[n], cbuf[n][curblock]);
+                    i = 0;
+                } else if (cbuf_zero[n][i] && powersave) {
+                    dmix = NULL;
+                    i = delay;
+                } else {
+                    for (i = 0; i < filters[n].n_channels[IN]; i++) {
+                        nu_mix[i] = input_timebuf[filters[n].channels[IN][i]];
+                        scales[i] = icomm_fctrl[n].scale[IN][i] *
+                            virtscales[IN][filters[n].channels[IN][i]];
+                    }
+                    if (filters[n].n_filters[IN] > 0) {
+                        /* the latest block of the evaluated filter-inputs */
+                        nu_mix[i] = evalbuf[n];
+                        scales[i++] = 1.0;
+                    }
+                    convolver_mixnscale(nu_mix, nu_inbuf, scales, i,
+                                        CONVOLVER_MIXMODE_TIME);
+                    dmix = nu_inbuf;
+                    i = delay;
+                }
+                nu_tail[n] = convolver_nu_convolve(nuconv[n], dmix, i,
+                                                   coeff < 0 ? NULL :
+                                                   bfconf->coeffs_tail[coeff]);
+                if (nu_tail[n] != NULL &&
+                    (filters[n].n_filters[OUT] > 0 ||
+                     events.n_post_convolve > 0 ||
+                     events.n_output_freqd > 0))
+                {
+                    /* the output must be complete in the frequency-domain */
+                    convolver_nu_add(nuconv[n], ocbuf[n],
+                                     ocbuf_zero[n] && powersave);
+                    ocbuf_zero[n] = false;
+                    nu_tail[n] = NULL;
+                }
+            }
             prevcoeff[n] = coeff;
 	    for (i = 0; i < events.n_post_convolve; i++) {
 		events.post_convolve[i](cbuf[n][curblock], n);
@@ -1848,7 +2686,10 @@ filter_process(struct bfaccess *bfaccess,
             iszero = true;
 	    for (i = 0; i < outconvbuf_n_filters[n]; i++) {
 		scales[i] = *outscale[n][i] / virtscales[OUT][outputs[n]];
-                if (!ocbuf_zero[outconvbuf_map[n][i]]) {
+                j = outconvbuf_map[n][i];
+                if (mtx[j] != NULL ?
+                    !mtx[j]->out_zero[outconvbuf_pos[n][i]] : !ocbuf_zero[j])
+                {
                     iszero = false;
                 }
 	    }
@@ -1859,12 +2700,54 @@ filter_process(struct bfaccess *bfaccess,
                                     output_freqcbuf[outputs[n]],
                                     scales,
                                     outconvbuf_n_filters[n],
+                                    bfconf->direct[OUT][outputs[n]] ?
+                                    CONVOLVER_MIXMODE_TIME :
                                     CONVOLVER_MIXMODE_OUTPUT);
                 output_freqcbuf_zero[outputs[n]] = false;
-            } else if (!output_freqcbuf_zero[outputs[n]]) {
-                memset(output_freqcbuf[outputs[n]], 0, convbufsize);
-                output_freqcbuf_zero[outputs[n]] = true;
+                /* if any filter is crossfading, the output with the previous
+                   coefficients is mixed as well */
+                crossfade = false;
+                for (i = 0; i < outconvbuf_n_filters[n]; i++) {
+                    j = outconvbuf_map[n][i];
+                    if (crossfading[j]) {
+                        crossfade_mixbufs[i] = crossfade_ocbuf[j];
+                        crossfade = true;
+                    } else {
+                        crossfade_mixbufs[i] = outconvbuf[n][i];
+                    }
+                }
+                if (crossfade) {
+                    convolver_mixnscale(crossfade_mixbufs,
+                                        output_crossfadecbuf[outputs[n]],
+                                        scales,
+                                        outconvbuf_n_filters[n],
+                                        CONVOLVER_MIXMODE_OUTPUT);
+                }
+                icomm->output_crossfade[outputs[n]] = crossfade;
+            } else {
+                if (!output_freqcbuf_zero[outputs[n]]) {
+                    memset(output_freqcbuf[outputs[n]], 0, convbufsize);
+                    output_freqcbuf_zero[outputs[n]] = true;
+                }
+                icomm->output_crossfade[outputs[n]] = false;
+            }
+            /* the time-domain tails of non-uniform partitioned filters are
+               mixed separately and added after the output transform */
+            for (i = k = 0; i < outconvbuf_n_filters[n]; i++) {
+                j = outconvbuf_map[n][i];
+                dmix = mtx[j] != NULL ?
+                    mtx[j]->nu_tail[outconvbuf_pos[n][i]] : nu_tail[j];
+                if (dmix != NULL) {
+                    nu_mix[k] = dmix;
+                    scales[k++] = *outscale[n][i] /
+                        virtscales[OUT][outputs[n]];
+                }
             }
+            if (k > 0) {
+                convolver_mixnscale(nu_mix, output_tailbuf[outputs[n]],
+                                    scales, k, CONVOLVER_MIXMODE_TIME);
+            }
+            icomm->output_tail[outputs[n]] = k > 0;
 	}
 	timestamp(&t2);
 	t[4] += t2 - t1;
@@ -1882,18 +2765,64 @@ filter_process(struct bfaccess *bfaccess,
 	    for (i = 0; i < events.n_output_freqd; i++) {
 		events.output_freqd[i](output_freqcbuf[virtch], virtch);
 	    }
-	    /* ocbuf[0] happens to be free, that's why we use it */
-            if (!output_freqcbuf_zero[virtch] || !powersave) {
-                convolver_freq2time(output_freqcbuf[virtch], ocbuf[0]);
-                ocbuf_zero[0] = false;
-                if (n_blocks == 1) {
-                    cbuf_zero[0][0] = false;
+            if (output_batch[n] == n) {
+                /* first of a run, all of it is transformed in one go unless
+                   some outputs are silent or crossfading */
+                output_batched = true;
+                for (i = n; i < n_procoutputs && output_batch[i] == n; i++) {
+                    if ((output_freqcbuf_zero[procoutputs[i]] && powersave) ||
+                        icomm->output_crossfade[procoutputs[i]])
+                    {
+                        output_batched = false;
+                    }
                 }
-            } else if (!ocbuf_zero[0]) {
-                memset(ocbuf[0], 0, convbufsize);
-                ocbuf_zero[0] = true;
-                if (n_blocks == 1) {
-                    cbuf_zero[0][0] = true;
+                if (output_batched) {
+                    convolver_freq2time_batch(output_plan[n],
+                                              output_freqcbuf[virtch],
+                                              output_timecbuf[n]);
+                }
+            }
+            if (output_batch[n] != -1 && output_batched) {
+                timecbuf = output_timecbuf[n];
+            } else {
+                /* ocbuf[0] happens to be free, that's why we use it */
+                timecbuf = ocbuf[0];
+                if (!output_freqcbuf_zero[virtch] || !powersave) {
+                    if (bfconf->direct[OUT][virtch]) {
+                        /* only direct filters output here, it is already in
+                           the time-domain */
+                        memcpy(ocbuf[0], output_freqcbuf[virtch],
+                               fragsize * bfconf->realsize);
+                    } else {
+                        convolver_freq2time(output_freqcbuf[virtch], ocbuf[0]);
+                        if (icomm->output_crossfade[virtch]) {
+                            convolver_freq2time(output_crossfadecbuf[virtch],
+                                                crossfade_timecbuf);
+                            convolver_crossfade_time(crossfade_timecbuf,
+                                                     ocbuf[0]);
+                        }
+                    }
+                    ocbuf_zero[0] = false;
+                    if (n_blocks == 1) {
+                        cbuf_zero[0][0] = false;
+                    }
+                } else if (!ocbuf_zero[0]) {
+                    memset(ocbuf[0], 0, convbufsize);
+                    ocbuf_zero[0] = true;
+                    if (n_blocks == 1) {
+                        cbuf_zero[0][0] = true;
+                    }
+                }
+            }
+
+            if (icomm->output_tail[virtch]) {
+                nu_mix[0] = timecbuf;
+                nu_mix[1] = output_tailbuf[virtch];
+                scales[0] = scales[1] = 1.0;
+                convolver_mixnscale(nu_mix, timecbuf, scales, 2,
+                                    CONVOLVER_MIXMODE_TIME);
+                if (timecbuf == ocbuf[0]) {
+                    ocbuf_zero[0] = false;
                 }
             }
 
@@ -1901,9 +2830,9 @@ filter_process(struct bfaccess *bfaccess,
                afford to check all values, but NaN/Inf tend to spread, so
                checking only one value usually catches the problem. */
             if ((bfconf->realsize == sizeof(float) &&
-                 !finite((double)((float *)ocbuf[0])[0])) ||
+                 !finite((double)((float *)timecbuf)[0])) ||
                 (bfconf->realsize == sizeof(double) &&
-                 !finite(((double *)ocbuf[0])[0])))
+                 !finite(((double *)timecbuf)[0])))
             {
                 fprintf(stderr, "NaN or Inf values in the system! "
                         "Invalid input? Aborting.\n");
@@ -1916,10 +2845,10 @@ filter_process(struct bfaccess *bfaccess,
 	    /* write to output buffer */
 	    timestamp(&t1);
 	    for (i = 0; i < events.n_output_timed; i++) {
-		events.output_timed[i](ocbuf[0], virtch);
+		events.output_timed[i](timecbuf, virtch);
 	    }
             if (output_sd_rest[virtch] != NULL) {
-                delay_subsample_update(ocbuf[0],
+                delay_subsample_update(timecbuf,
                                        output_sd_rest[virtch],
                                        icomm_subdelay[OUT][virtch]);
             }
@@ -1927,7 +2856,7 @@ filter_process(struct bfaccess *bfaccess,
 		/* only one virtual channel allocated to this physical one, so
 		   we write to it directly */                
                 of = icomm->overflow[virtch];
-                convolver_cbuf2raw(ocbuf[0],
+                convolver_cbuf2raw(timecbuf,
                                    outbuf[curbuf],
                                    &dai_buffer_format[OUT]->bf[physch],
                                    bfconf->dither_state[physch] != NULL,
@@ -1945,33 +2874,33 @@ filter_process(struct bfaccess *bfaccess,
                 {
                     delay += bfconf->sdf_length;
                 }
-		delay_update(output_db[virtch], ocbuf[0], bfconf->realsize, 1,
+		delay_update(output_db[virtch], timecbuf, bfconf->realsize, 1,
 			     delay, NULL);
 		if (!bit_isset(icomm_ismuted[OUT], virtch)) {
 		    if (!mixbuf_is_filled) {
-			memcpy(mixbuf, ocbuf[0], fragsize * bfconf->realsize);
+			memcpy(mixbuf, timecbuf, fragsize * bfconf->realsize);
 		    } else {
                         if (bfconf->realsize == 4) {
                             for (i = 0; i < fragsize; i += 4) {
                                 ((float *)mixbuf)[i+0] +=
-                                    ((float *)ocbuf[0])[i+0];
+                                    ((float *)timecbuf)[i+0];
                                 ((float *)mixbuf)[i+1] +=
-                                    ((float *)ocbuf[0])[i+1];
+                                    ((float *)timecbuf)[i+1];
                                 ((float *)mixbuf)[i+2] +=
-                                    ((float *)ocbuf[0])[i+2];
+                                    ((float *)timecbuf)[i+2];
                                 ((float *)mixbuf)[i+3] +=
-                                    ((float *)ocbuf[0])[i+3];
+                                    ((float *)timecbuf)[i+3];
                             }
                         } else {
                             for (i = 0; i < fragsize; i += 4) {
                                 ((double *)mixbuf)[i+0] +=
-                                    ((double *)ocbuf[0])[i+0];
+                                    ((double *)timecbuf)[i+0];
                                 ((double *)mixbuf)[i+1] +=
-                                    ((double *)ocbuf[0])[i+1];
+                                    ((double *)timecbuf)[i+1];
                                 ((double *)mixbuf)[i+2] +=
-                                    ((double *)ocbuf[0])[i+2];
+                                    ((double *)timecbuf)[i+2];
                                 ((double *)mixbuf)[i+3] +=
-                                    ((double *)ocbuf[0])[i+3];
+                                    ((double *)timecbuf)[i+3];
                             }
                         }
 		    }
@@ -2026,9 +2955,66 @@ filter_process(struct bfaccess *bfaccess,
             sched_yield();
         }
         timestamp(&icomm->debug.f[dbg_pos].w_output.ts_ret);
+
+        /* With processing_margin, the partitions after the first only need
+           input which has already arrived, so they are summed for the next
+           period now that the output is delivered. When the next input
+           arrives only the first partition is left to do. */
+        timestamp(&t1);
+        for (n = 0; n < n_filters; n++) {
+            coeff = ahead_coeff[n];
+            if (aheadbuf[n] == NULL || coeff < 0) {
+                continue;
+            }
+            if (coeff != prevcoeff[n]) {
+                /* the filter did not use the coefficients this period */
+                ahead_coeff[n] = -1;
+                continue;
+            }
+            convolver_filter_realsize(filters[n].realsize);
+            n_pairs = 0;
+            n_skipped = 0;
+            for (i = 1; i < ahead_cblocks[n] &&
+                     (procblocks[n] == n_blocks || i <= procblocks[n]); i++)
+            {
+                j = (int)((blockcounter + 1 - i) % (unsigned int)n_blocks);
+                if (bit_isset(bfconf->coeffs_zero[coeff], i)) {
+                    n_skipped++;
+                } else if (!cbuf_zero[n][j] || !powersave) {
+                    sum_cbufs[n_pairs] = cbuf[n][j];
+                    sum_coeffs[n_pairs] = bfconf->coeffs_data[coeff][i];
+                    if (bfconf->coeffs_band[coeff] != NULL) {
+                        sum_bands[n_pairs] = &bfconf->coeffs_band[coeff][2 * i];
+                    }
+                    sum_cbuf_indexes[n_pairs] = j;
+                    sum_coeff_indexes[n_pairs] = i;
+                    n_pairs++;
+                }
+            }
+            bands = bfconf->coeffs_band[coeff] != NULL ? sum_bands : NULL;
+            if (n_pairs > 0 && icbuf[n] != NULL) {
+                convolver_convolve_sum_interleaved
+                    (icbuf[n], sum_cbuf_indexes, icoeffs[n], sum_coeff_indexes,
+                     bands, n_pairs, n_blocks, aheadbuf[n],
+                     filters[n].double_accumulation);
+            } else if (n_pairs > 0) {
+                convolver_convolve_sum(sum_cbufs, sum_coeffs, bands, n_pairs,
+                                       aheadbuf[n],
+                                       bfconf->coeffs[coeff].compression,
+                                       filters[n].double_accumulation);
+            }
+            ahead_pairs[n] = n_pairs;
+            ahead_skipped[n] = n_skipped;
+        }
+        convolver_filter_realsize(bfconf->realsize);
+        timestamp(&t2);
+        t[3] += t2 - t1;
 	
 	/* swap convolve buffers */
 	curbuf = !curbuf;
+        if (++ringpos == ringblocks - 1) {
+            ringpos = 0;
+        }
 
 	/* advance input block */
 	blockcounter++;
@@ -2046,22 +3032,24 @@ filter_process(struct bfaccess *bfaccess,
   freq2time ... inverse fast fouirer transform of input buffers\n\
   real2raw .... sample format conversion from internal format to output\n\
   total ....... total time required per period\n\
+  skipped ..... percent of the partitions skipped as the coeff is zero\n\
   periods ..... number of periods processed so far\n\
   rti ......... current realtime index\n\
 \n\
 all times are in milliseconds, mean value over 10 periods\n\
 \n\
   pid |  raw2real | time2freq | mixscale1 |  convolve | mixscale2 | \
-freq2time |  real2raw |     total | periods | rti \n\
+freq2time |  real2raw |     total | skipped | periods | rti \n\
 --------------------------------------------------------------------\
-----------------------------------------------------\n");
+--------------------------------------------------------------\n");
                 }
                 clockmul = 1.0 / (bfconf->cpu_mhz * 1000.0);
                 for (n = 0; n < 8; n++) {
                     t[n] /= 10;
                 }
 		fprintf(stderr, "%5d | %9.3f | %9.3f | %9.3f | %9.3f |"
-                        " %9.3f | %9.3f | %9.3f | %9.3f | %7lu | %.3f\n",
+                        " %9.3f | %9.3f | %9.3f | %9.3f | %6.1f%% | %7lu |"
+                        " %.3f\n",
 			(int)getpid(),
 			(double)t[0] * clockmul,
 			(double)t[1] * clockmul,
@@ -2071,9 +3059,12 @@ freq2time |  real2raw |     total | periods | rti \n\
 			(double)t[5] * clockmul,
 			(double)t[6] * clockmul,
 			(double)t[7] * clockmul,
+                        part_count[1] == 0 ? 0.0 : 100.0 * part_count[1] /
+                        (part_count[0] + part_count[1]),
                         (unsigned long int)cc,
                         icomm->realtime_index);
                 memset(t, 0, sizeof(t));
+                memset(part_count, 0, sizeof(part_count));
 	    }
 	}
 
@@ -2129,6 +3120,50 @@ bf_callback_ready(int io)
     }
 }
 
+void
+bfrun_plan(void)
+{
+    int n, i, j, taps, batch[BF_MAXCHANNELS];
+    struct filter_process *fproc;
+
+    /* the equaliser logic module makes inverse in-place plans of the length
+       of its shared coefficient sets */
+    for (n = 0; n < bfconf->n_coeffs; n++) {
+        taps = bfconf->coeffs[n].n_blocks * bfconf->filter_length;
+        if (bfconf->coeffs[n].is_shared && log2_get(taps) != -1) {
+            convolver_fftplan(log2_get(taps), true, true);
+        }
+    }
+    convolver_fft_threads_init();
+
+    /* the batched plans made by filter_process() */
+    for (n = 0; n < bfconf->n_processes; n++) {
+        fproc = &bfconf->fproc[n];
+        FOR_IN_AND_OUT {
+            if (!find_batches(fproc->n_unique_channels[IO],
+                              fproc->unique_channels[IO], bfconf->direct[IO],
+                              batch))
+            {
+                continue;
+            }
+            for (i = 0; i < fproc->n_unique_channels[IO]; i++) {
+                if (batch[i] != i) {
+                    continue;
+                }
+                for (j = i; j < fproc->n_unique_channels[IO] &&
+                         batch[j] == i; j++);
+                convolver_batch_fftplan(j - i, IO == IN ?
+                                        INPUT_RING_BLOCKS *
+                                        bfconf->filter_length *
+                                        bfconf->realsize :
+                                        convolver_cbufsize(),
+                                        convolver_cbufsize(), IO == OUT);
+            }
+        }
+    }
+    convolver_save_wisdom();
+}
+
 void
 bfrun(void)
 {
@@ -2140,8 +3175,14 @@ bfrun(void)
     void *buffers[2][2];
     void *input_freqcbuf[bfconf->n_channels[IN]], *input_freqcbuf_base;
     void *output_freqcbuf[bfconf->n_channels[OUT]], *output_freqcbuf_base;
+    void *output_crossfadecbuf[bfconf->n_channels[OUT]];
+    void *output_crossfadecbuf_base = NULL;
+    uint32_t crossfade_outputs[BF_MAXCHANNELS/32];
+    void *input_timebuf[bfconf->n_channels[IN]];
+    void *output_tailbuf[bfconf->n_channels[OUT]];
+    void *input_timebuf_base = NULL, *output_tailbuf_base = NULL;
     int nc[2], cpos[2], channels[2][BF_MAXCHANNELS];
-    int n, i, j, cbufsize, physch;
+    int n, i, j, k, cbufsize, physch;
     bool_t checkdrift, trigger;
     struct bfaccess bfaccess;
     pid_t pid;
@@ -2183,6 +3224,65 @@ bfrun(void)
 	output_freqcbuf[n] = output_freqcbuf_base;
 	output_freqcbuf_base = (uint8_t *)output_freqcbuf_base + cbufsize;
     }
+    /* outputs with the previous coefficients of crossfading filters, only
+       needed for the outputs of those which output to channels alone, the
+       others crossfade within the filter */
+    memset(crossfade_outputs, 0, sizeof(crossfade_outputs));
+    for (n = i = 0; n < bfconf->n_filters; n++) {
+        if (!bfconf->filters[n].crossfade ||
+            bfconf->filters[n].n_filters[OUT] > 0)
+        {
+            continue;
+        }
+        for (j = 0; j < bfconf->filters[n].n_channels[OUT]; j++) {
+            k = bfconf->filters[n].channels[OUT][j];
+            if (!bit_isset(crossfade_outputs, k)) {
+                bit_set(crossfade_outputs, k);
+                i++;
+            }
+        }
+    }
+    if (i > 0 &&
+        (output_crossfadecbuf_base = shmalloc(i * cbufsize)) == NULL)
+    {
+        fprintf(stderr, "Failed to allocate shared memory: %s.\n",
+                strerror(errno));
+        bf_exit(BF_EXIT_NO_MEMORY);
+        return;
+    }
+    for (n = 0; n < bfconf->n_channels[OUT]; n++) {
+        output_crossfadecbuf[n] = NULL;
+        if (bit_isset(crossfade_outputs, n)) {
+            output_crossfadecbuf[n] = output_crossfadecbuf_base;
+            output_crossfadecbuf_base =
+                (uint8_t *)output_crossfadecbuf_base + cbufsize;
+        }
+    }
+    /* time-domain input and tail output of non-uniform partitioned
+       filters */
+    i = bfconf->filter_length * bfconf->realsize;
+    if (convolver_nu_head_blocks() < bfconf->n_blocks &&
+        ((input_timebuf_base = shmalloc(bfconf->n_channels[IN] * i)) == NULL ||
+         (output_tailbuf_base = shmalloc(bfconf->n_channels[OUT] * i)) ==
+         NULL))
+    {
+        fprintf(stderr, "Failed to allocate shared memory: %s.\n",
+                strerror(errno));
+        bf_exit(BF_EXIT_NO_MEMORY);
+        return;
+    }
+    for (n = 0; n < bfconf->n_channels[IN]; n++) {
+        input_timebuf[n] = input_timebuf_base;
+        if (input_timebuf_base != NULL) {
+            input_timebuf_base = (uint8_t *)input_timebuf_base + i;
+        }
+    }
+    for (n = 0; n < bfconf->n_channels[OUT]; n++) {
+        output_tailbuf[n] = output_tailbuf_base;
+        if (output_tailbuf_base != NULL) {
+            output_tailbuf_base = (uint8_t *)output_tailbuf_base + i;
+        }
+    }
     
     /* initialise process intercomm area */
     for (n = 0; n < sizeof(struct intercomm_area); n++) {
@@ -2304,6 +3404,7 @@ bfrun(void)
     bfaccess.bflogic_command = bflogic_command;
     bfaccess.convolver_coeffs2cbuf = convolver_runtime_coeffs2cbuf;
     bfaccess.convolver_fftplan = convolver_fftplan;
+    bfaccess.convolver_fft_execute = convolver_fft_execute;
     bfaccess.set_subdelay = set_subdelay;
     bfaccess.get_subdelay = get_subdelay;
 
@@ -2350,6 +3451,9 @@ bfrun(void)
 			   buffers[OUT],
 			   input_freqcbuf,
 			   output_freqcbuf,
+			   output_crossfadecbuf,
+			   input_timebuf,
+			   output_tailbuf,
 			   filter2filter_pipes[n][0],
 			   filter_writefd,
 			   bl_input_2_filter[0],
@@ -26,6 +26,10 @@ struct filter_process {
 void
 bfrun(void);
 
+/* Make all FFTW plans the configuration needs and save the wisdom. */
+void
+bfrun_plan(void);
+
 void
 bf_callback_ready(int io);
 
@@ -25,7 +25,8 @@ BruteFIR v1.0o (November 2016)                                \
 \n"
 
 #define USAGE_STRING \
-"Usage: %s [-quiet] [-nodefault] [-daemon] [configuration file]\n"
+"Usage: %s [-quiet] [-nodefault] [-daemon] [-plan [-exhaustive]]\n\
+        [configuration file]\n"
 
 int
 main(int argc,
@@ -35,6 +36,8 @@ main(int argc,
     bool_t quiet = false;
     bool_t nodefault = false;
     bool_t run_as_daemon = false;
+    bool_t exhaustive = false;
+    int plan = BF_PLAN_NONE;
     int n;
 
     for (n = 1; n < argc; n++) {
@@ -44,6 +47,10 @@ main(int argc,
             nodefault = true;
 	} else if (strcmp(argv[n], "-daemon") == 0) {
             run_as_daemon = true;
+	} else if (strcmp(argv[n], "-plan") == 0) {
+            plan = BF_PLAN_PATIENT;
+	} else if (strcmp(argv[n], "-exhaustive") == 0) {
+            exhaustive = true;
 	} else {
 	    if (config_filename != NULL) {
 		break;
@@ -51,7 +58,10 @@ main(int argc,
 	    config_filename = argv[n];
 	}
     }
-    if (n != argc) {
+    if (exhaustive && plan != BF_PLAN_NONE) {
+        plan = BF_PLAN_EXHAUSTIVE;
+    }
+    if (n != argc || (exhaustive && plan == BF_PLAN_NONE)) {
 	fprintf(stderr, PRESENTATION_STRING);
 	fprintf(stderr, USAGE_STRING, argv[0]);
 	return BF_EXIT_INVALID_CONFIG;
@@ -63,7 +73,12 @@ main(int argc,
     
     emalloc_set_exit_function(bf_exit, BF_EXIT_NO_MEMORY);
     
-    bfconf_init(config_filename, quiet, nodefault);
+    bfconf_init(config_filename, quiet, nodefault, plan);
+
+    if (plan != BF_PLAN_NONE) {
+        bfrun_plan();
+        exit(BF_EXIT_OK);
+    }
 
     if (run_as_daemon) {
         switch (fork()) {
@@ -13,11 +13,12 @@
 #include "bfmod.h"
 #include "dai.h"
 
-/* Convert from raw sample format to the convolver's own time-domain format. */
+/* Convert from raw sample format to the convolver's own time-domain format.
+   The samples are written to the upper half of 'cbuf', the lower half is
+   expected to hold the previous block of samples already. */
 void
 convolver_raw2cbuf(void *rawbuf,
 		   void *cbuf,
-		   void *next_cbuf,
 		   struct buffer_format *bf,
                    void (*postprocess)(void *realbuf,
                                        int n_samples,
@@ -30,7 +31,9 @@ convolver_time2freq(void *input_cbuf,
 		    void *output_cbuf);
 
 /* Scale and mix in the frequency-domain. The 'mixmode' parameter may be used
-   internally for possible reordering of data prior to or after convolution. */
+   internally for possible reordering of data prior to or after convolution.
+   With CONVOLVER_MIXMODE_TIME time-domain buffers of filter length samples
+   are mixed instead. */
 void
 convolver_mixnscale(void *input_cbufs[],
 		    void *output_cbuf,
@@ -39,6 +42,7 @@ convolver_mixnscale(void *input_cbufs[],
 #define CONVOLVER_MIXMODE_INPUT      1
 #define CONVOLVER_MIXMODE_INPUT_ADD  2
 #define CONVOLVER_MIXMODE_OUTPUT     3
+#define CONVOLVER_MIXMODE_TIME       4
 		    int mixmode);
 
 /* Convolution in the frequency-domain, done in-place. */
@@ -57,12 +61,81 @@ convolver_crossfade_inplace(void *input_cbuf,
                             void *crossfade_cbuf,
                             void *buffer_cbuf);
 
+/* Crossfade in the time-domain over the filter length, from the output in
+   'from_cbuf' to the output in 'to_cbuf', which gets the result. */
+void
+convolver_crossfade_time(void *from_cbuf,
+                         void *to_cbuf);
+
 /* Convolution in the frequency-domain, with the result added to the output. */
 void
 convolver_convolve_add(void *input_cbuf,
 		       void *coeffs,
 		       void *output_cbuf);
 
+/* Sum of the convolutions of several input buffers with the corresponding
+   coefficients, written to the output. Gives the same result as
+   convolver_convolve() on the first pair followed by convolver_convolve_add()
+   on the others, but passes over the output only once. If 'bands' is not NULL
+   it has the band of each coefficient set (see convolver_band_limit()), and
+   only those parts are processed. The coefficients are stored with the given
+   BF_COEFF_COMPRESSION_* format. If 'double_accumulation' is set, float data
+   is summed in double precision. */
+void
+convolver_convolve_sum(void *input_cbufs[],
+                       void *coeffs[],
+                       int *bands[],
+                       int n_pairs,
+                       void *output_cbuf,
+                       int compression,
+                       bool_t double_accumulation);
+
+/* Make convolver_convolve_sum() ready for sums of up to 'max_pairs' pairs
+   of compressed coefficients, by default it takes as many pairs as there are
+   blocks. Must be called in the process which does the sums. */
+void
+convolver_sum_init(int max_pairs);
+
+/* Bin-major ("interleaved") storage of 'n_parts' partitions: the spectrum is
+   divided into tiles, and the same tile of all partitions is stored next to
+   each other. The buffer is 'n_parts' times the cbufsize. This function copies
+   'cbuf' into partition 'index' of the interleaved buffer. */
+void
+convolver_interleave(void *cbuf,
+                     void *interleaved_buf,
+                     int n_parts,
+                     int index);
+
+/* As convolver_convolve_sum(), but the input buffers and coefficients are
+   given as partition indexes in interleaved buffers (see above). */
+void
+convolver_convolve_sum_interleaved(void *input_buf,
+                                   int input_indexes[],
+                                   void *coeffs_buf,
+                                   int coeffs_indexes[],
+                                   int *bands[],
+                                   int n_pairs,
+                                   int n_parts,
+                                   void *output_cbuf,
+                                   bool_t double_accumulation);
+
+/* The outputs of a matrix: output 'o' is the sum of the convolutions of the
+   'n_parts' input partitions with the coefficients coeffs[o * n_parts + p]
+   (with bands[o * n_parts + p] as in convolver_convolve_sum(), if 'bands'
+   is not NULL). NULL input partitions and coefficients are skipped. It is
+   done one tile of the spectrum at a time for all outputs, so the input
+   partitions are read from memory once per tile rather than once per
+   output. Needs convolver_sum_init() for 'n_parts' pairs. */
+void
+convolver_convolve_matrix(void *input_cbufs[],
+                          void *coeffs[],
+                          int *bands[],
+                          int n_parts,
+                          int n_outputs,
+                          void *output_cbufs[],
+                          int compression,
+                          bool_t double_accumulation);
+
 /* Convolve with dirac pulse. */
 void
 convolver_dirac_convolve(void *input_cbuf,
@@ -70,11 +143,66 @@ convolver_dirac_convolve(void *input_cbuf,
 void
 convolver_dirac_convolve_inplace(void *cbuf);
 
+/* With float_bits 64 filters may be convolved in float (see the 'float_bits'
+   filter field), with their partitions and coefficients stored as float.
+   This sets the size of the reals which the functions from
+   convolver_convolve_inplace() to the ones above multiply, and which
+   convolver_widen_coeffs() returns, until it is called again. All other
+   functions use the size given to convolver_init(). */
+void
+convolver_filter_realsize(int realsize);
+
+/* Convert a cbuf from one size of reals to another, for the input and output
+   spectra of filters convolved in float. It may be done in-place. */
+void
+convolver_convert_cbuf(void *input_cbuf,
+                       int input_realsize,
+                       void *output_cbuf,
+                       int output_realsize);
+
 /* Transform from frequency-domain to time-domain. */
 void
 convolver_freq2time(void *input_cbuf,
 		    void *output_cbuf);
 
+/* Re-create the FFTW plans to use the number of threads given by the
+   'fft_threads' setting. FFTW's threads do not survive fork(), so this must
+   be done in the process which executes the plans. */
+void
+convolver_fft_threads_init(void);
+
+/* Create a plan for transforming 'n_bufs' buffers in one go, which are laid
+   out 'input_distance' and 'output_distance' bytes apart. Returns NULL if
+   FFTW cannot make the plan, or if the built-in FFT is used for the size. */
+void *
+convolver_batch_fftplan(int n_bufs,
+                        int input_distance,
+                        int output_distance,
+                        bool_t invert);
+
+/* Batched transforms with a plan from convolver_batch_fftplan(), the buffers
+   given are the first of each set. */
+void
+convolver_time2freq_batch(void *plan,
+                          void *input_cbufs,
+                          void *output_cbufs);
+void
+convolver_freq2time_batch(void *plan,
+                          void *input_cbufs,
+                          void *output_cbufs);
+
+/* Convolution in the time-domain with a short coefficient set of 'n_taps',
+   which starts 'delay' samples in. The delay plus the number of taps must not
+   exceed the filter length. The input cbuf has the previous and the current
+   block of samples, as given by convolver_raw2cbuf(), and the output is the
+   current block. A single tap is done as a scaled copy. */
+void
+convolver_direct_convolve(void *input_cbuf,
+                          void *coeffs,
+                          int n_taps,
+                          int delay,
+                          void *output_cbuf);
+
 /* Evaluate convolution output by transforming it back to time-domain, do
    overlap-save and transform back to frequency-domain again. Used when filters
    are put in series. The 'buffer_cbuf' must be 1.5 times the cbufsize and must
@@ -99,6 +227,45 @@ convolver_cbuf2raw(void *cbuf,
 int
 convolver_cbufsize(void);
 
+/* As above, with reals of the given size. */
+int
+convolver_realsize_cbufsize(int realsize);
+
+/* Return the size of a coefficient partition stored with the given
+   BF_COEFF_COMPRESSION_* format. */
+int
+convolver_compressed_cbufsize(int compression);
+
+/* Compress a coefficient partition in the internal format into 'dest'. The
+   energy of the coefficients and of the error caused by the compression are
+   added to 'signal_energy' and 'error_energy'. */
+void
+convolver_compress_coeffs(void *cbuf,
+                          void *dest,
+                          int compression,
+                          double *signal_energy,
+                          double *error_energy);
+
+/* Return the sum of squares of the spectrum in a cbuf. */
+double
+convolver_cbuf_energy(void *cbuf);
+
+/* Find the band of a coefficient partition which has significant energy, as
+   the first and last + 1 block of 8 reals. Blocks are trimmed off the edges of
+   the spectrum as long as their sum of energy is at most 'max_energy', and
+   are cleared. Returns the part of the spectrum which is within the band. */
+double
+convolver_band_limit(void *cbuf,
+                     double max_energy,
+                     int band[2]);
+
+/* Return a coefficient partition in the precision set by
+   convolver_filter_realsize(). Compressed coefficients are widened into an
+   internal buffer, which is valid until the next call. */
+void *
+convolver_widen_coeffs(void *coeffs,
+                       int compression);
+
 /* Convert a set of coefficients to the convolver's internal frequency domain
    format. */
 void *
@@ -112,6 +279,17 @@ void
 convolver_runtime_coeffs2cbuf(void *src,
                               void *dest);
 
+/* Convolve two sets of (time-domain) coefficients with each other, each set
+   scaled by its own factor. The result has n_coeffs_a + n_coeffs_b - 1
+   coefficients and is returned in a new buffer. */
+void *
+convolver_combine_coeffs(void *coeffs_a,
+                         int n_coeffs_a,
+                         double scale_a,
+                         void *coeffs_b,
+                         int n_coeffs_b,
+                         double scale_b);
+
 
 /* Make a quick sanity check */
 bool_t
@@ -125,12 +303,22 @@ convolver_debug_dump_cbuf(const char filename[],
                           void *cbufs[],
                           int n_cbufs);
 
-/* Get a plan for the FFT lib used. Do not free it. */
+/* Get a plan for a real transform of 2^order samples, to and from FFTW's
+   halfcomplex format without normalisation. It is made by the FFTW or the
+   built-in FFT backend, as decided by the 'fft_backend' setting. Do not free
+   it. */
 void *
 convolver_fftplan(int order,
                   int invert,
                   int inplace);
 
+/* Execute a plan from convolver_fftplan(). A plan may be executed by several
+   threads at once. */
+void
+convolver_fft_execute(void *plan,
+                      void *input,
+                      void *output);
+
 
 typedef struct _td_conv_t_ td_conv_t;
 
@@ -145,6 +333,86 @@ void
 convolver_td_convolve(td_conv_t *tdc,
                       void *overlap_block);
 
+/* Non-uniform partitioning. Only the first blocks (the head) of a filter are
+   convolved with the functions above, the rest (the tail) is convolved with
+   progressively longer partitions by convolver_nu_convolve(). */
+typedef struct _nu_coeffs_t_ nu_coeffs_t;
+typedef struct _nu_conv_t_ nu_conv_t;
+
+/* Set up the partitioning for filters of 'n_blocks' blocks, non-uniform if
+   'nonuniform', with tail partitions no longer than 'max_partition_length'
+   samples (0 means no limit). Must be called after convolver_init(). */
+void
+convolver_nu_init(int n_blocks,
+                  bool_t nonuniform,
+                  int max_partition_length);
+
+/* Number of blocks in the head, equals the filter's number of blocks if
+   uniform partitioning is used. */
+int
+convolver_nu_head_blocks(void);
+
+/* Create tail coefficients from a complete set of cbufs. Returns NULL if the
+   coefficient set fits within the head. */
+nu_coeffs_t *
+convolver_nu_coeffs(void *cbufs[],
+                    int n_cbufs);
+
+/* Create tail convolution state for a filter, or an output of a matrix,
+   which sums the tails of 'n_inputs' inputs (1 for a filter, 0 for state
+   only used as an input of others). NULL if there is no tail. */
+nu_conv_t *
+convolver_nu_new(int n_inputs);
+
+/* The time-domain block of an input spectrum, for filters whose spectrum is
+   modified by logic modules before it is convolved. It is kept until the
+   next call to convolver_nu_convolve(). */
+void *
+convolver_nu_cbuf2time(nu_conv_t *nuc,
+                       void *input_cbuf);
+
+/* Called once per block, with the time-domain input block of the filter
+   ('input' is NULL if it is zero), which is delayed 'delay' blocks as the
+   head input. Returns the time-domain tail output for the block, to be added
+   to the valid part of the head output, or NULL if it is zero. It is kept
+   until the next call. */
+void *
+convolver_nu_convolve(nu_conv_t *nuc,
+                      void *input,
+                      int delay,
+                      nu_coeffs_t *coeffs);
+
+/* convolver_nu_convolve() in two steps, for matrices where each input is
+   convolved with a coefficient set for each output: convolver_nu_input()
+   takes the input block of 'nuc' and transforms it, and convolver_nu_sum()
+   sums the tails of 'n_inputs' such inputs, each with its coefficients
+   (NULL if none), to the output of 'nuc', which is returned as by
+   convolver_nu_convolve(). Each is called once per block, the inputs before
+   the sums. */
+void
+convolver_nu_input(nu_conv_t *nuc,
+                   void *input,
+                   int delay);
+
+void *
+convolver_nu_sum(nu_conv_t *nuc,
+                 nu_conv_t *inputs[],
+                 nu_coeffs_t *coeffs[],
+                 int n_inputs);
+
+/* Add the last tail output of convolver_nu_convolve() or convolver_nu_sum()
+   to 'output_cbuf' (or write it, if 'output_is_zero'), for filters whose
+   output must stay in the frequency domain. */
+void
+convolver_nu_add(nu_conv_t *nuc,
+                 void *output_cbuf,
+                 bool_t output_is_zero);
+
+/* Save the FFTW wisdom to the file given to convolver_init(). Planned wisdom
+   loaded at init is not overwritten. */
+void
+convolver_save_wisdom(void);
+
 /* Initialise convolver. Some convolvers may ignore 'config_filename' */
 bool_t
 convolver_init(const char config_filename[],
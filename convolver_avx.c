@@ -0,0 +1,852 @@
+/*
+ * (c) Copyright 2026 -- Anders Torger
+ *
+ * This program is open source. For license terms, see the LICENSE file.
+ *
+ */
+#include "asmprot.h"
+
+#include <immintrin.h>
+
+/*
+ * AVX2/FMA versions of the frequency domain functions. The internal format
+ * is blocks of 8 reals, 4 real parts followed by 4 imaginary parts, except
+ * for the first block where the first imaginary part is replaced with the
+ * (real) nyquist frequency. The 'loop_counter' is the number of blocks.
+ *
+ * This file must be compiled with -mavx2 -mfma -mf16c, and the functions may
+ * only be called if the processor supports it.
+ */
+
+static inline __m256
+cmul_addf(__m256 b,
+          __m256 c,
+          __m256 d)
+{
+    const __m256 sign = _mm256_set_ps(0.0, 0.0, 0.0, 0.0,
+                                      -0.0, -0.0, -0.0, -0.0);
+    __m256 bswap, cre, cim;
+
+    /* [re, im] * [cre, cim] = [re, im] * [cre, cre] + [im, re] * [-cim, cim] */
+    bswap = _mm256_permute2f128_ps(b, b, 0x01);
+    cre = _mm256_permute2f128_ps(c, c, 0x00);
+    cim = _mm256_xor_ps(_mm256_permute2f128_ps(c, c, 0x11), sign);
+    return _mm256_fmadd_ps(b, cre, _mm256_fmadd_ps(bswap, cim, d));
+}
+
+void
+convolver_avx_convolve_addf(void *input_cbuf,
+                            void *coeffs,
+                            void *output_cbuf,
+                            int loop_counter)
+{
+    float *b = (float *)input_cbuf;
+    float *c = (float *)coeffs;
+    float *d = (float *)output_cbuf;
+    float d1s, d2s;
+    int n;
+
+    d1s = d[0] + b[0] * c[0];
+    d2s = d[4] + b[4] * c[4];
+    for (n = 0; n < loop_counter << 3; n += 8) {
+        _mm256_storeu_ps(&d[n], cmul_addf(_mm256_loadu_ps(&b[n]),
+                                          _mm256_loadu_ps(&c[n]),
+                                          _mm256_loadu_ps(&d[n])));
+    }
+    d[0] = d1s;
+    d[4] = d2s;
+}
+
+void
+convolver_avx_convolvef(void *input_cbuf,
+                        void *coeffs,
+                        void *output_cbuf,
+                        int loop_counter)
+{
+    float *b = (float *)input_cbuf;
+    float *c = (float *)coeffs;
+    float *d = (float *)output_cbuf;
+    float d1s, d2s;
+    int n;
+
+    /* input_cbuf may be the same as output_cbuf */
+    d1s = b[0] * c[0];
+    d2s = b[4] * c[4];
+    for (n = 0; n < loop_counter << 3; n += 8) {
+        _mm256_storeu_ps(&d[n], cmul_addf(_mm256_loadu_ps(&b[n]),
+                                          _mm256_loadu_ps(&c[n]),
+                                          _mm256_setzero_ps()));
+    }
+    d[0] = d1s;
+    d[4] = d2s;
+}
+
+/*
+ * Sum of the products of several input buffers and coefficients. Four blocks
+ * are kept in registers while looping over all pairs, so the output is only
+ * written once.
+ */
+void
+convolver_avx_convolve_sumf(void *input_cbufs[],
+                            void *coeffs[],
+                            int n_pairs,
+                            void *output_cbuf,
+                            int loop_counter)
+{
+    float **b = (float **)input_cbufs;
+    float **c = (float **)coeffs;
+    float *d = (float *)output_cbuf;
+    __m256 d0, d1, d2, d3;
+    float d1s, d2s;
+    int n, p;
+
+    d1s = d2s = 0;
+    for (p = 0; p < n_pairs; p++) {
+        d1s += b[p][0] * c[p][0];
+        d2s += b[p][4] * c[p][4];
+    }
+    for (n = 0; n < (loop_counter & ~3) << 3; n += 32) {
+        d0 = d1 = d2 = d3 = _mm256_setzero_ps();
+        for (p = 0; p < n_pairs; p++) {
+            d0 = cmul_addf(_mm256_loadu_ps(&b[p][n+0]),
+                           _mm256_loadu_ps(&c[p][n+0]), d0);
+            d1 = cmul_addf(_mm256_loadu_ps(&b[p][n+8]),
+                           _mm256_loadu_ps(&c[p][n+8]), d1);
+            d2 = cmul_addf(_mm256_loadu_ps(&b[p][n+16]),
+                           _mm256_loadu_ps(&c[p][n+16]), d2);
+            d3 = cmul_addf(_mm256_loadu_ps(&b[p][n+24]),
+                           _mm256_loadu_ps(&c[p][n+24]), d3);
+        }
+        _mm256_storeu_ps(&d[n+0], d0);
+        _mm256_storeu_ps(&d[n+8], d1);
+        _mm256_storeu_ps(&d[n+16], d2);
+        _mm256_storeu_ps(&d[n+24], d3);
+    }
+    for (; n < loop_counter << 3; n += 8) {
+        d0 = _mm256_setzero_ps();
+        for (p = 0; p < n_pairs; p++) {
+            d0 = cmul_addf(_mm256_loadu_ps(&b[p][n]),
+                           _mm256_loadu_ps(&c[p][n]), d0);
+        }
+        _mm256_storeu_ps(&d[n], d0);
+    }
+    d[0] = d1s;
+    d[4] = d2s;
+}
+
+void
+convolver_avx_dirac_convolvef(void *input_cbuf,
+                              void *output_cbuf,
+                              double fraction,
+                              int loop_counter)
+{
+    const __m256 f = _mm256_set_ps(-fraction, fraction, -fraction, fraction,
+                                   -fraction, fraction, -fraction, fraction);
+    float *b = (float *)input_cbuf;
+    float *d = (float *)output_cbuf;
+    int n;
+
+    for (n = 0; n < loop_counter << 3; n += 8) {
+        _mm256_storeu_ps(&d[n], _mm256_mul_ps(_mm256_loadu_ps(&b[n]), f));
+    }
+}
+
+void
+convolver_avx_convolve_addd(void *input_cbuf,
+                            void *coeffs,
+                            void *output_cbuf,
+                            int loop_counter)
+{
+    double *b = (double *)input_cbuf;
+    double *c = (double *)coeffs;
+    double *d = (double *)output_cbuf;
+    __m256d bre, bim, cre, cim;
+    double d1s, d2s;
+    int n;
+
+    d1s = d[0] + b[0] * c[0];
+    d2s = d[4] + b[4] * c[4];
+    for (n = 0; n < loop_counter << 3; n += 8) {
+        bre = _mm256_loadu_pd(&b[n+0]);
+        bim = _mm256_loadu_pd(&b[n+4]);
+        cre = _mm256_loadu_pd(&c[n+0]);
+        cim = _mm256_loadu_pd(&c[n+4]);
+        _mm256_storeu_pd(&d[n+0],
+                         _mm256_fnmadd_pd(bim, cim,
+                                          _mm256_fmadd_pd(bre, cre,
+                                                          _mm256_loadu_pd
+                                                          (&d[n+0]))));
+        _mm256_storeu_pd(&d[n+4],
+                         _mm256_fmadd_pd(bim, cre,
+                                         _mm256_fmadd_pd(bre, cim,
+                                                         _mm256_loadu_pd
+                                                         (&d[n+4]))));
+    }
+    d[0] = d1s;
+    d[4] = d2s;
+}
+
+void
+convolver_avx_convolved(void *input_cbuf,
+                        void *coeffs,
+                        void *output_cbuf,
+                        int loop_counter)
+{
+    double *b = (double *)input_cbuf;
+    double *c = (double *)coeffs;
+    double *d = (double *)output_cbuf;
+    __m256d bre, bim, cre, cim;
+    double d1s, d2s;
+    int n;
+
+    /* input_cbuf may be the same as output_cbuf */
+    d1s = b[0] * c[0];
+    d2s = b[4] * c[4];
+    for (n = 0; n < loop_counter << 3; n += 8) {
+        bre = _mm256_loadu_pd(&b[n+0]);
+        bim = _mm256_loadu_pd(&b[n+4]);
+        cre = _mm256_loadu_pd(&c[n+0]);
+        cim = _mm256_loadu_pd(&c[n+4]);
+        _mm256_storeu_pd(&d[n+0],
+                         _mm256_fmsub_pd(bre, cre, _mm256_mul_pd(bim, cim)));
+        _mm256_storeu_pd(&d[n+4],
+                         _mm256_fmadd_pd(bre, cim, _mm256_mul_pd(bim, cre)));
+    }
+    d[0] = d1s;
+    d[4] = d2s;
+}
+
+void
+convolver_avx_convolve_sumd(void *input_cbufs[],
+                            void *coeffs[],
+                            int n_pairs,
+                            void *output_cbuf,
+                            int loop_counter)
+{
+    double **b = (double **)input_cbufs;
+    double **c = (double **)coeffs;
+    double *d = (double *)output_cbuf;
+    __m256d bre, bim, cre, cim, re0, im0, re1, im1;
+    double d1s, d2s;
+    int n, p;
+
+    d1s = d2s = 0;
+    for (p = 0; p < n_pairs; p++) {
+        d1s += b[p][0] * c[p][0];
+        d2s += b[p][4] * c[p][4];
+    }
+    for (n = 0; n < (loop_counter & ~1) << 3; n += 16) {
+        re0 = im0 = re1 = im1 = _mm256_setzero_pd();
+        for (p = 0; p < n_pairs; p++) {
+            bre = _mm256_loadu_pd(&b[p][n+0]);
+            bim = _mm256_loadu_pd(&b[p][n+4]);
+            cre = _mm256_loadu_pd(&c[p][n+0]);
+            cim = _mm256_loadu_pd(&c[p][n+4]);
+            re0 = _mm256_fnmadd_pd(bim, cim, _mm256_fmadd_pd(bre, cre, re0));
+            im0 = _mm256_fmadd_pd(bim, cre, _mm256_fmadd_pd(bre, cim, im0));
+            bre = _mm256_loadu_pd(&b[p][n+8]);
+            bim = _mm256_loadu_pd(&b[p][n+12]);
+            cre = _mm256_loadu_pd(&c[p][n+8]);
+            cim = _mm256_loadu_pd(&c[p][n+12]);
+            re1 = _mm256_fnmadd_pd(bim, cim, _mm256_fmadd_pd(bre, cre, re1));
+            im1 = _mm256_fmadd_pd(bim, cre, _mm256_fmadd_pd(bre, cim, im1));
+        }
+        _mm256_storeu_pd(&d[n+0], re0);
+        _mm256_storeu_pd(&d[n+4], im0);
+        _mm256_storeu_pd(&d[n+8], re1);
+        _mm256_storeu_pd(&d[n+12], im1);
+    }
+    if ((loop_counter & 1) != 0) {
+        re0 = im0 = _mm256_setzero_pd();
+        for (p = 0; p < n_pairs; p++) {
+            bre = _mm256_loadu_pd(&b[p][n+0]);
+            bim = _mm256_loadu_pd(&b[p][n+4]);
+            cre = _mm256_loadu_pd(&c[p][n+0]);
+            cim = _mm256_loadu_pd(&c[p][n+4]);
+            re0 = _mm256_fnmadd_pd(bim, cim, _mm256_fmadd_pd(bre, cre, re0));
+            im0 = _mm256_fmadd_pd(bim, cre, _mm256_fmadd_pd(bre, cim, im0));
+        }
+        _mm256_storeu_pd(&d[n+0], re0);
+        _mm256_storeu_pd(&d[n+4], im0);
+    }
+    d[0] = d1s;
+    d[4] = d2s;
+}
+
+void
+convolver_avx_dirac_convolved(void *input_cbuf,
+                              void *output_cbuf,
+                              double fraction,
+                              int loop_counter)
+{
+    const __m256d f = _mm256_set_pd(-fraction, fraction, -fraction, fraction);
+    double *b = (double *)input_cbuf;
+    double *d = (double *)output_cbuf;
+    int n;
+
+    for (n = 0; n < loop_counter << 3; n += 4) {
+        _mm256_storeu_pd(&d[n], _mm256_mul_pd(_mm256_loadu_pd(&b[n]), f));
+    }
+}
+
+/*
+ * Mix and scale. Input mode reorders from FFTW's halfcomplex format to the
+ * internal format, output mode does the opposite. The first two blocks
+ * (float) or the first block (double) contain the special case elements
+ * and are done in plain C, so 'loop_counter' must be at least 2.
+ */
+
+void
+convolver_avx_mixnscale_inputf(void *input_cbufs[],
+                               void *output_cbuf,
+                               double scales[],
+                               int n_bufs,
+                               int loop_counter)
+{
+    const __m256i reverse = _mm256_set_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+    int n_fft = loop_counter << 3;
+    float **ibufs = (float **)input_cbufs;
+    float *obuf = (float *)output_cbuf;
+    __m256 re, im, s;
+    int n, i;
+    float sscales[n_bufs];
+
+    for (i = 0; i < n_bufs; i++) {
+        sscales[i] = (float)scales[i];
+    }
+
+    for (n = 0; n < 8; n++) {
+        obuf[(n & ~3) * 2 + (n & 3)] = 0;
+        obuf[(n & ~3) * 2 + (n & 3) + 4] = 0;
+        for (i = 0; i < n_bufs; i++) {
+            obuf[(n & ~3) * 2 + (n & 3)] += ibufs[i][n] * sscales[i];
+            obuf[(n & ~3) * 2 + (n & 3) + 4] +=
+                ibufs[i][n == 0 ? n_fft >> 1 : n_fft - n] * sscales[i];
+        }
+    }
+    for (n = 8; n < n_fft >> 1; n += 8) {
+        re = _mm256_setzero_ps();
+        im = _mm256_setzero_ps();
+        for (i = 0; i < n_bufs; i++) {
+            s = _mm256_set1_ps(sscales[i]);
+            re = _mm256_fmadd_ps(_mm256_loadu_ps(&ibufs[i][n]), s, re);
+            im = _mm256_fmadd_ps(_mm256_loadu_ps(&ibufs[i][n_fft - n - 7]),
+                                 s, im);
+        }
+        im = _mm256_permutevar8x32_ps(im, reverse);
+        _mm256_storeu_ps(&obuf[(n<<1)+0], _mm256_permute2f128_ps(re, im, 0x20));
+        _mm256_storeu_ps(&obuf[(n<<1)+8], _mm256_permute2f128_ps(re, im, 0x31));
+    }
+}
+
+void
+convolver_avx_mixnscale_outputf(void *input_cbufs[],
+                                void *output_cbuf,
+                                double scales[],
+                                int n_bufs,
+                                int loop_counter)
+{
+    const __m256i reverse = _mm256_set_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+    int n_fft = loop_counter << 3;
+    float **ibufs = (float **)input_cbufs;
+    float *obuf = (float *)output_cbuf;
+    __m256 x0, x1, re, im, s;
+    int n, i;
+    float sscales[n_bufs];
+
+    for (i = 0; i < n_bufs; i++) {
+        sscales[i] = (float)scales[i];
+    }
+
+    for (n = 0; n < 8; n++) {
+        obuf[n] = 0;
+        obuf[n == 0 ? n_fft >> 1 : n_fft - n] = 0;
+        for (i = 0; i < n_bufs; i++) {
+            obuf[n] += ibufs[i][(n & ~3) * 2 + (n & 3)] * sscales[i];
+            obuf[n == 0 ? n_fft >> 1 : n_fft - n] +=
+                ibufs[i][(n & ~3) * 2 + (n & 3) + 4] * sscales[i];
+        }
+    }
+    for (n = 8; n < n_fft >> 1; n += 8) {
+        re = _mm256_setzero_ps();
+        im = _mm256_setzero_ps();
+        for (i = 0; i < n_bufs; i++) {
+            s = _mm256_set1_ps(sscales[i]);
+            x0 = _mm256_loadu_ps(&ibufs[i][(n<<1)+0]);
+            x1 = _mm256_loadu_ps(&ibufs[i][(n<<1)+8]);
+            re = _mm256_fmadd_ps(_mm256_permute2f128_ps(x0, x1, 0x20), s, re);
+            im = _mm256_fmadd_ps(_mm256_permute2f128_ps(x0, x1, 0x31), s, im);
+        }
+        _mm256_storeu_ps(&obuf[n], re);
+        _mm256_storeu_ps(&obuf[n_fft - n - 7],
+                         _mm256_permutevar8x32_ps(im, reverse));
+    }
+}
+
+void
+convolver_avx_mixnscale_inputd(void *input_cbufs[],
+                               void *output_cbuf,
+                               double scales[],
+                               int n_bufs,
+                               int loop_counter)
+{
+    int n_fft = loop_counter << 3;
+    double **ibufs = (double **)input_cbufs;
+    double *obuf = (double *)output_cbuf;
+    __m256d re, im, s;
+    int n, i;
+
+    for (n = 0; n < 4; n++) {
+        obuf[n] = 0;
+        obuf[n + 4] = 0;
+        for (i = 0; i < n_bufs; i++) {
+            obuf[n] += ibufs[i][n] * scales[i];
+            obuf[n + 4] += ibufs[i][n == 0 ? n_fft >> 1 : n_fft - n] *
+                scales[i];
+        }
+    }
+    for (n = 4; n < n_fft >> 1; n += 4) {
+        re = _mm256_setzero_pd();
+        im = _mm256_setzero_pd();
+        for (i = 0; i < n_bufs; i++) {
+            s = _mm256_set1_pd(scales[i]);
+            re = _mm256_fmadd_pd(_mm256_loadu_pd(&ibufs[i][n]), s, re);
+            im = _mm256_fmadd_pd(_mm256_loadu_pd(&ibufs[i][n_fft - n - 3]),
+                                 s, im);
+        }
+        _mm256_storeu_pd(&obuf[(n<<1)+0], re);
+        _mm256_storeu_pd(&obuf[(n<<1)+4], _mm256_permute4x64_pd(im, 0x1B));
+    }
+}
+
+void
+convolver_avx_mixnscale_outputd(void *input_cbufs[],
+                                void *output_cbuf,
+                                double scales[],
+                                int n_bufs,
+                                int loop_counter)
+{
+    int n_fft = loop_counter << 3;
+    double **ibufs = (double **)input_cbufs;
+    double *obuf = (double *)output_cbuf;
+    __m256d re, im, s;
+    int n, i;
+
+    for (n = 0; n < 4; n++) {
+        obuf[n] = 0;
+        obuf[n == 0 ? n_fft >> 1 : n_fft - n] = 0;
+        for (i = 0; i < n_bufs; i++) {
+            obuf[n] += ibufs[i][n] * scales[i];
+            obuf[n == 0 ? n_fft >> 1 : n_fft - n] += ibufs[i][n + 4] *
+                scales[i];
+        }
+    }
+    for (n = 4; n < n_fft >> 1; n += 4) {
+        re = _mm256_setzero_pd();
+        im = _mm256_setzero_pd();
+        for (i = 0; i < n_bufs; i++) {
+            s = _mm256_set1_pd(scales[i]);
+            re = _mm256_fmadd_pd(_mm256_loadu_pd(&ibufs[i][(n<<1)+0]), s, re);
+            im = _mm256_fmadd_pd(_mm256_loadu_pd(&ibufs[i][(n<<1)+4]), s, im);
+        }
+        _mm256_storeu_pd(&obuf[n], re);
+        _mm256_storeu_pd(&obuf[n_fft - n - 3],
+                         _mm256_permute4x64_pd(im, 0x1B));
+    }
+}
+
+/*
+ * Versions for the complex layout, where the real and imaginary parts are
+ * interleaved and there is no special case for DC and nyquist.
+ */
+
+static inline __m256
+ccmul_addf(__m256 b,
+           __m256 c,
+           __m256 d)
+{
+    const __m256 sign = _mm256_set_ps(0.0, -0.0, 0.0, -0.0,
+                                      0.0, -0.0, 0.0, -0.0);
+    __m256 bswap, cre, cim;
+
+    /* [re, im] * [cre, cim] = [re, im] * [cre, cre] + [im, re] * [-cim, cim] */
+    bswap = _mm256_permute_ps(b, 0xB1);
+    cre = _mm256_moveldup_ps(c);
+    cim = _mm256_xor_ps(_mm256_movehdup_ps(c), sign);
+    return _mm256_fmadd_ps(b, cre, _mm256_fmadd_ps(bswap, cim, d));
+}
+
+static inline __m256d
+ccmul_addd(__m256d b,
+           __m256d c,
+           __m256d d)
+{
+    const __m256d sign = _mm256_set_pd(0.0, -0.0, 0.0, -0.0);
+    __m256d bswap, cre, cim;
+
+    bswap = _mm256_permute_pd(b, 0x5);
+    cre = _mm256_movedup_pd(c);
+    cim = _mm256_xor_pd(_mm256_permute_pd(c, 0xF), sign);
+    return _mm256_fmadd_pd(b, cre, _mm256_fmadd_pd(bswap, cim, d));
+}
+
+void
+convolver_avx_complex_convolve_addf(void *input_cbuf,
+                                    void *coeffs,
+                                    void *output_cbuf,
+                                    int loop_counter)
+{
+    float *b = (float *)input_cbuf;
+    float *c = (float *)coeffs;
+    float *d = (float *)output_cbuf;
+    int n;
+
+    for (n = 0; n < loop_counter << 3; n += 8) {
+        _mm256_storeu_ps(&d[n], ccmul_addf(_mm256_loadu_ps(&b[n]),
+                                           _mm256_loadu_ps(&c[n]),
+                                           _mm256_loadu_ps(&d[n])));
+    }
+}
+
+void
+convolver_avx_complex_convolvef(void *input_cbuf,
+                                void *coeffs,
+                                void *output_cbuf,
+                                int loop_counter)
+{
+    float *b = (float *)input_cbuf;
+    float *c = (float *)coeffs;
+    float *d = (float *)output_cbuf;
+    int n;
+
+    /* input_cbuf may be the same as output_cbuf */
+    for (n = 0; n < loop_counter << 3; n += 8) {
+        _mm256_storeu_ps(&d[n], ccmul_addf(_mm256_loadu_ps(&b[n]),
+                                           _mm256_loadu_ps(&c[n]),
+                                           _mm256_setzero_ps()));
+    }
+}
+
+void
+convolver_avx_complex_convolve_sumf(void *input_cbufs[],
+                                    void *coeffs[],
+                                    int n_pairs,
+                                    void *output_cbuf,
+                                    int loop_counter)
+{
+    float **b = (float **)input_cbufs;
+    float **c = (float **)coeffs;
+    float *d = (float *)output_cbuf;
+    __m256 d0, d1, d2, d3;
+    int n, p;
+
+    for (n = 0; n < (loop_counter & ~3) << 3; n += 32) {
+        d0 = d1 = d2 = d3 = _mm256_setzero_ps();
+        for (p = 0; p < n_pairs; p++) {
+            d0 = ccmul_addf(_mm256_loadu_ps(&b[p][n+0]),
+                            _mm256_loadu_ps(&c[p][n+0]), d0);
+            d1 = ccmul_addf(_mm256_loadu_ps(&b[p][n+8]),
+                            _mm256_loadu_ps(&c[p][n+8]), d1);
+            d2 = ccmul_addf(_mm256_loadu_ps(&b[p][n+16]),
+                            _mm256_loadu_ps(&c[p][n+16]), d2);
+            d3 = ccmul_addf(_mm256_loadu_ps(&b[p][n+24]),
+                            _mm256_loadu_ps(&c[p][n+24]), d3);
+        }
+        _mm256_storeu_ps(&d[n+0], d0);
+        _mm256_storeu_ps(&d[n+8], d1);
+        _mm256_storeu_ps(&d[n+16], d2);
+        _mm256_storeu_ps(&d[n+24], d3);
+    }
+    for (; n < loop_counter << 3; n += 8) {
+        d0 = _mm256_setzero_ps();
+        for (p = 0; p < n_pairs; p++) {
+            d0 = ccmul_addf(_mm256_loadu_ps(&b[p][n]),
+                            _mm256_loadu_ps(&c[p][n]), d0);
+        }
+        _mm256_storeu_ps(&d[n], d0);
+    }
+}
+
+void
+convolver_avx_complex_convolve_addd(void *input_cbuf,
+                                    void *coeffs,
+                                    void *output_cbuf,
+                                    int loop_counter)
+{
+    double *b = (double *)input_cbuf;
+    double *c = (double *)coeffs;
+    double *d = (double *)output_cbuf;
+    int n;
+
+    for (n = 0; n < loop_counter << 3; n += 4) {
+        _mm256_storeu_pd(&d[n], ccmul_addd(_mm256_loadu_pd(&b[n]),
+                                           _mm256_loadu_pd(&c[n]),
+                                           _mm256_loadu_pd(&d[n])));
+    }
+}
+
+void
+convolver_avx_complex_convolved(void *input_cbuf,
+                                void *coeffs,
+                                void *output_cbuf,
+                                int loop_counter)
+{
+    double *b = (double *)input_cbuf;
+    double *c = (double *)coeffs;
+    double *d = (double *)output_cbuf;
+    int n;
+
+    /* input_cbuf may be the same as output_cbuf */
+    for (n = 0; n < loop_counter << 3; n += 4) {
+        _mm256_storeu_pd(&d[n], ccmul_addd(_mm256_loadu_pd(&b[n]),
+                                           _mm256_loadu_pd(&c[n]),
+                                           _mm256_setzero_pd()));
+    }
+}
+
+void
+convolver_avx_complex_convolve_sumd(void *input_cbufs[],
+                                    void *coeffs[],
+                                    int n_pairs,
+                                    void *output_cbuf,
+                                    int loop_counter)
+{
+    double **b = (double **)input_cbufs;
+    double **c = (double **)coeffs;
+    double *d = (double *)output_cbuf;
+    __m256d d0, d1, d2, d3;
+    int n, p;
+
+    for (n = 0; n < (loop_counter & ~1) << 3; n += 16) {
+        d0 = d1 = d2 = d3 = _mm256_setzero_pd();
+        for (p = 0; p < n_pairs; p++) {
+            d0 = ccmul_addd(_mm256_loadu_pd(&b[p][n+0]),
+                            _mm256_loadu_pd(&c[p][n+0]), d0);
+            d1 = ccmul_addd(_mm256_loadu_pd(&b[p][n+4]),
+                            _mm256_loadu_pd(&c[p][n+4]), d1);
+            d2 = ccmul_addd(_mm256_loadu_pd(&b[p][n+8]),
+                            _mm256_loadu_pd(&c[p][n+8]), d2);
+            d3 = ccmul_addd(_mm256_loadu_pd(&b[p][n+12]),
+                            _mm256_loadu_pd(&c[p][n+12]), d3);
+        }
+        _mm256_storeu_pd(&d[n+0], d0);
+        _mm256_storeu_pd(&d[n+4], d1);
+        _mm256_storeu_pd(&d[n+8], d2);
+        _mm256_storeu_pd(&d[n+12], d3);
+    }
+    if ((loop_counter & 1) != 0) {
+        d0 = d1 = _mm256_setzero_pd();
+        for (p = 0; p < n_pairs; p++) {
+            d0 = ccmul_addd(_mm256_loadu_pd(&b[p][n+0]),
+                            _mm256_loadu_pd(&c[p][n+0]), d0);
+            d1 = ccmul_addd(_mm256_loadu_pd(&b[p][n+4]),
+                            _mm256_loadu_pd(&c[p][n+4]), d1);
+        }
+        _mm256_storeu_pd(&d[n+0], d0);
+        _mm256_storeu_pd(&d[n+4], d1);
+    }
+}
+
+/*
+ * Float versions of the convolve sums which accumulate in double precision.
+ * Each half block of 4 floats is widened to 4 doubles when loaded.
+ */
+
+void
+convolver_avx_convolve_sum_mixedf(void *input_cbufs[],
+                                  void *coeffs[],
+                                  int n_pairs,
+                                  void *output_cbuf,
+                                  int loop_counter)
+{
+    float **b = (float **)input_cbufs;
+    float **c = (float **)coeffs;
+    float *d = (float *)output_cbuf;
+    __m256d bre, bim, cre, cim, re0, im0, re1, im1;
+    double d1s, d2s;
+    int n, p;
+
+    d1s = d2s = 0;
+    for (p = 0; p < n_pairs; p++) {
+        d1s += (double)b[p][0] * (double)c[p][0];
+        d2s += (double)b[p][4] * (double)c[p][4];
+    }
+    for (n = 0; n < (loop_counter & ~1) << 3; n += 16) {
+        re0 = im0 = re1 = im1 = _mm256_setzero_pd();
+        for (p = 0; p < n_pairs; p++) {
+            bre = _mm256_cvtps_pd(_mm_loadu_ps(&b[p][n+0]));
+            bim = _mm256_cvtps_pd(_mm_loadu_ps(&b[p][n+4]));
+            cre = _mm256_cvtps_pd(_mm_loadu_ps(&c[p][n+0]));
+            cim = _mm256_cvtps_pd(_mm_loadu_ps(&c[p][n+4]));
+            re0 = _mm256_fnmadd_pd(bim, cim, _mm256_fmadd_pd(bre, cre, re0));
+            im0 = _mm256_fmadd_pd(bim, cre, _mm256_fmadd_pd(bre, cim, im0));
+            bre = _mm256_cvtps_pd(_mm_loadu_ps(&b[p][n+8]));
+            bim = _mm256_cvtps_pd(_mm_loadu_ps(&b[p][n+12]));
+            cre = _mm256_cvtps_pd(_mm_loadu_ps(&c[p][n+8]));
+            cim = _mm256_cvtps_pd(_mm_loadu_ps(&c[p][n+12]));
+            re1 = _mm256_fnmadd_pd(bim, cim, _mm256_fmadd_pd(bre, cre, re1));
+            im1 = _mm256_fmadd_pd(bim, cre, _mm256_fmadd_pd(bre, cim, im1));
+        }
+        _mm_storeu_ps(&d[n+0], _mm256_cvtpd_ps(re0));
+        _mm_storeu_ps(&d[n+4], _mm256_cvtpd_ps(im0));
+        _mm_storeu_ps(&d[n+8], _mm256_cvtpd_ps(re1));
+        _mm_storeu_ps(&d[n+12], _mm256_cvtpd_ps(im1));
+    }
+    if ((loop_counter & 1) != 0) {
+        re0 = im0 = _mm256_setzero_pd();
+        for (p = 0; p < n_pairs; p++) {
+            bre = _mm256_cvtps_pd(_mm_loadu_ps(&b[p][n+0]));
+            bim = _mm256_cvtps_pd(_mm_loadu_ps(&b[p][n+4]));
+            cre = _mm256_cvtps_pd(_mm_loadu_ps(&c[p][n+0]));
+            cim = _mm256_cvtps_pd(_mm_loadu_ps(&c[p][n+4]));
+            re0 = _mm256_fnmadd_pd(bim, cim, _mm256_fmadd_pd(bre, cre, re0));
+            im0 = _mm256_fmadd_pd(bim, cre, _mm256_fmadd_pd(bre, cim, im0));
+        }
+        _mm_storeu_ps(&d[n+0], _mm256_cvtpd_ps(re0));
+        _mm_storeu_ps(&d[n+4], _mm256_cvtpd_ps(im0));
+    }
+    d[0] = (float)d1s;
+    d[4] = (float)d2s;
+}
+
+void
+convolver_avx_complex_convolve_sum_mixedf(void *input_cbufs[],
+                                          void *coeffs[],
+                                          int n_pairs,
+                                          void *output_cbuf,
+                                          int loop_counter)
+{
+    float **b = (float **)input_cbufs;
+    float **c = (float **)coeffs;
+    float *d = (float *)output_cbuf;
+    __m256d d0, d1;
+    int n, p;
+
+    for (n = 0; n < loop_counter << 3; n += 8) {
+        d0 = d1 = _mm256_setzero_pd();
+        for (p = 0; p < n_pairs; p++) {
+            d0 = ccmul_addd(_mm256_cvtps_pd(_mm_loadu_ps(&b[p][n+0])),
+                            _mm256_cvtps_pd(_mm_loadu_ps(&c[p][n+0])), d0);
+            d1 = ccmul_addd(_mm256_cvtps_pd(_mm_loadu_ps(&b[p][n+4])),
+                            _mm256_cvtps_pd(_mm_loadu_ps(&c[p][n+4])), d1);
+        }
+        _mm_storeu_ps(&d[n+0], _mm256_cvtpd_ps(d0));
+        _mm_storeu_ps(&d[n+4], _mm256_cvtpd_ps(d1));
+    }
+}
+
+/* the widening of compressed coefficients uses F16C, which all processors
+   with AVX2 have */
+void
+convolver_avx_widen_fp16f(void *input,
+                          void *output,
+                          double scale,
+                          int loop_counter)
+{
+    const __m256 s = _mm256_set1_ps((float)scale);
+    uint16_t *h = (uint16_t *)input;
+    float *d = (float *)output;
+    int n;
+
+    for (n = 0; n < loop_counter << 3; n += 8) {
+        _mm256_storeu_ps(&d[n], _mm256_mul_ps(_mm256_cvtph_ps(
+            _mm_loadu_si128((__m128i *)&h[n])), s));
+    }
+}
+
+void
+convolver_avx_widen_bf16f(void *input,
+                          void *output,
+                          double scale,
+                          int loop_counter)
+{
+    const __m256 s = _mm256_set1_ps((float)scale);
+    uint16_t *h = (uint16_t *)input;
+    float *d = (float *)output;
+    __m256i x;
+    int n;
+
+    for (n = 0; n < loop_counter << 3; n += 8) {
+        x = _mm256_cvtepu16_epi32(_mm_loadu_si128((__m128i *)&h[n]));
+        x = _mm256_slli_epi32(x, 16);
+        _mm256_storeu_ps(&d[n], _mm256_mul_ps(_mm256_castsi256_ps(x), s));
+    }
+}
+
+/*
+ * Time-domain convolution for the direct filters, 32 (float) or 16 (double)
+ * outputs at a time, with the rest done by the plain C loops at the end.
+ */
+void
+convolver_avx_direct_convolvef(void *input,
+                               void *coeffs,
+                               int n_taps,
+                               void *output,
+                               int n_samples)
+{
+    float *x = (float *)input;
+    float *h = (float *)coeffs;
+    float *y = (float *)output;
+    __m256 c, d0, d1, d2, d3;
+    float a;
+    int n, i;
+
+    for (n = 0; n + 32 <= n_samples; n += 32) {
+        d0 = d1 = d2 = d3 = _mm256_setzero_ps();
+        for (i = 0; i < n_taps; i++) {
+            c = _mm256_broadcast_ss(&h[i]);
+            d0 = _mm256_fmadd_ps(c, _mm256_loadu_ps(&x[n-i+0]), d0);
+            d1 = _mm256_fmadd_ps(c, _mm256_loadu_ps(&x[n-i+8]), d1);
+            d2 = _mm256_fmadd_ps(c, _mm256_loadu_ps(&x[n-i+16]), d2);
+            d3 = _mm256_fmadd_ps(c, _mm256_loadu_ps(&x[n-i+24]), d3);
+        }
+        _mm256_storeu_ps(&y[n+0], d0);
+        _mm256_storeu_ps(&y[n+8], d1);
+        _mm256_storeu_ps(&y[n+16], d2);
+        _mm256_storeu_ps(&y[n+24], d3);
+    }
+    for (; n < n_samples; n++) {
+        a = 0;
+        for (i = 0; i < n_taps; i++) {
+            a += h[i] * x[n-i];
+        }
+        y[n] = a;
+    }
+}
+
+void
+convolver_avx_direct_convolved(void *input,
+                               void *coeffs,
+                               int n_taps,
+                               void *output,
+                               int n_samples)
+{
+    double *x = (double *)input;
+    double *h = (double *)coeffs;
+    double *y = (double *)output;
+    __m256d c, d0, d1, d2, d3;
+    double a;
+    int n, i;
+
+    for (n = 0; n + 16 <= n_samples; n += 16) {
+        d0 = d1 = d2 = d3 = _mm256_setzero_pd();
+        for (i = 0; i < n_taps; i++) {
+            c = _mm256_broadcast_sd(&h[i]);
+            d0 = _mm256_fmadd_pd(c, _mm256_loadu_pd(&x[n-i+0]), d0);
+            d1 = _mm256_fmadd_pd(c, _mm256_loadu_pd(&x[n-i+4]), d1);
+            d2 = _mm256_fmadd_pd(c, _mm256_loadu_pd(&x[n-i+8]), d2);
+            d3 = _mm256_fmadd_pd(c, _mm256_loadu_pd(&x[n-i+12]), d3);
+        }
+        _mm256_storeu_pd(&y[n+0], d0);
+        _mm256_storeu_pd(&y[n+4], d1);
+        _mm256_storeu_pd(&y[n+8], d2);
+        _mm256_storeu_pd(&y[n+12], d3);
+    }
+    for (; n < n_samples; n++) {
+        a = 0;
+        for (i = 0; i < n_taps; i++) {
+            a += h[i] * x[n-i];
+        }
+        y[n] = a;
+    }
+}
@@ -0,0 +1,456 @@
+/*
+ * (c) Copyright 2026 -- Anders Torger
+ *
+ * This program is open source. For license terms, see the LICENSE file.
+ *
+ */
+#include "asmprot.h"
+
+#include <immintrin.h>
+
+/*
+ * AVX-512F versions of the frequency domain functions, same internal format
+ * as in convolver_avx.c. A float vector holds two blocks, so an odd block
+ * count is finished with a masked half vector. A double vector holds one
+ * block.
+ *
+ * This file must be compiled with -mavx512f, and the functions may only be
+ * called if the processor supports it.
+ */
+
+static inline __m512
+cmul_addf(__m512 b,
+          __m512 c,
+          __m512 d)
+{
+    const __m512i sign = _mm512_set_epi32(0, 0, 0, 0,
+                                          0x80000000, 0x80000000,
+                                          0x80000000, 0x80000000,
+                                          0, 0, 0, 0,
+                                          0x80000000, 0x80000000,
+                                          0x80000000, 0x80000000);
+    __m512 bswap, cre, cim;
+
+    /* [re, im] * [cre, cim] = [re, im] * [cre, cre] + [im, re] * [-cim, cim] */
+    bswap = _mm512_shuffle_f32x4(b, b, _MM_SHUFFLE(2, 3, 0, 1));
+    cre = _mm512_shuffle_f32x4(c, c, _MM_SHUFFLE(2, 2, 0, 0));
+    cim = _mm512_castsi512_ps
+        (_mm512_xor_si512(_mm512_castps_si512
+                          (_mm512_shuffle_f32x4(c, c, _MM_SHUFFLE(3, 3, 1, 1))),
+                          sign));
+    return _mm512_fmadd_ps(b, cre, _mm512_fmadd_ps(bswap, cim, d));
+}
+
+static inline __m512d
+cmul_addd(__m512d b,
+          __m512d c,
+          __m512d d)
+{
+    const __m512i sign = _mm512_set_epi64(0, 0, 0, 0,
+                                          0x8000000000000000LL,
+                                          0x8000000000000000LL,
+                                          0x8000000000000000LL,
+                                          0x8000000000000000LL);
+    __m512d bswap, cre, cim;
+
+    bswap = _mm512_shuffle_f64x2(b, b, _MM_SHUFFLE(1, 0, 3, 2));
+    cre = _mm512_shuffle_f64x2(c, c, _MM_SHUFFLE(1, 0, 1, 0));
+    cim = _mm512_castsi512_pd
+        (_mm512_xor_si512(_mm512_castpd_si512
+                          (_mm512_shuffle_f64x2(c, c, _MM_SHUFFLE(3, 2, 3, 2))),
+                          sign));
+    return _mm512_fmadd_pd(b, cre, _mm512_fmadd_pd(bswap, cim, d));
+}
+
+void
+convolver_avx512_convolve_addf(void *input_cbuf,
+                               void *coeffs,
+                               void *output_cbuf,
+                               int loop_counter)
+{
+    float *b = (float *)input_cbuf;
+    float *c = (float *)coeffs;
+    float *d = (float *)output_cbuf;
+    float d1s, d2s;
+    int n;
+
+    d1s = d[0] + b[0] * c[0];
+    d2s = d[4] + b[4] * c[4];
+    for (n = 0; n < (loop_counter & ~1) << 3; n += 16) {
+        _mm512_storeu_ps(&d[n], cmul_addf(_mm512_loadu_ps(&b[n]),
+                                          _mm512_loadu_ps(&c[n]),
+                                          _mm512_loadu_ps(&d[n])));
+    }
+    if ((loop_counter & 1) != 0) {
+        _mm512_mask_storeu_ps(&d[n], 0x00FF,
+                              cmul_addf(_mm512_maskz_loadu_ps(0x00FF, &b[n]),
+                                        _mm512_maskz_loadu_ps(0x00FF, &c[n]),
+                                        _mm512_maskz_loadu_ps(0x00FF, &d[n])));
+    }
+    d[0] = d1s;
+    d[4] = d2s;
+}
+
+void
+convolver_avx512_convolvef(void *input_cbuf,
+                           void *coeffs,
+                           void *output_cbuf,
+                           int loop_counter)
+{
+    float *b = (float *)input_cbuf;
+    float *c = (float *)coeffs;
+    float *d = (float *)output_cbuf;
+    float d1s, d2s;
+    int n;
+
+    /* input_cbuf may be the same as output_cbuf */
+    d1s = b[0] * c[0];
+    d2s = b[4] * c[4];
+    for (n = 0; n < (loop_counter & ~1) << 3; n += 16) {
+        _mm512_storeu_ps(&d[n], cmul_addf(_mm512_loadu_ps(&b[n]),
+                                          _mm512_loadu_ps(&c[n]),
+                                          _mm512_setzero_ps()));
+    }
+    if ((loop_counter & 1) != 0) {
+        _mm512_mask_storeu_ps(&d[n], 0x00FF,
+                              cmul_addf(_mm512_maskz_loadu_ps(0x00FF, &b[n]),
+                                        _mm512_maskz_loadu_ps(0x00FF, &c[n]),
+                                        _mm512_setzero_ps()));
+    }
+    d[0] = d1s;
+    d[4] = d2s;
+}
+
+/*
+ * Sum of the products of several input buffers and coefficients, see
+ * convolver_avx.c.
+ */
+void
+convolver_avx512_convolve_sumf(void *input_cbufs[],
+                               void *coeffs[],
+                               int n_pairs,
+                               void *output_cbuf,
+                               int loop_counter)
+{
+    float **b = (float **)input_cbufs;
+    float **c = (float **)coeffs;
+    float *d = (float *)output_cbuf;
+    __m512 d0, d1, d2, d3;
+    float d1s, d2s;
+    int n, p;
+
+    d1s = d2s = 0;
+    for (p = 0; p < n_pairs; p++) {
+        d1s += b[p][0] * c[p][0];
+        d2s += b[p][4] * c[p][4];
+    }
+    for (n = 0; n < (loop_counter & ~7) << 3; n += 64) {
+        d0 = d1 = d2 = d3 = _mm512_setzero_ps();
+        for (p = 0; p < n_pairs; p++) {
+            d0 = cmul_addf(_mm512_loadu_ps(&b[p][n+0]),
+                           _mm512_loadu_ps(&c[p][n+0]), d0);
+            d1 = cmul_addf(_mm512_loadu_ps(&b[p][n+16]),
+                           _mm512_loadu_ps(&c[p][n+16]), d1);
+            d2 = cmul_addf(_mm512_loadu_ps(&b[p][n+32]),
+                           _mm512_loadu_ps(&c[p][n+32]), d2);
+            d3 = cmul_addf(_mm512_loadu_ps(&b[p][n+48]),
+                           _mm512_loadu_ps(&c[p][n+48]), d3);
+        }
+        _mm512_storeu_ps(&d[n+0], d0);
+        _mm512_storeu_ps(&d[n+16], d1);
+        _mm512_storeu_ps(&d[n+32], d2);
+        _mm512_storeu_ps(&d[n+48], d3);
+    }
+    for (; n < (loop_counter & ~1) << 3; n += 16) {
+        d0 = _mm512_setzero_ps();
+        for (p = 0; p < n_pairs; p++) {
+            d0 = cmul_addf(_mm512_loadu_ps(&b[p][n]),
+                           _mm512_loadu_ps(&c[p][n]), d0);
+        }
+        _mm512_storeu_ps(&d[n], d0);
+    }
+    if ((loop_counter & 1) != 0) {
+        d0 = _mm512_setzero_ps();
+        for (p = 0; p < n_pairs; p++) {
+            d0 = cmul_addf(_mm512_maskz_loadu_ps(0x00FF, &b[p][n]),
+                           _mm512_maskz_loadu_ps(0x00FF, &c[p][n]), d0);
+        }
+        _mm512_mask_storeu_ps(&d[n], 0x00FF, d0);
+    }
+    d[0] = d1s;
+    d[4] = d2s;
+}
+
+void
+convolver_avx512_convolve_addd(void *input_cbuf,
+                               void *coeffs,
+                               void *output_cbuf,
+                               int loop_counter)
+{
+    double *b = (double *)input_cbuf;
+    double *c = (double *)coeffs;
+    double *d = (double *)output_cbuf;
+    double d1s, d2s;
+    int n;
+
+    d1s = d[0] + b[0] * c[0];
+    d2s = d[4] + b[4] * c[4];
+    for (n = 0; n < loop_counter << 3; n += 8) {
+        _mm512_storeu_pd(&d[n], cmul_addd(_mm512_loadu_pd(&b[n]),
+                                          _mm512_loadu_pd(&c[n]),
+                                          _mm512_loadu_pd(&d[n])));
+    }
+    d[0] = d1s;
+    d[4] = d2s;
+}
+
+void
+convolver_avx512_convolved(void *input_cbuf,
+                           void *coeffs,
+                           void *output_cbuf,
+                           int loop_counter)
+{
+    double *b = (double *)input_cbuf;
+    double *c = (double *)coeffs;
+    double *d = (double *)output_cbuf;
+    double d1s, d2s;
+    int n;
+
+    /* input_cbuf may be the same as output_cbuf */
+    d1s = b[0] * c[0];
+    d2s = b[4] * c[4];
+    for (n = 0; n < loop_counter << 3; n += 8) {
+        _mm512_storeu_pd(&d[n], cmul_addd(_mm512_loadu_pd(&b[n]),
+                                          _mm512_loadu_pd(&c[n]),
+                                          _mm512_setzero_pd()));
+    }
+    d[0] = d1s;
+    d[4] = d2s;
+}
+
+void
+convolver_avx512_convolve_sumd(void *input_cbufs[],
+                               void *coeffs[],
+                               int n_pairs,
+                               void *output_cbuf,
+                               int loop_counter)
+{
+    double **b = (double **)input_cbufs;
+    double **c = (double **)coeffs;
+    double *d = (double *)output_cbuf;
+    __m512d d0, d1, d2, d3;
+    double d1s, d2s;
+    int n, p;
+
+    d1s = d2s = 0;
+    for (p = 0; p < n_pairs; p++) {
+        d1s += b[p][0] * c[p][0];
+        d2s += b[p][4] * c[p][4];
+    }
+    for (n = 0; n < (loop_counter & ~3) << 3; n += 32) {
+        d0 = d1 = d2 = d3 = _mm512_setzero_pd();
+        for (p = 0; p < n_pairs; p++) {
+            d0 = cmul_addd(_mm512_loadu_pd(&b[p][n+0]),
+                           _mm512_loadu_pd(&c[p][n+0]), d0);
+            d1 = cmul_addd(_mm512_loadu_pd(&b[p][n+8]),
+                           _mm512_loadu_pd(&c[p][n+8]), d1);
+            d2 = cmul_addd(_mm512_loadu_pd(&b[p][n+16]),
+                           _mm512_loadu_pd(&c[p][n+16]), d2);
+            d3 = cmul_addd(_mm512_loadu_pd(&b[p][n+24]),
+                           _mm512_loadu_pd(&c[p][n+24]), d3);
+        }
+        _mm512_storeu_pd(&d[n+0], d0);
+        _mm512_storeu_pd(&d[n+8], d1);
+        _mm512_storeu_pd(&d[n+16], d2);
+        _mm512_storeu_pd(&d[n+24], d3);
+    }
+    for (; n < loop_counter << 3; n += 8) {
+        d0 = _mm512_setzero_pd();
+        for (p = 0; p < n_pairs; p++) {
+            d0 = cmul_addd(_mm512_loadu_pd(&b[p][n]),
+                           _mm512_loadu_pd(&c[p][n]), d0);
+        }
+        _mm512_storeu_pd(&d[n], d0);
+    }
+    d[0] = d1s;
+    d[4] = d2s;
+}
+
+/*
+ * Mix and scale, see convolver_avx.c. The first 16 elements from each end
+ * are done in plain C, so 'loop_counter' must be at least 4.
+ */
+
+void
+convolver_avx512_mixnscale_inputf(void *input_cbufs[],
+                                  void *output_cbuf,
+                                  double scales[],
+                                  int n_bufs,
+                                  int loop_counter)
+{
+    /* interleave four real parts with four reversed imaginary parts */
+    const __m512i lo = _mm512_set_epi32(24, 25, 26, 27, 7, 6, 5, 4,
+                                        28, 29, 30, 31, 3, 2, 1, 0);
+    const __m512i hi = _mm512_set_epi32(16, 17, 18, 19, 15, 14, 13, 12,
+                                        20, 21, 22, 23, 11, 10, 9, 8);
+    int n_fft = loop_counter << 3;
+    float **ibufs = (float **)input_cbufs;
+    float *obuf = (float *)output_cbuf;
+    __m512 re, im, s;
+    int n, i;
+    float sscales[n_bufs];
+
+    for (i = 0; i < n_bufs; i++) {
+        sscales[i] = (float)scales[i];
+    }
+
+    for (n = 0; n < 16; n++) {
+        obuf[(n & ~3) * 2 + (n & 3)] = 0;
+        obuf[(n & ~3) * 2 + (n & 3) + 4] = 0;
+        for (i = 0; i < n_bufs; i++) {
+            obuf[(n & ~3) * 2 + (n & 3)] += ibufs[i][n] * sscales[i];
+            obuf[(n & ~3) * 2 + (n & 3) + 4] +=
+                ibufs[i][n == 0 ? n_fft >> 1 : n_fft - n] * sscales[i];
+        }
+    }
+    for (n = 16; n < n_fft >> 1; n += 16) {
+        re = _mm512_setzero_ps();
+        im = _mm512_setzero_ps();
+        for (i = 0; i < n_bufs; i++) {
+            s = _mm512_set1_ps(sscales[i]);
+            re = _mm512_fmadd_ps(_mm512_loadu_ps(&ibufs[i][n]), s, re);
+            im = _mm512_fmadd_ps(_mm512_loadu_ps(&ibufs[i][n_fft - n - 15]),
+                                 s, im);
+        }
+        _mm512_storeu_ps(&obuf[(n<<1)+0], _mm512_permutex2var_ps(re, lo, im));
+        _mm512_storeu_ps(&obuf[(n<<1)+16], _mm512_permutex2var_ps(re, hi, im));
+    }
+}
+
+void
+convolver_avx512_mixnscale_outputf(void *input_cbufs[],
+                                   void *output_cbuf,
+                                   double scales[],
+                                   int n_bufs,
+                                   int loop_counter)
+{
+    /* gather the real parts, and the imaginary parts in reverse order */
+    const __m512i re_idx = _mm512_set_epi32(27, 26, 25, 24, 19, 18, 17, 16,
+                                            11, 10, 9, 8, 3, 2, 1, 0);
+    const __m512i im_idx = _mm512_set_epi32(4, 5, 6, 7, 12, 13, 14, 15,
+                                            20, 21, 22, 23, 28, 29, 30, 31);
+    int n_fft = loop_counter << 3;
+    float **ibufs = (float **)input_cbufs;
+    float *obuf = (float *)output_cbuf;
+    __m512 x0, x1, re, im, s;
+    int n, i;
+    float sscales[n_bufs];
+
+    for (i = 0; i < n_bufs; i++) {
+        sscales[i] = (float)scales[i];
+    }
+
+    for (n = 0; n < 16; n++) {
+        obuf[n] = 0;
+        obuf[n == 0 ? n_fft >> 1 : n_fft - n] = 0;
+        for (i = 0; i < n_bufs; i++) {
+            obuf[n] += ibufs[i][(n & ~3) * 2 + (n & 3)] * sscales[i];
+            obuf[n == 0 ? n_fft >> 1 : n_fft - n] +=
+                ibufs[i][(n & ~3) * 2 + (n & 3) + 4] * sscales[i];
+        }
+    }
+    for (n = 16; n < n_fft >> 1; n += 16) {
+        re = _mm512_setzero_ps();
+        im = _mm512_setzero_ps();
+        for (i = 0; i < n_bufs; i++) {
+            s = _mm512_set1_ps(sscales[i]);
+            x0 = _mm512_loadu_ps(&ibufs[i][(n<<1)+0]);
+            x1 = _mm512_loadu_ps(&ibufs[i][(n<<1)+16]);
+            re = _mm512_fmadd_ps(_mm512_permutex2var_ps(x0, re_idx, x1),
+                                 s, re);
+            im = _mm512_fmadd_ps(_mm512_permutex2var_ps(x0, im_idx, x1),
+                                 s, im);
+        }
+        _mm512_storeu_ps(&obuf[n], re);
+        _mm512_storeu_ps(&obuf[n_fft - n - 15], im);
+    }
+}
+
+void
+convolver_avx512_mixnscale_inputd(void *input_cbufs[],
+                                  void *output_cbuf,
+                                  double scales[],
+                                  int n_bufs,
+                                  int loop_counter)
+{
+    const __m512i lo = _mm512_set_epi64(12, 13, 14, 15, 3, 2, 1, 0);
+    const __m512i hi = _mm512_set_epi64(8, 9, 10, 11, 7, 6, 5, 4);
+    int n_fft = loop_counter << 3;
+    double **ibufs = (double **)input_cbufs;
+    double *obuf = (double *)output_cbuf;
+    __m512d re, im, s;
+    int n, i;
+
+    for (n = 0; n < 16; n++) {
+        obuf[(n & ~3) * 2 + (n & 3)] = 0;
+        obuf[(n & ~3) * 2 + (n & 3) + 4] = 0;
+        for (i = 0; i < n_bufs; i++) {
+            obuf[(n & ~3) * 2 + (n & 3)] += ibufs[i][n] * scales[i];
+            obuf[(n & ~3) * 2 + (n & 3) + 4] +=
+                ibufs[i][n == 0 ? n_fft >> 1 : n_fft - n] * scales[i];
+        }
+    }
+    for (n = 16; n < n_fft >> 1; n += 8) {
+        re = _mm512_setzero_pd();
+        im = _mm512_setzero_pd();
+        for (i = 0; i < n_bufs; i++) {
+            s = _mm512_set1_pd(scales[i]);
+            re = _mm512_fmadd_pd(_mm512_loadu_pd(&ibufs[i][n]), s, re);
+            im = _mm512_fmadd_pd(_mm512_loadu_pd(&ibufs[i][n_fft - n - 7]),
+                                 s, im);
+        }
+        _mm512_storeu_pd(&obuf[(n<<1)+0], _mm512_permutex2var_pd(re, lo, im));
+        _mm512_storeu_pd(&obuf[(n<<1)+8], _mm512_permutex2var_pd(re, hi, im));
+    }
+}
+
+void
+convolver_avx512_mixnscale_outputd(void *input_cbufs[],
+                                   void *output_cbuf,
+                                   double scales[],
+                                   int n_bufs,
+                                   int loop_counter)
+{
+    const __m512i re_idx = _mm512_set_epi64(11, 10, 9, 8, 3, 2, 1, 0);
+    const __m512i im_idx = _mm512_set_epi64(4, 5, 6, 7, 12, 13, 14, 15);
+    int n_fft = loop_counter << 3;
+    double **ibufs = (double **)input_cbufs;
+    double *obuf = (double *)output_cbuf;
+    __m512d x0, x1, re, im, s;
+    int n, i;
+
+    for (n = 0; n < 16; n++) {
+        obuf[n] = 0;
+        obuf[n == 0 ? n_fft >> 1 : n_fft - n] = 0;
+        for (i = 0; i < n_bufs; i++) {
+            obuf[n] += ibufs[i][(n & ~3) * 2 + (n & 3)] * scales[i];
+            obuf[n == 0 ? n_fft >> 1 : n_fft - n] +=
+                ibufs[i][(n & ~3) * 2 + (n & 3) + 4] * scales[i];
+        }
+    }
+    for (n = 16; n < n_fft >> 1; n += 8) {
+        re = _mm512_setzero_pd();
+        im = _mm512_setzero_pd();
+        for (i = 0; i < n_bufs; i++) {
+            s = _mm512_set1_pd(scales[i]);
+            x0 = _mm512_loadu_pd(&ibufs[i][(n<<1)+0]);
+            x1 = _mm512_loadu_pd(&ibufs[i][(n<<1)+8]);
+            re = _mm512_fmadd_pd(_mm512_permutex2var_pd(x0, re_idx, x1),
+                                 s, re);
+            im = _mm512_fmadd_pd(_mm512_permutex2var_pd(x0, im_idx, x1),
+                                 s, im);
+        }
+        _mm512_storeu_pd(&obuf[n], re);
+        _mm512_storeu_pd(&obuf[n_fft - n - 7], im);
+    }
+}
@@ -0,0 +1,973 @@
+/*
+ * (c) Copyright 2026 -- Anders Torger
+ *
+ * This program is open source. For license terms, see the LICENSE file.
+ *
+ */
+#include "asmprot.h"
+
+#include <arm_neon.h>
+
+/*
+ * AArch64 NEON (ASIMD) versions of the frequency domain functions and of the
+ * most common sample format conversions. The internal format is blocks of 8
+ * reals, 4 real parts followed by 4 imaginary parts, except for the first
+ * block where the first imaginary part is replaced with the (real) nyquist
+ * frequency. The 'loop_counter' is the number of blocks.
+ */
+
+void
+convolver_neon_convolve_addf(void *input_cbuf,
+                             void *coeffs,
+                             void *output_cbuf,
+                             int loop_counter)
+{
+    float *b = (float *)input_cbuf;
+    float *c = (float *)coeffs;
+    float *d = (float *)output_cbuf;
+    float32x4_t bre, bim, cre, cim;
+    float d1s, d2s;
+    int n;
+
+    d1s = d[0] + b[0] * c[0];
+    d2s = d[4] + b[4] * c[4];
+    for (n = 0; n < loop_counter << 3; n += 8) {
+        bre = vld1q_f32(&b[n+0]);
+        bim = vld1q_f32(&b[n+4]);
+        cre = vld1q_f32(&c[n+0]);
+        cim = vld1q_f32(&c[n+4]);
+        vst1q_f32(&d[n+0], vfmsq_f32(vfmaq_f32(vld1q_f32(&d[n+0]), bre, cre),
+                                     bim, cim));
+        vst1q_f32(&d[n+4], vfmaq_f32(vfmaq_f32(vld1q_f32(&d[n+4]), bre, cim),
+                                     bim, cre));
+    }
+    d[0] = d1s;
+    d[4] = d2s;
+}
+
+void
+convolver_neon_convolvef(void *input_cbuf,
+                         void *coeffs,
+                         void *output_cbuf,
+                         int loop_counter)
+{
+    float *b = (float *)input_cbuf;
+    float *c = (float *)coeffs;
+    float *d = (float *)output_cbuf;
+    float32x4_t bre, bim, cre, cim;
+    float d1s, d2s;
+    int n;
+
+    /* input_cbuf may be the same as output_cbuf */
+    d1s = b[0] * c[0];
+    d2s = b[4] * c[4];
+    for (n = 0; n < loop_counter << 3; n += 8) {
+        bre = vld1q_f32(&b[n+0]);
+        bim = vld1q_f32(&b[n+4]);
+        cre = vld1q_f32(&c[n+0]);
+        cim = vld1q_f32(&c[n+4]);
+        vst1q_f32(&d[n+0], vfmsq_f32(vmulq_f32(bre, cre), bim, cim));
+        vst1q_f32(&d[n+4], vfmaq_f32(vmulq_f32(bre, cim), bim, cre));
+    }
+    d[0] = d1s;
+    d[4] = d2s;
+}
+
+/*
+ * Sum of the products of several input buffers and coefficients. Two blocks
+ * are kept in registers while looping over all pairs, so the output is only
+ * written once.
+ */
+void
+convolver_neon_convolve_sumf(void *input_cbufs[],
+                             void *coeffs[],
+                             int n_pairs,
+                             void *output_cbuf,
+                             int loop_counter)
+{
+    float **b = (float **)input_cbufs;
+    float **c = (float **)coeffs;
+    float *d = (float *)output_cbuf;
+    float32x4_t bre, bim, cre, cim, re0, im0, re1, im1;
+    float d1s, d2s;
+    int n, p;
+
+    d1s = d2s = 0;
+    for (p = 0; p < n_pairs; p++) {
+        d1s += b[p][0] * c[p][0];
+        d2s += b[p][4] * c[p][4];
+    }
+    for (n = 0; n < (loop_counter & ~1) << 3; n += 16) {
+        re0 = im0 = re1 = im1 = vdupq_n_f32(0);
+        for (p = 0; p < n_pairs; p++) {
+            bre = vld1q_f32(&b[p][n+0]);
+            bim = vld1q_f32(&b[p][n+4]);
+            cre = vld1q_f32(&c[p][n+0]);
+            cim = vld1q_f32(&c[p][n+4]);
+            re0 = vfmsq_f32(vfmaq_f32(re0, bre, cre), bim, cim);
+            im0 = vfmaq_f32(vfmaq_f32(im0, bre, cim), bim, cre);
+            bre = vld1q_f32(&b[p][n+8]);
+            bim = vld1q_f32(&b[p][n+12]);
+            cre = vld1q_f32(&c[p][n+8]);
+            cim = vld1q_f32(&c[p][n+12]);
+            re1 = vfmsq_f32(vfmaq_f32(re1, bre, cre), bim, cim);
+            im1 = vfmaq_f32(vfmaq_f32(im1, bre, cim), bim, cre);
+        }
+        vst1q_f32(&d[n+0], re0);
+        vst1q_f32(&d[n+4], im0);
+        vst1q_f32(&d[n+8], re1);
+        vst1q_f32(&d[n+12], im1);
+    }
+    if ((loop_counter & 1) != 0) {
+        re0 = im0 = vdupq_n_f32(0);
+        for (p = 0; p < n_pairs; p++) {
+            bre = vld1q_f32(&b[p][n+0]);
+            bim = vld1q_f32(&b[p][n+4]);
+            cre = vld1q_f32(&c[p][n+0]);
+            cim = vld1q_f32(&c[p][n+4]);
+            re0 = vfmsq_f32(vfmaq_f32(re0, bre, cre), bim, cim);
+            im0 = vfmaq_f32(vfmaq_f32(im0, bre, cim), bim, cre);
+        }
+        vst1q_f32(&d[n+0], re0);
+        vst1q_f32(&d[n+4], im0);
+    }
+    d[0] = d1s;
+    d[4] = d2s;
+}
+
+void
+convolver_neon_dirac_convolvef(void *input_cbuf,
+                               void *output_cbuf,
+                               double fraction,
+                               int loop_counter)
+{
+    const float fv[4] = { (float)fraction, (float)-fraction,
+                          (float)fraction, (float)-fraction };
+    const float32x4_t f = vld1q_f32(fv);
+    float *b = (float *)input_cbuf;
+    float *d = (float *)output_cbuf;
+    int n;
+
+    for (n = 0; n < loop_counter << 3; n += 4) {
+        vst1q_f32(&d[n], vmulq_f32(vld1q_f32(&b[n]), f));
+    }
+}
+
+void
+convolver_neon_convolve_addd(void *input_cbuf,
+                             void *coeffs,
+                             void *output_cbuf,
+                             int loop_counter)
+{
+    double *b = (double *)input_cbuf;
+    double *c = (double *)coeffs;
+    double *d = (double *)output_cbuf;
+    float64x2_t bre, bim, cre, cim;
+    double d1s, d2s;
+    int n, i;
+
+    d1s = d[0] + b[0] * c[0];
+    d2s = d[4] + b[4] * c[4];
+    for (n = 0; n < loop_counter << 3; n += 8) {
+        for (i = 0; i < 4; i += 2) {
+            bre = vld1q_f64(&b[n+i+0]);
+            bim = vld1q_f64(&b[n+i+4]);
+            cre = vld1q_f64(&c[n+i+0]);
+            cim = vld1q_f64(&c[n+i+4]);
+            vst1q_f64(&d[n+i+0],
+                      vfmsq_f64(vfmaq_f64(vld1q_f64(&d[n+i+0]), bre, cre),
+                                bim, cim));
+            vst1q_f64(&d[n+i+4],
+                      vfmaq_f64(vfmaq_f64(vld1q_f64(&d[n+i+4]), bre, cim),
+                                bim, cre));
+        }
+    }
+    d[0] = d1s;
+    d[4] = d2s;
+}
+
+void
+convolver_neon_convolved(void *input_cbuf,
+                         void *coeffs,
+                         void *output_cbuf,
+                         int loop_counter)
+{
+    double *b = (double *)input_cbuf;
+    double *c = (double *)coeffs;
+    double *d = (double *)output_cbuf;
+    float64x2_t bre, bim, cre, cim;
+    double d1s, d2s;
+    int n, i;
+
+    /* input_cbuf may be the same as output_cbuf */
+    d1s = b[0] * c[0];
+    d2s = b[4] * c[4];
+    for (n = 0; n < loop_counter << 3; n += 8) {
+        for (i = 0; i < 4; i += 2) {
+            bre = vld1q_f64(&b[n+i+0]);
+            bim = vld1q_f64(&b[n+i+4]);
+            cre = vld1q_f64(&c[n+i+0]);
+            cim = vld1q_f64(&c[n+i+4]);
+            vst1q_f64(&d[n+i+0], vfmsq_f64(vmulq_f64(bre, cre), bim, cim));
+            vst1q_f64(&d[n+i+4], vfmaq_f64(vmulq_f64(bre, cim), bim, cre));
+        }
+    }
+    d[0] = d1s;
+    d[4] = d2s;
+}
+
+void
+convolver_neon_convolve_sumd(void *input_cbufs[],
+                             void *coeffs[],
+                             int n_pairs,
+                             void *output_cbuf,
+                             int loop_counter)
+{
+    double **b = (double **)input_cbufs;
+    double **c = (double **)coeffs;
+    double *d = (double *)output_cbuf;
+    float64x2_t bre, bim, cre, cim, re0, im0, re1, im1;
+    double d1s, d2s;
+    int n, p;
+
+    d1s = d2s = 0;
+    for (p = 0; p < n_pairs; p++) {
+        d1s += b[p][0] * c[p][0];
+        d2s += b[p][4] * c[p][4];
+    }
+    for (n = 0; n < loop_counter << 3; n += 8) {
+        re0 = im0 = re1 = im1 = vdupq_n_f64(0);
+        for (p = 0; p < n_pairs; p++) {
+            bre = vld1q_f64(&b[p][n+0]);
+            bim = vld1q_f64(&b[p][n+4]);
+            cre = vld1q_f64(&c[p][n+0]);
+            cim = vld1q_f64(&c[p][n+4]);
+            re0 = vfmsq_f64(vfmaq_f64(re0, bre, cre), bim, cim);
+            im0 = vfmaq_f64(vfmaq_f64(im0, bre, cim), bim, cre);
+            bre = vld1q_f64(&b[p][n+2]);
+            bim = vld1q_f64(&b[p][n+6]);
+            cre = vld1q_f64(&c[p][n+2]);
+            cim = vld1q_f64(&c[p][n+6]);
+            re1 = vfmsq_f64(vfmaq_f64(re1, bre, cre), bim, cim);
+            im1 = vfmaq_f64(vfmaq_f64(im1, bre, cim), bim, cre);
+        }
+        vst1q_f64(&d[n+0], re0);
+        vst1q_f64(&d[n+4], im0);
+        vst1q_f64(&d[n+2], re1);
+        vst1q_f64(&d[n+6], im1);
+    }
+    d[0] = d1s;
+    d[4] = d2s;
+}
+
+void
+convolver_neon_dirac_convolved(void *input_cbuf,
+                               void *output_cbuf,
+                               double fraction,
+                               int loop_counter)
+{
+    const double fv[2] = { fraction, -fraction };
+    const float64x2_t f = vld1q_f64(fv);
+    double *b = (double *)input_cbuf;
+    double *d = (double *)output_cbuf;
+    int n;
+
+    for (n = 0; n < loop_counter << 3; n += 2) {
+        vst1q_f64(&d[n], vmulq_f64(vld1q_f64(&b[n]), f));
+    }
+}
+
+/*
+ * Mix and scale. Input mode reorders from FFTW's halfcomplex format to the
+ * internal format, output mode does the opposite. The first block contains
+ * the special case elements and is done in plain C.
+ */
+
+static inline float32x4_t
+reversef(float32x4_t x)
+{
+    x = vrev64q_f32(x);
+    return vextq_f32(x, x, 2);
+}
+
+static inline float64x2_t
+reversed(float64x2_t x)
+{
+    return vextq_f64(x, x, 1);
+}
+
+void
+convolver_neon_mixnscale_inputf(void *input_cbufs[],
+                                void *output_cbuf,
+                                double scales[],
+                                int n_bufs,
+                                int loop_counter)
+{
+    int n_fft = loop_counter << 3;
+    float **ibufs = (float **)input_cbufs;
+    float *obuf = (float *)output_cbuf;
+    float32x4_t re, im;
+    float s;
+    int n, i;
+    float sscales[n_bufs];
+
+    for (i = 0; i < n_bufs; i++) {
+        sscales[i] = (float)scales[i];
+    }
+
+    for (n = 0; n < 4; n++) {
+        obuf[n] = 0;
+        obuf[n + 4] = 0;
+        for (i = 0; i < n_bufs; i++) {
+            obuf[n] += ibufs[i][n] * sscales[i];
+            obuf[n + 4] += ibufs[i][n == 0 ? n_fft >> 1 : n_fft - n] *
+                sscales[i];
+        }
+    }
+    for (n = 4; n < n_fft >> 1; n += 4) {
+        re = vdupq_n_f32(0);
+        im = vdupq_n_f32(0);
+        for (i = 0; i < n_bufs; i++) {
+            s = sscales[i];
+            re = vfmaq_n_f32(re, vld1q_f32(&ibufs[i][n]), s);
+            im = vfmaq_n_f32(im, vld1q_f32(&ibufs[i][n_fft - n - 3]), s);
+        }
+        vst1q_f32(&obuf[(n<<1)+0], re);
+        vst1q_f32(&obuf[(n<<1)+4], reversef(im));
+    }
+}
+
+void
+convolver_neon_mixnscale_outputf(void *input_cbufs[],
+                                 void *output_cbuf,
+                                 double scales[],
+                                 int n_bufs,
+                                 int loop_counter)
+{
+    int n_fft = loop_counter << 3;
+    float **ibufs = (float **)input_cbufs;
+    float *obuf = (float *)output_cbuf;
+    float32x4_t re, im;
+    float s;
+    int n, i;
+    float sscales[n_bufs];
+
+    for (i = 0; i < n_bufs; i++) {
+        sscales[i] = (float)scales[i];
+    }
+
+    for (n = 0; n < 4; n++) {
+        obuf[n] = 0;
+        obuf[n == 0 ? n_fft >> 1 : n_fft - n] = 0;
+        for (i = 0; i < n_bufs; i++) {
+            obuf[n] += ibufs[i][n] * sscales[i];
+            obuf[n == 0 ? n_fft >> 1 : n_fft - n] += ibufs[i][n + 4] *
+                sscales[i];
+        }
+    }
+    for (n = 4; n < n_fft >> 1; n += 4) {
+        re = vdupq_n_f32(0);
+        im = vdupq_n_f32(0);
+        for (i = 0; i < n_bufs; i++) {
+            s = sscales[i];
+            re = vfmaq_n_f32(re, vld1q_f32(&ibufs[i][(n<<1)+0]), s);
+            im = vfmaq_n_f32(im, vld1q_f32(&ibufs[i][(n<<1)+4]), s);
+        }
+        vst1q_f32(&obuf[n], re);
+        vst1q_f32(&obuf[n_fft - n - 3], reversef(im));
+    }
+}
+
+void
+convolver_neon_mixnscale_inputd(void *input_cbufs[],
+                                void *output_cbuf,
+                                double scales[],
+                                int n_bufs,
+                                int loop_counter)
+{
+    int n_fft = loop_counter << 3;
+    double **ibufs = (double **)input_cbufs;
+    double *obuf = (double *)output_cbuf;
+    float64x2_t re[2], im[2];
+    int n, i;
+
+    for (n = 0; n < 4; n++) {
+        obuf[n] = 0;
+        obuf[n + 4] = 0;
+        for (i = 0; i < n_bufs; i++) {
+            obuf[n] += ibufs[i][n] * scales[i];
+            obuf[n + 4] += ibufs[i][n == 0 ? n_fft >> 1 : n_fft - n] *
+                scales[i];
+        }
+    }
+    for (n = 4; n < n_fft >> 1; n += 4) {
+        re[0] = re[1] = im[0] = im[1] = vdupq_n_f64(0);
+        for (i = 0; i < n_bufs; i++) {
+            re[0] = vfmaq_n_f64(re[0], vld1q_f64(&ibufs[i][n+0]), scales[i]);
+            re[1] = vfmaq_n_f64(re[1], vld1q_f64(&ibufs[i][n+2]), scales[i]);
+            im[0] = vfmaq_n_f64(im[0], vld1q_f64(&ibufs[i][n_fft - n - 1]),
+                                scales[i]);
+            im[1] = vfmaq_n_f64(im[1], vld1q_f64(&ibufs[i][n_fft - n - 3]),
+                                scales[i]);
+        }
+        vst1q_f64(&obuf[(n<<1)+0], re[0]);
+        vst1q_f64(&obuf[(n<<1)+2], re[1]);
+        vst1q_f64(&obuf[(n<<1)+4], reversed(im[0]));
+        vst1q_f64(&obuf[(n<<1)+6], reversed(im[1]));
+    }
+}
+
+void
+convolver_neon_mixnscale_outputd(void *input_cbufs[],
+                                 void *output_cbuf,
+                                 double scales[],
+                                 int n_bufs,
+                                 int loop_counter)
+{
+    int n_fft = loop_counter << 3;
+    double **ibufs = (double **)input_cbufs;
+    double *obuf = (double *)output_cbuf;
+    float64x2_t re[2], im[2];
+    int n, i;
+
+    for (n = 0; n < 4; n++) {
+        obuf[n] = 0;
+        obuf[n == 0 ? n_fft >> 1 : n_fft - n] = 0;
+        for (i = 0; i < n_bufs; i++) {
+            obuf[n] += ibufs[i][n] * scales[i];
+            obuf[n == 0 ? n_fft >> 1 : n_fft - n] += ibufs[i][n + 4] *
+                scales[i];
+        }
+    }
+    for (n = 4; n < n_fft >> 1; n += 4) {
+        re[0] = re[1] = im[0] = im[1] = vdupq_n_f64(0);
+        for (i = 0; i < n_bufs; i++) {
+            re[0] = vfmaq_n_f64(re[0], vld1q_f64(&ibufs[i][(n<<1)+0]),
+                                scales[i]);
+            re[1] = vfmaq_n_f64(re[1], vld1q_f64(&ibufs[i][(n<<1)+2]),
+                                scales[i]);
+            im[0] = vfmaq_n_f64(im[0], vld1q_f64(&ibufs[i][(n<<1)+4]),
+                                scales[i]);
+            im[1] = vfmaq_n_f64(im[1], vld1q_f64(&ibufs[i][(n<<1)+6]),
+                                scales[i]);
+        }
+        vst1q_f64(&obuf[n+0], re[0]);
+        vst1q_f64(&obuf[n+2], re[1]);
+        vst1q_f64(&obuf[n_fft - n - 1], reversed(im[0]));
+        vst1q_f64(&obuf[n_fft - n - 3], reversed(im[1]));
+    }
+}
+
+/*
+ * Versions for the complex layout, where the real and imaginary parts are
+ * interleaved and there is no special case for DC and nyquist. The
+ * interleaving is undone by the load and store instructions.
+ */
+
+void
+convolver_neon_complex_convolve_addf(void *input_cbuf,
+                                     void *coeffs,
+                                     void *output_cbuf,
+                                     int loop_counter)
+{
+    float *b = (float *)input_cbuf;
+    float *c = (float *)coeffs;
+    float *d = (float *)output_cbuf;
+    float32x4x2_t bv, cv, dv;
+    int n;
+
+    for (n = 0; n < loop_counter << 3; n += 8) {
+        bv = vld2q_f32(&b[n]);
+        cv = vld2q_f32(&c[n]);
+        dv = vld2q_f32(&d[n]);
+        dv.val[0] = vfmsq_f32(vfmaq_f32(dv.val[0], bv.val[0], cv.val[0]),
+                              bv.val[1], cv.val[1]);
+        dv.val[1] = vfmaq_f32(vfmaq_f32(dv.val[1], bv.val[0], cv.val[1]),
+                              bv.val[1], cv.val[0]);
+        vst2q_f32(&d[n], dv);
+    }
+}
+
+void
+convolver_neon_complex_convolvef(void *input_cbuf,
+                                 void *coeffs,
+                                 void *output_cbuf,
+                                 int loop_counter)
+{
+    float *b = (float *)input_cbuf;
+    float *c = (float *)coeffs;
+    float *d = (float *)output_cbuf;
+    float32x4x2_t bv, cv, dv;
+    int n;
+
+    /* input_cbuf may be the same as output_cbuf */
+    for (n = 0; n < loop_counter << 3; n += 8) {
+        bv = vld2q_f32(&b[n]);
+        cv = vld2q_f32(&c[n]);
+        dv.val[0] = vfmsq_f32(vmulq_f32(bv.val[0], cv.val[0]),
+                              bv.val[1], cv.val[1]);
+        dv.val[1] = vfmaq_f32(vmulq_f32(bv.val[0], cv.val[1]),
+                              bv.val[1], cv.val[0]);
+        vst2q_f32(&d[n], dv);
+    }
+}
+
+void
+convolver_neon_complex_convolve_sumf(void *input_cbufs[],
+                                     void *coeffs[],
+                                     int n_pairs,
+                                     void *output_cbuf,
+                                     int loop_counter)
+{
+    float **b = (float **)input_cbufs;
+    float **c = (float **)coeffs;
+    float *d = (float *)output_cbuf;
+    float32x4x2_t bv, cv, d0, d1;
+    int n, p;
+
+    for (n = 0; n < (loop_counter & ~1) << 3; n += 16) {
+        d0.val[0] = d0.val[1] = d1.val[0] = d1.val[1] = vdupq_n_f32(0);
+        for (p = 0; p < n_pairs; p++) {
+            bv = vld2q_f32(&b[p][n+0]);
+            cv = vld2q_f32(&c[p][n+0]);
+            d0.val[0] = vfmsq_f32(vfmaq_f32(d0.val[0], bv.val[0], cv.val[0]),
+                                  bv.val[1], cv.val[1]);
+            d0.val[1] = vfmaq_f32(vfmaq_f32(d0.val[1], bv.val[0], cv.val[1]),
+                                  bv.val[1], cv.val[0]);
+            bv = vld2q_f32(&b[p][n+8]);
+            cv = vld2q_f32(&c[p][n+8]);
+            d1.val[0] = vfmsq_f32(vfmaq_f32(d1.val[0], bv.val[0], cv.val[0]),
+                                  bv.val[1], cv.val[1]);
+            d1.val[1] = vfmaq_f32(vfmaq_f32(d1.val[1], bv.val[0], cv.val[1]),
+                                  bv.val[1], cv.val[0]);
+        }
+        vst2q_f32(&d[n+0], d0);
+        vst2q_f32(&d[n+8], d1);
+    }
+    if ((loop_counter & 1) != 0) {
+        d0.val[0] = d0.val[1] = vdupq_n_f32(0);
+        for (p = 0; p < n_pairs; p++) {
+            bv = vld2q_f32(&b[p][n]);
+            cv = vld2q_f32(&c[p][n]);
+            d0.val[0] = vfmsq_f32(vfmaq_f32(d0.val[0], bv.val[0], cv.val[0]),
+                                  bv.val[1], cv.val[1]);
+            d0.val[1] = vfmaq_f32(vfmaq_f32(d0.val[1], bv.val[0], cv.val[1]),
+                                  bv.val[1], cv.val[0]);
+        }
+        vst2q_f32(&d[n], d0);
+    }
+}
+
+void
+convolver_neon_complex_convolve_addd(void *input_cbuf,
+                                     void *coeffs,
+                                     void *output_cbuf,
+                                     int loop_counter)
+{
+    double *b = (double *)input_cbuf;
+    double *c = (double *)coeffs;
+    double *d = (double *)output_cbuf;
+    float64x2x2_t bv, cv, dv;
+    int n;
+
+    for (n = 0; n < loop_counter << 3; n += 4) {
+        bv = vld2q_f64(&b[n]);
+        cv = vld2q_f64(&c[n]);
+        dv = vld2q_f64(&d[n]);
+        dv.val[0] = vfmsq_f64(vfmaq_f64(dv.val[0], bv.val[0], cv.val[0]),
+                              bv.val[1], cv.val[1]);
+        dv.val[1] = vfmaq_f64(vfmaq_f64(dv.val[1], bv.val[0], cv.val[1]),
+                              bv.val[1], cv.val[0]);
+        vst2q_f64(&d[n], dv);
+    }
+}
+
+void
+convolver_neon_complex_convolved(void *input_cbuf,
+                                 void *coeffs,
+                                 void *output_cbuf,
+                                 int loop_counter)
+{
+    double *b = (double *)input_cbuf;
+    double *c = (double *)coeffs;
+    double *d = (double *)output_cbuf;
+    float64x2x2_t bv, cv, dv;
+    int n;
+
+    /* input_cbuf may be the same as output_cbuf */
+    for (n = 0; n < loop_counter << 3; n += 4) {
+        bv = vld2q_f64(&b[n]);
+        cv = vld2q_f64(&c[n]);
+        dv.val[0] = vfmsq_f64(vmulq_f64(bv.val[0], cv.val[0]),
+                              bv.val[1], cv.val[1]);
+        dv.val[1] = vfmaq_f64(vmulq_f64(bv.val[0], cv.val[1]),
+                              bv.val[1], cv.val[0]);
+        vst2q_f64(&d[n], dv);
+    }
+}
+
+void
+convolver_neon_complex_convolve_sumd(void *input_cbufs[],
+                                     void *coeffs[],
+                                     int n_pairs,
+                                     void *output_cbuf,
+                                     int loop_counter)
+{
+    double **b = (double **)input_cbufs;
+    double **c = (double **)coeffs;
+    double *d = (double *)output_cbuf;
+    float64x2x2_t bv, cv, d0, d1;
+    int n, p;
+
+    for (n = 0; n < loop_counter << 3; n += 8) {
+        d0.val[0] = d0.val[1] = d1.val[0] = d1.val[1] = vdupq_n_f64(0);
+        for (p = 0; p < n_pairs; p++) {
+            bv = vld2q_f64(&b[p][n+0]);
+            cv = vld2q_f64(&c[p][n+0]);
+            d0.val[0] = vfmsq_f64(vfmaq_f64(d0.val[0], bv.val[0], cv.val[0]),
+                                  bv.val[1], cv.val[1]);
+            d0.val[1] = vfmaq_f64(vfmaq_f64(d0.val[1], bv.val[0], cv.val[1]),
+                                  bv.val[1], cv.val[0]);
+            bv = vld2q_f64(&b[p][n+4]);
+            cv = vld2q_f64(&c[p][n+4]);
+            d1.val[0] = vfmsq_f64(vfmaq_f64(d1.val[0], bv.val[0], cv.val[0]),
+                                  bv.val[1], cv.val[1]);
+            d1.val[1] = vfmaq_f64(vfmaq_f64(d1.val[1], bv.val[0], cv.val[1]),
+                                  bv.val[1], cv.val[0]);
+        }
+        vst2q_f64(&d[n+0], d0);
+        vst2q_f64(&d[n+4], d1);
+    }
+}
+
+/*
+ * Float versions of the convolve sums which accumulate in double precision.
+ * The real and imaginary parts are widened to doubles when loaded, with
+ * vld2q in the complex layout.
+ */
+
+static inline void
+cmul_add_mixedf(float32x4_t bre,
+                float32x4_t bim,
+                float32x4_t cre,
+                float32x4_t cim,
+                float64x2_t acc[4])
+{
+    float64x2_t br, bi, cr, ci;
+
+    br = vcvt_f64_f32(vget_low_f32(bre));
+    bi = vcvt_f64_f32(vget_low_f32(bim));
+    cr = vcvt_f64_f32(vget_low_f32(cre));
+    ci = vcvt_f64_f32(vget_low_f32(cim));
+    acc[0] = vfmsq_f64(vfmaq_f64(acc[0], br, cr), bi, ci);
+    acc[1] = vfmaq_f64(vfmaq_f64(acc[1], br, ci), bi, cr);
+    br = vcvt_high_f64_f32(bre);
+    bi = vcvt_high_f64_f32(bim);
+    cr = vcvt_high_f64_f32(cre);
+    ci = vcvt_high_f64_f32(cim);
+    acc[2] = vfmsq_f64(vfmaq_f64(acc[2], br, cr), bi, ci);
+    acc[3] = vfmaq_f64(vfmaq_f64(acc[3], br, ci), bi, cr);
+}
+
+void
+convolver_neon_convolve_sum_mixedf(void *input_cbufs[],
+                                   void *coeffs[],
+                                   int n_pairs,
+                                   void *output_cbuf,
+                                   int loop_counter)
+{
+    float **b = (float **)input_cbufs;
+    float **c = (float **)coeffs;
+    float *d = (float *)output_cbuf;
+    float64x2_t acc[4];
+    double d1s, d2s;
+    int n, p;
+
+    d1s = d2s = 0;
+    for (p = 0; p < n_pairs; p++) {
+        d1s += (double)b[p][0] * (double)c[p][0];
+        d2s += (double)b[p][4] * (double)c[p][4];
+    }
+    for (n = 0; n < loop_counter << 3; n += 8) {
+        acc[0] = acc[1] = acc[2] = acc[3] = vdupq_n_f64(0);
+        for (p = 0; p < n_pairs; p++) {
+            cmul_add_mixedf(vld1q_f32(&b[p][n+0]), vld1q_f32(&b[p][n+4]),
+                            vld1q_f32(&c[p][n+0]), vld1q_f32(&c[p][n+4]),
+                            acc);
+        }
+        vst1q_f32(&d[n+0], vcvt_high_f32_f64(vcvt_f32_f64(acc[0]), acc[2]));
+        vst1q_f32(&d[n+4], vcvt_high_f32_f64(vcvt_f32_f64(acc[1]), acc[3]));
+    }
+    d[0] = (float)d1s;
+    d[4] = (float)d2s;
+}
+
+void
+convolver_neon_complex_convolve_sum_mixedf(void *input_cbufs[],
+                                           void *coeffs[],
+                                           int n_pairs,
+                                           void *output_cbuf,
+                                           int loop_counter)
+{
+    float **b = (float **)input_cbufs;
+    float **c = (float **)coeffs;
+    float *d = (float *)output_cbuf;
+    float32x4x2_t bv, cv, dv;
+    float64x2_t acc[4];
+    int n, p;
+
+    for (n = 0; n < loop_counter << 3; n += 8) {
+        acc[0] = acc[1] = acc[2] = acc[3] = vdupq_n_f64(0);
+        for (p = 0; p < n_pairs; p++) {
+            bv = vld2q_f32(&b[p][n]);
+            cv = vld2q_f32(&c[p][n]);
+            cmul_add_mixedf(bv.val[0], bv.val[1], cv.val[0], cv.val[1], acc);
+        }
+        dv.val[0] = vcvt_high_f32_f64(vcvt_f32_f64(acc[0]), acc[2]);
+        dv.val[1] = vcvt_high_f32_f64(vcvt_f32_f64(acc[1]), acc[3]);
+        vst2q_f32(&d[n], dv);
+    }
+}
+
+void
+convolver_neon_widen_fp16f(void *input,
+                           void *output,
+                           double scale,
+                           int loop_counter)
+{
+    uint16_t *h = (uint16_t *)input;
+    float *d = (float *)output;
+    float s = (float)scale;
+    int n;
+
+    for (n = 0; n < loop_counter << 3; n += 4) {
+        vst1q_f32(&d[n], vmulq_n_f32(vcvt_f32_f16(vreinterpret_f16_u16(
+            vld1_u16(&h[n]))), s));
+    }
+}
+
+void
+convolver_neon_widen_bf16f(void *input,
+                           void *output,
+                           double scale,
+                           int loop_counter)
+{
+    uint16_t *h = (uint16_t *)input;
+    float *d = (float *)output;
+    float s = (float)scale;
+    int n;
+
+    for (n = 0; n < loop_counter << 3; n += 4) {
+        vst1q_f32(&d[n], vmulq_n_f32(vreinterpretq_f32_u32(
+            vshll_n_u16(vld1_u16(&h[n]), 16)), s));
+    }
+}
+
+/*
+ * Time-domain convolution for the direct filters, 16 (float) or 8 (double)
+ * outputs at a time, with the rest done by the plain C loops at the end.
+ */
+void
+convolver_neon_direct_convolvef(void *input,
+                                void *coeffs,
+                                int n_taps,
+                                void *output,
+                                int n_samples)
+{
+    float *x = (float *)input;
+    float *h = (float *)coeffs;
+    float *y = (float *)output;
+    float32x4_t d0, d1, d2, d3;
+    float a;
+    int n, i;
+
+    for (n = 0; n + 16 <= n_samples; n += 16) {
+        d0 = d1 = d2 = d3 = vdupq_n_f32(0);
+        for (i = 0; i < n_taps; i++) {
+            d0 = vfmaq_n_f32(d0, vld1q_f32(&x[n-i+0]), h[i]);
+            d1 = vfmaq_n_f32(d1, vld1q_f32(&x[n-i+4]), h[i]);
+            d2 = vfmaq_n_f32(d2, vld1q_f32(&x[n-i+8]), h[i]);
+            d3 = vfmaq_n_f32(d3, vld1q_f32(&x[n-i+12]), h[i]);
+        }
+        vst1q_f32(&y[n+0], d0);
+        vst1q_f32(&y[n+4], d1);
+        vst1q_f32(&y[n+8], d2);
+        vst1q_f32(&y[n+12], d3);
+    }
+    for (; n < n_samples; n++) {
+        a = 0;
+        for (i = 0; i < n_taps; i++) {
+            a += h[i] * x[n-i];
+        }
+        y[n] = a;
+    }
+}
+
+void
+convolver_neon_direct_convolved(void *input,
+                                void *coeffs,
+                                int n_taps,
+                                void *output,
+                                int n_samples)
+{
+    double *x = (double *)input;
+    double *h = (double *)coeffs;
+    double *y = (double *)output;
+    float64x2_t d0, d1, d2, d3;
+    double a;
+    int n, i;
+
+    for (n = 0; n + 8 <= n_samples; n += 8) {
+        d0 = d1 = d2 = d3 = vdupq_n_f64(0);
+        for (i = 0; i < n_taps; i++) {
+            d0 = vfmaq_n_f64(d0, vld1q_f64(&x[n-i+0]), h[i]);
+            d1 = vfmaq_n_f64(d1, vld1q_f64(&x[n-i+2]), h[i]);
+            d2 = vfmaq_n_f64(d2, vld1q_f64(&x[n-i+4]), h[i]);
+            d3 = vfmaq_n_f64(d3, vld1q_f64(&x[n-i+6]), h[i]);
+        }
+        vst1q_f64(&y[n+0], d0);
+        vst1q_f64(&y[n+2], d1);
+        vst1q_f64(&y[n+4], d2);
+        vst1q_f64(&y[n+6], d3);
+    }
+    for (; n < n_samples; n++) {
+        a = 0;
+        for (i = 0; i < n_taps; i++) {
+            a += h[i] * x[n-i];
+        }
+        y[n] = a;
+    }
+}
+
+/*
+ * Sample conversion to and from the float internal format, for native byte
+ * order 16 and 32 bit integers and 32 bit floats. The functions return the
+ * number of samples converted, the caller converts the rest with the
+ * generic code. Zero is returned for formats not handled here.
+ */
+
+int
+convolver_neon_raw2realf(void *realbuf,
+                         void *rawbuf,
+                         int bytes,
+                         int isfloat,
+                         int spacing,
+                         int n_samples)
+{
+    float *r = (float *)realbuf;
+    int n;
+
+    if (spacing > 2 || (isfloat && bytes != 4)) {
+        return 0;
+    }
+    /* with spacing 2 the last load would read one sample too far */
+    n_samples = (spacing == 1 ? n_samples : n_samples - 1) & ~7;
+    switch (bytes) {
+    case 2: {
+        int16_t *s = (int16_t *)rawbuf;
+        int16x8_t x;
+
+        for (n = 0; n < n_samples; n += 8) {
+            x = spacing == 1 ? vld1q_s16(&s[n]) : vld2q_s16(&s[n<<1]).val[0];
+            vst1q_f32(&r[n+0], vcvtq_f32_s32(vmovl_s16(vget_low_s16(x))));
+            vst1q_f32(&r[n+4], vcvtq_f32_s32(vmovl_high_s16(x)));
+        }
+        break;
+    }
+    case 4:
+        if (isfloat) {
+            float *s = (float *)rawbuf;
+
+            for (n = 0; n < n_samples; n += 4) {
+                vst1q_f32(&r[n], spacing == 1 ? vld1q_f32(&s[n]) :
+                          vld2q_f32(&s[n<<1]).val[0]);
+            }
+        } else {
+            int32_t *s = (int32_t *)rawbuf;
+
+            for (n = 0; n < n_samples; n += 4) {
+                vst1q_f32(&r[n], vcvtq_f32_s32
+                          (spacing == 1 ? vld1q_s32(&s[n]) :
+                           vld2q_s32(&s[n<<1]).val[0]));
+            }
+        }
+        break;
+    default:
+        return 0;
+    }
+    return n_samples;
+}
+
+/* Same rounding and clipping as dither_funs.h without dither. The
+   conversion stops at the first group of four samples which contains a
+   sample to be clipped or a sample exceeding 'limit' (or NaN/Inf), so the
+   generic code can deal with overflow counting and errors. */
+int
+convolver_neon_real2rawf(void *rawbuf,
+                         void *realbuf,
+                         int bits,
+                         int bytes,
+                         int spacing,
+                         int n_samples,
+                         double limit,
+                         int32_t *intlargest)
+{
+    const float64x2_t half = vdupq_n_f64(0.5);
+    const float64x2_t lim = vdupq_n_f64(limit);
+    const float64x2_t rmin = vdupq_n_f64(-(double)((uint64_t)1 << (bits - 1)));
+    const float64x2_t rmax =
+        vdupq_n_f64((double)(((uint64_t)1 << (bits - 1)) - 1));
+    float *r = (float *)realbuf;
+    float32x4_t x;
+    float64x2_t lo, hi;
+    uint64x2_t ok;
+    int64x2_t slo, shi;
+    int32x4_t s, largest;
+    int32_t tmp[4];
+    int n, i;
+
+    if (bytes != 2 && bytes != 4) {
+        return 0;
+    }
+    largest = vdupq_n_s32(0);
+    for (n = 0; n < (n_samples & ~3); n += 4) {
+        x = vld1q_f32(&r[n]);
+        lo = vcvt_f64_f32(vget_low_f32(x));
+        hi = vcvt_high_f64_f32(x);
+        ok = vandq_u64(vcaleq_f64(lo, lim), vcaleq_f64(hi, lim));
+        lo = vaddq_f64(lo, half);
+        hi = vaddq_f64(hi, half);
+        ok = vandq_u64(ok, vandq_u64(vcgtq_f64(lo, rmin), vcleq_f64(lo, rmax)));
+        ok = vandq_u64(ok, vandq_u64(vcgtq_f64(hi, rmin), vcleq_f64(hi, rmax)));
+        if (vminvq_u32(vreinterpretq_u32_u64(ok)) == 0) {
+            break;
+        }
+        /* truncate, and one step down for negative values */
+        slo = vaddq_s64(vcvtq_s64_f64(lo),
+                        vreinterpretq_s64_u64(vcltzq_f64(lo)));
+        shi = vaddq_s64(vcvtq_s64_f64(hi),
+                        vreinterpretq_s64_u64(vcltzq_f64(hi)));
+        s = vcombine_s32(vmovn_s64(slo), vmovn_s64(shi));
+        largest = vmaxq_s32(largest, vabsq_s32(s));
+        if (spacing == 1) {
+            if (bytes == 2) {
+                vst1_s16(&((int16_t *)rawbuf)[n], vmovn_s32(s));
+            } else {
+                vst1q_s32(&((int32_t *)rawbuf)[n], s);
+            }
+        } else {
+            vst1q_s32(tmp, s);
+            for (i = 0; i < 4; i++) {
+                if (bytes == 2) {
+                    ((int16_t *)rawbuf)[(n + i) * spacing] = (int16_t)tmp[i];
+                } else {
+                    ((int32_t *)rawbuf)[(n + i) * spacing] = tmp[i];
+                }
+            }
+        }
+    }
+    if (vmaxvq_s32(largest) > *intlargest) {
+        *intlargest = vmaxvq_s32(largest);
+    }
+    return n;
+}
@@ -1397,7 +1397,7 @@ dai_input(volatile struct debug_input dbg[],
 }
 
 void
-dai_output(bool_t iodelay_fill,
+dai_output(int iodelay_fill,
            int synch_fd,
            volatile struct debug_output dbg[],
            int dbg_len,
@@ -1451,6 +1451,16 @@ dai_output(bool_t iodelay_fill,
     if (iodelay_fill) {
         memcpy(&wfds, &clocked_wfds, sizeof(fd_set));
         devsleft = n_clocked_devs;
+        /* a shorter fill is taken from the end of the silent buffer */
+        if (iodelay_fill < period_size) {
+            for (n = 0; n < n_devs[OUT]; n++) {
+                sd = dev[OUT][n];
+                if (!sd->uses_callback && FD_ISSET(sd->fd, &clocked_wfds)) {
+                    sd->buf_left = iodelay_fill * sd->channels.sf.bytes *
+                        sd->channels.open_channels;
+                }
+            }
+        }
     } else {
         devsleft = n_fd_devs[OUT];
         memcpy(&wfds, &dev_fds[OUT], sizeof(fd_set));
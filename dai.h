@@ -135,9 +135,11 @@ dai_input(volatile struct debug_input dbg[],
 
 /*
  * Always full fragment size. Buffer area not filled with samples must be zero.
+ * If 'iodelay_fill' is non-zero, that many frames of silence (at most a
+ * fragment) are written to the clocked devices instead.
  */
 void
-dai_output(bool_t iodelay_fill,
+dai_output(int iodelay_fill,
            int synch_fd,
            volatile struct debug_output dbg[],
            int dbg_len,
@@ -0,0 +1,212 @@
+/*
+ * (c) Copyright 2026 -- Anders Torger
+ *
+ * This program is open source. For license terms, see the LICENSE file.
+ *
+ */
+#include "defs.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include "fft_radix4.h"
+#include "emalloc.h"
+#include "log2.h"
+
+struct radix4_plan {
+    int length;
+    int realsize;
+    bool_t invert;
+    /* e^(-2 pi i n / (length / 2)) and e^(-2 pi i n / length) for n below
+       length / 2, real parts followed by imaginary parts */
+    void *twiddles;
+    void *rtwiddles;
+    /* the second and third twiddle of each butterfly of the first stage,
+       which the vectorised stage loads as they are */
+    void *stwiddles;
+};
+
+/* Two complex buffers of length / 2 in split format for the transforms. They
+   are per thread so a plan can be executed by several threads at once, like
+   FFTW's, and grow to the largest length executed. That is usually when the
+   plans are benchmarked at startup, before the filter processes are made. */
+static __thread void *thread_work = NULL;
+static __thread int thread_work_size = 0;
+
+static void *
+get_work(int size)
+{
+    if (size > thread_work_size) {
+        efree(thread_work);
+        thread_work = emallocaligned(size);
+        thread_work_size = size;
+    }
+    return thread_work;
+}
+
+/* The butterflies are done on a vector of reals at a time where there are
+   SSE or SSE2 instructions, otherwise in plain C. */
+#ifdef __SSE__
+#include <xmmintrin.h>
+#define vec_t __m128
+#define VLEN 4
+#define VLOAD(p) _mm_loadu_ps(p)
+#define VSTORE(p, v) _mm_storeu_ps(p, v)
+#define VSET1(x) _mm_set1_ps(x)
+#define VADD(a, b) _mm_add_ps(a, b)
+#define VSUB(a, b) _mm_sub_ps(a, b)
+#define VMUL(a, b) _mm_mul_ps(a, b)
+#define VREVERSE(v) _mm_shuffle_ps(v, v, _MM_SHUFFLE(0, 1, 2, 3))
+/* load a0 b0 a1 b1 ... into a and b */
+#define VLOAD_DEINTERLEAVE2(p, a, b)                                         \
+    do {                                                                     \
+        __m128 _x = _mm_loadu_ps(&(p)[0]), _y = _mm_loadu_ps(&(p)[4]);       \
+        a = _mm_shuffle_ps(_x, _y, _MM_SHUFFLE(2, 0, 2, 0));                 \
+        b = _mm_shuffle_ps(_x, _y, _MM_SHUFFLE(3, 1, 3, 1));                 \
+    } while (0)
+/* store a0 b0 a1 b1 ... */
+#define VSTORE_INTERLEAVE2(p, a, b)                                          \
+    do {                                                                     \
+        _mm_storeu_ps(&(p)[0], _mm_unpacklo_ps(a, b));                       \
+        _mm_storeu_ps(&(p)[4], _mm_unpackhi_ps(a, b));                       \
+    } while (0)
+/* store a0 b0 c0 d0 a1 b1 c1 d1 ... */
+#define VSTORE_INTERLEAVE4(p, a, b, c, d)                                    \
+    do {                                                                     \
+        _MM_TRANSPOSE4_PS(a, b, c, d);                                       \
+        _mm_storeu_ps(&(p)[0], a);                                           \
+        _mm_storeu_ps(&(p)[4], b);                                           \
+        _mm_storeu_ps(&(p)[8], c);                                           \
+        _mm_storeu_ps(&(p)[12], d);                                          \
+    } while (0)
+#endif
+#define real_t float
+#define TWIDDLES_NAME twiddlesf
+#define VBUTTERFLY_NAME vbutterflyf
+#define CFFT_NAME cfftf
+#define EXECUTE_NAME executef
+#include "fft_radix4funs.h"
+#undef real_t
+#undef TWIDDLES_NAME
+#undef VBUTTERFLY_NAME
+#undef CFFT_NAME
+#undef EXECUTE_NAME
+#undef vec_t
+#undef VLEN
+#undef VLOAD
+#undef VSTORE
+#undef VSET1
+#undef VADD
+#undef VSUB
+#undef VMUL
+#undef VREVERSE
+#undef VLOAD_DEINTERLEAVE2
+#undef VSTORE_INTERLEAVE2
+#undef VSTORE_INTERLEAVE4
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#define vec_t __m128d
+#define VLEN 2
+#define VLOAD(p) _mm_loadu_pd(p)
+#define VSTORE(p, v) _mm_storeu_pd(p, v)
+#define VSET1(x) _mm_set1_pd(x)
+#define VADD(a, b) _mm_add_pd(a, b)
+#define VSUB(a, b) _mm_sub_pd(a, b)
+#define VMUL(a, b) _mm_mul_pd(a, b)
+#define VREVERSE(v) _mm_shuffle_pd(v, v, 1)
+#define VLOAD_DEINTERLEAVE2(p, a, b)                                         \
+    do {                                                                     \
+        __m128d _x = _mm_loadu_pd(&(p)[0]), _y = _mm_loadu_pd(&(p)[2]);      \
+        a = _mm_unpacklo_pd(_x, _y);                                         \
+        b = _mm_unpackhi_pd(_x, _y);                                         \
+    } while (0)
+#define VSTORE_INTERLEAVE2(p, a, b)                                          \
+    do {                                                                     \
+        _mm_storeu_pd(&(p)[0], _mm_unpacklo_pd(a, b));                       \
+        _mm_storeu_pd(&(p)[2], _mm_unpackhi_pd(a, b));                       \
+    } while (0)
+#define VSTORE_INTERLEAVE4(p, a, b, c, d)                                    \
+    do {                                                                     \
+        _mm_storeu_pd(&(p)[0], _mm_unpacklo_pd(a, b));                       \
+        _mm_storeu_pd(&(p)[2], _mm_unpacklo_pd(c, d));                       \
+        _mm_storeu_pd(&(p)[4], _mm_unpackhi_pd(a, b));                       \
+        _mm_storeu_pd(&(p)[6], _mm_unpackhi_pd(c, d));                       \
+    } while (0)
+#endif
+#define real_t double
+#define TWIDDLES_NAME twiddlesd
+#define VBUTTERFLY_NAME vbutterflyd
+#define CFFT_NAME cfftd
+#define EXECUTE_NAME executed
+#include "fft_radix4funs.h"
+#undef real_t
+#undef TWIDDLES_NAME
+#undef VBUTTERFLY_NAME
+#undef CFFT_NAME
+#undef EXECUTE_NAME
+#undef vec_t
+#undef VLEN
+#undef VLOAD
+#undef VSTORE
+#undef VSET1
+#undef VADD
+#undef VSUB
+#undef VMUL
+#undef VREVERSE
+#undef VLOAD_DEINTERLEAVE2
+#undef VSTORE_INTERLEAVE2
+#undef VSTORE_INTERLEAVE4
+
+void *
+fft_radix4_plan(int length,
+                bool_t invert,
+                int realsize)
+{
+    struct radix4_plan *p;
+
+    if (length < 2 || log2_get(length) == -1) {
+        return NULL;
+    }
+    p = emalloc(sizeof(struct radix4_plan));
+    p->length = length;
+    p->realsize = realsize;
+    p->invert = invert;
+    p->twiddles = emallocaligned(length * realsize);
+    p->rtwiddles = emallocaligned(length * realsize);
+    p->stwiddles = emallocaligned(length * realsize);
+    if (realsize == 4) {
+        twiddlesf(p);
+    } else {
+        twiddlesd(p);
+    }
+    return p;
+}
+
+void
+fft_radix4_execute(void *plan,
+                   void *input,
+                   void *output)
+{
+    struct radix4_plan *p = (struct radix4_plan *)plan;
+
+    void *w = get_work(2 * p->length * p->realsize);
+
+    if (p->realsize == 4) {
+        executef(p, (const float *)input, (float *)output, w);
+    } else {
+        executed(p, (const double *)input, (double *)output, w);
+    }
+}
+
+void
+fft_radix4_destroy(void *plan)
+{
+    struct radix4_plan *p = (struct radix4_plan *)plan;
+
+    efree(p->twiddles);
+    efree(p->rtwiddles);
+    efree(p->stwiddles);
+    efree(p);
+}
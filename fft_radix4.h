@@ -0,0 +1,37 @@
+/*
+ * (c) Copyright 2026 -- Anders Torger
+ *
+ * This program is open source. For license terms, see the LICENSE file.
+ *
+ */
+#ifndef _FFT_RADIX4_H_
+#define _FFT_RADIX4_H_
+
+#include "defs.h"
+
+/*
+ * Built-in FFT for power of two lengths, an alternative to FFTW for small
+ * sizes where FFTW's call overhead dominates. The transforms have the same
+ * format as FFTW's r2r transforms: the forward transform (R2HC) gives the
+ * spectrum in halfcomplex order, and the inverse (HC2R) takes it back. Neither
+ * is normalised. The input and output buffers may be the same, and a plan may
+ * be executed by several threads at once. The butterflies use SSE/SSE2 where
+ * available.
+ */
+
+/* Create a plan for 'length' reals of 'realsize' bytes, NULL if the length
+   is not a power of two of at least 2. */
+void *
+fft_radix4_plan(int length,
+                bool_t invert,
+                int realsize);
+
+void
+fft_radix4_execute(void *plan,
+                   void *input,
+                   void *output);
+
+void
+fft_radix4_destroy(void *plan);
+
+#endif
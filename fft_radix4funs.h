@@ -0,0 +1,349 @@
+/*
+ * (c) Copyright 2026 -- Anders Torger
+ *
+ * This program is open source. For license terms, see the LICENSE file.
+ *
+ */
+static void
+TWIDDLES_NAME(struct radix4_plan *p)
+{
+    real_t *tw = (real_t *)p->twiddles, *rtw = (real_t *)p->rtwiddles;
+    real_t *stw = (real_t *)p->stwiddles;
+    int m = p->length >> 1, m4 = m >> 2, n;
+
+    for (n = 0; n < m; n++) {
+        tw[n] = (real_t)cos(2.0 * M_PI * (double)n / (double)m);
+        tw[m + n] = (real_t)-sin(2.0 * M_PI * (double)n / (double)m);
+        rtw[n] = (real_t)cos(M_PI * (double)n / (double)m);
+        rtw[m + n] = (real_t)-sin(M_PI * (double)n / (double)m);
+    }
+    for (n = 0; n < m4; n++) {
+        stw[n] = tw[2 * n];
+        stw[m4 + n] = tw[m + 2 * n];
+        stw[2 * m4 + n] = tw[3 * n];
+        stw[3 * m4 + n] = tw[m + 3 * n];
+    }
+}
+
+#ifdef VLEN
+/* A radix-4 butterfly on VLEN lanes, 'x' and 'y' are the real and imaginary
+   parts of a, b, c, d and of the four outputs, 'w' those of the twiddles of
+   the last three outputs. */
+static inline void
+VBUTTERFLY_NAME(const vec_t x[8],
+                const vec_t w[6],
+                vec_t y[8])
+{
+    vec_t apcr, apci, amcr, amci, bpdr, bpdi, bmdr, bmdi, tr, ti;
+
+    apcr = VADD(x[0], x[4]);
+    apci = VADD(x[1], x[5]);
+    amcr = VSUB(x[0], x[4]);
+    amci = VSUB(x[1], x[5]);
+    bpdr = VADD(x[2], x[6]);
+    bpdi = VADD(x[3], x[7]);
+    bmdr = VSUB(x[2], x[6]);
+    bmdi = VSUB(x[3], x[7]);
+    y[0] = VADD(apcr, bpdr);
+    y[1] = VADD(apci, bpdi);
+    tr = VADD(amcr, bmdi);
+    ti = VSUB(amci, bmdr);
+    y[2] = VSUB(VMUL(tr, w[0]), VMUL(ti, w[1]));
+    y[3] = VADD(VMUL(tr, w[1]), VMUL(ti, w[0]));
+    tr = VSUB(apcr, bpdr);
+    ti = VSUB(apci, bpdi);
+    y[4] = VSUB(VMUL(tr, w[2]), VMUL(ti, w[3]));
+    y[5] = VADD(VMUL(tr, w[3]), VMUL(ti, w[2]));
+    tr = VSUB(amcr, bmdi);
+    ti = VADD(amci, bmdr);
+    y[6] = VSUB(VMUL(tr, w[4]), VMUL(ti, w[5]));
+    y[7] = VADD(VMUL(tr, w[5]), VMUL(ti, w[4]));
+}
+#endif
+
+/* Forward complex FFT of 'm' points in split format (real parts in re[0],
+   imaginary in im[0]), Stockham autosort radix-4 stages ending with a radix-2
+   stage if the order is odd. The buffers re[1] and im[1] are used for the
+   stages in between, and the index of the buffers holding the result is
+   returned. With vectors, the first stage is vectorised over the butterflies
+   and the others over their contiguous inner loop. */
+static int
+CFFT_NAME(int m,
+          const real_t tw[],
+          const real_t stw[],
+          real_t *re[2],
+          real_t *im[2])
+{
+    const real_t *ar, *ai, *br, *bi, *cr, *ci, *dr, *di;
+    real_t *y0r, *y0i, *y1r, *y1i, *y2r, *y2i, *y3r, *y3i;
+    real_t w1r, w1i, w2r, w2i, w3r, w3i;
+    real_t apcr, apci, amcr, amci, bpdr, bpdi, bmdr, bmdi, tr, ti;
+    int n, n4, s, p, q, step, cur = 0;
+#ifdef VLEN
+    vec_t vx[8], vw[6], vy[8];
+    int k;
+#endif
+
+    for (n = m, s = 1; n >= 4; n >>= 2, s <<= 2) {
+        n4 = n >> 2;
+        step = m / n;
+#ifdef VLEN
+        if (s == 1 && n4 >= VLEN) {
+            for (p = 0; p < n4; p += VLEN) {
+                for (k = 0; k < 4; k++) {
+                    vx[k << 1] = VLOAD(&re[cur][k * n4 + p]);
+                    vx[(k << 1) + 1] = VLOAD(&im[cur][k * n4 + p]);
+                }
+                vw[0] = VLOAD(&tw[p]);
+                vw[1] = VLOAD(&tw[m + p]);
+                for (k = 0; k < 4; k++) {
+                    vw[k + 2] = VLOAD(&stw[k * n4 + p]);
+                }
+                VBUTTERFLY_NAME(vx, vw, vy);
+                VSTORE_INTERLEAVE4(&re[!cur][4 * p],
+                                   vy[0], vy[2], vy[4], vy[6]);
+                VSTORE_INTERLEAVE4(&im[!cur][4 * p],
+                                   vy[1], vy[3], vy[5], vy[7]);
+            }
+            cur = !cur;
+            continue;
+        }
+        if (s >= VLEN) {
+            for (p = 0; p < n4; p++) {
+                vw[0] = VSET1(tw[p * step]);
+                vw[1] = VSET1(tw[m + p * step]);
+                vw[2] = VSET1(tw[2 * p * step]);
+                vw[3] = VSET1(tw[m + 2 * p * step]);
+                vw[4] = VSET1(tw[3 * p * step]);
+                vw[5] = VSET1(tw[m + 3 * p * step]);
+                ar = &re[cur][s * p];
+                ai = &im[cur][s * p];
+                y0r = &re[!cur][s * 4 * p];
+                y0i = &im[!cur][s * 4 * p];
+                for (q = 0; q < s; q += VLEN) {
+                    for (k = 0; k < 4; k++) {
+                        vx[k << 1] = VLOAD(&ar[k * s * n4 + q]);
+                        vx[(k << 1) + 1] = VLOAD(&ai[k * s * n4 + q]);
+                    }
+                    VBUTTERFLY_NAME(vx, vw, vy);
+                    for (k = 0; k < 4; k++) {
+                        VSTORE(&y0r[k * s + q], vy[k << 1]);
+                        VSTORE(&y0i[k * s + q], vy[(k << 1) + 1]);
+                    }
+                }
+            }
+            cur = !cur;
+            continue;
+        }
+#endif
+        for (p = 0; p < n4; p++) {
+            w1r = tw[p * step];
+            w1i = tw[m + p * step];
+            w2r = tw[2 * p * step];
+            w2i = tw[m + 2 * p * step];
+            w3r = tw[3 * p * step];
+            w3i = tw[m + 3 * p * step];
+            ar = &re[cur][s * p];
+            ai = &im[cur][s * p];
+            br = &ar[s * n4];
+            bi = &ai[s * n4];
+            cr = &br[s * n4];
+            ci = &bi[s * n4];
+            dr = &cr[s * n4];
+            di = &ci[s * n4];
+            y0r = &re[!cur][s * 4 * p];
+            y0i = &im[!cur][s * 4 * p];
+            y1r = &y0r[s];
+            y1i = &y0i[s];
+            y2r = &y1r[s];
+            y2i = &y1i[s];
+            y3r = &y2r[s];
+            y3i = &y2i[s];
+            /* the inner loop runs over contiguous data, for vectorisation */
+            for (q = 0; q < s; q++) {
+                apcr = ar[q] + cr[q];
+                apci = ai[q] + ci[q];
+                amcr = ar[q] - cr[q];
+                amci = ai[q] - ci[q];
+                bpdr = br[q] + dr[q];
+                bpdi = bi[q] + di[q];
+                bmdr = br[q] - dr[q];
+                bmdi = bi[q] - di[q];
+                y0r[q] = apcr + bpdr;
+                y0i[q] = apci + bpdi;
+                /* a - c - i(b - d) */
+                tr = amcr + bmdi;
+                ti = amci - bmdr;
+                y1r[q] = tr * w1r - ti * w1i;
+                y1i[q] = tr * w1i + ti * w1r;
+                tr = apcr - bpdr;
+                ti = apci - bpdi;
+                y2r[q] = tr * w2r - ti * w2i;
+                y2i[q] = tr * w2i + ti * w2r;
+                /* a - c + i(b - d) */
+                tr = amcr - bmdi;
+                ti = amci + bmdr;
+                y3r[q] = tr * w3r - ti * w3i;
+                y3i[q] = tr * w3i + ti * w3r;
+            }
+        }
+        cur = !cur;
+    }
+    if (n == 2) {
+        ar = re[cur];
+        ai = im[cur];
+        y0r = re[!cur];
+        y0i = im[!cur];
+        q = 0;
+#ifdef VLEN
+        for (; q + VLEN <= s; q += VLEN) {
+            VSTORE(&y0r[q], VADD(VLOAD(&ar[q]), VLOAD(&ar[s + q])));
+            VSTORE(&y0i[q], VADD(VLOAD(&ai[q]), VLOAD(&ai[s + q])));
+            VSTORE(&y0r[s + q], VSUB(VLOAD(&ar[q]), VLOAD(&ar[s + q])));
+            VSTORE(&y0i[s + q], VSUB(VLOAD(&ai[q]), VLOAD(&ai[s + q])));
+        }
+#endif
+        for (; q < s; q++) {
+            y0r[q] = ar[q] + ar[s + q];
+            y0i[q] = ai[q] + ai[s + q];
+            y0r[s + q] = ar[q] - ar[s + q];
+            y0i[s + q] = ai[q] - ai[s + q];
+        }
+        cur = !cur;
+    }
+    return cur;
+}
+
+/* The real transforms are done as a complex FFT of half the length, with the
+   even samples as real parts and the odd as imaginary parts, and the spectrum
+   split into the even and odd samples' spectra before and after. */
+static void
+EXECUTE_NAME(struct radix4_plan *p,
+             const real_t input[],
+             real_t output[],
+             void *work)
+{
+    const real_t *tw = (const real_t *)p->twiddles;
+    const real_t *rtw = (const real_t *)p->rtwiddles;
+    const real_t *stw = (const real_t *)p->stwiddles;
+    real_t *re[2], *im[2];
+    real_t er, ei, dr, di, odr, odi, wr, wi;
+    int m = p->length >> 1, n, k, cur;
+#ifdef VLEN
+    vec_t vzr, vzi, vcr, vci, ver, vei, vdr, vdi, vor, voi, vwr, vwi;
+    const vec_t half = VSET1((real_t)0.5);
+#endif
+
+    re[0] = (real_t *)work;
+    im[0] = &re[0][m];
+    re[1] = &im[0][m];
+    im[1] = &re[1][m];
+    if (!p->invert) {
+        n = 0;
+#ifdef VLEN
+        for (; n + VLEN <= m; n += VLEN) {
+            VLOAD_DEINTERLEAVE2(&input[n << 1], vzr, vzi);
+            VSTORE(&re[0][n], vzr);
+            VSTORE(&im[0][n], vzi);
+        }
+#endif
+        for (; n < m; n++) {
+            re[0][n] = input[n << 1];
+            im[0][n] = input[(n << 1) + 1];
+        }
+        cur = CFFT_NAME(m, tw, stw, re, im);
+        output[0] = re[cur][0] + im[cur][0];
+        output[m] = re[cur][0] - im[cur][0];
+        k = 1;
+#ifdef VLEN
+        for (; k + VLEN <= m; k += VLEN) {
+            /* Z[k] and Z[m - k] for VLEN values of k */
+            vzr = VLOAD(&re[cur][k]);
+            vzi = VLOAD(&im[cur][k]);
+            vcr = VREVERSE(VLOAD(&re[cur][m - k - VLEN + 1]));
+            vci = VREVERSE(VLOAD(&im[cur][m - k - VLEN + 1]));
+            ver = VMUL(half, VADD(vzr, vcr));
+            vei = VMUL(half, VSUB(vzi, vci));
+            vor = VMUL(half, VADD(vzi, vci));
+            voi = VMUL(half, VSUB(vcr, vzr));
+            vwr = VLOAD(&rtw[k]);
+            vwi = VLOAD(&rtw[m + k]);
+            VSTORE(&output[k],
+                   VADD(ver, VSUB(VMUL(vor, vwr), VMUL(voi, vwi))));
+            VSTORE(&output[p->length - k - VLEN + 1],
+                   VREVERSE(VADD(vei, VADD(VMUL(vor, vwi),
+                                           VMUL(voi, vwr)))));
+        }
+#endif
+        for (; k < m; k++) {
+            /* E = (Z[k] + conj(Z[m-k])) / 2, O = (Z[k] - conj(Z[m-k])) / 2i */
+            er = (real_t)0.5 * (re[cur][k] + re[cur][m - k]);
+            ei = (real_t)0.5 * (im[cur][k] - im[cur][m - k]);
+            odr = (real_t)0.5 * (im[cur][k] + im[cur][m - k]);
+            odi = (real_t)-0.5 * (re[cur][k] - re[cur][m - k]);
+            wr = rtw[k];
+            wi = rtw[m + k];
+            output[k] = er + odr * wr - odi * wi;
+            output[p->length - k] = ei + odr * wi + odi * wr;
+        }
+        return;
+    }
+
+    /* the inverse complex FFT is done as a forward FFT of the conjugate */
+    k = 0;
+#ifdef VLEN
+    er = input[0] + input[m];
+    dr = input[0] - input[m];
+    re[0][0] = er;
+    im[0][0] = -dr;
+    for (k = 1; k + VLEN <= m; k += VLEN) {
+        vzr = VLOAD(&input[k]);
+        vcr = VREVERSE(VLOAD(&input[m - k - VLEN + 1]));
+        vzi = VREVERSE(VLOAD(&input[p->length - k - VLEN + 1]));
+        vci = VLOAD(&input[m + k]);
+        ver = VADD(vzr, vcr);
+        vei = VSUB(vzi, vci);
+        vdr = VSUB(vzr, vcr);
+        vdi = VADD(vzi, vci);
+        vwr = VLOAD(&rtw[k]);
+        vwi = VLOAD(&rtw[m + k]);
+        /* D * conj(W^k) */
+        vor = VADD(VMUL(vdr, vwr), VMUL(vdi, vwi));
+        voi = VSUB(VMUL(vdi, vwr), VMUL(vdr, vwi));
+        VSTORE(&re[0][k], VSUB(ver, voi));
+        VSTORE(&im[0][k], VSUB(VSET1((real_t)0), VADD(vei, vor)));
+    }
+#endif
+    for (; k < m; k++) {
+        if (k == 0) {
+            er = input[0] + input[m];
+            ei = 0;
+            dr = input[0] - input[m];
+            di = 0;
+        } else {
+            er = input[k] + input[m - k];
+            ei = input[p->length - k] - input[m + k];
+            dr = input[k] - input[m - k];
+            di = input[p->length - k] + input[m + k];
+        }
+        /* Z[k] = E + i * D * conj(W^k) */
+        wr = rtw[k];
+        wi = -rtw[m + k];
+        odr = dr * wr - di * wi;
+        odi = dr * wi + di * wr;
+        re[0][k] = er - odi;
+        im[0][k] = -(ei + odr);
+    }
+    cur = CFFT_NAME(m, tw, stw, re, im);
+    n = 0;
+#ifdef VLEN
+    for (; n + VLEN <= m; n += VLEN) {
+        VSTORE_INTERLEAVE2(&output[n << 1], VLOAD(&re[cur][n]),
+                           VSUB(VSET1((real_t)0), VLOAD(&im[cur][n])));
+    }
+#endif
+    for (; n < m; n++) {
+        output[n << 1] = re[cur][n];
+        output[(n << 1) + 1] = -im[cur][n];
+    }
+}
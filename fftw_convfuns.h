@@ -11,486 +11,119 @@ MIXNSCALE_NAME(void *input_cbufs[],
                int n_bufs,
                int mixmode)
 {
-    int n, i;
     real_t sscales[n_bufs], **ibufs = (real_t **)input_cbufs;
     real_t *obuf = (real_t *)output_cbuf;
-    
+    real_t re[4], im[4];
+    bool_t unity = true;
+    int n, i, k;
+
     for (n = 0; n < n_bufs; n++) {
 	sscales[n] = (real_t)scales[n];
-    }    
+        if (scales[n] != 1.0) {
+            unity = false;
+        }
+    }
     switch (mixmode) {
     case CONVOLVER_MIXMODE_INPUT:
-	switch (n_bufs) {
-	case 1:
-	    for (n = 0; n < n_fft >> 1; n += 4) {
-		obuf[(n<<1)+0] = ibufs[0][n+0] * sscales[0];
-		obuf[(n<<1)+1] = ibufs[0][n+1] * sscales[0];
-		obuf[(n<<1)+2] = ibufs[0][n+2] * sscales[0];
-		obuf[(n<<1)+3] = ibufs[0][n+3] * sscales[0];
-	    }
-	    obuf[4] = ibufs[0][n_fft >> 1] * sscales[0];
-	    ibufs[0] = &ibufs[0][n_fft];
-	    obuf[5] = ibufs[0][-1] * sscales[0];
-	    obuf[6] = ibufs[0][-2] * sscales[0];
-	    obuf[7] = ibufs[0][-3] * sscales[0];
-	    for (n = 4; n < n_fft >> 1; n += 4) {
-		obuf[(n<<1)+4] = ibufs[0][-n-0] * sscales[0];
-		obuf[(n<<1)+5] = ibufs[0][-n-1] * sscales[0];
-		obuf[(n<<1)+6] = ibufs[0][-n-2] * sscales[0];
-		obuf[(n<<1)+7] = ibufs[0][-n-3] * sscales[0];
-	    }
-	    ibufs[0] = &ibufs[0][-n_fft];
-	    break;
-	case 2:
-	    for (n = 0; n < n_fft >> 1; n += 4) {
-		obuf[(n<<1)+0] =
-		    ibufs[0][n+0] * sscales[0] +
-		    ibufs[1][n+0] * sscales[1];
-		obuf[(n<<1)+1] =
-		    ibufs[0][n+1] * sscales[0] +
-		    ibufs[1][n+1] * sscales[1];
-		obuf[(n<<1)+2] =
-		    ibufs[0][n+2] * sscales[0] +
-		    ibufs[1][n+2] * sscales[1];
-		obuf[(n<<1)+3] =
-		    ibufs[0][n+3] * sscales[0] +
-		    ibufs[1][n+3] * sscales[1];
-	    }
-	    obuf[4] =
-		ibufs[0][n_fft >> 1] * sscales[0] +
-		ibufs[1][n_fft >> 1] * sscales[1];
-	    ibufs[0] = &ibufs[0][n_fft];
-	    ibufs[1] = &ibufs[1][n_fft];
-	    obuf[5] =
-		ibufs[0][-1] * sscales[0] +
-		ibufs[1][-1] * sscales[1];
-	    obuf[6] =
-		ibufs[0][-2] * sscales[0] +
-		ibufs[1][-2] * sscales[1];
-	    obuf[7] =
-		ibufs[0][-3] * sscales[0] +
-		ibufs[1][-3] * sscales[1];
-	    for (n = 4; n < n_fft >> 1; n += 4) {
-		obuf[(n<<1)+4] =
-		    ibufs[0][-n-0] * sscales[0] +
-		    ibufs[1][-n-0] * sscales[1];
-		obuf[(n<<1)+5] =
-		    ibufs[0][-n-1] * sscales[0] +
-		    ibufs[1][-n-1] * sscales[1];
-		obuf[(n<<1)+6] =
-		    ibufs[0][-n-2] * sscales[0] +
-		    ibufs[1][-n-2] * sscales[1];
-		obuf[(n<<1)+7] =
-		    ibufs[0][-n-3] * sscales[0] +
-		    ibufs[1][-n-3] * sscales[1];
-	    }
-	    ibufs[0] = &ibufs[0][-n_fft];
-	    ibufs[1] = &ibufs[1][-n_fft];
-	    break;
-	case 3:
-	    for (n = 0; n < n_fft >> 1; n += 4) {
-		obuf[(n<<1)+0] =
-		    ibufs[0][n+0] * sscales[0] +
-		    ibufs[1][n+0] * sscales[1] +
-		    ibufs[2][n+0] * sscales[2];
-		obuf[(n<<1)+1] =
-		    ibufs[0][n+1] * sscales[0] +
-		    ibufs[1][n+1] * sscales[1] +
-		    ibufs[2][n+1] * sscales[2];
-		obuf[(n<<1)+2] =
-		    ibufs[0][n+2] * sscales[0] +
-		    ibufs[1][n+2] * sscales[1] +
-		    ibufs[2][n+2] * sscales[2];
-		obuf[(n<<1)+3] =
-		    ibufs[0][n+3] * sscales[0] +
-		    ibufs[1][n+3] * sscales[1] +
-		    ibufs[2][n+3] * sscales[2];
-	    }
-	    obuf[4] =
-		ibufs[0][n_fft >> 1] * sscales[0] +
-		ibufs[1][n_fft >> 1] * sscales[1] +
-		ibufs[2][n_fft >> 1] * sscales[2];
-	    ibufs[0] = &ibufs[0][n_fft];
-	    ibufs[1] = &ibufs[1][n_fft];
-	    ibufs[2] = &ibufs[2][n_fft];
-	    obuf[5] =
-		ibufs[0][-1] * sscales[0] +
-		ibufs[1][-1] * sscales[1] +
-		ibufs[2][-1] * sscales[2];
-	    obuf[6] =
-		ibufs[0][-2] * sscales[0] +
-		ibufs[1][-2] * sscales[1] +
-		ibufs[2][-2] * sscales[2];
-	    obuf[7] =
-		ibufs[0][-3] * sscales[0] +
-		ibufs[1][-3] * sscales[1] +
-		ibufs[2][-3] * sscales[2];
-	    for (n = 4; n < n_fft >> 1; n += 4) {
-		obuf[(n<<1)+4] =
-		    ibufs[0][-n-0] * sscales[0] +
-		    ibufs[1][-n-0] * sscales[1] +
-		    ibufs[2][-n-0] * sscales[2];
-		obuf[(n<<1)+5] =
-		    ibufs[0][-n-1] * sscales[0] +
-		    ibufs[1][-n-1] * sscales[1] +
-		    ibufs[2][-n-1] * sscales[2];
-		obuf[(n<<1)+6] =
-		    ibufs[0][-n-2] * sscales[0] +
-		    ibufs[1][-n-2] * sscales[1] +
-		    ibufs[2][-n-2] * sscales[2];
-		obuf[(n<<1)+7] =
-		    ibufs[0][-n-3] * sscales[0] +
-		    ibufs[1][-n-3] * sscales[1] +
-		    ibufs[2][-n-3] * sscales[2];
-	    }
-	    ibufs[0] = &ibufs[0][-n_fft];
-	    ibufs[1] = &ibufs[1][-n_fft];
-	    ibufs[2] = &ibufs[2][-n_fft];
-	    break;
-	case 4:
-	    for (n = 0; n < n_fft >> 1; n += 4) {
-		obuf[(n<<1)+0] =
-		    ibufs[0][n+0] * sscales[0] +
-		    ibufs[1][n+0] * sscales[1] +
-		    ibufs[2][n+0] * sscales[2] +
-		    ibufs[3][n+0] * sscales[3];
-		obuf[(n<<1)+1] =
-		    ibufs[0][n+1] * sscales[0] +
-		    ibufs[1][n+1] * sscales[1] +
-		    ibufs[2][n+1] * sscales[2] +
-		    ibufs[3][n+1] * sscales[3];
-		obuf[(n<<1)+2] =
-		    ibufs[0][n+2] * sscales[0] +
-		    ibufs[1][n+2] * sscales[1] +
-		    ibufs[2][n+2] * sscales[2] +
-		    ibufs[3][n+2] * sscales[3];
-		obuf[(n<<1)+3] =
-		    ibufs[0][n+3] * sscales[0] +
-		    ibufs[1][n+3] * sscales[1] +
-		    ibufs[2][n+3] * sscales[2] +
-		    ibufs[3][n+3] * sscales[3];
-	    }
-	    obuf[4] =
-		ibufs[0][n_fft >> 1] * sscales[0] +
-		ibufs[1][n_fft >> 1] * sscales[1] +
-		ibufs[2][n_fft >> 1] * sscales[2] +
-		ibufs[3][n_fft >> 1] * sscales[3];
-	    ibufs[0] = &ibufs[0][n_fft];
-	    ibufs[1] = &ibufs[1][n_fft];
-	    ibufs[2] = &ibufs[2][n_fft];
-	    ibufs[3] = &ibufs[3][n_fft];
-	    obuf[5] =
-		ibufs[0][-1] * sscales[0] +
-		ibufs[1][-1] * sscales[1] +
-		ibufs[2][-1] * sscales[2] +
-		ibufs[3][-1] * sscales[3];
-	    obuf[6] =
-		ibufs[0][-2] * sscales[0] +
-		ibufs[1][-2] * sscales[1] +
-		ibufs[2][-2] * sscales[2] +
-		ibufs[3][-2] * sscales[3];
-	    obuf[7] =
-		ibufs[0][-3] * sscales[0] +
-		ibufs[1][-3] * sscales[1] +
-		ibufs[2][-3] * sscales[2] +
-		ibufs[3][-3] * sscales[3];
-	    for (n = 4; n < n_fft >> 1; n += 4) {
-		obuf[(n<<1)+4] =
-		    ibufs[0][-n-0] * sscales[0] +
-		    ibufs[1][-n-0] * sscales[1] +
-		    ibufs[2][-n-0] * sscales[2] +
-		    ibufs[3][-n-0] * sscales[3];
-		obuf[(n<<1)+5] =
-		    ibufs[0][-n-1] * sscales[0] +
-		    ibufs[1][-n-1] * sscales[1] +
-		    ibufs[2][-n-1] * sscales[2] +
-		    ibufs[3][-n-1] * sscales[3];
-		obuf[(n<<1)+6] =
-		    ibufs[0][-n-2] * sscales[0] +
-		    ibufs[1][-n-2] * sscales[1] +
-		    ibufs[2][-n-2] * sscales[2] +
-		    ibufs[3][-n-2] * sscales[3];
-		obuf[(n<<1)+7] =
-		    ibufs[0][-n-3] * sscales[0] +
-		    ibufs[1][-n-3] * sscales[1] +
-		    ibufs[2][-n-3] * sscales[2] +
-		    ibufs[3][-n-3] * sscales[3];
-	    }
-	    ibufs[0] = &ibufs[0][-n_fft];
-	    ibufs[1] = &ibufs[1][-n_fft];
-	    ibufs[2] = &ibufs[2][-n_fft];
-	    ibufs[3] = &ibufs[3][-n_fft];
-	    break;
-	default:
-	    for (n = 0; n < n_fft >> 1; n += 4) {
-		obuf[(n<<1)+0] = ibufs[0][n+0] * sscales[0];
-		obuf[(n<<1)+1] = ibufs[0][n+1] * sscales[0];
-		obuf[(n<<1)+2] = ibufs[0][n+2] * sscales[0];
-		obuf[(n<<1)+3] = ibufs[0][n+3] * sscales[0];
-		for (i = 1; i < n_bufs; i++) {
-		    obuf[(n<<1)+0] += ibufs[i][n+0] * sscales[i];
-		    obuf[(n<<1)+1] += ibufs[i][n+1] * sscales[i];
-		    obuf[(n<<1)+2] += ibufs[i][n+2] * sscales[i];
-		    obuf[(n<<1)+3] += ibufs[i][n+3] * sscales[i];
-		}
-	    }
-	    obuf[4] = ibufs[0][n_fft >> 1] * sscales[0];
-	    ibufs[0] = &ibufs[0][n_fft];
-	    obuf[5] = ibufs[0][-1] * sscales[0];
-	    obuf[6] = ibufs[0][-2] * sscales[0];
-	    obuf[7] = ibufs[0][-3] * sscales[0];
-	    for (i = 1; i < n_bufs; i++) {
-		obuf[4] += ibufs[i][n_fft >> 1] * sscales[i];
-		ibufs[i] = &ibufs[i][n_fft];
-		obuf[5] += ibufs[i][-1] * sscales[i];
-		obuf[6] += ibufs[i][-2] * sscales[i];
-		obuf[7] += ibufs[i][-3] * sscales[i];
-	    }
-	    for (n = 4; n < n_fft >> 1; n += 4) {
-		obuf[(n<<1)+4] = ibufs[0][-n-0] * sscales[0];
-		obuf[(n<<1)+5] = ibufs[0][-n-1] * sscales[0];
-		obuf[(n<<1)+6] = ibufs[0][-n-2] * sscales[0];
-		obuf[(n<<1)+7] = ibufs[0][-n-3] * sscales[0];
-		for (i = 1; i < n_bufs; i++) {
-		    obuf[(n<<1)+4] += ibufs[i][-n-0] * sscales[i];
-		    obuf[(n<<1)+5] += ibufs[i][-n-1] * sscales[i];
-		    obuf[(n<<1)+6] += ibufs[i][-n-2] * sscales[i];
-		    obuf[(n<<1)+7] += ibufs[i][-n-3] * sscales[i];
-		}
-	    }
-	    for (i = 0; i < n_bufs; i++) {
-		ibufs[i] = &ibufs[i][-n_fft];
-	    }
-	    break;
-	}
+    case CONVOLVER_MIXMODE_INPUT_ADD:
+        /* from halfcomplex to internal order, the first imaginary part is
+           replaced with the nyquist frequency */
+        for (k = 0; k < 4; k++) {
+            re[k] = im[k] = 0;
+            for (i = 0; i < n_bufs; i++) {
+                re[k] += ibufs[i][k] * sscales[i];
+                im[k] += ibufs[i][k == 0 ? n_fft >> 1 : n_fft - k] *
+                    sscales[i];
+            }
+        }
+        for (n = 0; n < n_fft >> 1; n += 4) {
+            if (n != 0) {
+                if (n_bufs == 1 && unity) {
+                    /* reordering only */
+                    for (k = 0; k < 4; k++) {
+                        re[k] = ibufs[0][n+k];
+                        im[k] = ibufs[0][n_fft-n-k];
+                    }
+                } else if (unity) {
+                    for (k = 0; k < 4; k++) {
+                        re[k] = im[k] = 0;
+                    }
+                    for (i = 0; i < n_bufs; i++) {
+                        for (k = 0; k < 4; k++) {
+                            re[k] += ibufs[i][n+k];
+                            im[k] += ibufs[i][n_fft-n-k];
+                        }
+                    }
+                } else {
+                    for (k = 0; k < 4; k++) {
+                        re[k] = im[k] = 0;
+                    }
+                    for (i = 0; i < n_bufs; i++) {
+                        for (k = 0; k < 4; k++) {
+                            re[k] += ibufs[i][n+k] * sscales[i];
+                            im[k] += ibufs[i][n_fft-n-k] * sscales[i];
+                        }
+                    }
+                }
+            }
+            if (mixmode == CONVOLVER_MIXMODE_INPUT_ADD) {
+                for (k = 0; k < 4; k++) {
+                    obuf[(n<<1)+k+0] += re[k];
+                    obuf[(n<<1)+k+4] += im[k];
+                }
+            } else {
+                for (k = 0; k < 4; k++) {
+                    obuf[(n<<1)+k+0] = re[k];
+                    obuf[(n<<1)+k+4] = im[k];
+                }
+            }
+        }
 	break;
 	
     case CONVOLVER_MIXMODE_OUTPUT:
-	switch (n_bufs) {
-	case 1:
-	    for (n = 0; n < n_fft >> 1; n += 4) {
-		obuf[n+0] = ibufs[0][(n<<1)+0] * sscales[0];
-		obuf[n+1] = ibufs[0][(n<<1)+1] * sscales[0];
-		obuf[n+2] = ibufs[0][(n<<1)+2] * sscales[0];
-		obuf[n+3] = ibufs[0][(n<<1)+3] * sscales[0];
-	    }
-	    obuf[n_fft >> 1] = ibufs[0][4] * sscales[0];
-	    obuf = &obuf[n_fft];
-	    obuf[-1] = ibufs[0][5] * sscales[0];
-	    obuf[-2] = ibufs[0][6] * sscales[0];
-	    obuf[-3] = ibufs[0][7] * sscales[0];
-	    for (n = 4; n < n_fft >> 1; n += 4) {
-		obuf[-n-0] = ibufs[0][(n<<1)+4] * sscales[0];
-		obuf[-n-1] = ibufs[0][(n<<1)+5] * sscales[0];
-		obuf[-n-2] = ibufs[0][(n<<1)+6] * sscales[0];
-		obuf[-n-3] = ibufs[0][(n<<1)+7] * sscales[0];
-	    }
-	    break;
-	case 2:
-	    for (n = 0; n < n_fft >> 1; n += 4) {
-		obuf[n+0] =
-		    ibufs[0][(n<<1)+0] * sscales[0] +
-		    ibufs[1][(n<<1)+0] * sscales[1];
-		obuf[n+1] =
-		    ibufs[0][(n<<1)+1] * sscales[0] +
-		    ibufs[1][(n<<1)+1] * sscales[1];
-		obuf[n+2] =
-		    ibufs[0][(n<<1)+2] * sscales[0] +
-		    ibufs[1][(n<<1)+2] * sscales[1];
-		obuf[n+3] =
-		    ibufs[0][(n<<1)+3] * sscales[0] +
-		    ibufs[1][(n<<1)+3] * sscales[1];
-	    }
-	    obuf[n_fft >> 1] =
-		ibufs[0][4] * sscales[0] +
-		ibufs[1][4] * sscales[1];
-	    obuf = &obuf[n_fft];
-	    obuf[-1] =
-		ibufs[0][5] * sscales[0] +
-		ibufs[1][5] * sscales[1];
-	    obuf[-2] =
-		ibufs[0][6] * sscales[0] +
-		ibufs[1][6] * sscales[1];
-	    obuf[-3] =
-		ibufs[0][7] * sscales[0] +
-		ibufs[1][7] * sscales[1];
-	    for (n = 4; n < n_fft >> 1; n += 4) {
-		obuf[-n-0] =
-		    ibufs[0][(n<<1)+4] * sscales[0] +
-		    ibufs[1][(n<<1)+4] * sscales[1];
-		obuf[-n-1] =
-		    ibufs[0][(n<<1)+5] * sscales[0] +
-		    ibufs[1][(n<<1)+5] * sscales[1];
-		obuf[-n-2] =
-		    ibufs[0][(n<<1)+6] * sscales[0] +
-		    ibufs[1][(n<<1)+6] * sscales[1];
-		obuf[-n-3] =
-		    ibufs[0][(n<<1)+7] * sscales[0] +
-		    ibufs[1][(n<<1)+7] * sscales[1];
-	    }
-	    break;
-	case 3:
-	    for (n = 0; n < n_fft >> 1; n += 4) {
-		obuf[n+0] =
-		    ibufs[0][(n<<1)+0] * sscales[0] +
-		    ibufs[1][(n<<1)+0] * sscales[1] +
-		    ibufs[2][(n<<1)+0] * sscales[2];
-		obuf[n+1] =
-		    ibufs[0][(n<<1)+1] * sscales[0] +
-		    ibufs[1][(n<<1)+1] * sscales[1] +
-		    ibufs[2][(n<<1)+1] * sscales[2];
-		obuf[n+2] =
-		    ibufs[0][(n<<1)+2] * sscales[0] +
-		    ibufs[1][(n<<1)+2] * sscales[1] +
-		    ibufs[2][(n<<1)+2] * sscales[2];
-		obuf[n+3] =
-		    ibufs[0][(n<<1)+3] * sscales[0] +
-		    ibufs[1][(n<<1)+3] * sscales[1] +
-		    ibufs[2][(n<<1)+3] * sscales[2];
-	    }
-	    obuf[n_fft >> 1] =
-		ibufs[0][4] * sscales[0] +
-		ibufs[1][4] * sscales[1] +
-		ibufs[2][4] * sscales[2];
-	    obuf = &obuf[n_fft];
-	    obuf[-1] =
-		ibufs[0][5] * sscales[0] +
-		ibufs[1][5] * sscales[1] +
-		ibufs[2][5] * sscales[2];
-	    obuf[-2] =
-		ibufs[0][6] * sscales[0] +
-		ibufs[1][6] * sscales[1] +
-		ibufs[2][6] * sscales[2];
-	    obuf[-3] =
-		ibufs[0][7] * sscales[0] +
-		ibufs[1][7] * sscales[1] +
-		ibufs[2][7] * sscales[2];
-	    for (n = 4; n < n_fft >> 1; n += 4) {
-		obuf[-n-0] =
-		    ibufs[0][(n<<1)+4] * sscales[0] +
-		    ibufs[1][(n<<1)+4] * sscales[1] +
-		    ibufs[2][(n<<1)+4] * sscales[2];
-		obuf[-n-1] =
-		    ibufs[0][(n<<1)+5] * sscales[0] +
-		    ibufs[1][(n<<1)+5] * sscales[1] +
-		    ibufs[2][(n<<1)+5] * sscales[2];
-		obuf[-n-2] =
-		    ibufs[0][(n<<1)+6] * sscales[0] +
-		    ibufs[1][(n<<1)+6] * sscales[1] +
-		    ibufs[2][(n<<1)+6] * sscales[2];
-		obuf[-n-3] =
-		    ibufs[0][(n<<1)+7] * sscales[0] +
-		    ibufs[1][(n<<1)+7] * sscales[1] +
-		    ibufs[2][(n<<1)+7] * sscales[2];
-	    }
-	    break;
-	case 4:
-	    for (n = 0; n < n_fft >> 1; n += 4) {
-		obuf[n+0] =
-		    ibufs[0][(n<<1)+0] * sscales[0] +
-		    ibufs[1][(n<<1)+0] * sscales[1] +
-		    ibufs[2][(n<<1)+0] * sscales[2] +
-		    ibufs[3][(n<<1)+0] * sscales[3];
-		obuf[n+1] =
-		    ibufs[0][(n<<1)+1] * sscales[0] +
-		    ibufs[1][(n<<1)+1] * sscales[1] +
-		    ibufs[2][(n<<1)+1] * sscales[2] +
-		    ibufs[3][(n<<1)+1] * sscales[3];
-		obuf[n+2] =
-		    ibufs[0][(n<<1)+2] * sscales[0] +
-		    ibufs[1][(n<<1)+2] * sscales[1] +
-		    ibufs[2][(n<<1)+2] * sscales[2] +
-		    ibufs[3][(n<<1)+2] * sscales[3];
-		obuf[n+3] =
-		    ibufs[0][(n<<1)+3] * sscales[0] +
-		    ibufs[1][(n<<1)+3] * sscales[1] +
-		    ibufs[2][(n<<1)+3] * sscales[2] +
-		    ibufs[3][(n<<1)+3] * sscales[3];
-	    }
-	    obuf[n_fft >> 1] =
-		ibufs[0][4] * sscales[0] +
-		ibufs[1][4] * sscales[1] +
-		ibufs[2][4] * sscales[2] +
-		ibufs[3][4] * sscales[3];
-	    obuf = &obuf[n_fft];
-	    obuf[-1] =
-		ibufs[0][5] * sscales[0] +
-		ibufs[1][5] * sscales[1] +
-		ibufs[2][5] * sscales[2] +
-		ibufs[3][5] * sscales[3];
-	    obuf[-2] =
-		ibufs[0][6] * sscales[0] +
-		ibufs[1][6] * sscales[1] +
-		ibufs[2][6] * sscales[2] +
-		ibufs[3][6] * sscales[3];
-	    obuf[-3] =
-		ibufs[0][7] * sscales[0] +
-		ibufs[1][7] * sscales[1] +
-		ibufs[2][7] * sscales[2] +
-		ibufs[3][7] * sscales[3];
-	    for (n = 4; n < n_fft >> 1; n += 4) {
-		obuf[-n-0] =
-		    ibufs[0][(n<<1)+4] * sscales[0] +
-		    ibufs[1][(n<<1)+4] * sscales[1] +
-		    ibufs[2][(n<<1)+4] * sscales[2] +
-		    ibufs[3][(n<<1)+4] * sscales[3];
-		obuf[-n-1] =
-		    ibufs[0][(n<<1)+5] * sscales[0] +
-		    ibufs[1][(n<<1)+5] * sscales[1] +
-		    ibufs[2][(n<<1)+5] * sscales[2] +
-		    ibufs[3][(n<<1)+5] * sscales[3];
-		obuf[-n-2] =
-		    ibufs[0][(n<<1)+6] * sscales[0] +
-		    ibufs[1][(n<<1)+6] * sscales[1] +
-		    ibufs[2][(n<<1)+6] * sscales[2] +
-		    ibufs[3][(n<<1)+6] * sscales[3];
-		obuf[-n-3] =
-		    ibufs[0][(n<<1)+7] * sscales[0] +
-		    ibufs[1][(n<<1)+7] * sscales[1] +
-		    ibufs[2][(n<<1)+7] * sscales[2] +
-		    ibufs[3][(n<<1)+7] * sscales[3];
-	    }
-	    break;
-	default:
-	    for (n = 0; n < n_fft >> 1; n += 4) {
-		obuf[n+0] = ibufs[0][(n<<1)+0] * sscales[0];
-		obuf[n+1] = ibufs[0][(n<<1)+1] * sscales[0];
-		obuf[n+2] = ibufs[0][(n<<1)+2] * sscales[0];
-		obuf[n+3] = ibufs[0][(n<<1)+3] * sscales[0];
-		for (i = 1; i < n_bufs; i++) {
-		    obuf[n+0] += ibufs[i][(n<<1)+0] * sscales[i];
-		    obuf[n+1] += ibufs[i][(n<<1)+1] * sscales[i];
-		    obuf[n+2] += ibufs[i][(n<<1)+2] * sscales[i];
-		    obuf[n+3] += ibufs[i][(n<<1)+3] * sscales[i];
-		}
-	    }
-	    obuf[n_fft >> 1] = ibufs[0][4] * sscales[0];
-	    for (i = 1; i < n_bufs; i++) {
-		obuf[n_fft >> 1] += ibufs[i][4] * sscales[i];
-	    }
-	    obuf = &obuf[n_fft];
-	    obuf[-1] = ibufs[0][5] * sscales[0];
-	    obuf[-2] = ibufs[0][6] * sscales[0];
-	    obuf[-3] = ibufs[0][7] * sscales[0];
-	    for (i = 1; i < n_bufs; i++) {
-		obuf[-1] += ibufs[i][5] * sscales[i];
-		obuf[-2] += ibufs[i][6] * sscales[i];
-		obuf[-3] += ibufs[i][7] * sscales[i];
-	    }
-	    for (n = 4; n < n_fft >> 1; n += 4) {
-		obuf[-n-0] = ibufs[0][(n<<1)+4] * sscales[0];
-		obuf[-n-1] = ibufs[0][(n<<1)+5] * sscales[0];
-		obuf[-n-2] = ibufs[0][(n<<1)+6] * sscales[0];
-		obuf[-n-3] = ibufs[0][(n<<1)+7] * sscales[0];
-		for (i = 1; i < n_bufs; i++) {
-		    obuf[-n-0] += ibufs[i][(n<<1)+4] * sscales[i];
-		    obuf[-n-1] += ibufs[i][(n<<1)+5] * sscales[i];
-		    obuf[-n-2] += ibufs[i][(n<<1)+6] * sscales[i];
-		    obuf[-n-3] += ibufs[i][(n<<1)+7] * sscales[i];
-		}
-	    }
-	    break;
-	}
+        /* from internal order to halfcomplex */
+        for (n = 0; n < n_fft >> 1; n += 4) {
+            if (n_bufs == 1 && unity) {
+                /* reordering only */
+                for (k = 0; k < 4; k++) {
+                    re[k] = ibufs[0][(n<<1)+k+0];
+                    im[k] = ibufs[0][(n<<1)+k+4];
+                }
+            } else if (unity) {
+                for (k = 0; k < 4; k++) {
+                    re[k] = im[k] = 0;
+                }
+                for (i = 0; i < n_bufs; i++) {
+                    for (k = 0; k < 4; k++) {
+                        re[k] += ibufs[i][(n<<1)+k+0];
+                        im[k] += ibufs[i][(n<<1)+k+4];
+                    }
+                }
+            } else {
+                for (k = 0; k < 4; k++) {
+                    re[k] = im[k] = 0;
+                }
+                for (i = 0; i < n_bufs; i++) {
+                    for (k = 0; k < 4; k++) {
+                        re[k] += ibufs[i][(n<<1)+k+0] * sscales[i];
+                        im[k] += ibufs[i][(n<<1)+k+4] * sscales[i];
+                    }
+                }
+            }
+            for (k = 0; k < 4; k++) {
+                obuf[n+k] = re[k];
+            }
+            if (n == 0) {
+                obuf[n_fft >> 1] = im[0];
+                obuf[n_fft - 1] = im[1];
+                obuf[n_fft - 2] = im[2];
+                obuf[n_fft - 3] = im[3];
+            } else {
+                for (k = 0; k < 4; k++) {
+                    obuf[n_fft-n-k] = im[k];
+                }
+            }
+        }
 	break;
 	
     default:
@@ -589,6 +222,42 @@ CONVOLVE_ADD_NAME(void *input_cbuf,
     d[4] = d2s;
 }
 
+static void
+CONVOLVE_SUM_NAME(void *input_cbufs[],
+                  void *coeffs[],
+                  int n_pairs,
+                  void *output_cbuf,
+                  int loop_counter)
+{
+    real_t **b = (real_t **)input_cbufs;
+    real_t **c = (real_t **)coeffs;
+    real_t *d = (real_t *)output_cbuf;
+    real_t d1s, d2s, a[8];
+    int n, i, p;
+
+    d1s = d2s = 0;
+    for (p = 0; p < n_pairs; p++) {
+        d1s += b[p][0] * c[p][0];
+        d2s += b[p][4] * c[p][4];
+    }
+    for (n = 0; n < loop_counter << 3; n += 8) {
+        for (i = 0; i < 8; i++) {
+            a[i] = 0;
+        }
+        for (p = 0; p < n_pairs; p++) {
+            for (i = 0; i < 4; i++) {
+                a[i+0] += b[p][n+i] * c[p][n+i] - b[p][n+i+4] * c[p][n+i+4];
+                a[i+4] += b[p][n+i] * c[p][n+i+4] + b[p][n+i+4] * c[p][n+i];
+            }
+        }
+        for (i = 0; i < 8; i++) {
+            d[n+i] = a[i];
+        }
+    }
+    d[0] = d1s;
+    d[4] = d2s;
+}
+
 static void
 DIRAC_CONVOLVE_INPLACE_NAME(void *cbuf)
 {
@@ -618,3 +287,475 @@ DIRAC_CONVOLVE_NAME(void *input_cbuf,
     }
 }
 
+
+/*
+ * The same functions for the complex spectrum layout, which is FFTW's r2c
+ * output as is: the real and imaginary parts of the n_fft / 2 + 1 bins
+ * interleaved, padded with zeroes to whole blocks of 8 reals. The DC and
+ * nyquist bins are ordinary (with zero imaginary parts), so there are no
+ * special cases, and mixing is a plain scaled sum without reordering.
+ */
+static void
+COMPLEX_MIXNSCALE_NAME(void *input_cbufs[],
+                       void *output_cbuf,
+                       double scales[],
+                       int n_bufs,
+                       int mixmode,
+                       int loop_counter)
+{
+    real_t sscales[n_bufs], **ibufs = (real_t **)input_cbufs;
+    real_t *obuf = (real_t *)output_cbuf;
+    int n, i;
+
+    for (n = 0; n < n_bufs; n++) {
+	sscales[n] = (real_t)scales[n];
+    }
+    i = 0;
+    if (mixmode != CONVOLVER_MIXMODE_INPUT_ADD) {
+        if (n_bufs == 1 && scales[0] == 1.0) {
+            if (obuf != ibufs[0]) {
+                memcpy(obuf, ibufs[0], (loop_counter << 3) * sizeof(real_t));
+            }
+            return;
+        }
+        for (n = 0; n < loop_counter << 3; n++) {
+            obuf[n] = ibufs[0][n] * sscales[0];
+        }
+        i = 1;
+    }
+    for (; i < n_bufs; i++) {
+        for (n = 0; n < loop_counter << 3; n++) {
+            obuf[n] += ibufs[i][n] * sscales[i];
+        }
+    }
+}
+
+static void
+COMPLEX_CONVOLVE_NAME(void *input_cbuf,
+                      void *coeffs,
+                      void *output_cbuf,
+                      int loop_counter)
+{
+    real_t *b = (real_t *)input_cbuf;
+    real_t *c = (real_t *)coeffs;
+    real_t *d = (real_t *)output_cbuf;
+    real_t re, im;
+    int n;
+
+    /* input_cbuf may be the same as output_cbuf */
+    for (n = 0; n < loop_counter << 3; n += 2) {
+        re = b[n+0] * c[n+0] - b[n+1] * c[n+1];
+        im = b[n+0] * c[n+1] + b[n+1] * c[n+0];
+        d[n+0] = re;
+        d[n+1] = im;
+    }
+}
+
+static void
+COMPLEX_CONVOLVE_ADD_NAME(void *input_cbuf,
+                          void *coeffs,
+                          void *output_cbuf,
+                          int loop_counter)
+{
+    real_t *b = (real_t *)input_cbuf;
+    real_t *c = (real_t *)coeffs;
+    real_t *d = (real_t *)output_cbuf;
+    int n;
+
+    for (n = 0; n < loop_counter << 3; n += 2) {
+        d[n+0] += b[n+0] * c[n+0] - b[n+1] * c[n+1];
+        d[n+1] += b[n+0] * c[n+1] + b[n+1] * c[n+0];
+    }
+}
+
+static void
+COMPLEX_CONVOLVE_SUM_NAME(void *input_cbufs[],
+                          void *coeffs[],
+                          int n_pairs,
+                          void *output_cbuf,
+                          int loop_counter)
+{
+    real_t **b = (real_t **)input_cbufs;
+    real_t **c = (real_t **)coeffs;
+    real_t *d = (real_t *)output_cbuf;
+    real_t a[8];
+    int n, i, p;
+
+    for (n = 0; n < loop_counter << 3; n += 8) {
+        for (i = 0; i < 8; i++) {
+            a[i] = 0;
+        }
+        for (p = 0; p < n_pairs; p++) {
+            for (i = 0; i < 8; i += 2) {
+                a[i+0] += b[p][n+i] * c[p][n+i] - b[p][n+i+1] * c[p][n+i+1];
+                a[i+1] += b[p][n+i] * c[p][n+i+1] + b[p][n+i+1] * c[p][n+i];
+            }
+        }
+        for (i = 0; i < 8; i++) {
+            d[n+i] = a[i];
+        }
+    }
+}
+
+static void
+COMPLEX_DIRAC_CONVOLVE_NAME(void *input_cbuf,
+                            void *output_cbuf,
+                            double fraction,
+                            int loop_counter)
+{
+    real_t f = (real_t)fraction;
+    real_t *b = (real_t *)input_cbuf;
+    real_t *d = (real_t *)output_cbuf;
+    int n;
+
+    /* the dirac is at n_fft / 2, so every other bin changes sign */
+    for (n = 0; n < loop_counter << 3; n += 4) {
+	d[n+0] = b[n+0] * +f;
+	d[n+1] = b[n+1] * +f;
+	d[n+2] = b[n+2] * -f;
+	d[n+3] = b[n+3] * -f;
+    }
+}
+
+/* widening of compressed coefficients, which are the same in both layouts */
+static void
+WIDEN_FP16_NAME(void *input,
+                void *output,
+                double scale,
+                int loop_counter)
+{
+    uint16_t *h = (uint16_t *)input;
+    real_t *d = (real_t *)output;
+    real_t s = (real_t)scale;
+    int n;
+
+    for (n = 0; n < loop_counter << 3; n++) {
+        d[n] = (real_t)fp16_to_float(h[n]) * s;
+    }
+}
+
+static void
+WIDEN_BF16_NAME(void *input,
+                void *output,
+                double scale,
+                int loop_counter)
+{
+    uint16_t *h = (uint16_t *)input;
+    real_t *d = (real_t *)output;
+    real_t s = (real_t)scale;
+    int n;
+
+    for (n = 0; n < loop_counter << 3; n++) {
+        d[n] = (real_t)bf16_to_float(h[n]) * s;
+    }
+}
+
+/* mixing of time-domain buffers of 'n_samples' samples, without reordering */
+static void
+TIME_MIXNSCALE_NAME(void *input_bufs[],
+                    void *output_buf,
+                    double scales[],
+                    int n_bufs,
+                    int n_samples)
+{
+    real_t **b = (real_t **)input_bufs;
+    real_t *d = (real_t *)output_buf;
+    real_t s;
+    int n, i;
+
+    s = (real_t)scales[0];
+    for (n = 0; n < n_samples; n++) {
+        d[n] = b[0][n] * s;
+    }
+    for (i = 1; i < n_bufs; i++) {
+        s = (real_t)scales[i];
+        for (n = 0; n < n_samples; n++) {
+            d[n] += b[i][n] * s;
+        }
+    }
+}
+
+/*
+ * Convolution in the time-domain with 'n_taps' coefficients. The input points
+ * at the first of the 'n_samples' samples to convolve, and the 'n_taps' - 1
+ * samples before it are read too. Eight outputs are summed at a time, which
+ * the compiler can vectorise.
+ */
+static void
+DIRECT_CONVOLVE_NAME(void *input,
+                     void *coeffs,
+                     int n_taps,
+                     void *output,
+                     int n_samples)
+{
+    real_t *x = (real_t *)input;
+    real_t *h = (real_t *)coeffs;
+    real_t *y = (real_t *)output;
+    real_t a[8];
+    int n, i, k;
+
+    for (n = 0; n + 8 <= n_samples; n += 8) {
+        for (k = 0; k < 8; k++) {
+            a[k] = 0;
+        }
+        for (i = 0; i < n_taps; i++) {
+            for (k = 0; k < 8; k++) {
+                a[k] += h[i] * x[n+k-i];
+            }
+        }
+        for (k = 0; k < 8; k++) {
+            y[n+k] = a[k];
+        }
+    }
+    for (; n < n_samples; n++) {
+        a[0] = 0;
+        for (i = 0; i < n_taps; i++) {
+            a[0] += h[i] * x[n-i];
+        }
+        y[n] = a[0];
+    }
+}
+
+#if REALSIZE == 4
+/*
+ * Versions of the convolve sums which accumulate in double precision, but
+ * store the result as float, so the rounding error does not grow with the
+ * number of partitions summed.
+ */
+static void
+MIXED_CONVOLVE_SUM_NAME(void *input_cbufs[],
+                        void *coeffs[],
+                        int n_pairs,
+                        void *output_cbuf,
+                        int loop_counter)
+{
+    real_t **b = (real_t **)input_cbufs;
+    real_t **c = (real_t **)coeffs;
+    real_t *d = (real_t *)output_cbuf;
+    double d1s, d2s, a[8];
+    int n, i, p;
+
+    d1s = d2s = 0;
+    for (p = 0; p < n_pairs; p++) {
+        d1s += (double)b[p][0] * (double)c[p][0];
+        d2s += (double)b[p][4] * (double)c[p][4];
+    }
+    for (n = 0; n < loop_counter << 3; n += 8) {
+        for (i = 0; i < 8; i++) {
+            a[i] = 0;
+        }
+        for (p = 0; p < n_pairs; p++) {
+            for (i = 0; i < 4; i++) {
+                a[i+0] += (double)b[p][n+i] * (double)c[p][n+i] -
+                    (double)b[p][n+i+4] * (double)c[p][n+i+4];
+                a[i+4] += (double)b[p][n+i] * (double)c[p][n+i+4] +
+                    (double)b[p][n+i+4] * (double)c[p][n+i];
+            }
+        }
+        for (i = 0; i < 8; i++) {
+            d[n+i] = (real_t)a[i];
+        }
+    }
+    d[0] = (real_t)d1s;
+    d[4] = (real_t)d2s;
+}
+
+static void
+COMPLEX_MIXED_CONVOLVE_SUM_NAME(void *input_cbufs[],
+                                void *coeffs[],
+                                int n_pairs,
+                                void *output_cbuf,
+                                int loop_counter)
+{
+    real_t **b = (real_t **)input_cbufs;
+    real_t **c = (real_t **)coeffs;
+    real_t *d = (real_t *)output_cbuf;
+    double a[8];
+    int n, i, p;
+
+    for (n = 0; n < loop_counter << 3; n += 8) {
+        for (i = 0; i < 8; i++) {
+            a[i] = 0;
+        }
+        for (p = 0; p < n_pairs; p++) {
+            for (i = 0; i < 8; i += 2) {
+                a[i+0] += (double)b[p][n+i] * (double)c[p][n+i] -
+                    (double)b[p][n+i+1] * (double)c[p][n+i+1];
+                a[i+1] += (double)b[p][n+i] * (double)c[p][n+i+1] +
+                    (double)b[p][n+i+1] * (double)c[p][n+i];
+            }
+        }
+        for (i = 0; i < 8; i++) {
+            d[n+i] = (real_t)a[i];
+        }
+    }
+}
+#endif
+
+/*
+ * Building blocks for the non-uniform partitioning tail levels, which split
+ * each large transform into sub-transforms and radix-2 passes so the work
+ * can be spread over several periods. Passes and products work on the
+ * element range [first, last) of the whole job.
+ */
+static void
+NU_GATHER_NAME(void *dest,
+               void *src,
+               int base,
+               int mask,
+               int stride,
+               int n_reals)
+{
+    real_t *d = (real_t *)dest, *s = (real_t *)src;
+    int n;
+
+    for (n = 0; n < n_reals; n++) {
+        d[n] = s[(base + n * stride) & mask];
+    }
+}
+
+static void
+NU_SCATTER_NAME(void *dest,
+                void *src,
+                int stride,
+                int n_reals)
+{
+    real_t *d = (real_t *)dest, *s = (real_t *)src;
+    int n;
+
+    for (n = 0; n < n_reals; n++) {
+        d[n * stride] = s[n];
+    }
+}
+
+/* Combine pairs of 'len' long halfcomplex spectra into 'n_out' spectra of
+   twice the length (decimation in time). Spectrum 'c' and 'c + n_out' of
+   'src' form spectrum 'c' of 'dest'. 'cos_table' holds cos(2 * pi * j / N)
+   for j = 0 ... N / 4, where N / 'step' is the output length. */
+static void
+NU_FORWARD_PASS_NAME(void *src,
+                     void *dest,
+                     int len,
+                     int n_out,
+                     int first,
+                     int last,
+                     const double cos_table[],
+                     int step,
+                     int quarter)
+{
+    real_t *e, *o, *x, er, ei, tr, ti, wr, wi;
+    int i, k, c, len2 = len >> 1;
+
+    c = first / (len2 + 1);
+    k = first - c * (len2 + 1);
+    for (i = first; i < last; i++) {
+        e = &((real_t *)src)[c * len];
+        o = &((real_t *)src)[(c + n_out) * len];
+        x = &((real_t *)dest)[c * (len << 1)];
+        if (k == 0) {
+            x[0] = e[0] + o[0];
+            x[len] = e[0] - o[0];
+        } else if (k == len2) {
+            x[len2] = e[len2];
+            x[len + len2] = -o[len2];
+        } else {
+            wr = (real_t)cos_table[k * step];
+            wi = (real_t)cos_table[quarter - k * step];
+            tr = wr * o[k] + wi * o[len - k];
+            ti = wr * o[len - k] - wi * o[k];
+            er = e[k];
+            ei = e[len - k];
+            x[k] = er + tr;
+            x[(len << 1) - k] = ei + ti;
+            x[len - k] = er - tr;
+            x[len + k] = ti - ei;
+        }
+        if (++k > len2) {
+            k = 0;
+            c++;
+        }
+    }
+}
+
+/* The inverse of the above (without the 1/2 scaling): split 'n_in'
+   halfcomplex spectra of twice 'len' into two each, spectrum 'c' of 'src'
+   becomes spectrum 'c' and 'c + n_in' of 'dest'. */
+static void
+NU_INVERSE_PASS_NAME(void *src,
+                     void *dest,
+                     int len,
+                     int n_in,
+                     int first,
+                     int last,
+                     const double cos_table[],
+                     int step,
+                     int quarter)
+{
+    real_t *e, *o, *x, a1, b1, a2, b2, dr, di, wr, wi;
+    int i, k, c, len2 = len >> 1;
+
+    c = first / (len2 + 1);
+    k = first - c * (len2 + 1);
+    for (i = first; i < last; i++) {
+        x = &((real_t *)src)[c * (len << 1)];
+        e = &((real_t *)dest)[c * len];
+        o = &((real_t *)dest)[(c + n_in) * len];
+        if (k == 0) {
+            e[0] = x[0] + x[len];
+            o[0] = x[0] - x[len];
+        } else if (k == len2) {
+            e[len2] = 2 * x[len2];
+            o[len2] = -2 * x[len + len2];
+        } else {
+            wr = (real_t)cos_table[k * step];
+            wi = (real_t)cos_table[quarter - k * step];
+            a1 = x[k];
+            b1 = x[(len << 1) - k];
+            a2 = x[len - k];
+            b2 = x[len + k];
+            e[k] = a1 + a2;
+            e[len - k] = b1 - b2;
+            dr = a1 - a2;
+            di = b1 + b2;
+            o[k] = dr * wr - di * wi;
+            o[len - k] = dr * wi + di * wr;
+        }
+        if (++k > len2) {
+            k = 0;
+            c++;
+        }
+    }
+}
+
+/* Multiply the bins [first, last) of two 'size' long halfcomplex spectra,
+   and add the products to 'output_cbuf', or write them if not 'add'. */
+static void
+NU_CONVOLVE_NAME(void *input_cbuf,
+                 void *coeffs,
+                 void *output_cbuf,
+                 int size,
+                 int first,
+                 int last,
+                 int add)
+{
+    real_t *b = (real_t *)input_cbuf, *c = (real_t *)coeffs;
+    real_t *d = (real_t *)output_cbuf;
+    int n, size2 = size >> 1;
+
+    if (!add) {
+        for (n = first; n < last; n++) {
+            d[n] = 0;
+            if (n != 0 && n != size2) {
+                d[size - n] = 0;
+            }
+        }
+    }
+    for (n = first; n < last; n++) {
+        if (n == 0 || n == size2) {
+            d[n] += b[n] * c[n];
+            continue;
+        }
+        d[n] += b[n] * c[n] - b[size - n] * c[size - n];
+        d[size - n] += b[n] * c[size - n] + b[size - n] * c[n];
+    }
+}
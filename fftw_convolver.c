@@ -13,6 +13,7 @@
 #include <string.h>
 #include <inttypes.h>
 #include <math.h>
+#include <float.h>
 #ifdef __OS_SUNOS__
 #include <ieeefp.h>
 #endif
@@ -32,21 +33,94 @@
 #include "inout.h"
 #include "timestamp.h"
 #include "numunion.h"
+#include "fft_radix4.h"
 
 #define ifftplans fftplan_table[1][0]
 #define ifftplans_inplace fftplan_table[1][1]
 #define fftplans fftplan_table[0][0]
 #define fftplans_inplace fftplan_table[0][1]
-static void *fftplan_table[2][2][32];
+/* FFT backends for the transforms of the plan table. All do FFTW's
+   unnormalised r2r transforms, R2HC forward and HC2R inverse, and their plans
+   may be executed by several threads at once (modules get them through
+   convolver_fft_execute()). */
+struct fft_backend {
+    const char *name;
+    void *(*create_plan)(int length,
+                         bool_t inplace,
+                         bool_t invert);
+    void (*execute)(void *plan,
+                    void *input,
+                    void *output);
+    void (*destroy_plan)(void *plan);
+};
+struct fft_plan {
+    const struct fft_backend *backend;
+    void *plan;
+};
+#define FFT_BACKEND_AUTO   -1
+#define FFT_BACKEND_FFTW    0
+#define FFT_BACKEND_RADIX4  1
+#define N_FFT_BACKENDS      2
+/* larger sizes are left to FFTW, unless the built-in FFT is chosen */
+#define RADIX4_MAX_AUTO_ORDER 16
+static int fft_backend;
+
+static struct fft_plan *fftplan_table[2][2][32];
 static uint32_t fftplan_generated[2][2];
+/* r2c and c2r plans of the base order, used with the complex layout */
+static void *cfftplan_table[2][2];
 static int realsize = 0;
 
+/* planner flags, FFTW_WISDOM_ONLY is added when planned wisdom (made with
+   'brutefir -plan') is loaded for this processor */
+static unsigned int plan_flags = FFTW_MEASURE;
+static char *wisdom_filename = NULL;
+static bool_t save_wisdom = true;
+#define PLANNED_WISDOM_HEADER "# BruteFIR planned wisdom, processor: "
+
 static int n_fft, n_fft2, fft_order;
 
+/* the spectrum layout is either FFTW's halfcomplex reordered into blocks of
+   4 real parts followed by 4 imaginary parts, or (if complex_layout is set)
+   the interleaved complex output of FFTW's r2c transform. n_cblocks is the
+   number of blocks of 8 reals the frequency domain functions loop over. */
+static bool_t complex_layout = false;
+static int n_cblocks;
+
+/* blocks of 8 reals per tile in the interleaved partition layout, one tile of
+   all partitions should fit in the level 1 or 2 cache */
+#define CONVOLVER_INTERLEAVE_BLOCKS 16
+
+/* bytes of input partitions per tile in the sums of a matrix, which should
+   fit in the level 2 cache while all outputs are summed */
+#define CONVOLVER_MATRIX_TILE_BYTES (256 * 1024)
+
+/* compressed coefficients are widened into these, 'widebuf' holds a tile of
+   each of up to 'widebuf_pairs' partitions in a sum, and 'wide_cbuf' a whole
+   partition */
+static void *widebuf = NULL;
+static int widebuf_pairs = 0;
+static void *wide_cbuf = NULL;
+
 #define OPT_CODE_GCC   0
 #define OPT_CODE_SSE   1
 #define OPT_CODE_SSE2  2
+#define OPT_CODE_AVX2  3
+#define OPT_CODE_AVX512 4
+#define OPT_CODE_NEON  5
+#define N_OPT_CODES    6
+#if defined(CONVOLVER_HAS_AVX512) && !defined(CONVOLVER_HAS_AVX2)
+#error "CONVOLVER_HAS_AVX512 requires CONVOLVER_HAS_AVX2"
+#endif
 static int opt_code;
+static bool_t cpu_has[N_OPT_CODES];
+static const char *opt_code_names[] = {
+    "", "SSE", "SSE2", "AVX2/FMA", "AVX-512", "NEON"
+};
+/* as written in the configuration file */
+static const char *opt_code_settings[] = {
+    "none", "sse", "sse", "avx2", "avx512", "neon"
+};
 
 #if defined(__ARCH_IA32__) || defined(__ARCH_X86_64__)
 static inline void
@@ -57,49 +131,240 @@ cpuid(uint32_t op,
       uint32_t *edx)
 {
     asm volatile ("cpuid" : "=a" (*eax), "=b" (*ebx), "=c" (*ecx),
-		  "=d" (*edx) : "a" (op));
+		  "=d" (*edx) : "a" (op), "c" (0));
 }
-static void
-decide_opt_code(void)
-{
-    uint32_t level, junk, cap;
-    numunion_t vendor[2];
 
-    opt_code = OPT_CODE_GCC;
+#ifdef CONVOLVER_HAS_AVX2
+static bool_t
+has_avx2_fma(uint32_t level,
+             uint32_t cap2)
+{
+    uint32_t xcr0, junk, cap7;
 
-    vendor[1].u8[4] = '\0';
-    cpuid(0x00000000, &level, &vendor->u32[0], &vendor->u32[2],
-          &vendor->u32[1]);
-    if (strcmp((char *)vendor->u8, "GenuineIntel") == 0 &&
-        level >= 0x00000001)
+    /* FMA, OSXSAVE, AVX and F16C */
+    if (level < 0x00000007 ||
+        (cap2 & ((1 << 12) | (1 << 27) | (1 << 28) | (1 << 29))) !=
+        ((1 << 12) | (1 << 27) | (1 << 28) | (1 << 29)))
     {
-	cpuid(0x00000001, &junk, &junk, &junk, &cap);
-        if (realsize == 8) {
-            if ((cap & (1 << 26)) != 0) {
-                opt_code = OPT_CODE_SSE2;
-                pinfo("SSE2 capability detected -- optimisation enabled.\n");
+        return false;
+    }
+    /* the OS must save the XMM and YMM registers */
+    asm volatile ("xgetbv" : "=a" (xcr0), "=d" (junk) : "c" (0));
+    if ((xcr0 & 0x6) != 0x6) {
+        return false;
+    }
+    cpuid(0x00000007, &junk, &cap7, &junk, &junk);
+    return (cap7 & (1 << 5)) != 0;
+}
+#endif
+
+#ifdef CONVOLVER_HAS_AVX512
+static bool_t
+has_avx512f(uint32_t level,
+            uint32_t cap2)
+{
+    uint32_t xcr0, junk, cap7;
+
+    if (!has_avx2_fma(level, cap2)) {
+        return false;
+    }
+    /* the OS must also save the opmask and ZMM registers */
+    asm volatile ("xgetbv" : "=a" (xcr0), "=d" (junk) : "c" (0));
+    if ((xcr0 & 0xE6) != 0xE6) {
+        return false;
+    }
+    cpuid(0x00000007, &junk, &cap7, &junk, &junk);
+    return (cap7 & (1 << 16)) != 0;
+}
+#endif
+
+#ifdef CONVOLVER_HAS_AVX512
+static bool_t
+avx512_is_faster(void)
+{
+    uint64_t t1, t2, best[2];
+    void *buf[3];
+    int n, i, k, n_loops;
+
+    /* time convolve-add of a block with both versions, best of a few runs
+       each, so short frequency drops do not decide it */
+    for (n = 0; n < 3; n++) {
+        buf[n] = emallocaligned(n_fft * realsize);
+        memset(buf[n], 0, n_fft * realsize);
+    }
+    n_loops = n_fft >= (1 << 16) ? 16 : (1 << 20) / n_fft;
+    best[0] = best[1] = ~(uint64_t)0;
+    for (k = 0; k < 8; k++) {
+        for (i = 0; i < 2; i++) {
+            timestamp(&t1);
+            for (n = 0; n < n_loops; n++) {
+                if (realsize == 4) {
+                    if (i == 0) {
+                        convolver_avx_convolve_addf(buf[0], buf[1], buf[2],
+                                                    n_fft >> 3);
+                    } else {
+                        convolver_avx512_convolve_addf(buf[0], buf[1], buf[2],
+                                                       n_fft >> 3);
+                    }
+                } else {
+                    if (i == 0) {
+                        convolver_avx_convolve_addd(buf[0], buf[1], buf[2],
+                                                    n_fft >> 3);
+                    } else {
+                        convolver_avx512_convolve_addd(buf[0], buf[1], buf[2],
+                                                       n_fft >> 3);
+                    }
+                }
             }
-	} else {
-            if ((cap & (1 << 25)) != 0) {
-                opt_code = OPT_CODE_SSE;
-                pinfo("SSE capability detected -- optimisation enabled.\n");
+            timestamp(&t2);
+            if (t2 - t1 < best[i]) {
+                best[i] = t2 - t1;
             }
-	}
+        }
+    }
+    for (n = 0; n < 3; n++) {
+        efree(buf[n]);
     }
+    if (best[1] >= best[0]) {
+        pinfo("AVX-512 capability detected, but not faster than AVX2.\n");
+        return false;
+    }
+    return true;
+}
+#endif
+
+static void
+detect_cpu(void)
+{
+    uint32_t level, junk, cap, cap2;
+
+    /* only feature bits are used, the vendor does not matter */
+    cpuid(0x00000000, &level, &junk, &junk, &junk);
+    if (level < 0x00000001) {
+        return;
+    }
+    cpuid(0x00000001, &junk, &junk, &cap2, &cap);
+#ifdef __SSE__
+    cpu_has[OPT_CODE_SSE] = realsize == 4 && (cap & (1 << 25)) != 0;
+#endif
+#ifdef __SSE2__
+    cpu_has[OPT_CODE_SSE2] = realsize == 8 && (cap & (1 << 26)) != 0;
+#endif
+#ifdef CONVOLVER_HAS_AVX2
+    cpu_has[OPT_CODE_AVX2] = has_avx2_fma(level, cap2);
+#endif
+#ifdef CONVOLVER_HAS_AVX512
+    cpu_has[OPT_CODE_AVX512] = has_avx512f(level, cap2);
+#endif
 }
 #else
 static void
-decide_opt_code(void)
+detect_cpu(void)
 {
-    opt_code = OPT_CODE_GCC;
+#if defined(__aarch64__) && defined(CONVOLVER_HAS_NEON)
+    /* NEON is a mandatory part of AArch64 */
+    cpu_has[OPT_CODE_NEON] = true;
+#endif
 }
 #endif
 
+static bool_t
+decide_opt_code(const char name[])
+{
+    int n;
+
+    memset(cpu_has, 0, sizeof(cpu_has));
+    cpu_has[OPT_CODE_GCC] = true;
+    detect_cpu();
+
+    if (name == NULL || strcmp(name, "auto") == 0) {
+        for (n = N_OPT_CODES - 1; !cpu_has[n]; n--);
+        opt_code = n;
+#ifdef CONVOLVER_HAS_AVX512
+        /* some processors lower their clock when running AVX-512 code, so
+           it is only used if it really is faster */
+        if (opt_code == OPT_CODE_AVX512 && cpu_has[OPT_CODE_AVX2] &&
+            !avx512_is_faster())
+        {
+            opt_code = OPT_CODE_AVX2;
+        }
+#endif
+        if (opt_code != OPT_CODE_GCC) {
+            pinfo("%s capability detected -- optimisation enabled.\n",
+                  opt_code_names[opt_code]);
+        }
+        return true;
+    }
+    for (n = 0; n < N_OPT_CODES; n++) {
+        if (strcmp(name, opt_code_settings[n]) == 0) {
+            break;
+        }
+    }
+    if (n == OPT_CODE_SSE && realsize == 8) {
+        n = OPT_CODE_SSE2;
+    }
+    if (n == N_OPT_CODES || !cpu_has[n]) {
+        fprintf(stderr, "Optimisation \"%s\" is not supported on this "
+                "processor.\n", name);
+        return false;
+    }
+    opt_code = n;
+    if (opt_code != OPT_CODE_GCC) {
+        pinfo("%s optimisation enabled.\n", opt_code_names[opt_code]);
+    }
+    return true;
+}
+
+/* With planned wisdom FFTW only makes plans it has wisdom for, which it may
+   lack if the configuration has changed since it was planned. Those plans are
+   measured as without planned wisdom. */
+static bool_t
+missing_wisdom(void *plan,
+               unsigned int *flags)
+{
+    if (plan != NULL || (*flags & FFTW_WISDOM_ONLY) == 0) {
+        return false;
+    }
+    pinfo("not in planned wisdom, measuring...");
+    *flags = FFTW_MEASURE;
+    return true;
+}
+
+static void
+processor_model(char model[],
+                int size)
+{
+    FILE *stream;
+    char s[1000], *p;
+
+    /* This code is Linux specific... */
+
+    strcpy(model, "unknown");
+    if ((stream = fopen("/proc/cpuinfo", "rt")) == NULL) {
+        return;
+    }
+    s[999] = '\0';
+    while (fgets(s, 999, stream) != NULL) {
+        if ((strncasecmp(s, "model name", 10) == 0 ||
+             strncasecmp(s, "cpu part", 8) == 0) &&
+            (p = strchr(s, ':')) != NULL)
+        {
+            for (p++; *p == ' ' || *p == '\t'; p++);
+            p[strcspn(p, "\r\n")] = '\0';
+            strncpy(model, p, size - 1);
+            model[size - 1] = '\0';
+            break;
+        }
+    }
+    fclose(stream);
+}
+
 static void *
 create_fft_plan(int length,
                 bool_t inplace,
                 bool_t invert)
 {
+    unsigned int flags = plan_flags;
     void *plan, *buf[2];
 
     buf[0] = emallocaligned(length * realsize);
@@ -109,20 +374,391 @@ create_fft_plan(int length,
         buf[1] = emallocaligned(length * realsize);
         memset(buf[1], 0, length * realsize);
     }
+    do {
+        if (realsize == 4) {
+            plan = fftwf_plan_r2r_1d(length, buf[0], buf[1],
+                                     invert ? FFTW_HC2R : FFTW_R2HC, flags);
+        } else {
+            plan = fftw_plan_r2r_1d(length, buf[0], buf[1],
+                                    invert ? FFTW_HC2R : FFTW_R2HC, flags);
+        }
+    } while (missing_wisdom(plan, &flags));
+    efree(buf[0]);
+    if (!inplace) {
+        efree(buf[1]);
+    }
+    return plan;
+}
+
+static void *
+create_complex_fft_plan(int length,
+                        bool_t inplace,
+                        bool_t invert)
+{
+    unsigned int flags = plan_flags;
+    void *plan, *buf[2];
+
+    /* the complex side has length / 2 + 1 elements */
+    buf[0] = emallocaligned((length + 2) * realsize);
+    memset(buf[0], 0, (length + 2) * realsize);
+    buf[1] = buf[0];
+    if (!inplace) {
+        buf[1] = emallocaligned((length + 2) * realsize);
+        memset(buf[1], 0, (length + 2) * realsize);
+    }
+    do {
+        if (realsize == 4) {
+            if (invert) {
+                plan = fftwf_plan_dft_c2r_1d(length, (fftwf_complex *)buf[0],
+                                             (float *)buf[1], flags);
+            } else {
+                plan = fftwf_plan_dft_r2c_1d(length, (float *)buf[0],
+                                             (fftwf_complex *)buf[1], flags);
+            }
+        } else {
+            if (invert) {
+                plan = fftw_plan_dft_c2r_1d(length, (fftw_complex *)buf[0],
+                                            (double *)buf[1], flags);
+            } else {
+                plan = fftw_plan_dft_r2c_1d(length, (double *)buf[0],
+                                            (fftw_complex *)buf[1], flags);
+            }
+        }
+    } while (missing_wisdom(plan, &flags));
+    efree(buf[0]);
+    if (!inplace) {
+        efree(buf[1]);
+    }
+    return plan;
+}
+
+static void *
+create_batch_fft_plan(int n_bufs,
+                      int input_distance,
+                      int output_distance,
+                      bool_t invert)
+{
+    fftw_r2r_kind kind = invert ? FFTW_HC2R : FFTW_R2HC;
+    unsigned int flags = plan_flags;
+    int length = n_fft;
+    void *plan, *buf[2];
+
+    /* distances are in reals, on the complex side they are halved */
+    buf[0] = emallocaligned(n_bufs * input_distance * realsize);
+    memset(buf[0], 0, n_bufs * input_distance * realsize);
+    buf[1] = emallocaligned(n_bufs * output_distance * realsize);
+    memset(buf[1], 0, n_bufs * output_distance * realsize);
+    do {
+        if (complex_layout) {
+            if (realsize == 4) {
+                if (invert) {
+                    plan = fftwf_plan_many_dft_c2r(1, &length, n_bufs,
+                                                   (fftwf_complex *)buf[0],
+                                                   NULL, 1, input_distance / 2,
+                                                   (float *)buf[1], NULL,
+                                                   1, output_distance, flags);
+                } else {
+                    plan = fftwf_plan_many_dft_r2c(1, &length, n_bufs,
+                                                   (float *)buf[0], NULL,
+                                                   1, input_distance,
+                                                   (fftwf_complex *)buf[1],
+                                                   NULL, 1, output_distance / 2,
+                                                   flags);
+                }
+            } else {
+                if (invert) {
+                    plan = fftw_plan_many_dft_c2r(1, &length, n_bufs,
+                                                  (fftw_complex *)buf[0],
+                                                  NULL, 1, input_distance / 2,
+                                                  (double *)buf[1], NULL,
+                                                  1, output_distance, flags);
+                } else {
+                    plan = fftw_plan_many_dft_r2c(1, &length, n_bufs,
+                                                  (double *)buf[0], NULL,
+                                                  1, input_distance,
+                                                  (fftw_complex *)buf[1],
+                                                  NULL, 1, output_distance / 2,
+                                                  flags);
+                }
+            }
+        } else if (realsize == 4) {
+            plan = fftwf_plan_many_r2r(1, &length, n_bufs, (float *)buf[0],
+                                       NULL, 1, input_distance,
+                                       (float *)buf[1], NULL,
+                                       1, output_distance, &kind, flags);
+        } else {
+            plan = fftw_plan_many_r2r(1, &length, n_bufs, (double *)buf[0],
+                                      NULL, 1, input_distance,
+                                      (double *)buf[1], NULL,
+                                      1, output_distance, &kind, flags);
+        }
+    } while (missing_wisdom(plan, &flags));
+    efree(buf[0]);
+    efree(buf[1]);
+    return plan;
+}
+
+static void
+execute_fftw_plan(void *plan,
+                  void *input,
+                  void *output)
+{
+    if (realsize == 4) {
+        fftwf_execute_r2r((const fftwf_plan)plan,
+                          (float *)input, (float *)output);
+    } else {
+        fftw_execute_r2r((const fftw_plan)plan,
+                         (double *)input, (double *)output);
+    }
+}
+
+static void
+destroy_fftw_plan(void *plan)
+{
     if (realsize == 4) {
-        plan = fftwf_plan_r2r_1d(length, buf[0], buf[1],
-                                 invert ? FFTW_HC2R : FFTW_R2HC,
-                                 FFTW_MEASURE);
+        fftwf_destroy_plan((fftwf_plan)plan);
     } else {
-        plan = fftw_plan_r2r_1d(length, buf[0], buf[1],
-                                invert ? FFTW_HC2R : FFTW_R2HC,
-                                FFTW_MEASURE);
+        fftw_destroy_plan((fftw_plan)plan);
+    }
+}
+
+static void *
+create_radix4_plan(int length,
+                   bool_t inplace,
+                   bool_t invert)
+{
+    /* the built-in FFT uses its own buffers, in place or not */
+    return fft_radix4_plan(length, invert, realsize);
+}
+
+static const struct fft_backend fft_backends[N_FFT_BACKENDS] = {
+    { "FFTW", create_fft_plan, execute_fftw_plan, destroy_fftw_plan },
+    { "radix-4", create_radix4_plan, fft_radix4_execute, fft_radix4_destroy }
+};
+
+/* Returns the index of the fastest of the backends which have a plan, best of
+   a few runs each. The transforms are run on zeroes, they take the same time
+   whatever the data is. */
+static int
+fastest_fft_backend(void *plans[],
+                    int length,
+                    bool_t inplace)
+{
+    uint64_t t1, t2, best[N_FFT_BACKENDS];
+    int n, i, k, n_loops, fastest = -1;
+    void *buf[2];
+
+    buf[0] = emallocaligned(length * realsize);
+    memset(buf[0], 0, length * realsize);
+    buf[1] = buf[0];
+    if (!inplace) {
+        buf[1] = emallocaligned(length * realsize);
+        memset(buf[1], 0, length * realsize);
+    }
+    n_loops = length >= (1 << 16) ? 4 : (1 << 18) / length;
+    for (n = 0; n < N_FFT_BACKENDS; n++) {
+        best[n] = ~(uint64_t)0;
+    }
+    for (k = 0; k < 8; k++) {
+        for (n = 0; n < N_FFT_BACKENDS; n++) {
+            if (plans[n] == NULL) {
+                continue;
+            }
+            timestamp(&t1);
+            for (i = 0; i < n_loops; i++) {
+                fft_backends[n].execute(plans[n], buf[0], buf[1]);
+            }
+            timestamp(&t2);
+            if (t2 - t1 < best[n]) {
+                best[n] = t2 - t1;
+            }
+        }
+    }
+    for (n = 0; n < N_FFT_BACKENDS; n++) {
+        if (plans[n] != NULL && (fastest == -1 || best[n] < best[fastest])) {
+            fastest = n;
+        }
     }
     efree(buf[0]);
     if (!inplace) {
         efree(buf[1]);
     }
-    return plan;
+    return fastest;
+}
+
+/* Creates a plan with the backend given by the 'fft_backend' setting, or with
+   the fastest one for the size. FFTW's threads are only used by the FFTW
+   backend, so then it is always chosen. */
+static struct fft_plan *
+make_fft_plan(int order,
+              bool_t inplace,
+              bool_t invert)
+{
+    void *plans[N_FFT_BACKENDS];
+    struct fft_plan *fftplan;
+    int n, backend;
+
+    backend = fft_backend;
+    if (backend == FFT_BACKEND_AUTO &&
+        (bfconf->fft_threads > 1 || order > RADIX4_MAX_AUTO_ORDER))
+    {
+        backend = FFT_BACKEND_FFTW;
+    }
+    for (n = 0; n < N_FFT_BACKENDS; n++) {
+        plans[n] = NULL;
+        if (backend == FFT_BACKEND_AUTO || backend == n) {
+            plans[n] = fft_backends[n].create_plan(1 << order, inplace,
+                                                   invert);
+        }
+    }
+    if (plans[FFT_BACKEND_RADIX4] == NULL) {
+        /* sizes which the built-in FFT cannot do */
+        if (plans[FFT_BACKEND_FFTW] == NULL) {
+            plans[FFT_BACKEND_FFTW] = create_fft_plan(1 << order, inplace,
+                                                      invert);
+        }
+        backend = FFT_BACKEND_FFTW;
+    } else if (backend == FFT_BACKEND_AUTO) {
+        backend = fastest_fft_backend(plans, 1 << order, inplace);
+    }
+    for (n = 0; n < N_FFT_BACKENDS; n++) {
+        if (n != backend && plans[n] != NULL) {
+            fft_backends[n].destroy_plan(plans[n]);
+        }
+    }
+    fftplan = emalloc(sizeof(struct fft_plan));
+    fftplan->backend = &fft_backends[backend];
+    fftplan->plan = plans[backend];
+    return fftplan;
+}
+
+/* executes a plan of the base order, single or batched, in the current
+   spectrum layout (before the frequency domain reordering in the halfcomplex
+   case) */
+static void
+execute_fft_plan(void *plan,
+                 void *input_cbuf,
+                 void *output_cbuf,
+                 bool_t invert)
+{
+    if (complex_layout) {
+        if (realsize == 4) {
+            if (invert) {
+                fftwf_execute_dft_c2r((const fftwf_plan)plan,
+                                      (fftwf_complex *)input_cbuf,
+                                      (float *)output_cbuf);
+            } else {
+                fftwf_execute_dft_r2c((const fftwf_plan)plan,
+                                      (float *)input_cbuf,
+                                      (fftwf_complex *)output_cbuf);
+            }
+        } else {
+            if (invert) {
+                fftw_execute_dft_c2r((const fftw_plan)plan,
+                                     (fftw_complex *)input_cbuf,
+                                     (double *)output_cbuf);
+            } else {
+                fftw_execute_dft_r2c((const fftw_plan)plan,
+                                     (double *)input_cbuf,
+                                     (fftw_complex *)output_cbuf);
+            }
+        }
+    } else {
+        execute_fftw_plan(plan, input_cbuf, output_cbuf);
+    }
+}
+
+/* transform of the base order */
+static void
+execute_fft(void *input_cbuf,
+            void *output_cbuf,
+            bool_t invert)
+{
+    bool_t inplace = input_cbuf == output_cbuf;
+
+    if (complex_layout) {
+        execute_fft_plan(cfftplan_table[invert][inplace],
+                         input_cbuf, output_cbuf, invert);
+    } else {
+        convolver_fft_execute(fftplan_table[invert][inplace][fft_order],
+                              input_cbuf, output_cbuf);
+    }
+}
+
+/*
+ * Conversions between float and the 16 bit formats used for compressed
+ * coefficients, IEEE half precision (fp16) and the upper half of a float
+ * (bf16). Rounding is to nearest even. Values are scaled before compression
+ * so they never overflow fp16, and there are no NaN or Inf among them.
+ */
+static inline float
+fp16_to_float(uint16_t h)
+{
+    union { uint32_t u; float f; } v;
+    uint32_t exp = (h >> 10) & 0x1F;
+
+    if (exp == 0) {
+        /* zero or subnormal */
+        v.f = (float)(h & 0x3FF) * (1.0f / 16777216.0f);
+        v.u |= (uint32_t)(h & 0x8000) << 16;
+    } else {
+        v.u = (uint32_t)(h & 0x8000) << 16 | (exp + 112) << 23 |
+            (uint32_t)(h & 0x3FF) << 13;
+    }
+    return v.f;
+}
+
+static uint16_t
+float_to_fp16(float f)
+{
+    union { uint32_t u; float f; } v;
+    uint32_t sign, man, rem, half, h;
+    int exp, shift;
+
+    v.f = f;
+    sign = (v.u >> 16) & 0x8000;
+    exp = (int)((v.u >> 23) & 0xFF) - 112;
+    man = v.u & 0x7FFFFF;
+    if (exp >= 31) {
+        return (uint16_t)(sign | 0x7C00);
+    }
+    if (exp <= 0) {
+        if (exp < -10) {
+            return (uint16_t)sign;
+        }
+        man |= 0x800000;
+        shift = 14 - exp;
+    } else {
+        shift = 13;
+    }
+    h = man >> shift;
+    rem = man & ((1 << shift) - 1);
+    half = 1 << (shift - 1);
+    if (exp > 0) {
+        h |= (uint32_t)exp << 10;
+    }
+    if (rem > half || (rem == half && (h & 1) != 0)) {
+        h++;
+    }
+    return (uint16_t)(sign | h);
+}
+
+static inline float
+bf16_to_float(uint16_t h)
+{
+    union { uint32_t u; float f; } v;
+
+    v.u = (uint32_t)h << 16;
+    return v.f;
+}
+
+static uint16_t
+float_to_bf16(float f)
+{
+    union { uint32_t u; float f; } v;
+
+    v.f = f;
+    return (uint16_t)((v.u + 0x7FFF + ((v.u >> 16) & 1)) >> 16);
 }
 
 #define real_t float
@@ -132,8 +768,25 @@ create_fft_plan(int length,
 #define CONVOLVE_INPLACE_NAME convolve_inplacef
 #define CONVOLVE_NAME convolvef
 #define CONVOLVE_ADD_NAME convolve_addf
+#define CONVOLVE_SUM_NAME convolve_sumf
 #define DIRAC_CONVOLVE_INPLACE_NAME dirac_convolve_inplacef
 #define DIRAC_CONVOLVE_NAME dirac_convolvef
+#define COMPLEX_MIXNSCALE_NAME complex_mixnscalef
+#define COMPLEX_CONVOLVE_NAME complex_convolvef
+#define COMPLEX_CONVOLVE_ADD_NAME complex_convolve_addf
+#define COMPLEX_CONVOLVE_SUM_NAME complex_convolve_sumf
+#define COMPLEX_DIRAC_CONVOLVE_NAME complex_dirac_convolvef
+#define WIDEN_FP16_NAME widen_fp16f
+#define WIDEN_BF16_NAME widen_bf16f
+#define TIME_MIXNSCALE_NAME time_mixnscalef
+#define DIRECT_CONVOLVE_NAME direct_convolvef
+#define NU_GATHER_NAME nu_gatherf
+#define NU_SCATTER_NAME nu_scatterf
+#define NU_FORWARD_PASS_NAME nu_forward_passf
+#define NU_INVERSE_PASS_NAME nu_inverse_passf
+#define NU_CONVOLVE_NAME nu_convolvef
+#define MIXED_CONVOLVE_SUM_NAME convolve_sum_mixedf
+#define COMPLEX_MIXED_CONVOLVE_SUM_NAME complex_convolve_sum_mixedf
 #include "raw2real.h"
 #include "fftw_convfuns.h"
 #undef real_t
@@ -143,8 +796,25 @@ create_fft_plan(int length,
 #undef CONVOLVE_INPLACE_NAME
 #undef CONVOLVE_NAME
 #undef CONVOLVE_ADD_NAME
+#undef CONVOLVE_SUM_NAME
 #undef DIRAC_CONVOLVE_INPLACE_NAME
 #undef DIRAC_CONVOLVE_NAME
+#undef COMPLEX_MIXNSCALE_NAME
+#undef COMPLEX_CONVOLVE_NAME
+#undef COMPLEX_CONVOLVE_ADD_NAME
+#undef COMPLEX_CONVOLVE_SUM_NAME
+#undef COMPLEX_DIRAC_CONVOLVE_NAME
+#undef WIDEN_FP16_NAME
+#undef WIDEN_BF16_NAME
+#undef TIME_MIXNSCALE_NAME
+#undef DIRECT_CONVOLVE_NAME
+#undef NU_GATHER_NAME
+#undef NU_SCATTER_NAME
+#undef NU_FORWARD_PASS_NAME
+#undef NU_INVERSE_PASS_NAME
+#undef NU_CONVOLVE_NAME
+#undef MIXED_CONVOLVE_SUM_NAME
+#undef COMPLEX_MIXED_CONVOLVE_SUM_NAME
 
 #define real_t double
 #define REALSIZE 8
@@ -153,8 +823,23 @@ create_fft_plan(int length,
 #define CONVOLVE_INPLACE_NAME convolve_inplaced
 #define CONVOLVE_NAME convolved
 #define CONVOLVE_ADD_NAME convolve_addd
+#define CONVOLVE_SUM_NAME convolve_sumd
 #define DIRAC_CONVOLVE_INPLACE_NAME dirac_convolve_inplaced
 #define DIRAC_CONVOLVE_NAME dirac_convolved
+#define COMPLEX_MIXNSCALE_NAME complex_mixnscaled
+#define COMPLEX_CONVOLVE_NAME complex_convolved
+#define COMPLEX_CONVOLVE_ADD_NAME complex_convolve_addd
+#define COMPLEX_CONVOLVE_SUM_NAME complex_convolve_sumd
+#define COMPLEX_DIRAC_CONVOLVE_NAME complex_dirac_convolved
+#define WIDEN_FP16_NAME widen_fp16d
+#define WIDEN_BF16_NAME widen_bf16d
+#define TIME_MIXNSCALE_NAME time_mixnscaled
+#define DIRECT_CONVOLVE_NAME direct_convolved
+#define NU_GATHER_NAME nu_gatherd
+#define NU_SCATTER_NAME nu_scatterd
+#define NU_FORWARD_PASS_NAME nu_forward_passd
+#define NU_INVERSE_PASS_NAME nu_inverse_passd
+#define NU_CONVOLVE_NAME nu_convolved
 #include "raw2real.h"
 #include "fftw_convfuns.h"
 #undef real_t
@@ -164,53 +849,456 @@ create_fft_plan(int length,
 #undef CONVOLVE_INPLACE_NAME
 #undef CONVOLVE_NAME
 #undef CONVOLVE_ADD_NAME
+#undef CONVOLVE_SUM_NAME
 #undef DIRAC_CONVOLVE_INPLACE_NAME
 #undef DIRAC_CONVOLVE_NAME
+#undef COMPLEX_MIXNSCALE_NAME
+#undef COMPLEX_CONVOLVE_NAME
+#undef COMPLEX_CONVOLVE_ADD_NAME
+#undef COMPLEX_CONVOLVE_SUM_NAME
+#undef COMPLEX_DIRAC_CONVOLVE_NAME
+#undef WIDEN_FP16_NAME
+#undef WIDEN_BF16_NAME
+#undef TIME_MIXNSCALE_NAME
+#undef DIRECT_CONVOLVE_NAME
+#undef NU_GATHER_NAME
+#undef NU_SCATTER_NAME
+#undef NU_FORWARD_PASS_NAME
+#undef NU_INVERSE_PASS_NAME
+#undef NU_CONVOLVE_NAME
+
+/*
+ * The frequency domain functions (and some of the sample conversions) are
+ * called through this table, which is filled in by setup_kernels() with the
+ * best version available for each of them. 'loop_counter' is the number of
+ * blocks of 8 reals. 'convolve' and 'dirac_convolve' must work in-place,
+ * 'convolve_sum' writes the sum of the products of 'n_pairs' input buffers
+ * and coefficient sets, 'convolve_sum_mixed' does the same but accumulates
+ * float data in double precision, the 'widen' functions expand compressed
+ * coefficients, 'direct_convolve' convolves 'n_samples' in the time-domain,
+ * and the sample conversion functions return the number of samples
+ * converted, or are NULL if there is no special version. With float_bits 64
+ * a second table with the float versions is used by filters which are
+ * convolved in float, see convolver_filter_realsize().
+ */
+struct kernel_table {
+    void (*convolve_add)(void *input_cbuf,
+                         void *coeffs,
+                         void *output_cbuf,
+                         int loop_counter);
+    void (*convolve)(void *input_cbuf,
+                     void *coeffs,
+                     void *output_cbuf,
+                     int loop_counter);
+    void (*convolve_sum)(void *input_cbufs[],
+                         void *coeffs[],
+                         int n_pairs,
+                         void *output_cbuf,
+                         int loop_counter);
+    void (*convolve_sum_mixed)(void *input_cbufs[],
+                               void *coeffs[],
+                               int n_pairs,
+                               void *output_cbuf,
+                               int loop_counter);
+    void (*dirac_convolve)(void *input_cbuf,
+                           void *output_cbuf,
+                           double fraction,
+                           int loop_counter);
+    void (*widen_fp16)(void *input,
+                       void *output,
+                       double scale,
+                       int loop_counter);
+    void (*widen_bf16)(void *input,
+                       void *output,
+                       double scale,
+                       int loop_counter);
+    void (*direct_convolve)(void *input,
+                            void *coeffs,
+                            int n_taps,
+                            void *output,
+                            int n_samples);
+    void (*mixnscale_input)(void *input_cbufs[],
+                            void *output_cbuf,
+                            double scales[],
+                            int n_bufs,
+                            int loop_counter);
+    void (*mixnscale_output)(void *input_cbufs[],
+                             void *output_cbuf,
+                             double scales[],
+                             int n_bufs,
+                             int loop_counter);
+    int (*raw2real)(void *realbuf,
+                    void *rawbuf,
+                    int bytes,
+                    int isfloat,
+                    int spacing,
+                    int n_samples);
+    int (*real2raw)(void *rawbuf,
+                    void *realbuf,
+                    int bits,
+                    int bytes,
+                    int spacing,
+                    int n_samples,
+                    double limit,
+                    int32_t *intlargest);
+};
+static struct kernel_table kernels, float_kernels;
+
+/* the table and size of reals used by the functions which multiply spectra */
+static struct kernel_table *filter_kernels = &kernels;
+static int filter_realsize = 0;
+
+/* the generic C versions, wrapped to fit in the table */
+#define GCC_KERNELS(S)                                                         \
+static void                                                                    \
+gcc_convolve_add##S(void *input_cbuf,                                          \
+                    void *coeffs,                                              \
+                    void *output_cbuf,                                         \
+                    int loop_counter)                                          \
+{                                                                              \
+    convolve_add##S(input_cbuf, coeffs, output_cbuf);                          \
+}                                                                              \
+                                                                               \
+static void                                                                    \
+gcc_convolve##S(void *input_cbuf,                                              \
+                void *coeffs,                                                  \
+                void *output_cbuf,                                             \
+                int loop_counter)                                              \
+{                                                                              \
+    if (input_cbuf == output_cbuf) {                                           \
+        convolve_inplace##S(input_cbuf, coeffs);                               \
+    } else {                                                                   \
+        convolve##S(input_cbuf, coeffs, output_cbuf);                          \
+    }                                                                          \
+}                                                                              \
+                                                                               \
+static void                                                                    \
+gcc_convolve_sum##S(void *input_cbufs[],                                       \
+                    void *coeffs[],                                            \
+                    int n_pairs,                                               \
+                    void *output_cbuf,                                         \
+                    int loop_counter)                                          \
+{                                                                              \
+    convolve_sum##S(input_cbufs, coeffs, n_pairs, output_cbuf, loop_counter);  \
+}                                                                              \
+                                                                               \
+static void                                                                    \
+gcc_dirac_convolve##S(void *input_cbuf,                                        \
+                      void *output_cbuf,                                       \
+                      double fraction,                                         \
+                      int loop_counter)                                        \
+{                                                                              \
+    if (input_cbuf == output_cbuf) {                                           \
+        dirac_convolve_inplace##S(input_cbuf);                                 \
+    } else {                                                                   \
+        dirac_convolve##S(input_cbuf, output_cbuf);                            \
+    }                                                                          \
+}                                                                              \
+                                                                               \
+static void                                                                    \
+gcc_mixnscale_input##S(void *input_cbufs[],                                    \
+                       void *output_cbuf,                                      \
+                       double scales[],                                        \
+                       int n_bufs,                                             \
+                       int loop_counter)                                       \
+{                                                                              \
+    mixnscale##S(input_cbufs, output_cbuf, scales, n_bufs,                     \
+                 CONVOLVER_MIXMODE_INPUT);                                     \
+}                                                                              \
+                                                                               \
+static void                                                                    \
+gcc_mixnscale_output##S(void *input_cbufs[],                                   \
+                        void *output_cbuf,                                     \
+                        double scales[],                                       \
+                        int n_bufs,                                            \
+                        int loop_counter)                                      \
+{                                                                              \
+    mixnscale##S(input_cbufs, output_cbuf, scales, n_bufs,                     \
+                 CONVOLVER_MIXMODE_OUTPUT);                                    \
+}                                                                              \
+                                                                               \
+static void                                                                    \
+gcc_complex_mixnscale_input##S(void *input_cbufs[],                            \
+                               void *output_cbuf,                              \
+                               double scales[],                                \
+                               int n_bufs,                                     \
+                               int loop_counter)                               \
+{                                                                              \
+    complex_mixnscale##S(input_cbufs, output_cbuf, scales, n_bufs,             \
+                         CONVOLVER_MIXMODE_INPUT, loop_counter);               \
+}                                                                              \
+                                                                               \
+static void                                                                    \
+gcc_complex_mixnscale_output##S(void *input_cbufs[],                           \
+                                void *output_cbuf,                             \
+                                double scales[],                               \
+                                int n_bufs,                                    \
+                                int loop_counter)                              \
+{                                                                              \
+    complex_mixnscale##S(input_cbufs, output_cbuf, scales, n_bufs,             \
+                         CONVOLVER_MIXMODE_OUTPUT, loop_counter);              \
+}
+GCC_KERNELS(f)
+GCC_KERNELS(d)
+#undef GCC_KERNELS
+
+/* true if code for the given processor feature may be used */
+static bool_t
+use_code(int code)
+{
+    if (!cpu_has[code]) {
+        return false;
+    }
+    if (code == OPT_CODE_NEON || opt_code == OPT_CODE_NEON) {
+        return code == opt_code;
+    }
+    return code <= opt_code;
+}
+
+static void
+setup_kernels(struct kernel_table *k,
+              int rsize)
+{
+    if (rsize == 4) {
+        k->convolve_add = gcc_convolve_addf;
+        k->convolve = gcc_convolvef;
+        k->convolve_sum = gcc_convolve_sumf;
+        k->dirac_convolve = gcc_dirac_convolvef;
+        k->mixnscale_input = gcc_mixnscale_inputf;
+        k->mixnscale_output = gcc_mixnscale_outputf;
+        k->widen_fp16 = widen_fp16f;
+        k->widen_bf16 = widen_bf16f;
+        k->direct_convolve = direct_convolvef;
+    } else {
+        k->convolve_add = gcc_convolve_addd;
+        k->convolve = gcc_convolved;
+        k->convolve_sum = gcc_convolve_sumd;
+        k->dirac_convolve = gcc_dirac_convolved;
+        k->mixnscale_input = gcc_mixnscale_inputd;
+        k->mixnscale_output = gcc_mixnscale_outputd;
+        k->widen_fp16 = widen_fp16d;
+        k->widen_bf16 = widen_bf16d;
+        k->direct_convolve = direct_convolved;
+    }
+    k->raw2real = NULL;
+    k->real2raw = NULL;
+
+    /* the SSE code is float only, and the SSE2 code double only */
+#ifdef __SSE__
+    if (rsize == 4 && use_code(OPT_CODE_SSE)) {
+        k->convolve_add = convolver_sse_convolve_add;
+    }
+#endif
+#ifdef __SSE2__
+    if (rsize == 8 && use_code(OPT_CODE_SSE2)) {
+        k->convolve_add = convolver_sse2_convolve_add;
+    }
+#endif
+#ifdef CONVOLVER_HAS_AVX2
+    if (use_code(OPT_CODE_AVX2)) {
+        if (rsize == 4) {
+            k->convolve_add = convolver_avx_convolve_addf;
+            k->convolve = convolver_avx_convolvef;
+            k->convolve_sum = convolver_avx_convolve_sumf;
+            k->dirac_convolve = convolver_avx_dirac_convolvef;
+            /* also used in AVX-512 mode */
+            k->widen_fp16 = convolver_avx_widen_fp16f;
+            k->widen_bf16 = convolver_avx_widen_bf16f;
+            k->direct_convolve = convolver_avx_direct_convolvef;
+        } else {
+            k->convolve_add = convolver_avx_convolve_addd;
+            k->convolve = convolver_avx_convolved;
+            k->convolve_sum = convolver_avx_convolve_sumd;
+            k->dirac_convolve = convolver_avx_dirac_convolved;
+            k->direct_convolve = convolver_avx_direct_convolved;
+        }
+        /* the AVX2 code does the first two blocks in plain C */
+        if (n_fft >= 16) {
+            if (rsize == 4) {
+                k->mixnscale_input = convolver_avx_mixnscale_inputf;
+                k->mixnscale_output = convolver_avx_mixnscale_outputf;
+            } else {
+                k->mixnscale_input = convolver_avx_mixnscale_inputd;
+                k->mixnscale_output = convolver_avx_mixnscale_outputd;
+            }
+        }
+    }
+#endif
+#ifdef CONVOLVER_HAS_AVX512
+    /* no AVX-512 dirac_convolve, it is not worth it as it is rarely used */
+    if (use_code(OPT_CODE_AVX512)) {
+        if (rsize == 4) {
+            k->convolve_add = convolver_avx512_convolve_addf;
+            k->convolve = convolver_avx512_convolvef;
+            k->convolve_sum = convolver_avx512_convolve_sumf;
+        } else {
+            k->convolve_add = convolver_avx512_convolve_addd;
+            k->convolve = convolver_avx512_convolved;
+            k->convolve_sum = convolver_avx512_convolve_sumd;
+        }
+        /* the AVX-512 code does the first four blocks in plain C */
+        if (n_fft >= 32) {
+            if (rsize == 4) {
+                k->mixnscale_input = convolver_avx512_mixnscale_inputf;
+                k->mixnscale_output = convolver_avx512_mixnscale_outputf;
+            } else {
+                k->mixnscale_input = convolver_avx512_mixnscale_inputd;
+                k->mixnscale_output = convolver_avx512_mixnscale_outputd;
+            }
+        }
+    }
+#endif
+#ifdef CONVOLVER_HAS_NEON
+    if (use_code(OPT_CODE_NEON)) {
+        if (rsize == 4) {
+            k->convolve_add = convolver_neon_convolve_addf;
+            k->convolve = convolver_neon_convolvef;
+            k->convolve_sum = convolver_neon_convolve_sumf;
+            k->dirac_convolve = convolver_neon_dirac_convolvef;
+            k->mixnscale_input = convolver_neon_mixnscale_inputf;
+            k->mixnscale_output = convolver_neon_mixnscale_outputf;
+            k->raw2real = convolver_neon_raw2realf;
+            k->real2raw = convolver_neon_real2rawf;
+            k->widen_fp16 = convolver_neon_widen_fp16f;
+            k->widen_bf16 = convolver_neon_widen_bf16f;
+            k->direct_convolve = convolver_neon_direct_convolvef;
+        } else {
+            k->convolve_add = convolver_neon_convolve_addd;
+            k->convolve = convolver_neon_convolved;
+            k->convolve_sum = convolver_neon_convolve_sumd;
+            k->dirac_convolve = convolver_neon_dirac_convolved;
+            k->mixnscale_input = convolver_neon_mixnscale_inputd;
+            k->mixnscale_output = convolver_neon_mixnscale_outputd;
+            k->direct_convolve = convolver_neon_direct_convolved;
+        }
+    }
+#endif
+}
+
+/* the frequency domain functions for the complex layout, which replace the
+   ones set up by setup_kernels(), the sample conversions are the same */
+static void
+setup_complex_kernels(struct kernel_table *k,
+                      int rsize)
+{
+    if (rsize == 4) {
+        k->convolve_add = complex_convolve_addf;
+        k->convolve = complex_convolvef;
+        k->convolve_sum = complex_convolve_sumf;
+        k->dirac_convolve = complex_dirac_convolvef;
+        k->mixnscale_input = gcc_complex_mixnscale_inputf;
+        k->mixnscale_output = gcc_complex_mixnscale_outputf;
+    } else {
+        k->convolve_add = complex_convolve_addd;
+        k->convolve = complex_convolved;
+        k->convolve_sum = complex_convolve_sumd;
+        k->dirac_convolve = complex_dirac_convolved;
+        k->mixnscale_input = gcc_complex_mixnscale_inputd;
+        k->mixnscale_output = gcc_complex_mixnscale_outputd;
+    }
+#ifdef CONVOLVER_HAS_AVX2
+    /* there are no AVX-512 versions, these are used in that mode too */
+    if (use_code(OPT_CODE_AVX2)) {
+        if (rsize == 4) {
+            k->convolve_add = convolver_avx_complex_convolve_addf;
+            k->convolve = convolver_avx_complex_convolvef;
+            k->convolve_sum = convolver_avx_complex_convolve_sumf;
+        } else {
+            k->convolve_add = convolver_avx_complex_convolve_addd;
+            k->convolve = convolver_avx_complex_convolved;
+            k->convolve_sum = convolver_avx_complex_convolve_sumd;
+        }
+    }
+#endif
+#ifdef CONVOLVER_HAS_NEON
+    if (use_code(OPT_CODE_NEON)) {
+        if (rsize == 4) {
+            k->convolve_add = convolver_neon_complex_convolve_addf;
+            k->convolve = convolver_neon_complex_convolvef;
+            k->convolve_sum = convolver_neon_complex_convolve_sumf;
+        } else {
+            k->convolve_add = convolver_neon_complex_convolve_addd;
+            k->convolve = convolver_neon_complex_convolved;
+            k->convolve_sum = convolver_neon_complex_convolve_sumd;
+        }
+    }
+#endif
+}
+
+/* float storage with double precision accumulation of the partition sums */
+static void
+setup_mixed_kernels(struct kernel_table *k)
+{
+    if (complex_layout) {
+        k->convolve_sum_mixed = complex_convolve_sum_mixedf;
+    } else {
+        k->convolve_sum_mixed = convolve_sum_mixedf;
+    }
+#ifdef CONVOLVER_HAS_AVX2
+    /* also used in AVX-512 mode */
+    if (use_code(OPT_CODE_AVX2)) {
+        if (complex_layout) {
+            k->convolve_sum_mixed =
+                convolver_avx_complex_convolve_sum_mixedf;
+        } else {
+            k->convolve_sum_mixed =
+                convolver_avx_convolve_sum_mixedf;
+        }
+    }
+#endif
+#ifdef CONVOLVER_HAS_NEON
+    if (use_code(OPT_CODE_NEON)) {
+        if (complex_layout) {
+            k->convolve_sum_mixed =
+                convolver_neon_complex_convolve_sum_mixedf;
+        } else {
+            k->convolve_sum_mixed =
+                convolver_neon_convolve_sum_mixedf;
+        }
+    }
+#endif
+}
 
 void
 convolver_raw2cbuf(void *rawbuf,
 		   void *cbuf,
-		   void *next_cbuf,
 		   struct buffer_format *bf,
                    void (*postprocess)(void *realbuf,
                                        int n_samples,
                                        void *arg),
                    void *pp_arg)
 {
+    void *realbuf = &((uint8_t *)cbuf)[n_fft2 * realsize];
+    int n = 0;
+
     if (realsize == 4) {
-        raw2realf(next_cbuf, (void *)&((uint8_t *)rawbuf)[bf->byte_offset],
+        if (kernels.raw2real != NULL && !bf->sf.swap) {
+            n = kernels.raw2real(realbuf,
+                                 &((uint8_t *)rawbuf)[bf->byte_offset],
+                                 bf->sf.bytes, bf->sf.isfloat,
+                                 bf->sample_spacing, n_fft2);
+        }
+        raw2realf(&((float *)realbuf)[n],
+                  (void *)&((uint8_t *)rawbuf)[bf->byte_offset +
+                                               n * bf->sample_spacing *
+                                               bf->sf.bytes],
                   bf->sf.bytes,
-                  bf->sf.isfloat, bf->sample_spacing, bf->sf.swap, n_fft2);
+                  bf->sf.isfloat, bf->sample_spacing, bf->sf.swap, n_fft2 - n);
     } else {
-        raw2reald(next_cbuf, (void *)&((uint8_t *)rawbuf)[bf->byte_offset],
+        raw2reald(realbuf, (void *)&((uint8_t *)rawbuf)[bf->byte_offset],
                   bf->sf.bytes,
                   bf->sf.isfloat, bf->sample_spacing, bf->sf.swap, n_fft2);
     }
     if (postprocess != NULL) {
-        postprocess(next_cbuf, n_fft2, pp_arg);
+        postprocess(realbuf, n_fft2, pp_arg);
     }
-        
-    memcpy(&((uint8_t *)cbuf)[n_fft2 * realsize], next_cbuf, n_fft2 * realsize);
 }
 
 void
 convolver_time2freq(void *input_cbuf,
 		    void *output_cbuf)
 {
-    void *fftplan;
-
-    if (input_cbuf == output_cbuf) {
-        fftplan = fftplans_inplace[fft_order];
-    } else {
-        fftplan = fftplans[fft_order];
-    }
-    if (realsize == 4) {
-        fftwf_execute_r2r((const fftwf_plan)fftplan,
-                          (float *)input_cbuf, (float *)output_cbuf);
-    } else {
-        fftw_execute_r2r((const fftw_plan)fftplan,
-                         (double *)input_cbuf, (double *)output_cbuf);
-    }
+    execute_fft(input_cbuf, output_cbuf, false);
 }
 
 void
@@ -220,10 +1308,37 @@ convolver_mixnscale(void *input_cbufs[],
                     int n_bufs,
                     int mixmode)
 {
-    if (realsize == 4) {
-        mixnscalef(input_cbufs, output_cbuf, scales, n_bufs, mixmode);
-    } else {
-        mixnscaled(input_cbufs, output_cbuf, scales, n_bufs, mixmode);
+    switch (mixmode) {
+    case CONVOLVER_MIXMODE_INPUT:
+        kernels.mixnscale_input(input_cbufs, output_cbuf, scales, n_bufs,
+                                n_cblocks);
+        break;
+    case CONVOLVER_MIXMODE_OUTPUT:
+        kernels.mixnscale_output(input_cbufs, output_cbuf, scales, n_bufs,
+                                 n_cblocks);
+        break;
+    case CONVOLVER_MIXMODE_TIME:
+        if (realsize == 4) {
+            time_mixnscalef(input_cbufs, output_cbuf, scales, n_bufs, n_fft2);
+        } else {
+            time_mixnscaled(input_cbufs, output_cbuf, scales, n_bufs, n_fft2);
+        }
+        break;
+    default:
+        if (complex_layout) {
+            if (realsize == 4) {
+                complex_mixnscalef(input_cbufs, output_cbuf, scales, n_bufs,
+                                   mixmode, n_cblocks);
+            } else {
+                complex_mixnscaled(input_cbufs, output_cbuf, scales, n_bufs,
+                                   mixmode, n_cblocks);
+            }
+        } else if (realsize == 4) {
+            mixnscalef(input_cbufs, output_cbuf, scales, n_bufs, mixmode);
+        } else {
+            mixnscaled(input_cbufs, output_cbuf, scales, n_bufs, mixmode);
+        }
+        break;
     }
 }
 
@@ -231,11 +1346,7 @@ void
 convolver_convolve_inplace(void *cbuf,
                            void *coeffs)
 {
-    if (realsize == 4) {
-        convolve_inplacef(cbuf, coeffs);
-    } else {
-        convolve_inplaced(cbuf, coeffs);
-    }
+    filter_kernels->convolve(cbuf, coeffs, cbuf, n_cblocks);
 }
 
 void
@@ -243,10 +1354,273 @@ convolver_convolve(void *input_cbuf,
                    void *coeffs,
                    void *output_cbuf)
 {
-    if (realsize == 4) {
-        convolvef(input_cbuf, coeffs, output_cbuf);
+    filter_kernels->convolve(input_cbuf, coeffs, output_cbuf, n_cblocks);
+}
+
+static int
+interleave_blocks(void)
+{
+    return n_cblocks < CONVOLVER_INTERLEAVE_BLOCKS ?
+        n_cblocks : CONVOLVER_INTERLEAVE_BLOCKS;
+}
+
+/* sum of products for 'len' reals starting at real 'n' of the spectrum, the
+   pointers in 'b' and 'c' point at the tile */
+static void
+sum_tile(void *b[],
+         void *c[],
+         int n_pairs,
+         void *output_cbuf,
+         int n,
+         int len,
+         bool_t double_accumulation)
+{
+    double re, im;
+    int p;
+
+    if (double_accumulation) {
+        filter_kernels->convolve_sum_mixed
+            (b, c, n_pairs, &((uint8_t *)output_cbuf)[n * filter_realsize],
+             len >> 3);
+    } else {
+        filter_kernels->convolve_sum
+            (b, c, n_pairs, &((uint8_t *)output_cbuf)[n * filter_realsize],
+             len >> 3);
+    }
+    if (n == 0 || complex_layout) {
+        return;
+    }
+    /* the kernels treat the first element as DC and nyquist, which is
+       only true for the first tile, so it is redone here */
+    re = im = 0;
+    if (filter_realsize == 4) {
+        for (p = 0; p < n_pairs; p++) {
+            re += ((float *)b[p])[0] * ((float *)c[p])[0] -
+                ((float *)b[p])[4] * ((float *)c[p])[4];
+            im += ((float *)b[p])[0] * ((float *)c[p])[4] +
+                ((float *)b[p])[4] * ((float *)c[p])[0];
+        }
+        ((float *)output_cbuf)[n+0] = (float)re;
+        ((float *)output_cbuf)[n+4] = (float)im;
+    } else {
+        for (p = 0; p < n_pairs; p++) {
+            re += ((double *)b[p])[0] * ((double *)c[p])[0] -
+                ((double *)b[p])[4] * ((double *)c[p])[4];
+            im += ((double *)b[p])[0] * ((double *)c[p])[4] +
+                ((double *)b[p])[4] * ((double *)c[p])[0];
+        }
+        ((double *)output_cbuf)[n+0] = re;
+        ((double *)output_cbuf)[n+4] = im;
+    }
+}
+
+/* true if coefficients stored with the given compression must be widened
+   before they are multiplied in the precision of the filter */
+static inline bool_t
+needs_widening(int compression)
+{
+    return compression != BF_COEFF_COMPRESSION_NONE &&
+        (compression != BF_COEFF_COMPRESSION_FP32 || filter_realsize == 8);
+}
+
+/* a compressed partition has 16 bits for each real of a cbuf, followed by
+   the scale to widen with, or with fp32 it is a cbuf of floats. It is widened
+   to the precision of the filter. */
+static void
+widen(void *coeffs,
+      int compression,
+      int offset,
+      int len,
+      void *output)
+{
+    double scale;
+    int n;
+
+    if (compression == BF_COEFF_COMPRESSION_FP32) {
+        for (n = 0; n < len; n++) {
+            ((double *)output)[n] = (double)((float *)coeffs)[offset + n];
+        }
+        return;
+    }
+    memcpy(&scale, &((uint8_t *)coeffs)[convolver_cbufsize() / realsize * 2],
+           sizeof(double));
+    if (compression == BF_COEFF_COMPRESSION_FP16) {
+        filter_kernels->widen_fp16(&((uint16_t *)coeffs)[offset], output,
+                                   scale, len >> 3);
     } else {
-        convolved(input_cbuf, coeffs, output_cbuf);
+        filter_kernels->widen_bf16(&((uint16_t *)coeffs)[offset], output,
+                                   scale, len >> 3);
+    }
+}
+
+/* true if the band of blocks (first and last + 1) covers any of the 'len'
+   reals starting at real 'n' */
+static inline bool_t
+in_band(const int band[2],
+        int n,
+        int len)
+{
+    return band[0] << 3 < n + len && band[1] << 3 > n;
+}
+
+void
+convolver_convolve_sum(void *input_cbufs[],
+                       void *coeffs[],
+                       int *bands[],
+                       int n_pairs,
+                       void *output_cbuf,
+                       int compression,
+                       bool_t double_accumulation)
+{
+    int n, p, k, len, tile = interleave_blocks() << 3;
+    void *b[n_pairs], *c[n_pairs];
+
+    if (!needs_widening(compression) && bands == NULL) {
+        sum_tile(input_cbufs, coeffs, n_pairs, output_cbuf, 0, n_cblocks << 3,
+                 double_accumulation);
+        return;
+    }
+    /* done one tile at a time, so that only the partitions which have
+       coefficients in the tile are summed, and so that compressed
+       coefficients are read from memory in compressed form and the wide
+       tiles stay in cache */
+    for (n = 0; n < n_cblocks << 3; n += tile) {
+        len = (n_cblocks << 3) - n < tile ? (n_cblocks << 3) - n : tile;
+        for (p = k = 0; p < n_pairs; p++) {
+            if (bands != NULL && !in_band(bands[p], n, len)) {
+                continue;
+            }
+            b[k] = &((uint8_t *)input_cbufs[p])[n * filter_realsize];
+            if (!needs_widening(compression)) {
+                c[k] = &((uint8_t *)coeffs[p])[n * filter_realsize];
+            } else {
+                c[k] = &((uint8_t *)widebuf)[k * tile * filter_realsize];
+                widen(coeffs[p], compression, n, len, c[k]);
+            }
+            k++;
+        }
+        if (k == 0) {
+            memset(&((uint8_t *)output_cbuf)[n * filter_realsize], 0,
+                   len * filter_realsize);
+        } else {
+            sum_tile(b, c, k, output_cbuf, n, len, double_accumulation);
+        }
+    }
+}
+
+void
+convolver_convolve_matrix(void *input_cbufs[],
+                          void *coeffs[],
+                          int *bands[],
+                          int n_parts,
+                          int n_outputs,
+                          void *output_cbufs[],
+                          int compression,
+                          bool_t double_accumulation)
+{
+    int n, o, p, k, len, tile;
+    void *b[n_parts], *c[n_parts], **oc;
+
+    /* as long as the input partitions of a tile fit in the cache, but not
+       longer than widebuf is made for */
+    tile = (CONVOLVER_MATRIX_TILE_BYTES / (n_parts * filter_realsize)) & ~7;
+    if (tile > interleave_blocks() << 3) {
+        tile = interleave_blocks() << 3;
+    } else if (tile < 8) {
+        tile = 8;
+    }
+    for (n = 0; n < n_cblocks << 3; n += tile) {
+        len = (n_cblocks << 3) - n < tile ? (n_cblocks << 3) - n : tile;
+        for (o = 0; o < n_outputs; o++) {
+            oc = &coeffs[o * n_parts];
+            for (p = k = 0; p < n_parts; p++) {
+                if (input_cbufs[p] == NULL || oc[p] == NULL ||
+                    (bands != NULL && bands[o * n_parts + p] != NULL &&
+                     !in_band(bands[o * n_parts + p], n, len)))
+                {
+                    continue;
+                }
+                b[k] = &((uint8_t *)input_cbufs[p])[n * filter_realsize];
+                if (!needs_widening(compression)) {
+                    c[k] = &((uint8_t *)oc[p])[n * filter_realsize];
+                } else {
+                    c[k] = &((uint8_t *)widebuf)[k * tile * filter_realsize];
+                    widen(oc[p], compression, n, len, c[k]);
+                }
+                k++;
+            }
+            if (k == 0) {
+                memset(&((uint8_t *)output_cbufs[o])[n * filter_realsize], 0,
+                       len * filter_realsize);
+            } else {
+                sum_tile(b, c, k, output_cbufs[o], n, len,
+                         double_accumulation);
+            }
+        }
+    }
+}
+
+void
+convolver_sum_init(int max_pairs)
+{
+    if (widebuf == NULL || max_pairs <= widebuf_pairs) {
+        return;
+    }
+    efree(widebuf);
+    widebuf_pairs = max_pairs;
+    widebuf = emallocaligned(widebuf_pairs *
+                             CONVOLVER_INTERLEAVE_BLOCKS * 8 * realsize);
+}
+
+void
+convolver_interleave(void *cbuf,
+                     void *interleaved_buf,
+                     int n_parts,
+                     int index)
+{
+    int n, len, tile = interleave_blocks() << 3;
+
+    for (n = 0; n < n_cblocks << 3; n += tile) {
+        /* with the complex layout the last tile may be shorter */
+        len = (n_cblocks << 3) - n < tile ? (n_cblocks << 3) - n : tile;
+        memcpy(&((uint8_t *)interleaved_buf)[(n * n_parts + index * len) *
+                                             filter_realsize],
+               &((uint8_t *)cbuf)[n * filter_realsize], len * filter_realsize);
+    }
+}
+
+void
+convolver_convolve_sum_interleaved(void *input_buf,
+                                   int input_indexes[],
+                                   void *coeffs_buf,
+                                   int coeffs_indexes[],
+                                   int *bands[],
+                                   int n_pairs,
+                                   int n_parts,
+                                   void *output_cbuf,
+                                   bool_t double_accumulation)
+{
+    int n, p, k, len, tile = interleave_blocks() << 3;
+    void *b[n_pairs], *c[n_pairs];
+
+    for (n = 0; n < n_cblocks << 3; n += tile) {
+        len = (n_cblocks << 3) - n < tile ? (n_cblocks << 3) - n : tile;
+        for (p = k = 0; p < n_pairs; p++) {
+            if (bands != NULL && !in_band(bands[p], n, len)) {
+                continue;
+            }
+            b[k] = &((uint8_t *)input_buf)[(n * n_parts + input_indexes[p] *
+                                            len) * filter_realsize];
+            c[k] = &((uint8_t *)coeffs_buf)[(n * n_parts + coeffs_indexes[p] *
+                                             len) * filter_realsize];
+            k++;
+        }
+        if (k == 0) {
+            memset(&((uint8_t *)output_cbuf)[n * filter_realsize], 0,
+                   len * filter_realsize);
+        } else {
+            sum_tile(b, c, k, output_cbuf, n, len, double_accumulation);
+        }
     }
 }
 
@@ -265,27 +1639,7 @@ convolver_convolve_add(void *input_cbuf,
     memcpy(_c, coeffs, n_fft * sizeof(real_t));
     memcpy(_d, output_cbuf, n_fft * sizeof(real_t));
     */
-    switch (opt_code) {
-#ifdef __SSE__
-    case OPT_CODE_SSE:
-	convolver_sse_convolve_add(input_cbuf, coeffs, output_cbuf,
-                                   n_fft >> 3);
-	break;
-#ifdef __SSE2__
-    case OPT_CODE_SSE2:
-	convolver_sse2_convolve_add(input_cbuf, coeffs, output_cbuf,
-                                    n_fft >> 3);
-	break;
-#endif
-#endif
-    default:
-    case OPT_CODE_GCC:
-        if (realsize == 4) {
-            convolve_addf(input_cbuf, coeffs, output_cbuf);
-        } else {
-            convolve_addd(input_cbuf, coeffs, output_cbuf);
-        }
-    }
+    filter_kernels->convolve_add(input_cbuf, coeffs, output_cbuf, n_cblocks);
     /*
     {
 	real_t d1s, d2s, err, e;
@@ -328,39 +1682,45 @@ convolver_convolve_add(void *input_cbuf,
 }
 
 void
-convolver_crossfade_inplace(void *input_cbuf,
-                            void *crossfade_cbuf,
-                            void *buffer_cbuf)
+convolver_crossfade_time(void *from_cbuf,
+                         void *to_cbuf)
 {
-    void *buf1, *buf2;
-    double scale, d;
+    double d;
     float f;
     int n;
 
-    buf1 = buffer_cbuf;
-    buf2 = &((uint8_t *)buffer_cbuf)[n_fft * realsize];
-    scale = 1.0;
-    convolver_mixnscale(&crossfade_cbuf, buffer_cbuf, &scale, 1,
-                        CONVOLVER_MIXMODE_OUTPUT);
-    convolver_freq2time(buffer_cbuf, crossfade_cbuf);
-    convolver_mixnscale(&input_cbuf, buffer_cbuf, &scale, 1,
-                        CONVOLVER_MIXMODE_OUTPUT);
-    convolver_freq2time(buffer_cbuf, buffer_cbuf);
     if (realsize == 4) {
         f = 1.0 / (float)(n_fft2 - 1);
         for (n = 0; n < n_fft2; n++) {
-            ((float *)buffer_cbuf)[n] = 
-                ((float *)crossfade_cbuf)[n] * (1.0 - f * (float)n) +
-                ((float *)buffer_cbuf)[n] * f * (float)n;
+            ((float *)to_cbuf)[n] =
+                ((float *)from_cbuf)[n] * (1.0 - f * (float)n) +
+                ((float *)to_cbuf)[n] * f * (float)n;
         }
     } else {
         d = 1.0 / (double)(n_fft2 - 1);
         for (n = 0; n < n_fft2; n++) {
-            ((double *)buf1)[n] = 
-                ((double *)buf1)[n] * (1.0 - d * (double)n) +
-                ((double *)buf2)[n] * d * (double)n;
+            ((double *)to_cbuf)[n] =
+                ((double *)from_cbuf)[n] * (1.0 - d * (double)n) +
+                ((double *)to_cbuf)[n] * d * (double)n;
         }
     }
+}
+
+void
+convolver_crossfade_inplace(void *input_cbuf,
+                            void *crossfade_cbuf,
+                            void *buffer_cbuf)
+{
+    double scale;
+
+    scale = 1.0;
+    convolver_mixnscale(&crossfade_cbuf, buffer_cbuf, &scale, 1,
+                        CONVOLVER_MIXMODE_OUTPUT);
+    convolver_freq2time(buffer_cbuf, crossfade_cbuf);
+    convolver_mixnscale(&input_cbuf, buffer_cbuf, &scale, 1,
+                        CONVOLVER_MIXMODE_OUTPUT);
+    convolver_freq2time(buffer_cbuf, buffer_cbuf);
+    convolver_crossfade_time(crossfade_cbuf, buffer_cbuf);
     convolver_time2freq(buffer_cbuf, buffer_cbuf);
     scale = 1.0 / (double)n_fft;
     convolver_mixnscale(&buffer_cbuf, input_cbuf, &scale, 1,
@@ -370,21 +1730,59 @@ convolver_crossfade_inplace(void *input_cbuf,
 void
 convolver_dirac_convolve_inplace(void *cbuf)
 {
-    if (realsize == 4) {
-        dirac_convolve_inplacef(cbuf);
-    } else {
-        dirac_convolve_inplaced(cbuf);
-    }
+    filter_kernels->dirac_convolve(cbuf, cbuf, 1.0 / (double)n_fft,
+                                   n_cblocks);
 }
 
 void
 convolver_dirac_convolve(void *input_cbuf,
                          void *output_cbuf)
 {
-    if (realsize == 4) {
-        dirac_convolvef(input_cbuf, output_cbuf);
+    filter_kernels->dirac_convolve(input_cbuf, output_cbuf,
+                                   1.0 / (double)n_fft, n_cblocks);
+}
+
+void
+convolver_filter_realsize(int _realsize)
+{
+    filter_kernels = _realsize == realsize ? &kernels : &float_kernels;
+    filter_realsize = _realsize;
+}
+
+void
+convolver_convert_cbuf(void *input_cbuf,
+                       int input_realsize,
+                       void *output_cbuf,
+                       int output_realsize)
+{
+    float f[8];
+    double d[8];
+    int n, i;
+
+    /* done a block of 8 reals at a time through local copies, so it works
+       in place in both directions. Widening goes from the end so that no
+       floats are overwritten before they are read. */
+    if (input_realsize == output_realsize) {
+        if (input_cbuf != output_cbuf) {
+            memcpy(output_cbuf, input_cbuf,
+                   (n_cblocks << 3) * input_realsize);
+        }
+    } else if (output_realsize == 8) {
+        for (n = (n_cblocks - 1) << 3; n >= 0; n -= 8) {
+            memcpy(f, &((float *)input_cbuf)[n], sizeof(f));
+            for (i = 0; i < 8; i++) {
+                d[i] = (double)f[i];
+            }
+            memcpy(&((double *)output_cbuf)[n], d, sizeof(d));
+        }
     } else {
-        dirac_convolved(input_cbuf, output_cbuf);
+        for (n = 0; n < n_cblocks << 3; n += 8) {
+            memcpy(d, &((double *)input_cbuf)[n], sizeof(d));
+            for (i = 0; i < 8; i++) {
+                f[i] = (float)d[i];
+            }
+            memcpy(&((float *)output_cbuf)[n], f, sizeof(f));
+        }
     }
 }
 
@@ -392,20 +1790,76 @@ void
 convolver_freq2time(void *input_cbuf,
 		    void *output_cbuf)
 {
-    void *ifftplan;
+    execute_fft(input_cbuf, output_cbuf, true);
+}
 
-    if (input_cbuf == output_cbuf) {
-        ifftplan = ifftplans_inplace[fft_order];
-    } else {
-        ifftplan = ifftplans[fft_order];
+void *
+convolver_batch_fftplan(int n_bufs,
+                        int input_distance,
+                        int output_distance,
+                        bool_t invert)
+{
+    void *plan;
+
+    /* the built-in FFT has no batched transforms. If it was only chosen as
+       the fastest for single transforms, the batch is still done by FFTW,
+       as saving the overhead per call is what batching is for. If it was
+       set explicitly the transforms are done one by one. */
+    if (!complex_layout && fft_backend == FFT_BACKEND_RADIX4 &&
+        fftplan_table[invert][false][fft_order]->backend !=
+        &fft_backends[FFT_BACKEND_FFTW])
+    {
+        pinfo("The %d %s transforms of size %d are done one by one with "
+              "the built-in radix-4 FFT.\n", n_bufs,
+              invert ? "inverse" : "forward", n_fft);
+        return NULL;
     }
-    if (realsize == 4) {
-        fftwf_execute_r2r((const fftwf_plan)ifftplan,
-                          (float *)input_cbuf, (float *)output_cbuf);
-    } else {
-        fftw_execute_r2r((const fftw_plan)ifftplan,
-                         (double *)input_cbuf, (double *)output_cbuf);
+    pinfo("Creating %s FFTW plan of %d transforms of size %d...",
+          invert ? "inverse" : "forward", n_bufs, n_fft);
+    plan = create_batch_fft_plan(n_bufs, input_distance / realsize,
+                                 output_distance / realsize, invert);
+    pinfo("finished.\n");
+    return plan;
+}
+
+void
+convolver_time2freq_batch(void *plan,
+                          void *input_cbufs,
+                          void *output_cbufs)
+{
+    execute_fft_plan(plan, input_cbufs, output_cbufs, false);
+}
+
+void
+convolver_freq2time_batch(void *plan,
+                          void *input_cbufs,
+                          void *output_cbufs)
+{
+    execute_fft_plan(plan, input_cbufs, output_cbufs, true);
+}
+
+void
+convolver_direct_convolve(void *input_cbuf,
+                          void *coeffs,
+                          int n_taps,
+                          int delay,
+                          void *output_cbuf)
+{
+    void *input = &((uint8_t *)input_cbuf)[(n_fft2 - delay) * realsize];
+    double scale;
+
+    if (n_taps == 1) {
+        /* gain and delay only */
+        if (realsize == 4) {
+            scale = (double)((float *)coeffs)[0];
+            time_mixnscalef(&input, output_cbuf, &scale, 1, n_fft2);
+        } else {
+            scale = ((double *)coeffs)[0];
+            time_mixnscaled(&input, output_cbuf, &scale, 1, n_fft2);
+        }
+        return;
     }
+    kernels.direct_convolve(input, coeffs, n_taps, output_cbuf, n_fft2);
 }
 
 void
@@ -413,21 +1867,9 @@ convolver_convolve_eval(void *input_cbuf,
 			void *buffer_cbuf, /* 1.5 x size */
 			void *output_cbuf)
 {
-    if (realsize == 4) {
-        fftwf_execute_r2r((const fftwf_plan)ifftplans[fft_order],
-                          (float *)input_cbuf,
-                          &((float *)buffer_cbuf)[n_fft2]);
-        fftwf_execute_r2r((const fftwf_plan)fftplans[fft_order],
-                          (float *)buffer_cbuf,
-                          (float *)output_cbuf);
-    } else {
-        fftw_execute_r2r((const fftw_plan)ifftplans[fft_order],
-                         (double *)input_cbuf,
-                         &((double *)buffer_cbuf)[n_fft2]);
-        fftw_execute_r2r((const fftw_plan)fftplans[fft_order],
-                         (double *)buffer_cbuf,
-                         (double *)output_cbuf);
-    }
+    execute_fft(input_cbuf, &((uint8_t *)buffer_cbuf)[n_fft2 * realsize],
+                true);
+    execute_fft(buffer_cbuf, output_cbuf, false);
     memcpy(buffer_cbuf, &((uint8_t *)buffer_cbuf)[n_fft2 * realsize],
 	   n_fft2 * realsize);
 }
@@ -487,6 +1929,8 @@ convolver_cbuf2raw(void *cbuf,
 		   void *dither_state,
 		   struct bfoverflow *overflow)
 {
+    int n;
+
     if (realsize == 4) {
         if (apply_dither && !bf->sf.isfloat) {
             dither_preloop_real2int_hp_tpdf(dither_state, n_fft2);
@@ -495,10 +1939,24 @@ convolver_cbuf2raw(void *cbuf,
                               bf->sf.isfloat, bf->sample_spacing,
                               bf->sf.swap, n_fft2, overflow, dither_state);
         } else {
-            real2rawf_no_dither((void *)&((uint8_t *)outbuf)[bf->byte_offset],
-                                cbuf, bf->sf.sbytes << 3, bf->sf.bytes,
-                                bf->sf.isfloat, bf->sample_spacing,
-                                bf->sf.swap, n_fft2, overflow);
+            n = 0;
+            if (kernels.real2raw != NULL && !bf->sf.isfloat &&
+                !bf->sf.swap)
+            {
+                n = kernels.real2raw(&((uint8_t *)outbuf)[bf->byte_offset],
+                                     cbuf, bf->sf.sbytes << 3, bf->sf.bytes,
+                                     bf->sample_spacing, n_fft2,
+                                     bfconf->safety_limit != 0.0 ?
+                                     bfconf->safety_limit * overflow->max :
+                                     DBL_MAX, &overflow->intlargest);
+            }
+            real2rawf_no_dither((void *)&((uint8_t *)outbuf)
+                                [bf->byte_offset + n * bf->sample_spacing *
+                                 bf->sf.bytes],
+                                &((float *)cbuf)[n], bf->sf.sbytes << 3,
+                                bf->sf.bytes, bf->sf.isfloat,
+                                bf->sample_spacing, bf->sf.swap, n_fft2 - n,
+                                overflow);
         }
     } else {
         if (apply_dither && !bf->sf.isfloat) {
@@ -520,7 +1978,154 @@ convolver_cbuf2raw(void *cbuf,
 int
 convolver_cbufsize(void)
 {
-    return n_fft * realsize;
+    return convolver_realsize_cbufsize(realsize);
+}
+
+int
+convolver_realsize_cbufsize(int _realsize)
+{
+    /* the complex layout has n_fft + 2 reals, which are padded to whole
+       blocks (64 bytes keeps the alignment of consecutive buffers) */
+    if (complex_layout) {
+        return n_fft * _realsize + 64;
+    }
+    return n_fft * _realsize;
+}
+
+int
+convolver_compressed_cbufsize(int compression)
+{
+    if (compression == BF_COEFF_COMPRESSION_NONE) {
+        return convolver_cbufsize();
+    }
+    if (compression == BF_COEFF_COMPRESSION_FP32) {
+        return convolver_realsize_cbufsize(4);
+    }
+    /* 16 bits per real, followed by the scale */
+    return convolver_cbufsize() / realsize * 2 + 64;
+}
+
+void
+convolver_compress_coeffs(void *cbuf,
+                          void *dest,
+                          int compression,
+                          double *signal_energy,
+                          double *error_energy)
+{
+    double x, y, max = 0, scale = 1.0;
+    uint16_t *h = (uint16_t *)dest;
+    int n, exp;
+
+    if (widebuf == NULL) {
+        widebuf_pairs = bfconf->n_blocks;
+        widebuf = emallocaligned(widebuf_pairs *
+                                 CONVOLVER_INTERLEAVE_BLOCKS * 8 * realsize);
+        wide_cbuf = emallocaligned(convolver_cbufsize());
+        memset(wide_cbuf, 0, convolver_cbufsize());
+    }
+    memset(dest, 0, convolver_compressed_cbufsize(compression));
+    for (n = 0; n < n_cblocks << 3; n++) {
+        x = realsize == 4 ? ((float *)cbuf)[n] : ((double *)cbuf)[n];
+        if (fabs(x) > max) {
+            max = fabs(x);
+        }
+    }
+    /* the range of fp16 is small, so the values are scaled with a power of
+       two which puts the largest just below 32768, bf16 has the range of
+       float and needs no scaling */
+    if (compression == BF_COEFF_COMPRESSION_FP16 && max > 0) {
+        frexp(max, &exp);
+        scale = ldexp(1.0, 15 - exp);
+    }
+    for (n = 0; n < n_cblocks << 3; n++) {
+        x = realsize == 4 ? ((float *)cbuf)[n] : ((double *)cbuf)[n];
+        if (compression == BF_COEFF_COMPRESSION_FP32) {
+            ((float *)dest)[n] = (float)x;
+        } else if (compression == BF_COEFF_COMPRESSION_FP16) {
+            h[n] = float_to_fp16((float)(x * scale));
+        } else {
+            h[n] = float_to_bf16((float)(x * scale));
+        }
+    }
+    if (compression != BF_COEFF_COMPRESSION_FP32) {
+        scale = 1.0 / scale;
+        memcpy(&((uint8_t *)dest)[convolver_cbufsize() / realsize * 2],
+               &scale, sizeof(double));
+    }
+
+    /* compare with the original to get the error */
+    widen(dest, compression, 0, n_cblocks << 3, wide_cbuf);
+    for (n = 0; n < n_cblocks << 3; n++) {
+        if (realsize == 4) {
+            x = ((float *)cbuf)[n];
+            y = ((float *)wide_cbuf)[n];
+        } else {
+            x = ((double *)cbuf)[n];
+            y = ((double *)wide_cbuf)[n];
+        }
+        *signal_energy += x * x;
+        *error_energy += (x - y) * (x - y);
+    }
+}
+
+double
+convolver_cbuf_energy(void *cbuf)
+{
+    double x, energy = 0;
+    int n;
+
+    for (n = 0; n < n_cblocks << 3; n++) {
+        x = realsize == 4 ? ((float *)cbuf)[n] : ((double *)cbuf)[n];
+        energy += x * x;
+    }
+    return energy;
+}
+
+double
+convolver_band_limit(void *cbuf,
+                     double max_energy,
+                     int band[2])
+{
+    double x, energy[n_cblocks], removed = 0;
+    int n, i;
+
+    for (n = 0; n < n_cblocks; n++) {
+        energy[n] = 0;
+        for (i = n << 3; i < (n + 1) << 3; i++) {
+            x = realsize == 4 ? ((float *)cbuf)[i] : ((double *)cbuf)[i];
+            energy[n] += x * x;
+        }
+    }
+    /* trim from the top first, since that is where the energy usually is
+       lowest, and then from the bottom with what remains */
+    band[0] = 0;
+    band[1] = n_cblocks;
+    while (band[1] > band[0] && removed + energy[band[1] - 1] <= max_energy) {
+        removed += energy[--band[1]];
+    }
+    while (band[0] < band[1] && removed + energy[band[0]] <= max_energy) {
+        removed += energy[band[0]++];
+    }
+    if (band[0] == band[1]) {
+        band[0] = band[1] = 0;
+        memset(cbuf, 0, (n_cblocks << 3) * realsize);
+        return 0;
+    }
+    memset(cbuf, 0, (band[0] << 3) * realsize);
+    memset(&((uint8_t *)cbuf)[(band[1] << 3) * realsize], 0,
+           ((n_cblocks - band[1]) << 3) * realsize);
+    return (double)(band[1] - band[0]) / (double)n_cblocks;
+}
+
+void *
+convolver_widen_coeffs(void *coeffs,
+                       int compression)
+{
+    if (!needs_widening(compression)) {
+        return coeffs;
+    }
+    widen(coeffs, compression, 0, n_cblocks << 3, wide_cbuf);
+    return wide_cbuf;
 }
 
 void *
@@ -533,8 +2138,8 @@ convolver_coeffs2cbuf(void *coeffs,
     int n, len;
 
     len = (n_coeffs > n_fft2) ? n_fft2 : n_coeffs;
-    rcoeffs = emallocaligned(n_fft * realsize);
-    memset(rcoeffs, 0, n_fft * realsize);
+    rcoeffs = emallocaligned(convolver_cbufsize());
+    memset(rcoeffs, 0, convolver_cbufsize());
 
     if (realsize == 4) {
         for (n = 0; n < len; n++) {
@@ -545,8 +2150,6 @@ convolver_coeffs2cbuf(void *coeffs,
                 return NULL;
             }
         }
-        fftwf_execute_r2r((const fftwf_plan)fftplans_inplace[fft_order],
-                          (float *)rcoeffs, (float *)rcoeffs);
     } else {
         for (n = 0; n < len; n++) {
             ((double *)rcoeffs)[n_fft2 + n] = ((double *)coeffs)[n] * scale;
@@ -555,15 +2158,14 @@ convolver_coeffs2cbuf(void *coeffs,
                 return NULL;
             }
         }
-        fftw_execute_r2r((const fftw_plan)fftplans_inplace[fft_order],
-                         (double *)rcoeffs, (double *)rcoeffs);
     }
+    execute_fft(rcoeffs, rcoeffs, false);
 
     scale = 1.0 / (double)n_fft;
     if (optional_dest != NULL) {
         coeffs_data = optional_dest;
     } else {
-        coeffs_data = emallocaligned(n_fft * realsize);
+        coeffs_data = emallocaligned(convolver_cbufsize());
     }
     convolver_mixnscale(&rcoeffs, coeffs_data, &scale, 1,
 			CONVOLVER_MIXMODE_INPUT);
@@ -574,43 +2176,117 @@ convolver_coeffs2cbuf(void *coeffs,
 
 void
 convolver_runtime_coeffs2cbuf(void *src,  /* nfft / 2 */
-                              void *dest) /* nfft */
+                              void *dest) /* cbufsize */
 {
     static void *tmp = NULL;
     double scale;
     
     if (tmp == NULL) {
-        tmp = emallocaligned(n_fft * realsize);
+        tmp = emallocaligned(convolver_cbufsize());
+        memset(tmp, 0, convolver_cbufsize());
+    }
+    memset(dest, 0, n_fft2 * realsize);
+    memcpy(&((uint8_t *)dest)[n_fft2 * realsize], src, n_fft2 * realsize);
+    execute_fft(dest, tmp, false);
+    scale = 1.0 / (double)n_fft;
+    convolver_mixnscale(&tmp, dest, &scale, 1, CONVOLVER_MIXMODE_INPUT);
+}
+
+void *
+convolver_combine_coeffs(void *coeffs_a,
+                         int n_coeffs_a,
+                         double scale_a,
+                         void *coeffs_b,
+                         int n_coeffs_b,
+                         double scale_b)
+{
+    double *a, *b, *c, re, im;
+    int n, i, len, order, size;
+    fftw_plan plan;
+    void *coeffs;
+
+    len = n_coeffs_a + n_coeffs_b - 1;
+    a = emalloc(n_coeffs_a * sizeof(double));
+    b = emalloc(n_coeffs_b * sizeof(double));
+    for (n = 0; n < n_coeffs_a; n++) {
+        a[n] = scale_a * (realsize == 4 ? (double)((float *)coeffs_a)[n] :
+                          ((double *)coeffs_a)[n]);
     }
-    memset(dest, 0, n_fft2 * realsize);
-    memcpy(&((uint8_t *)dest)[n_fft2 * realsize], src, n_fft2 * realsize);
-    if (realsize == 4) {
-        fftwf_execute_r2r((const fftwf_plan)fftplans[fft_order],
-                          (float *)dest, (float *)tmp);
+    for (n = 0; n < n_coeffs_b; n++) {
+        b[n] = scale_b * (realsize == 4 ? (double)((float *)coeffs_b)[n] :
+                          ((double *)coeffs_b)[n]);
+    }
+    if (n_coeffs_a <= 64 || n_coeffs_b <= 64) {
+        /* short sets, typically dirac pulses, are quicker done directly */
+        c = emalloc(len * sizeof(double));
+        memset(c, 0, len * sizeof(double));
+        for (n = 0; n < n_coeffs_a; n++) {
+            if (a[n] != 0) {
+                for (i = 0; i < n_coeffs_b; i++) {
+                    c[n + i] += a[n] * b[i];
+                }
+            }
+        }
     } else {
-        fftw_execute_r2r((const fftw_plan)fftplans[fft_order],
-                         (double *)dest, (double *)tmp);
+        /* this is done once at startup, so plans are made in double precision
+           without wisdom, whatever the internal resolution is */
+        order = log2_roof(len);
+        size = 1 << order;
+        c = emallocaligned(size * sizeof(double));
+        plan = fftw_plan_r2r_1d(size, c, c, FFTW_R2HC, FFTW_ESTIMATE);
+        memset(c, 0, size * sizeof(double));
+        memcpy(c, b, n_coeffs_b * sizeof(double));
+        fftw_execute(plan);
+        efree(b);
+        b = c;
+        c = emallocaligned(size * sizeof(double));
+        memset(c, 0, size * sizeof(double));
+        memcpy(c, a, n_coeffs_a * sizeof(double));
+        fftw_execute_r2r(plan, c, c);
+        fftw_destroy_plan(plan);
+        /* halfcomplex product, with the normalisation of the inverse FFT */
+        c[0] = c[0] * b[0] / (double)size;
+        c[size >> 1] = c[size >> 1] * b[size >> 1] / (double)size;
+        for (n = 1; n < size >> 1; n++) {
+            re = c[n] * b[n] - c[size - n] * b[size - n];
+            im = c[n] * b[size - n] + c[size - n] * b[n];
+            c[n] = re / (double)size;
+            c[size - n] = im / (double)size;
+        }
+        plan = fftw_plan_r2r_1d(size, c, c, FFTW_HC2R, FFTW_ESTIMATE);
+        fftw_execute(plan);
+        fftw_destroy_plan(plan);
     }
-    scale = 1.0 / (double)n_fft;
-    convolver_mixnscale(&tmp, dest, &scale, 1, CONVOLVER_MIXMODE_INPUT);
+    coeffs = emalloc(len * realsize);
+    for (n = 0; n < len; n++) {
+        if (realsize == 4) {
+            ((float *)coeffs)[n] = (float)c[n];
+        } else {
+            ((double *)coeffs)[n] = c[n];
+        }
+    }
+    efree(a);
+    efree(b);
+    efree(c);
+    return coeffs;
 }
 
 bool_t
 convolver_verify_cbuf(void *cbufs[],
                       int n_cbufs)
 {
-    int n, i;
+    int n, i, n_reals = convolver_cbufsize() / realsize;
     
     for (n = 0; n < n_cbufs; n++) {
         if (realsize == 4) {
-            for (i = 0; i < n_fft; i++) {
+            for (i = 0; i < n_reals; i++) {
                 if (!finite((double)((float *)cbufs[n])[i])) {
                     fprintf(stderr, "NaN or Inf value among coefficients.\n");
                     return false;
                 }
             }
         } else {
-            for (i = 0; i < n_fft; i++) {
+            for (i = 0; i < n_reals; i++) {
                 if (!finite(((double *)cbufs[n])[i])) {
                     fprintf(stderr, "NaN or Inf value among coefficients.\n");
                     return false;
@@ -636,20 +2312,17 @@ convolver_debug_dump_cbuf(const char filename[],
                 strerror(errno));
         return;
     }
-    coeffs = emallocaligned(n_fft * realsize);
+    coeffs = emallocaligned(convolver_cbufsize());
     scale = 1.0;    
     for (n = 0; n < n_cbufs; n++) {
         convolver_mixnscale(&cbufs[n], coeffs, &scale, 1,
                             CONVOLVER_MIXMODE_OUTPUT);
+        execute_fft(coeffs, coeffs, true);
         if (realsize == 4) {
-            fftwf_execute_r2r((const fftwf_plan)ifftplans_inplace[fft_order],
-                              (float *)coeffs, (float *)coeffs);
             for (i = 0; i < n_fft2; i++) {
                 fprintf(stream, "%.16e\n", ((float *)coeffs)[n_fft2 + i]);
             }
         } else {
-            fftw_execute_r2r((const fftw_plan)ifftplans_inplace[fft_order],
-                             (double *)coeffs, (double *)coeffs);
             for (i = 0; i < n_fft2; i++) {
                 fprintf(stream, "%.16e\n", ((double *)coeffs)[n_fft2 + i]);
             }
@@ -667,18 +2340,64 @@ convolver_fftplan(int order,
     invert = !!invert;
     inplace = !!inplace;
     if (!bit_isset(&fftplan_generated[invert][inplace], order)) {
-        pinfo("Creating %s%sFFTW plan of size %d using wisdom...",
+        pinfo("Creating %s%sFFT plan of size %d...",
               invert ? "inverse " : "forward ",
               inplace ? "inplace " : "",
               1 << order);
         fftplan_table[invert][inplace][order] =
-            create_fft_plan(1 << order, inplace, invert);
-        pinfo("finished\n");
+            make_fft_plan(order, inplace, invert);
+        pinfo("finished (%s).\n",
+              fftplan_table[invert][inplace][order]->backend->name);
         bit_set(&fftplan_generated[invert][inplace], order);
     }
     return fftplan_table[invert][inplace][order];
 }
 
+void
+convolver_fft_execute(void *plan,
+                      void *input,
+                      void *output)
+{
+    struct fft_plan *fftplan = (struct fft_plan *)plan;
+
+    fftplan->backend->execute(fftplan->plan, input, output);
+}
+
+void
+convolver_fft_threads_init(void)
+{
+    int invert, inplace, order;
+
+    if (bfconf->fft_threads <= 1) {
+        return;
+    }
+#ifdef CONVOLVER_HAS_FFTW_THREADS
+    if (realsize == 4) {
+        fftwf_plan_with_nthreads(bfconf->fft_threads);
+    } else {
+        fftw_plan_with_nthreads(bfconf->fft_threads);
+    }
+#endif
+    /* the old plans are left as they are, logic modules may have kept
+       them */
+    pinfo("Creating FFTW plans for %d threads...", bfconf->fft_threads);
+    for (invert = 0; invert < 2; invert++) {
+        for (inplace = 0; inplace < 2; inplace++) {
+            if (complex_layout) {
+                cfftplan_table[invert][inplace] =
+                    create_complex_fft_plan(n_fft, inplace, invert);
+            }
+            for (order = 0; order < 32; order++) {
+                if (bit_isset(&fftplan_generated[invert][inplace], order)) {
+                    fftplan_table[invert][inplace][order] =
+                        make_fft_plan(order, inplace, invert);
+                }
+            }
+        }
+    }
+    pinfo("finished.\n");
+}
+
 struct _td_conv_t_ {
     void *fftplan;
     void *ifftplan;    
@@ -719,14 +2438,13 @@ convolver_td_new(void *coeffs,
            (blocklen - n_coeffs) * realsize);
     memcpy(&((uint8_t *)tdc->coeffs)[blocklen * realsize], coeffs,
            n_coeffs * realsize);
+    convolver_fft_execute(tdc->fftplan, tdc->coeffs, tdc->coeffs);
     if (realsize == 4) {
-        fftwf_execute_r2r(tdc->fftplan, tdc->coeffs, tdc->coeffs);
         scalef = 1.0 / (float)(blocklen << 1);
         for (n = 0; n < blocklen << 1; n++) {
             ((float *)tdc->coeffs)[n] *= scalef;
         }
     } else {
-        fftw_execute_r2r(tdc->fftplan, tdc->coeffs, tdc->coeffs);
         scaled = 1.0 / (double)(blocklen << 1);
         for (n = 0; n < blocklen << 1; n++) {
             ((double *)tdc->coeffs)[n] *= scaled;
@@ -768,17 +2486,581 @@ void
 convolver_td_convolve(td_conv_t *tdc,
                       void *overlap_block)
 {
+    convolver_fft_execute(tdc->fftplan, overlap_block, overlap_block);
+    convolve_inplace_ordered(overlap_block, tdc->coeffs, tdc->blocklen << 1);
+    convolver_fft_execute(tdc->ifftplan, overlap_block, overlap_block);
+}
+
+/*
+ * Non-uniform partitioning. The first blocks (the head) are convolved with
+ * the ordinary uniform partitioned functions. The tail is split into levels
+ * of doubling partition sizes, level 'l' having partitions of (1 << l)
+ * blocks. A level cannot start before (2 << l) - 1 blocks, which gives it
+ * time to collect its input and then (1 << l) periods until the result is
+ * needed. The transforms of a level are not done at once, but decomposed
+ * into (1 << l) transforms of the ordinary size and 'l' radix-2 passes, and
+ * the forward transform, the products, and the inverse are each split into
+ * (1 << l) units of work, so a level does an equal share of its work in
+ * each of its periods.
+ */
+#define NU_MAX_LEVELS 24
+
+struct _nu_coeffs_t_ {
+    int n_parts[NU_MAX_LEVELS + 1];
+    void *parts[NU_MAX_LEVELS + 1];
+};
+
+struct _nu_conv_t_ {
+    unsigned int blockcounter;
+    unsigned int sum_blockcounter;
+    int n_inputs;
+    int ring_size;
+    void *ring;
+    void *tmp;
+    struct {
+        int pos;
+        bool_t zero;
+        nu_coeffs_t **coeffs;
+        void *fdl;
+        void *acc;
+        void *work[2];
+        void *out[2];
+        bool_t out_zero[2];
+    } level[NU_MAX_LEVELS + 1];
+};
+
+static int nu_n_blocks = 0;
+static int nu_head = 0;
+static int nu_n_levels = 0;
+static int nu_start[NU_MAX_LEVELS + 1];
+static int nu_parts[NU_MAX_LEVELS + 1];
+static double *nu_cos_table = NULL;
+
+static void
+nu_setup(int n_blocks,
+         int max_partition_length)
+{
+    int rem, size, l;
+
+    nu_n_levels = 0;
+    nu_head = n_blocks;
+    if (max_partition_length <= 0) {
+        max_partition_length = n_blocks * n_fft2;
+    }
+    if (n_blocks <= 3 || max_partition_length < 2 * n_fft2) {
+        return;
+    }
+    nu_head = 3;
+    for (l = 1, size = 2; l <= NU_MAX_LEVELS; l++, size <<= 1) {
+        nu_start[l] = (size << 1) - 1;
+        rem = n_blocks - nu_start[l];
+        nu_parts[l] = 2;
+        nu_n_levels = l;
+        if ((size << 1) * n_fft2 > max_partition_length ||
+            rem - (size << 1) < (size << 1) || l == NU_MAX_LEVELS)
+        {
+            /* last level, extend it to cover the rest */
+            nu_parts[l] = (rem + size - 1) / size;
+            break;
+        }
+    }
+}
+
+static void
+add_reals(void *dest,
+          void *src,
+          int n_reals)
+{
+    int n;
+
+    if (realsize == 4) {
+        for (n = 0; n < n_reals; n++) {
+            ((float *)dest)[n] += ((float *)src)[n];
+        }
+    } else {
+        for (n = 0; n < n_reals; n++) {
+            ((double *)dest)[n] += ((double *)src)[n];
+        }
+    }
+}
+
+static void
+scale_reals(void *buf,
+            double scale,
+            int n_reals)
+{
+    int n;
+
+    if (realsize == 4) {
+        for (n = 0; n < n_reals; n++) {
+            ((float *)buf)[n] *= (float)scale;
+        }
+    } else {
+        for (n = 0; n < n_reals; n++) {
+            ((double *)buf)[n] *= scale;
+        }
+    }
+}
+
+/* Start of the work unit range [first, last) for chunk 'c' of 'n_chunks'. */
+static inline int
+nu_chunk(int total,
+         int c,
+         int n_chunks)
+{
+    return (int)((int64_t)total * c / n_chunks);
+}
+
+/*
+ * Forward transform units [first, last) of level 'l', out of (l + 1) << l.
+ * The first (1 << l) units transform the decimated sequences of the window
+ * at 'base' in 'src' (a ring buffer with 'mask'), the rest are the radix-2
+ * passes, the last one writing the spectrum to 'dest'.
+ */
+static void
+nu_forward_units(int l,
+                 void *src,
+                 int base,
+                 int mask,
+                 void *work[2],
+                 void *dest,
+                 int first,
+                 int last)
+{
+    int u, c, p, len, total, lo, hi, size = 1 << l;
+    int quarter = (n_fft << nu_n_levels) >> 2;
+    uint8_t *seg, *out;
+
+    for (u = first; u < last; u++) {
+        p = u >> l;
+        c = u & (size - 1);
+        if (p == 0) {
+            seg = &((uint8_t *)work[0])[c * n_fft * realsize];
+            if (realsize == 4) {
+                nu_gatherf(seg, src, base + c, mask, size, n_fft);
+            } else {
+                nu_gatherd(seg, src, base + c, mask, size, n_fft);
+            }
+            convolver_fft_execute(fftplans_inplace[fft_order], seg, seg);
+            continue;
+        }
+        len = n_fft << (p - 1);
+        total = (size >> p) * ((len >> 1) + 1);
+        lo = nu_chunk(total, c, size);
+        hi = nu_chunk(total, c + 1, size);
+        out = p == l ? dest : work[p & 1];
+        if (realsize == 4) {
+            nu_forward_passf(work[(p - 1) & 1], out, len, size >> p, lo, hi,
+                             nu_cos_table, (quarter << 1) / len, quarter);
+        } else {
+            nu_forward_passd(work[(p - 1) & 1], out, len, size >> p, lo, hi,
+                             nu_cos_table, (quarter << 1) / len, quarter);
+        }
+    }
+}
+
+/*
+ * Inverse transform units [first, last) of level 'l', out of (l + 1) << l,
+ * the reverse of the above. The first half of the result, the valid part,
+ * is written to 'dest'. The result is not scaled.
+ */
+static void
+nu_inverse_units(int l,
+                 void *src,
+                 void *work[2],
+                 void *dest,
+                 int first,
+                 int last)
+{
+    int u, c, p, len, total, lo, hi, size = 1 << l;
+    int quarter = (n_fft << nu_n_levels) >> 2;
+    uint8_t *seg;
+
+    for (u = first; u < last; u++) {
+        p = u >> l;
+        c = u & (size - 1);
+        if (p == l) {
+            seg = &((uint8_t *)work[l & 1])[c * n_fft * realsize];
+            convolver_fft_execute(ifftplans_inplace[fft_order], seg, seg);
+            if (realsize == 4) {
+                nu_scatterf(&((float *)dest)[c], seg, size, n_fft2);
+            } else {
+                nu_scatterd(&((double *)dest)[c], seg, size, n_fft2);
+            }
+            continue;
+        }
+        len = n_fft << (l - p - 1);
+        total = (1 << p) * ((len >> 1) + 1);
+        lo = nu_chunk(total, c, size);
+        hi = nu_chunk(total, c + 1, size);
+        if (realsize == 4) {
+            nu_inverse_passf(p == 0 ? src : work[p & 1], work[(p + 1) & 1],
+                             len, 1 << p, lo, hi, nu_cos_table,
+                             (quarter << 1) / len, quarter);
+        } else {
+            nu_inverse_passd(p == 0 ? src : work[p & 1], work[(p + 1) & 1],
+                             len, 1 << p, lo, hi, nu_cos_table,
+                             (quarter << 1) / len, quarter);
+        }
+    }
+}
+
+void
+convolver_nu_init(int n_blocks,
+                  bool_t nonuniform,
+                  int max_partition_length)
+{
+    int n, quarter;
+
+    nu_n_blocks = n_blocks;
+    nu_head = n_blocks;
+    nu_n_levels = 0;
+    if (!nonuniform) {
+        return;
+    }
+    nu_setup(n_blocks, max_partition_length);
+    if (nu_n_levels == 0) {
+        return;
+    }
+    pinfo("Non-uniform partitioning: %d blocks of %d, then partitions up "
+          "to %d.\n", nu_head, n_fft2, (1 << nu_n_levels) * n_fft2);
+    /* the tail levels are made of transforms of the ordinary size, which
+       are also needed with the complex layout */
+    convolver_fftplan(fft_order, false, true);
+    convolver_fftplan(fft_order, true, true);
+    quarter = (n_fft << nu_n_levels) >> 2;
+    nu_cos_table = emalloc((quarter + 1) * sizeof(double));
+    for (n = 0; n <= quarter; n++) {
+        nu_cos_table[n] = cos(M_PI * (double)n / (double)(quarter << 1));
+    }
+}
+
+int
+convolver_nu_head_blocks(void)
+{
+    return nu_head;
+}
+
+nu_coeffs_t *
+convolver_nu_coeffs(void *cbufs[],
+                    int n_cbufs)
+{
+    int l, p, k, b, size, n_parts;
+    void *tmp, *src, *work[2];
+    nu_coeffs_t *nuc;
+    uint8_t *dest;
+    double scale;
+
+    if (n_cbufs <= nu_head) {
+        return NULL;
+    }
+    nuc = emalloc(sizeof(nu_coeffs_t));
+    memset(nuc, 0, sizeof(nu_coeffs_t));
+    tmp = emallocaligned(convolver_cbufsize());
+    size = n_fft << nu_n_levels;
+    src = emallocaligned(size * realsize);
+    work[0] = emallocaligned(size * realsize);
+    work[1] = emallocaligned(size * realsize);
+    for (l = 1; l <= nu_n_levels && nu_start[l] < n_cbufs; l++) {
+        size = 1 << l;
+        n_parts = (n_cbufs - nu_start[l] + size - 1) / size;
+        if (n_parts > nu_parts[l]) {
+            n_parts = nu_parts[l];
+        }
+        nuc->n_parts[l] = n_parts;
+        nuc->parts[l] = emallocaligned(n_parts * size * n_fft * realsize);
+        for (p = 0; p < n_parts; p++) {
+            /* recover the time-domain coefficients from the uniform
+               partitions, and put them in the upper half */
+            memset(src, 0, size * n_fft * realsize);
+            for (k = 0; k < size; k++) {
+                b = nu_start[l] + p * size + k;
+                if (b >= n_cbufs) {
+                    break;
+                }
+                scale = 1.0;
+                convolver_mixnscale(&cbufs[b], tmp, &scale, 1,
+                                    CONVOLVER_MIXMODE_OUTPUT);
+                convolver_freq2time(tmp, tmp);
+                memcpy(&((uint8_t *)src)[(size + k) * n_fft2 * realsize],
+                       &((uint8_t *)tmp)[n_fft2 * realsize],
+                       n_fft2 * realsize);
+            }
+            /* same transform as the input gets */
+            dest = &((uint8_t *)nuc->parts[l])[p * size * n_fft * realsize];
+            nu_forward_units(l, src, 0, size * n_fft - 1, work, dest, 0,
+                             (l + 1) << l);
+            scale_reals(dest, 1.0 / (double)(size * n_fft), size * n_fft);
+        }
+    }
+    efree(tmp);
+    efree(src);
+    efree(work[0]);
+    efree(work[1]);
+    return nuc;
+}
+
+nu_conv_t *
+convolver_nu_new(int n_inputs)
+{
+    nu_conv_t *nuc;
+    int l, size;
+
+    if (nu_n_levels == 0) {
+        return NULL;
+    }
+    nuc = emalloc(sizeof(nu_conv_t));
+    memset(nuc, 0, sizeof(nu_conv_t));
+    nuc->n_inputs = n_inputs;
+    /* room for the delay, and a power of two for the window reads */
+    size = 4 * (1 << nu_n_levels) + nu_n_blocks;
+    nuc->ring_size = 1;
+    while (nuc->ring_size < size) {
+        nuc->ring_size <<= 1;
+    }
+    nuc->ring_size *= n_fft2;
+    nuc->ring = emallocaligned(nuc->ring_size * realsize);
+    memset(nuc->ring, 0, nuc->ring_size * realsize);
+    nuc->tmp = emallocaligned(convolver_cbufsize());
+    memset(nuc->tmp, 0, convolver_cbufsize());
+    for (l = 1; l <= nu_n_levels; l++) {
+        size = (1 << l) * n_fft * realsize;
+        nuc->level[l].fdl = emallocaligned(nu_parts[l] * size);
+        memset(nuc->level[l].fdl, 0, nu_parts[l] * size);
+        nuc->level[l].acc = emallocaligned(size);
+        nuc->level[l].work[0] = emallocaligned(size);
+        nuc->level[l].work[1] = emallocaligned(size);
+        nuc->level[l].zero = true;
+        nuc->level[l].out[0] = emallocaligned(size >> 1);
+        nuc->level[l].out[1] = emallocaligned(size >> 1);
+        nuc->level[l].out_zero[0] = true;
+        nuc->level[l].out_zero[1] = true;
+        if (n_inputs > 0) {
+            nuc->level[l].coeffs = emalloc(n_inputs * sizeof(nu_coeffs_t *));
+        }
+    }
+    return nuc;
+}
+
+void *
+convolver_nu_cbuf2time(nu_conv_t *nuc,
+                       void *input_cbuf)
+{
+    double scale;
+
+    scale = 1.0 / (double)n_fft;
+    convolver_mixnscale(&input_cbuf, nuc->tmp, &scale, 1,
+                        CONVOLVER_MIXMODE_OUTPUT);
+    convolver_freq2time(nuc->tmp, nuc->tmp);
+    return &((uint8_t *)nuc->tmp)[n_fft2 * realsize];
+}
+
+void
+convolver_nu_input(nu_conv_t *nuc,
+                   void *input,
+                   int delay)
+{
+    int l, size, pos, len, n_units, first, last, fwd, jj, phase;
+    unsigned int t = nuc->blockcounter++;
+    uint8_t *ring = (uint8_t *)nuc->ring;
+
+    /* put the time-domain input into the ring buffer, delayed as the head
+       input */
+    pos = (int)((t + (unsigned int)delay) * (unsigned int)n_fft2 &
+                (unsigned int)(nuc->ring_size - 1));
+    if (input != NULL) {
+        memcpy(&ring[pos * realsize], input, n_fft2 * realsize);
+    } else {
+        memset(&ring[pos * realsize], 0, n_fft2 * realsize);
+    }
+
+    /* do this period's share of the forward transforms of each tail level,
+       see convolver_nu_sum() */
+    for (l = 1; l <= nu_n_levels; l++) {
+        size = 1 << l;
+        phase = (int)((t + 1) & (size - 1));
+        jj = (int)((t + 1) >> l);
+        if (jj < 1) {
+            continue;
+        }
+        len = size * n_fft;
+        if (phase == 0) {
+            nuc->level[l].pos = (nuc->level[l].pos + 1) % nu_parts[l];
+        }
+        n_units = (l << 1) + 3;
+        first = phase * n_units;
+        last = first + n_units;
+        fwd = (l + 1) << l;
+        if (first < fwd) {
+            nu_forward_units(l, ring, (jj - 2) * size * n_fft2,
+                             nuc->ring_size - 1, nuc->level[l].work,
+                             &((uint8_t *)nuc->level[l].fdl)
+                             [nuc->level[l].pos * len * realsize],
+                             first, last < fwd ? last : fwd);
+        }
+    }
+}
+
+void *
+convolver_nu_sum(nu_conv_t *nuc,
+                 nu_conv_t *inputs[],
+                 nu_coeffs_t *coeffs[],
+                 int n_inputs)
+{
+    int l, p, n, c, i, size, len, n_parts, n_units, first, last, fwd;
+    unsigned int t = nuc->sum_blockcounter++;
+    uint8_t *buf;
+    bool_t iszero, add;
+    int jj, j, phase, lo, hi;
+    nu_coeffs_t *cur;
+
+    /* do this period's share of the work of each tail level. The window of
+       two partitions ending with block 'jj' * 'size' - 1 is complete at the
+       start of the level's period (phase 0), and its output is needed
+       'size' periods later. The work is made of (l + 1) << l forward
+       transform units, done by convolver_nu_input() for each input, 1 << l
+       product units and (l + 1) << l inverse transform units, done in the
+       order given */
+    for (l = 1; l <= nu_n_levels; l++) {
+        size = 1 << l;
+        phase = (int)((t + 1) & (size - 1));
+        jj = (int)((t + 1) >> l);
+        if (jj < 1) {
+            continue;
+        }
+        j = jj - 1;
+        n_parts = nu_parts[l];
+        len = size * n_fft;
+        if (phase == 0) {
+            /* the coefficients are kept for the whole window */
+            nuc->level[l].zero = true;
+            for (i = 0; i < n_inputs; i++) {
+                nuc->level[l].coeffs[i] = coeffs[i];
+                if (coeffs[i] != NULL && coeffs[i]->n_parts[l] > 0) {
+                    nuc->level[l].zero = false;
+                }
+            }
+        }
+        n_units = (l << 1) + 3;
+        first = phase * n_units;
+        last = first + n_units;
+        fwd = (l + 1) << l;
+        if (nuc->level[l].zero) {
+            if (phase == size - 1) {
+                nuc->level[l].out_zero[j & 1] = true;
+            }
+            continue;
+        }
+        for (c = first - fwd; c < last - fwd && c < size; c++) {
+            if (c < 0) {
+                continue;
+            }
+            lo = nu_chunk((len >> 1) + 1, c, size);
+            hi = nu_chunk((len >> 1) + 1, c + 1, size);
+            add = false;
+            for (i = 0; i < n_inputs; i++) {
+                cur = nuc->level[l].coeffs[i];
+                for (p = 0; cur != NULL && p < cur->n_parts[l]; p++) {
+                    n = (inputs[i]->level[l].pos - p + n_parts) % n_parts;
+                    if (realsize == 4) {
+                        nu_convolvef(&((uint8_t *)inputs[i]->level[l].fdl)
+                                     [n * len * realsize],
+                                     &((uint8_t *)cur->parts[l])
+                                     [p * len * realsize],
+                                     nuc->level[l].acc, len, lo, hi, add);
+                    } else {
+                        nu_convolved(&((uint8_t *)inputs[i]->level[l].fdl)
+                                     [n * len * realsize],
+                                     &((uint8_t *)cur->parts[l])
+                                     [p * len * realsize],
+                                     nuc->level[l].acc, len, lo, hi, add);
+                    }
+                    add = true;
+                }
+            }
+        }
+        if (last > fwd + size) {
+            first -= fwd + size;
+            nu_inverse_units(l, nuc->level[l].acc, nuc->level[l].work,
+                             nuc->level[l].out[j & 1], first > 0 ? first : 0,
+                             last - (fwd + size));
+        }
+        if (phase == size - 1) {
+            nuc->level[l].out_zero[j & 1] = false;
+        }
+    }
+
+    /* sum the tail output for this period */
+    iszero = true;
+    for (l = 1; l <= nu_n_levels; l++) {
+        size = 1 << l;
+        j = (int)((t + 1) >> l) - 2;
+        if (j < 0 || nuc->level[l].out_zero[j & 1]) {
+            continue;
+        }
+        buf = &((uint8_t *)nuc->level[l].out[j & 1])
+            [((t + 1) & (size - 1)) * n_fft2 * realsize];
+        if (iszero) {
+            memcpy(nuc->tmp, buf, n_fft2 * realsize);
+            iszero = false;
+        } else {
+            add_reals(nuc->tmp, buf, n_fft2);
+        }
+    }
+    return iszero ? NULL : nuc->tmp;
+}
+
+void *
+convolver_nu_convolve(nu_conv_t *nuc,
+                      void *input,
+                      int delay,
+                      nu_coeffs_t *coeffs)
+{
+    convolver_nu_input(nuc, input, delay);
+    return convolver_nu_sum(nuc, &nuc, &coeffs, 1);
+}
+
+void
+convolver_nu_add(nu_conv_t *nuc,
+                 void *output_cbuf,
+                 bool_t output_is_zero)
+{
+    double scale;
+
+    memset(&((uint8_t *)nuc->tmp)[n_fft2 * realsize], 0,
+           n_fft2 * realsize);
+    convolver_time2freq(nuc->tmp, nuc->tmp);
+    scale = 1.0 / (double)n_fft;
+    convolver_mixnscale(&nuc->tmp, output_cbuf, &scale, 1,
+                        output_is_zero ? CONVOLVER_MIXMODE_INPUT :
+                        CONVOLVER_MIXMODE_INPUT_ADD);
+}
+
+void
+convolver_save_wisdom(void)
+{
+    char model[1000];
+    FILE *stream;
+
+    if (!save_wisdom) {
+        return;
+    }
+    if ((stream = fopen(wisdom_filename, "wt")) == NULL) {
+        fprintf(stderr, "Warning: could not save wisdom:\n"
+                "  could not open \"%s\" for writing: %s.\n",
+                wisdom_filename, strerror(errno));
+        return;
+    }
+    if (bfconf->plan != BF_PLAN_NONE) {
+        processor_model(model, sizeof(model));
+        fprintf(stream, "%s%s\n", PLANNED_WISDOM_HEADER, model);
+    }
     if (realsize == 4) {
-        fftwf_execute_r2r(tdc->fftplan, overlap_block, overlap_block);
-        convolve_inplace_ordered(overlap_block, tdc->coeffs,
-                                 tdc->blocklen << 1);
-        fftwf_execute_r2r(tdc->ifftplan, overlap_block, overlap_block);
+        fftwf_export_wisdom_to_file(stream);
     } else {
-        fftw_execute_r2r(tdc->fftplan, overlap_block, overlap_block);
-        convolve_inplace_ordered(overlap_block, tdc->coeffs,
-                                 tdc->blocklen << 1);
-        fftw_execute_r2r(tdc->ifftplan, overlap_block, overlap_block);
+        fftw_export_wisdom_to_file(stream);
     }
+    fclose(stream);
 }
 
 bool_t
@@ -786,12 +3068,12 @@ convolver_init(const char config_filename[],
 	       int length,
                int _realsize)
 {
-    int order;
+    char s[1000], model[1000];
+    int order, header_length;
+    bool_t quiet, use_wisdom;
     FILE *stream;
-    bool_t quiet;
 
     realsize = _realsize;
-    decide_opt_code();
 
     if (realsize != 4 && realsize != 8) {
 	fprintf(stderr, "Invalid real size %d.\n", realsize);
@@ -805,7 +3087,54 @@ convolver_init(const char config_filename[],
     fft_order = order;
     n_fft = 2 * length;
     n_fft2 = length;
+    complex_layout = bfconf->complex_spectrum;
+    n_cblocks = complex_layout ? (n_fft >> 3) + 1 : n_fft >> 3;
+
+    if (!decide_opt_code(bfconf->cpu_optimisation)) {
+        return false;
+    }
+    setup_kernels(&kernels, realsize);
+    if (complex_layout) {
+        setup_complex_kernels(&kernels, realsize);
+    }
+    /* double precision accumulation is selected per filter */
+    kernels.convolve_sum_mixed = kernels.convolve_sum;
+    if (realsize == 4) {
+        setup_mixed_kernels(&kernels);
+    } else {
+        /* for filters which are convolved in float */
+        setup_kernels(&float_kernels, 4);
+        if (complex_layout) {
+            setup_complex_kernels(&float_kernels, 4);
+        }
+        setup_mixed_kernels(&float_kernels);
+    }
+    filter_kernels = &kernels;
+    filter_realsize = realsize;
 
+    /* the threads are put to use by convolver_fft_threads_init() */
+#ifdef CONVOLVER_HAS_FFTW_THREADS
+    if (bfconf->fft_threads > 1 &&
+        (realsize == 4 ? fftwf_init_threads() : fftw_init_threads()) == 0)
+    {
+        fprintf(stderr, "Failed to initialise FFTW threads.\n");
+        return false;
+    }
+#else
+    if (bfconf->fft_threads > 1) {
+        fprintf(stderr, "Warning: built without FFTW thread support, "
+                "fft_threads is ignored.\n");
+        bfconf->fft_threads = 1;
+    }
+#endif
+
+    /* Planned wisdom is made from with FFTW_WISDOM_ONLY and is left as it is,
+       other wisdom is added to */
+    wisdom_filename = estrdup(config_filename);
+    if (bfconf->plan != BF_PLAN_NONE) {
+        plan_flags = bfconf->plan == BF_PLAN_EXHAUSTIVE ?
+            FFTW_EXHAUSTIVE : FFTW_PATIENT;
+    }
     if ((stream = fopen(config_filename, "rt")) == NULL) {
 	if (errno != ENOENT) {
 	    fprintf(stderr, "Could not open \"%s\" for reading: %s.\n",
@@ -813,39 +3142,78 @@ convolver_init(const char config_filename[],
 	    return false;
 	}
     } else {
-        /* We ignore if we can't read wisdom, we just overwrite with new */
-        if (realsize == 4) {
-            fftwf_import_wisdom_from_file(stream);
+        use_wisdom = true;
+        header_length = strlen(PLANNED_WISDOM_HEADER);
+        if (fgets(s, sizeof(s), stream) != NULL &&
+            strncmp(s, PLANNED_WISDOM_HEADER, header_length) == 0)
+        {
+            processor_model(model, sizeof(model));
+            s[header_length + strcspn(&s[header_length], "\r\n")] = '\0';
+            if (strcmp(&s[header_length], model) != 0) {
+                fprintf(stderr, "Warning: the wisdom in \"%s\" is planned "
+                        "for another processor\n  (%s), ignoring it.\n",
+                        config_filename, &s[header_length]);
+                use_wisdom = false;
+                save_wisdom = bfconf->plan != BF_PLAN_NONE;
+            } else if (bfconf->plan == BF_PLAN_NONE) {
+                pinfo("Using planned wisdom.\n");
+                plan_flags = FFTW_WISDOM_ONLY | FFTW_PATIENT;
+                save_wisdom = false;
+            }
         } else {
-            fftw_import_wisdom_from_file(stream);
+            rewind(stream);
+        }
+        /* We ignore if we can't read wisdom, we just overwrite with new */
+        if (use_wisdom) {
+            if (realsize == 4) {
+                fftwf_import_wisdom_from_file(stream);
+            } else {
+                fftw_import_wisdom_from_file(stream);
+            }
         }
         fclose(stream);
     }
 
+    if (bfconf->fft_backend != NULL &&
+        strcmp(bfconf->fft_backend, "fftw") == 0)
+    {
+        fft_backend = FFT_BACKEND_FFTW;
+    } else if (bfconf->fft_backend != NULL &&
+               strcmp(bfconf->fft_backend, "radix4") == 0)
+    {
+        fft_backend = FFT_BACKEND_RADIX4;
+    } else {
+        fft_backend = FFT_BACKEND_AUTO;
+    }
     memset(fftplan_generated, 0, sizeof(fftplan_generated));
-    pinfo("Creating 4 FFTW plans of size %d...", 1 << fft_order);
-    quiet = bfconf->quiet;
-    bfconf->quiet = true;
-    convolver_fftplan(fft_order, false, false);
-    convolver_fftplan(fft_order, false, true);
-    convolver_fftplan(fft_order, true, false);
-    convolver_fftplan(fft_order, true, true);
-    bfconf->quiet = quiet;
+    if (complex_layout) {
+        pinfo("Creating 4 FFTW r2c/c2r plans of size %d...", 1 << fft_order);
+        cfftplan_table[0][0] = create_complex_fft_plan(n_fft, false, false);
+        cfftplan_table[0][1] = create_complex_fft_plan(n_fft, true, false);
+        cfftplan_table[1][0] = create_complex_fft_plan(n_fft, false, true);
+        cfftplan_table[1][1] = create_complex_fft_plan(n_fft, true, true);
+    } else {
+        pinfo("Creating 4 FFT plans of size %d...", 1 << fft_order);
+        quiet = bfconf->quiet;
+        bfconf->quiet = true;
+        convolver_fftplan(fft_order, false, false);
+        convolver_fftplan(fft_order, false, true);
+        convolver_fftplan(fft_order, true, false);
+        convolver_fftplan(fft_order, true, true);
+        bfconf->quiet = quiet;
+    }
     pinfo("finished.\n");
+    if (!complex_layout) {
+        pinfo("FFT backend for size %d: %s forward, %s inverse.\n",
+              1 << fft_order, fftplan_table[0][0][fft_order]->backend->name,
+              fftplan_table[1][0][fft_order]->backend->name);
+    }
 
-    /* Wisdom is cumulative, save it each time (and get wiser) */
-    if ((stream = fopen(config_filename, "wt")) == NULL) {
-        fprintf(stderr, "Warning: could not save wisdom:\n"
-                "  could not open \"%s\" for writing: %s.\n",
-                config_filename, strerror(errno));
-    } else {
-        if (realsize == 4) {
-            fftwf_export_wisdom_to_file(stream);
-        } else {
-            fftw_export_wisdom_to_file(stream);
-        }
-        fclose(stream);
+    /* Wisdom is cumulative, save it each time (and get wiser). In plan mode
+       it is saved when all plans are made. */
+    if (bfconf->plan == BF_PLAN_NONE) {
+        convolver_save_wisdom();
     }
-    
+
     return true;
 }
@@ -23,6 +23,7 @@ RENDER_EQUALISER_NAME(struct realtime_eq *eq)
     real_t mag, rad, curfreq, scale, divtaps, tapspi;
     real_t *eqmag, *eqfreq, *eqphase;
     struct timeval tv1, tv2;
+    void *target;
     char path[1024];
     FILE *stream;
     int n, i;
@@ -62,15 +63,7 @@ RENDER_EQUALISER_NAME(struct realtime_eq *eq)
     ((real_t *)rbuf)[eq->taps>>1] = eqmag[eq->band_count - 1] * scale;
 
     /* convert to time-domain */
-#if REALSIZE == 4
-    fftwf_execute_r2r((const fftwf_plan)eq->ifftplan,
-                      (real_t *)rbuf, (real_t *)rbuf);
-#elif REALSIZE == 8
-    fftw_execute_r2r((const fftw_plan)eq->ifftplan,
-                     (real_t *)rbuf, (real_t *)rbuf);
-#else
- #error invalid REALSIZE
-#endif
+    bfaccess->convolver_fft_execute(eq->ifftplan, rbuf, rbuf);
 
     if (debug_dump_filter_path != NULL) {
         snprintf(path, 1024, debug_dump_filter_path, eq->coeff[0]);
@@ -85,9 +78,17 @@ RENDER_EQUALISER_NAME(struct realtime_eq *eq)
     }
     /* put to target BruteFIR coeffients */
     for (n = 0; n < coeffs[eq->coeff[0]].n_blocks; n++) {
+        target = bfaccess->coeffs_data[eq->coeff[!eq->active_coeff]][n];
+        if (coeffs[eq->coeff[0]].compression != BF_COEFF_COMPRESSION_FP32) {
+            bfaccess->convolver_coeffs2cbuf(&((real_t *)rbuf)
+                                            [block_length * n], target);
+            continue;
+        }
         bfaccess->convolver_coeffs2cbuf(&((real_t *)rbuf)[block_length * n],
-                                        bfaccess->coeffs_data
-                                        [eq->coeff[!eq->active_coeff]][n]);
+                                        wide_cbuf);
+        for (i = 0; i < 2 * block_length; i++) {
+            ((float *)target)[i] = (float)((real_t *)wide_cbuf)[i];
+        }
     }
     gettimeofday(&tv2, NULL);
     timersub(&tv2, &tv1, &tv1);
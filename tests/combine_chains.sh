@@ -0,0 +1,80 @@
+#!/bin/sh
+#
+# Filters in series combined at startup must give the same output as when
+# they are run as given. With a logic module loaded only fixed filters are
+# combined, so the CLI is loaded in both runs and only the fixed fields
+# differ. Covers a filter taking over the inputs of two filters with the same
+# set and delay, filters taking over the outputs of a filter they feed with
+# different sets, delays which add up, a filter without coefficients, and a
+# filter which is not fixed left in a chain of fixed ones. The filters keep
+# their indexes when combined, so the same CLI command changes the filter
+# after the combined chains in both runs, and an absorbed filter is refused.
+# The combined run is also compared with the reference convolution computed
+# by firtest.
+#
+. ./common.sh
+
+"$FIRTEST" noise "$WORK/in.raw" 8192 3 1 || exit 1
+"$FIRTEST" coeffs "$WORK/c0.txt" 200 2 || exit 1
+"$FIRTEST" coeffs "$WORK/c1.txt" 150 3 || exit 1
+"$FIRTEST" coeffs "$WORK/c2.txt" 100 4 || exit 1
+
+# config <float bits> <fixed> <cli script>
+config() {
+    cat <<EOF
+float_bits: $1;
+filter_length: 128,8;
+
+logic: "cli" { script: "$3"; };
+
+coeff 0 { filename: "$WORK/c0.txt"; format: "text"; };
+coeff 1 { filename: "$WORK/c1.txt"; format: "text"; };
+coeff 2 { filename: "$WORK/c2.txt"; format: "text"; };
+
+filter 0 { from_inputs: 0; to_filters: 2; coeff: 0; delay: 1; fixed: $2; };
+filter 1 { from_inputs: 1//0.5; to_filters: 2; coeff: 0; delay: 1;
+           fixed: $2; };
+filter 2 { from_filters: 0, 1//-1; to_outputs: 0; coeff: 1; fixed: $2; };
+filter 3 { from_inputs: 2; to_filters: 5; coeff: 1; fixed: $2; };
+filter 4 { from_inputs: 0//0.25; to_filters: 5; coeff: -1; delay: 2;
+           fixed: $2; };
+filter 5 { from_filters: 3, 4; to_outputs: 1/3; coeff: 2; delay: 1;
+           fixed: $2; };
+filter 6 { from_inputs: 1; to_filters: 7; coeff: 2; fixed: $2; };
+filter 7 { from_filters: 6; to_filters: 8; coeff: 0; };
+filter 8 { from_filters: 7; to_outputs: 2; coeff: 1; fixed: $2; };
+EOF
+}
+
+reference ref 3 3 0:0:1:128:c0.txt+c1.txt 0:1:-0.5:128:c0.txt+c1.txt \
+          1:2:$(scale 3):128:c1.txt+c2.txt 1:0:$(scale 3 0.25):384:c2.txt \
+          2:1:0.5:0:c2.txt+c0.txt+c1.txt || exit 1
+
+failed=0
+for bits in 32 64; do
+    if [ $bits = 32 ]; then
+        tolerance=1e-5
+    else
+        tolerance=1e-12
+    fi
+    echo "float_bits $bits:"
+    if run combined 3 3 $bits true \
+           "cffa 7 6 m0.5;; cfc 0 1;; lf;; sleep b1000" &&
+        [ $(grep -c "is combined with" "$WORK/combined.log") = 4 ] &&
+        [ $(grep -c "(combined into other filters)" \
+                 "$WORK/combined.log") = 3 ] &&
+        grep -q "Filter 0 is combined into other filters and cannot" \
+             "$WORK/combined.log" &&
+        run separate 3 3 $bits false "cffa 7 6 m0.5;; sleep b1000" &&
+        ! grep -q "is combined with" "$WORK/separate.log" &&
+        "$FIRTEST" compare "$WORK/combined.raw" "$WORK/separate.raw" \
+                   $tolerance &&
+        "$FIRTEST" compare "$WORK/combined.raw" "$WORK/ref.raw" $tolerance
+    then
+        echo "  passed"
+    else
+        echo "  FAILED"
+        failed=1
+    fi
+done
+exit $failed
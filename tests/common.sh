@@ -0,0 +1,82 @@
+#
+# Sourced by the test scripts, which are run from the tests directory after
+# building, or through 'make check'. BRUTEFIR and MODULES_PATH may point
+# elsewhere than the build directory.
+#
+BRUTEFIR=${BRUTEFIR:-../brutefir}
+MODULES_PATH=${MODULES_PATH:-..}
+FIRTEST=${FIRTEST:-./firtest}
+WORK=${TMPDIR:-/tmp}/brutefir_test.$$
+
+trap 'rm -rf "$WORK"' EXIT
+mkdir -p "$WORK" || exit 1
+
+# run <name> <inputs> <outputs> [<config arguments>...]
+#
+# Writes <name>.conf from the common settings, what the config function of
+# the test script prints given the remaining arguments, and file I/O reading
+# <inputs> channels from in.raw and writing <outputs> channels to <name>.raw.
+# Then runs BruteFIR with it, and shows <name>.log if it fails.
+run() {
+    run_name=$1
+    run_inputs=$2
+    run_outputs=$3
+    shift 3
+    {
+        cat <<EOF
+sampling_rate: 44100;
+overflow_warnings: false;
+show_progress: false;
+modules_path: "$MODULES_PATH";
+convolver_config: "$WORK/wisdom";
+EOF
+        config "$@"
+        cat <<EOF
+
+input $(channel_list $run_inputs) {
+        device: "file" { path: "$WORK/in.raw"; };
+        sample: "FLOAT64_LE";
+        channels: $run_inputs;
+};
+output $(channel_list $run_outputs) {
+        device: "file" { path: "$WORK/$run_name.raw"; };
+        sample: "FLOAT64_LE";
+        channels: $run_outputs;
+};
+EOF
+    } > "$WORK/$run_name.conf"
+    "$BRUTEFIR" -nodefault "$WORK/$run_name.conf" \
+                > "$WORK/$run_name.log" 2>&1
+    if [ $? -ne 0 ]; then
+        cat "$WORK/$run_name.log"
+        return 1
+    fi
+}
+
+# reference <name> <inputs> <outputs> <term>...
+#
+# Writes the output BruteFIR should give to <name>.raw, computed from in.raw
+# by 'firtest convolve'. The coefficient files in the terms are given
+# relative to the work directory.
+reference() {
+    reference_name=$1
+    reference_inputs=$2
+    reference_outputs=$3
+    shift 3
+    "$FIRTEST" convolve "$WORK/in.raw" $reference_inputs \
+               "$WORK/$reference_name.raw" $reference_outputs \
+               $(for term in "$@"; do
+                     echo "$term" | sed "s|\([^:+]*\.txt\)|$WORK/\1|g"
+                 done)
+}
+
+# channel_list <channels>, prints 0, 1, ... <channels - 1>
+channel_list() {
+    awk "BEGIN { printf \"0\"; for (n = 1; n < $1; n++) printf \", %d\", n }"
+}
+
+# scale <attenuation in dB> [<multiplier>], prints the scale of a channel
+# given as <attenuation>, or as <attenuation>/<multiplier>, in a filter
+scale() {
+    awk "BEGIN { printf \"%.17g\", ${2:-1} * 10 ^ (-$1 / 20) }"
+}
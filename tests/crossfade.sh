@@ -0,0 +1,69 @@
+#!/bin/sh
+#
+# A coefficient change made by the CLI on a crossfading filter must give a
+# linear crossfade over one block from the output with the old coefficients
+# to the output with the new ones. Covers a filter feeding an output which is
+# also fed by a filter that does not crossfade, a filter feeding another
+# filter, and uniform and non-uniform partitioning (where crossfading filters
+# are convolved uniformly) in both float and double precision. The outputs
+# with the old and the new coefficients are compared with the reference
+# convolution computed by firtest.
+#
+. ./common.sh
+
+"$FIRTEST" noise "$WORK/in.raw" 8192 2 1 || exit 1
+"$FIRTEST" coeffs "$WORK/c0.txt" 1000 2 || exit 1
+"$FIRTEST" coeffs "$WORK/c1.txt" 700 3 || exit 1
+"$FIRTEST" coeffs "$WORK/c2.txt" 300 4 || exit 1
+
+# config <float bits> <partitioning> <coeff> <script>
+config() {
+    cat <<EOF
+float_bits: $1;
+filter_length: 64,16;
+partitioning: $2;
+
+logic: "cli" { script: "$4"; };
+
+coeff 0 { filename: "$WORK/c0.txt"; format: "text"; };
+coeff 1 { filename: "$WORK/c1.txt"; format: "text"; };
+coeff 2 { filename: "$WORK/c2.txt"; format: "text"; };
+
+filter 0 { from_inputs: 0; to_outputs: 0; coeff: $3; crossfade: true; };
+filter 1 { from_inputs: 1; to_filters: 2; coeff: $3; crossfade: true; };
+filter 2 { from_filters: 1; to_outputs: 1; coeff: -1; };
+filter 3 { from_inputs: 1; to_outputs: 0; coeff: 2; };
+EOF
+}
+
+for n in 0 1; do
+    reference ref$n 2 2 0:0:1:0:c$n.txt 1:1:1:0:c$n.txt 0:1:1:0:c2.txt ||
+        exit 1
+done
+
+failed=0
+for bits in 32 64; do
+    if [ $bits = 32 ]; then
+        tolerance=1e-5
+    else
+        tolerance=1e-12
+    fi
+    for partitioning in '"uniform"' '"non-uniform"'; do
+        echo "float_bits $bits, partitioning $partitioning:"
+        if run from 2 2 $bits "$partitioning" 0 "sleep b1000" &&
+            "$FIRTEST" compare "$WORK/from.raw" "$WORK/ref0.raw" $tolerance &&
+            run to 2 2 $bits "$partitioning" 1 "sleep b1000" &&
+            "$FIRTEST" compare "$WORK/to.raw" "$WORK/ref1.raw" $tolerance &&
+            run switch 2 2 $bits "$partitioning" 0 \
+                "sleep b37;; cfc 0 1; cfc 1 1;; sleep b1000" &&
+            "$FIRTEST" crossfade "$WORK/from.raw" "$WORK/to.raw" \
+                       "$WORK/switch.raw" 2 64 $tolerance
+        then
+            echo "  passed"
+        else
+            echo "  FAILED"
+            failed=1
+        fi
+    done
+done
+exit $failed
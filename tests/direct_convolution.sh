@@ -0,0 +1,68 @@
+#!/bin/sh
+#
+# Filters convolved in the time-domain (direct_convolution) must give the
+# same output as when they are processed in the frequency-domain. Covers the
+# dirac pulse with scaling and a filter delay, a single tap with leading
+# zeros (taken as a delay), a short set, and two filters mixed to one output,
+# next to filters which stay in the frequency-domain as they share a channel
+# with a long filter. The CLI must refuse to change a direct filter to a
+# set which is not kept in the time-domain. Both are compared with the
+# reference convolution computed by firtest.
+#
+. ./common.sh
+
+"$FIRTEST" noise "$WORK/in.raw" 8192 3 1 || exit 1
+printf '0\n0\n0\n0.7\n' > "$WORK/tap.txt"
+printf '0\n0\n0.5\n-0.25\n0.125\n0\n' > "$WORK/short.txt"
+"$FIRTEST" coeffs "$WORK/long.txt" 150 2 || exit 1
+
+# config <float bits> <filter length> <direct convolution> <script>
+config() {
+    cat <<EOF
+float_bits: $1;
+filter_length: $2;
+direct_convolution: $3;
+
+logic: "cli" { script: "$4"; };
+
+coeff 0 { filename: "$WORK/tap.txt"; format: "text"; };
+coeff 1 { filename: "$WORK/short.txt"; format: "text"; };
+coeff 2 { filename: "$WORK/long.txt"; format: "text"; };
+
+filter 0 { from_inputs: 0//0.5; to_outputs: 0; coeff: -1; delay: 1; };
+filter 1 { from_inputs: 1; to_outputs: 1; coeff: 0; };
+filter 2 { from_inputs: 0; to_outputs: 2; coeff: 1; };
+filter 3 { from_inputs: 1//-1; to_outputs: 2; coeff: -1; };
+filter 4 { from_inputs: 2; to_outputs: 3, 4; coeff: 1; };
+filter 5 { from_inputs: 2; to_outputs: 4; coeff: 2; };
+EOF
+}
+
+failed=0
+for bits in 32 64; do
+    if [ $bits = 32 ]; then
+        tolerance=1e-6
+    else
+        tolerance=1e-12
+    fi
+    for length in 256,2 64,4 64,3; do
+        echo "float_bits $bits, filter_length $length:"
+        if run direct 3 5 $bits $length 8 "cfc 1 2;; sleep b1000" &&
+            [ $(grep -c "^Filter .* in the time-domain" \
+                     "$WORK/direct.log") = 4 ] &&
+            grep -q "coefficients are not kept there" "$WORK/direct.log" &&
+            run fft 3 5 $bits $length false "sleep b1000" &&
+            reference ref 3 5 0:0:0.5:${length%,*}:- 1:1:1:0:tap.txt \
+                      2:0:1:0:short.txt 2:1:-1:0:- 3:2:1:0:short.txt \
+                      4:2:1:0:short.txt 4:2:1:0:long.txt &&
+            "$FIRTEST" compare "$WORK/direct.raw" "$WORK/ref.raw" $tolerance &&
+            "$FIRTEST" compare "$WORK/fft.raw" "$WORK/ref.raw" $tolerance
+        then
+            echo "  passed"
+        else
+            echo "  FAILED"
+            failed=1
+        fi
+    done
+done
+exit $failed
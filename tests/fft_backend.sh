@@ -0,0 +1,63 @@
+#!/bin/sh
+#
+# Consecutive inputs and outputs must be transformed with batched FFTW plans
+# with the automatic FFT backend, also when the built-in FFT is chosen for
+# single transforms, and one by one only when the built-in FFT is set. All
+# backends must give the reference convolution computed by firtest.
+#
+. ./common.sh
+
+"$FIRTEST" noise "$WORK/in.raw" 8192 3 1 || exit 1
+"$FIRTEST" coeffs "$WORK/c0.txt" 300 2 || exit 1
+"$FIRTEST" coeffs "$WORK/c1.txt" 200 3 || exit 1
+
+# config <float bits> <filter length> <backend>
+config() {
+    cat <<EOF
+float_bits: $1;
+filter_length: $2;
+fft_backend: "$3";
+
+coeff 0 { filename: "$WORK/c0.txt"; format: "text"; };
+coeff 1 { filename: "$WORK/c1.txt"; format: "text"; };
+
+filter 0 { from_inputs: 0; to_outputs: 0; coeff: 0; };
+filter 1 { from_inputs: 1; to_outputs: 1; coeff: 1; };
+filter 2 { from_inputs: 2; to_outputs: 2; coeff: 0; };
+EOF
+}
+
+reference ref 3 3 0:0:1:0:c0.txt 1:1:1:0:c1.txt 2:2:1:0:c0.txt || exit 1
+
+# batched <name>, true if both directions have a batched FFTW plan
+batched() {
+    grep -q "forward FFTW plan of 3 transforms" "$WORK/$1.log" &&
+        grep -q "inverse FFTW plan of 3 transforms" "$WORK/$1.log"
+}
+
+failed=0
+for bits in 32 64; do
+    if [ $bits = 32 ]; then
+        tolerance=1e-5
+    else
+        tolerance=1e-12
+    fi
+    for length in 64,8 1024,1; do
+        echo "float_bits $bits, filter_length $length:"
+        if run auto 3 3 $bits $length auto && batched auto &&
+            grep -q "^FFT backend for size" "$WORK/auto.log" &&
+            run fftw 3 3 $bits $length fftw && batched fftw &&
+            run radix4 3 3 $bits $length radix4 && ! batched radix4 &&
+            grep -q "done one by one" "$WORK/radix4.log" &&
+            "$FIRTEST" compare "$WORK/auto.raw" "$WORK/ref.raw" $tolerance &&
+            "$FIRTEST" compare "$WORK/fftw.raw" "$WORK/ref.raw" $tolerance &&
+            "$FIRTEST" compare "$WORK/radix4.raw" "$WORK/ref.raw" $tolerance
+        then
+            echo "  passed"
+        else
+            echo "  FAILED"
+            failed=1
+        fi
+    done
+done
+exit $failed
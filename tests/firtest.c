@@ -0,0 +1,385 @@
+/*
+ * (c) Copyright 2026 -- Anders Torger
+ *
+ * This program is open source. For license terms, see the LICENSE file.
+ *
+ */
+
+/*
+ * Helper for the test scripts: writes test signals and coefficient sets,
+ * computes reference outputs, and compares BruteFIR outputs.
+ *
+ *   firtest noise <file> <frames> <channels> <seed>
+ *       white noise in [-0.5, 0.5], FLOAT64_LE interleaved
+ *   firtest coeffs <file> <taps> <seed>
+ *       decaying noise coefficients, in text format
+ *   firtest convolve <input> <channels> <output> <channels> <term>...
+ *       reference output as long as the input, by direct convolution. With
+ *       file I/O BruteFIR writes the output aligned with the input. Each
+ *       term is <output>:<input>:<scale>:<delay>:<coeffs>, which adds the
+ *       input channel scaled, delayed <delay> frames and convolved with the
+ *       coefficients to the output channel. <coeffs> is a coefficient file
+ *       in text format, or '-' for a single unit tap, and several joined
+ *       with '+' are convolved with each other, like filters in series.
+ *   firtest compare <file a> <file b> <tolerance> [<channels> <channel>...]
+ *       largest difference between two FLOAT64_LE files, fails if above the
+ *       tolerance, if the lengths differ or if they are empty. If the files
+ *       have <channels> interleaved channels, only the given ones are
+ *       compared.
+ *   firtest crossfade <from> <to> <file> <channels> <block frames> <tolerance>
+ *       checks that the file is <from> up to a block, then one block of a
+ *       linear crossfade from <from> to <to>, and then <to>. Fails if there
+ *       is no such block.
+ */
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <stdint.h>
+#include <math.h>
+
+static uint32_t seed;
+
+static double
+noise(void)
+{
+    seed = seed * 1664525 + 1013904223;
+    return (double)(seed >> 8) / (double)(1 << 24) - 0.5;
+}
+
+static void
+write_le64(FILE *stream,
+           double x)
+{
+    uint8_t b[8];
+    uint64_t u;
+    int n;
+
+    memcpy(&u, &x, 8);
+    for (n = 0; n < 8; n++) {
+        b[n] = (uint8_t)(u >> (8 * n));
+    }
+    fwrite(b, 8, 1, stream);
+}
+
+static int
+read_le64(FILE *stream,
+          double *x)
+{
+    uint8_t b[8];
+    uint64_t u = 0;
+    int n;
+
+    if (fread(b, 8, 1, stream) != 1) {
+        return 0;
+    }
+    for (n = 0; n < 8; n++) {
+        u |= (uint64_t)b[n] << (8 * n);
+    }
+    memcpy(x, &u, 8);
+    return 1;
+}
+
+static FILE *
+open_file(const char filename[],
+          const char mode[])
+{
+    FILE *stream;
+
+    if ((stream = fopen(filename, mode)) == NULL) {
+        fprintf(stderr, "firtest: could not open \"%s\".\n", filename);
+        exit(2);
+    }
+    return stream;
+}
+
+static int
+compare(const char filename_a[],
+        const char filename_b[],
+        double tolerance,
+        int channels,
+        char *selected[])
+{
+    FILE *a, *b;
+    double x, y, max = 0;
+    int n_a, n_b, n = 0, i, channel, compared = 0;
+
+    a = open_file(filename_a, "rb");
+    b = open_file(filename_b, "rb");
+    while (1) {
+        n_a = read_le64(a, &x);
+        n_b = read_le64(b, &y);
+        if (n_a != n_b) {
+            fprintf(stderr, "firtest: the lengths of \"%s\" and \"%s\" "
+                    "differ.\n", filename_a, filename_b);
+            return 1;
+        }
+        if (n_a == 0) {
+            break;
+        }
+        /* without selected channels all are compared */
+        channel = n++ % channels;
+        for (i = 0; selected[i] != NULL; i++) {
+            if (atoi(selected[i]) == channel) {
+                break;
+            }
+        }
+        if (i > 0 && selected[i] == NULL) {
+            continue;
+        }
+        if (!(fabs(x - y) <= max)) {
+            max = fabs(x - y);
+        }
+        compared++;
+    }
+    fclose(a);
+    fclose(b);
+    printf("%d samples, largest difference %.3g\n", compared, max);
+    return compared == 0 || !(max <= tolerance);
+}
+
+static double *
+read_file(const char filename[],
+          int *n_samples)
+{
+    FILE *stream;
+    double *buf = NULL, x;
+    int size = 0;
+
+    stream = open_file(filename, "rb");
+    *n_samples = 0;
+    while (read_le64(stream, &x)) {
+        if (*n_samples == size) {
+            size = size == 0 ? 65536 : 2 * size;
+            if ((buf = realloc(buf, size * sizeof(double))) == NULL) {
+                fprintf(stderr, "firtest: out of memory.\n");
+                exit(2);
+            }
+        }
+        buf[(*n_samples)++] = x;
+    }
+    fclose(stream);
+    return buf;
+}
+
+static double *
+read_coeffs(const char filename[],
+            int *n_taps)
+{
+    FILE *stream;
+    double *buf = NULL, x;
+    int size = 0;
+
+    *n_taps = 0;
+    if (strcmp(filename, "-") == 0) {
+        /* a single unit tap */
+        if ((buf = malloc(sizeof(double))) == NULL) {
+            fprintf(stderr, "firtest: out of memory.\n");
+            exit(2);
+        }
+        buf[(*n_taps)++] = 1.0;
+        return buf;
+    }
+    stream = open_file(filename, "r");
+    while (fscanf(stream, "%lf", &x) == 1) {
+        if (*n_taps == size) {
+            size = size == 0 ? 4096 : 2 * size;
+            if ((buf = realloc(buf, size * sizeof(double))) == NULL) {
+                fprintf(stderr, "firtest: out of memory.\n");
+                exit(2);
+            }
+        }
+        buf[(*n_taps)++] = x;
+    }
+    fclose(stream);
+    if (*n_taps == 0) {
+        fprintf(stderr, "firtest: no coefficients in \"%s\".\n", filename);
+        exit(2);
+    }
+    return buf;
+}
+
+/* the coefficient files joined with '+' convolved with each other */
+static double *
+chain_coeffs(char names[],
+             int *n_taps)
+{
+    double *h, *c, *y;
+    int n_h, n_c, n, i;
+    char *name;
+
+    name = strtok(names, "+");
+    h = read_coeffs(name, &n_h);
+    while ((name = strtok(NULL, "+")) != NULL) {
+        c = read_coeffs(name, &n_c);
+        if ((y = calloc(n_h + n_c - 1, sizeof(double))) == NULL) {
+            fprintf(stderr, "firtest: out of memory.\n");
+            exit(2);
+        }
+        for (n = 0; n < n_h; n++) {
+            for (i = 0; i < n_c; i++) {
+                y[n + i] += h[n] * c[i];
+            }
+        }
+        free(h);
+        free(c);
+        h = y;
+        n_h += n_c - 1;
+    }
+    *n_taps = n_h;
+    return h;
+}
+
+static int
+convolve(const char filename_in[],
+         int in_channels,
+         const char filename_out[],
+         int out_channels,
+         int n_terms,
+         char *terms[])
+{
+    int n_x, frames, n, i, k, t, output, input, term_delay, n_taps;
+    double *x, *y, *h, scale, sum;
+    char names[1024];
+    FILE *stream;
+
+    x = read_file(filename_in, &n_x);
+    frames = n_x / in_channels;
+    if ((y = calloc(frames * out_channels, sizeof(double))) == NULL) {
+        fprintf(stderr, "firtest: out of memory.\n");
+        exit(2);
+    }
+    for (n = 0; n < n_terms; n++) {
+        if (sscanf(terms[n], "%d:%d:%lf:%d:%1023s", &output, &input, &scale,
+                   &term_delay, names) != 5 ||
+            output < 0 || output >= out_channels ||
+            input < 0 || input >= in_channels || term_delay < 0)
+        {
+            fprintf(stderr, "firtest: invalid term \"%s\".\n", terms[n]);
+            return 2;
+        }
+        h = chain_coeffs(names, &n_taps);
+        for (t = term_delay; t < frames; t++) {
+            sum = 0;
+            k = t - term_delay;
+            for (i = 0; i < n_taps && i <= k; i++) {
+                sum += h[i] * x[(k - i) * in_channels + input];
+            }
+            y[t * out_channels + output] += scale * sum;
+        }
+        free(h);
+    }
+    stream = open_file(filename_out, "wb");
+    for (n = 0; n < frames * out_channels; n++) {
+        write_le64(stream, y[n]);
+    }
+    fclose(stream);
+    free(x);
+    free(y);
+    return 0;
+}
+
+static int
+crossfade(const char filename_from[],
+          const char filename_to[],
+          const char filename[],
+          int channels,
+          int block_frames,
+          double tolerance)
+{
+    double *from, *to, *y, w, max = 0;
+    int n_from, n_to, n, start, end, block_length;
+
+    from = read_file(filename_from, &n_from);
+    to = read_file(filename_to, &n_to);
+    y = read_file(filename, &n);
+    if (n != n_from || n != n_to || n == 0) {
+        fprintf(stderr, "firtest: the lengths of the files differ.\n");
+        return 1;
+    }
+    /* the fade starts at the block of the first sample which is not
+       <from> */
+    for (start = 0; start < n; start++) {
+        if (!(fabs(y[start] - from[start]) <= tolerance)) {
+            break;
+        }
+    }
+    block_length = channels * block_frames;
+    start -= start % block_length;
+    end = start + block_length;
+    if (end > n) {
+        fprintf(stderr, "firtest: \"%s\" has no complete crossfade.\n",
+                filename);
+        return 1;
+    }
+    for (n = start; n < n_to; n++) {
+        if (n < end) {
+            w = (double)((n - start) / channels) / (double)(block_frames - 1);
+            w = from[n] * (1.0 - w) + to[n] * w;
+        } else {
+            w = to[n];
+        }
+        if (!(fabs(y[n] - w) <= max)) {
+            max = fabs(y[n] - w);
+        }
+    }
+    printf("crossfade at frame %d, largest difference %.3g\n",
+           start / channels, max);
+    free(from);
+    free(to);
+    free(y);
+    return !(max <= tolerance);
+}
+
+int
+main(int argc,
+     char *argv[])
+{
+    FILE *stream;
+    int n, n_samples;
+
+    if (argc == 6 && strcmp(argv[1], "noise") == 0) {
+        n_samples = atoi(argv[3]) * atoi(argv[4]);
+        seed = (uint32_t)atoi(argv[5]);
+        stream = open_file(argv[2], "wb");
+        for (n = 0; n < n_samples; n++) {
+            write_le64(stream, noise());
+        }
+        fclose(stream);
+        return 0;
+    }
+    if (argc == 5 && strcmp(argv[1], "coeffs") == 0) {
+        n_samples = atoi(argv[3]);
+        seed = (uint32_t)atoi(argv[4]);
+        stream = open_file(argv[2], "w");
+        for (n = 0; n < n_samples; n++) {
+            fprintf(stream, "%.17g\n", 2.0 * noise() *
+                    exp(-6.0 * (double)n / (double)n_samples));
+        }
+        fclose(stream);
+        return 0;
+    }
+    if (argc >= 6 && strcmp(argv[1], "convolve") == 0) {
+        return convolve(argv[2], atoi(argv[3]), argv[4], atoi(argv[5]),
+                        argc - 6, &argv[6]);
+    }
+    if (argc == 5 && strcmp(argv[1], "compare") == 0) {
+        return compare(argv[2], argv[3], atof(argv[4]), 1, &argv[5]);
+    }
+    if (argc > 6 && strcmp(argv[1], "compare") == 0) {
+        return compare(argv[2], argv[3], atof(argv[4]), atoi(argv[5]),
+                       &argv[6]);
+    }
+    if (argc == 8 && strcmp(argv[1], "crossfade") == 0) {
+        return crossfade(argv[2], argv[3], argv[4], atoi(argv[5]),
+                         atoi(argv[6]), atof(argv[7]));
+    }
+    fprintf(stderr, "usage: firtest noise <file> <frames> <channels> <seed>\n"
+            "       firtest coeffs <file> <taps> <seed>\n"
+            "       firtest convolve <input> <channels> <output> <channels> "
+            "<term>...\n"
+            "       firtest compare <file a> <file b> <tolerance> "
+            "[<channels> <channel>...]\n"
+            "       firtest crossfade <from> <to> <file> <channels> "
+            "<block frames> <tolerance>\n");
+    return 2;
+}
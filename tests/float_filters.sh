@@ -0,0 +1,95 @@
+#!/bin/sh
+#
+# Filters convolved in float (the filter float_bits field) in a 64 bit
+# configuration must give the same output, within float precision, as the
+# same filters convolved in double. Covers coefficients stored as fp32 and
+# fp16, a filter delay, a filter feeding another filter, double accumulation,
+# interleaved partitions, the complex spectrum layout, non-uniform
+# partitioning, and an equaliser rendered by the eq module to shared fp32
+# coefficients (not with non-uniform partitioning, where changes made by
+# modules only reach the first partitions). The outputs which are not
+# equalised are compared with the reference convolution computed by firtest,
+# within the precision of the compression.
+#
+. ./common.sh
+
+"$FIRTEST" noise "$WORK/in.raw" 8192 2 1 || exit 1
+"$FIRTEST" coeffs "$WORK/c0.txt" 768 2 || exit 1
+"$FIRTEST" coeffs "$WORK/c1.txt" 700 3 || exit 1
+
+EQ='logic: "eq" {
+        {
+                coeff: 2;
+                bands: 100, 1000, 5000;
+                magnitude: 100/6, 1000/-4, 5000/3;
+        };
+};
+coeff 2 {
+        filename: "dirac pulse";
+        shared_mem: true;
+        blocks: 8;
+        compression: "fp32";
+};'
+
+# config <filter float bits> <compression> <settings>
+config() {
+    cat <<EOF
+float_bits: 64;
+filter_length: 128,8;
+$3
+
+coeff 0 { filename: "$WORK/c0.txt"; format: "text"; compression: "$2"; };
+coeff 1 { filename: "$WORK/c1.txt"; format: "text"; compression: "$2"; };
+$eq
+
+filter 0 {
+        from_inputs: 0, 1//0.5;
+        to_outputs: 0;
+        coeff: 0;
+        delay: 2;
+        float_bits: $1;
+};
+filter 1 { from_inputs: 1; to_filters: 2; coeff: 1; float_bits: $1; };
+filter 2 { from_filters: 1; to_outputs: 1; coeff: 0; float_bits: $1; };
+filter 3 {
+        from_inputs: 0;
+        to_outputs: 2;
+        coeff: $eqcoeff;
+        float_bits: $1;
+};
+EOF
+}
+
+reference ref 2 3 0:0:1:256:c0.txt 0:1:0.5:256:c0.txt \
+          1:1:1:0:c1.txt+c0.txt || exit 1
+
+failed=0
+for compression in fp32 fp16; do
+    if [ $compression = fp32 ]; then
+        tolerance=1e-5
+    else
+        tolerance=1e-2
+    fi
+    for settings in "" "double_accumulation: true;" \
+        "interleaved_partitions: true;" 'spectrum_layout: "complex";' \
+        'partitioning: "non-uniform";'
+    do
+        case "$settings" in
+            *non-uniform*) eq= ; eqcoeff=-1 ;;
+            *) eq=$EQ ; eqcoeff=2 ;;
+        esac
+        echo "$compression${settings:+, $settings}"
+        if run float 2 3 32 $compression "$settings" &&
+            run double 2 3 64 $compression "$settings" &&
+            "$FIRTEST" compare "$WORK/float.raw" "$WORK/double.raw" 1e-5 &&
+            "$FIRTEST" compare "$WORK/double.raw" "$WORK/ref.raw" \
+                       $tolerance 3 0 1
+        then
+            echo "  passed"
+        else
+            echo "  FAILED"
+            failed=1
+        fi
+    done
+done
+exit $failed
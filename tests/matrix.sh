@@ -0,0 +1,99 @@
+#!/bin/sh
+#
+# A matrix must give the same output as the same coefficient sets run as
+# separate filters, one for each input of each output. Covers coefficient
+# sets of different lengths, one shorter than the filter and one starting
+# with zero partitions, a scaled input, partitions long enough for the
+# spectrum to be summed in several tiles, interleaved partitions, the complex
+# spectrum layout, double accumulation, non-uniform partitioning, and input
+# attenuation, output attenuation and delay changed by the CLI while
+# running. Without the changes the matrix must give the reference convolution
+# computed by firtest.
+#
+. ./common.sh
+
+"$FIRTEST" noise "$WORK/in.raw" 16384 2 1 || exit 1
+for n in 0 1 2 3 4; do
+    "$FIRTEST" coeffs "$WORK/c$n.txt" $((1000 - 150 * n)) $((n + 2)) || exit 1
+done
+# one zero partition of 512 before the set
+awk 'BEGIN { for (n = 0; n < 512; n++) print 0 }' > "$WORK/c5.txt"
+"$FIRTEST" coeffs "$WORK/c.txt" 100 7 || exit 1
+cat "$WORK/c.txt" >> "$WORK/c5.txt"
+
+# config <float bits> <filter length> <settings> <script> <filters>
+config() {
+    cat <<EOF
+float_bits: $1;
+filter_length: $2;
+$3
+
+logic: "cli" { script: "$4"; };
+
+coeff 0 { filename: "$WORK/c0.txt"; format: "text"; };
+coeff 1 { filename: "$WORK/c1.txt"; format: "text"; };
+coeff 2 { filename: "$WORK/c2.txt"; format: "text"; };
+coeff 3 { filename: "$WORK/c3.txt"; format: "text"; };
+coeff 4 { filename: "$WORK/c4.txt"; format: "text"; };
+coeff 5 { filename: "$WORK/c5.txt"; format: "text"; };
+
+$5
+EOF
+}
+
+MATRIX='matrix "m" {
+        from_inputs: 0, 1//0.5;
+        to_outputs: 0, 1/3, 2;
+        coeff: 0, 1, 2, 3, 4, 5;
+};'
+MATRIX_SCRIPT='sleep b37;; cfia 0 1 m-0.25;; sleep b21;; cfoa 0 2 6;;
+               sleep b29;; cfd 0 3;; sleep b1000'
+FILTERS='filter 0 { from_inputs: 0; to_outputs: 0; coeff: 0; };
+filter 1 { from_inputs: 1//0.5; to_outputs: 0; coeff: 1; };
+filter 2 { from_inputs: 0; to_outputs: 1/3; coeff: 2; };
+filter 3 { from_inputs: 1//0.5; to_outputs: 1/3; coeff: 3; };
+filter 4 { from_inputs: 0; to_outputs: 2; coeff: 4; };
+filter 5 { from_inputs: 1//0.5; to_outputs: 2; coeff: 5; };'
+FILTERS_SCRIPT='sleep b37;; cfia 1 1 m-0.25; cfia 3 1 m-0.25; cfia 5 1 m-0.25;;
+                sleep b21;; cfoa 4 2 6; cfoa 5 2 6;; sleep b29;;
+                cfd 0 3; cfd 1 3; cfd 2 3; cfd 3 3; cfd 4 3; cfd 5 3;;
+                sleep b1000'
+
+reference ref 2 3 0:0:1:0:c0.txt 0:1:0.5:0:c1.txt \
+          1:0:$(scale 3):0:c2.txt 1:1:$(scale 3 0.5):0:c3.txt \
+          2:0:1:0:c4.txt 2:1:0.5:0:c5.txt || exit 1
+
+failed=0
+for bits in 32 64; do
+    if [ $bits = 32 ]; then
+        tolerance=1e-5
+    else
+        tolerance=1e-12
+    fi
+    for length in 64,16 512,4; do
+        for settings in "" "interleaved_partitions: true;" \
+            'spectrum_layout: "complex";' "double_accumulation: true;" \
+            'partitioning: "non-uniform";'
+        do
+            name="float_bits $bits, filter_length $length"
+            echo "$name${settings:+, $settings}"
+            if run static 2 3 $bits $length "$settings" "sleep b1000" \
+                   "$MATRIX" &&
+                "$FIRTEST" compare "$WORK/static.raw" "$WORK/ref.raw" \
+                           $tolerance &&
+                run matrix 2 3 $bits $length "$settings" "$MATRIX_SCRIPT" \
+                    "$MATRIX" &&
+                run filters 2 3 $bits $length "$settings" \
+                    "$FILTERS_SCRIPT" "$FILTERS" &&
+                "$FIRTEST" compare "$WORK/matrix.raw" "$WORK/filters.raw" \
+                           $tolerance
+            then
+                echo "  passed"
+            else
+                echo "  FAILED"
+                failed=1
+            fi
+        done
+    done
+done
+exit $failed
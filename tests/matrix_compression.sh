@@ -0,0 +1,69 @@
+#!/bin/sh
+#
+# A matrix with compressed coefficients must give the same output as the
+# same coefficients run as separate filters. A matrix sums more partitions
+# at once than a filter has blocks, which once overran the buffer the
+# coefficients are widened into. Both are compared with the reference
+# convolution computed by firtest, within the precision of the compression.
+#
+. ./common.sh
+
+"$FIRTEST" noise "$WORK/in.raw" 8192 2 1 || exit 1
+for n in 0 1 2 3; do
+    "$FIRTEST" coeffs "$WORK/c$n.txt" $((200 + 100 * n)) $((n + 2)) || exit 1
+done
+
+# config <float bits> <filter length> <compression> <filters>
+config() {
+    cat <<EOF
+float_bits: $1;
+filter_length: $2;
+
+coeff 0 { filename: "$WORK/c0.txt"; format: "text"; compression: "$3"; };
+coeff 1 { filename: "$WORK/c1.txt"; format: "text"; compression: "$3"; };
+coeff 2 { filename: "$WORK/c2.txt"; format: "text"; compression: "$3"; };
+coeff 3 { filename: "$WORK/c3.txt"; format: "text"; compression: "$3"; };
+
+$4
+EOF
+}
+
+MATRIX='matrix "m" {
+        from_inputs: 0, 1//0.5;
+        to_outputs: 0, 1;
+        coeff: 0, 1, 2, 3;
+};'
+FILTERS='filter 0 { from_inputs: 0; to_outputs: 0; coeff: 0; };
+filter 1 { from_inputs: 1//0.5; to_outputs: 0; coeff: 1; };
+filter 2 { from_inputs: 0; to_outputs: 1; coeff: 2; };
+filter 3 { from_inputs: 1//0.5; to_outputs: 1; coeff: 3; };'
+
+reference ref 2 2 0:0:1:0:c0.txt 0:1:0.5:0:c1.txt 1:0:1:0:c2.txt \
+          1:1:0.5:0:c3.txt || exit 1
+
+failed=0
+for bits in 32 64; do
+    for length in 512,1 128,4 64,8; do
+        for compression in fp32 fp16 bf16; do
+            case $compression in
+                fp32) tolerance=1e-6 ;;
+                fp16) tolerance=2e-3 ;;
+                bf16) tolerance=2e-2 ;;
+            esac
+            echo "float_bits $bits, filter_length $length, $compression:"
+            if run matrix 2 2 $bits $length $compression "$MATRIX" &&
+                run filters 2 2 $bits $length $compression "$FILTERS" &&
+                "$FIRTEST" compare "$WORK/matrix.raw" "$WORK/filters.raw" \
+                           1e-4 &&
+                "$FIRTEST" compare "$WORK/matrix.raw" "$WORK/ref.raw" \
+                           $tolerance
+            then
+                echo "  passed"
+            else
+                echo "  FAILED"
+                failed=1
+            fi
+        done
+    done
+done
+exit $failed
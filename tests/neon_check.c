@@ -0,0 +1,678 @@
+/*
+ * (c) Copyright 2026 -- Anders Torger
+ *
+ * This program is open source. For license terms, see the LICENSE file.
+ *
+ */
+
+/*
+ * Cross-check of the NEON functions in convolver_neon.c against plain C
+ * references written from the descriptions of the internal formats (see
+ * fftw_convfuns.h), over a range of sizes which covers the odd block counts
+ * and the tails of the loops. It is built natively on AArch64, and 'make
+ * check-neon-qemu' cross-compiles it and runs it with qemu-aarch64. 'make
+ * check-neon-emu' builds it with the scalar intrinsics in tests/neon_emu,
+ * which only checks the C code around the intrinsics, not NEON itself.
+ */
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <stdint.h>
+#include <math.h>
+
+#include "asmprot.h"
+
+#define MAX_BLOCKS 9
+#define MAX_FFT (MAX_BLOCKS << 3)
+#define MAX_PAIRS 4
+#define MAX_TAPS 33
+#define MAX_SAMPLES 70
+
+typedef void (*convolve_fn)(void *input_cbuf,
+                            void *coeffs,
+                            void *output_cbuf,
+                            int loop_counter);
+typedef void (*convolve_sum_fn)(void *input_cbufs[],
+                                void *coeffs[],
+                                int n_pairs,
+                                void *output_cbuf,
+                                int loop_counter);
+typedef void (*mixnscale_fn)(void *input_cbufs[],
+                             void *output_cbuf,
+                             double scales[],
+                             int n_bufs,
+                             int loop_counter);
+
+static int n_checks = 0;
+static int n_failed = 0;
+static uint32_t seed = 1;
+
+static double
+noise(void)
+{
+    seed = seed * 1664525 + 1013904223;
+    return (double)(seed >> 8) / (double)(1 << 23) - 1.0;
+}
+
+static double
+get(void *buf,
+    int realsize,
+    int n)
+{
+    return realsize == 4 ? (double)((float *)buf)[n] : ((double *)buf)[n];
+}
+
+static void
+set(void *buf,
+    int realsize,
+    int n,
+    double x)
+{
+    if (realsize == 4) {
+        ((float *)buf)[n] = (float)x;
+    } else {
+        ((double *)buf)[n] = x;
+    }
+}
+
+static void
+fill(void *buf,
+     int realsize,
+     int n)
+{
+    int i;
+
+    for (i = 0; i < n; i++) {
+        set(buf, realsize, i, noise());
+    }
+}
+
+/* compare 'n' values to the reference, relative to the magnitude of the
+   values which were summed */
+static void
+check(const char name[],
+      int realsize,
+      int size,
+      void *buf,
+      double ref[],
+      int n,
+      double magnitude)
+{
+    double tolerance = (realsize == 4 ? 1e-6 : 1e-14) * magnitude;
+    int i;
+
+    n_checks++;
+    for (i = 0; i < n; i++) {
+        if (!(fabs(get(buf, realsize, i) - ref[i]) <= tolerance)) {
+            fprintf(stderr, "%s%s, size %d: element %d is %.9g, expected "
+                    "%.9g.\n", name, realsize == 4 ? "f" : "d", size, i,
+                    get(buf, realsize, i), ref[i]);
+            n_failed++;
+            return;
+        }
+    }
+}
+
+/* the product of two blocks of 8 reals, 4 real parts followed by 4
+   imaginary, with DC and nyquist in the first block as two real parts */
+static void
+ref_block_product(void *b,
+                  void *c,
+                  int realsize,
+                  int n,
+                  double d[])
+{
+    double bre, bim, cre, cim;
+    int k;
+
+    for (k = 0; k < 4; k++) {
+        bre = get(b, realsize, n + k);
+        bim = get(b, realsize, n + k + 4);
+        cre = get(c, realsize, n + k);
+        cim = get(c, realsize, n + k + 4);
+        if (n + k == 0) {
+            d[0] += bre * cre;
+            d[4] += bim * cim;
+        } else {
+            d[n + k] += bre * cre - bim * cim;
+            d[n + k + 4] += bre * cim + bim * cre;
+        }
+    }
+}
+
+/* the product of interleaved complex values */
+static void
+ref_complex_product(void *b,
+                    void *c,
+                    int realsize,
+                    int n,
+                    double d[])
+{
+    double bre, bim, cre, cim;
+
+    bre = get(b, realsize, n);
+    bim = get(b, realsize, n + 1);
+    cre = get(c, realsize, n);
+    cim = get(c, realsize, n + 1);
+    d[n] += bre * cre - bim * cim;
+    d[n + 1] += bre * cim + bim * cre;
+}
+
+static void
+ref_product(void *b,
+            void *c,
+            int realsize,
+            int n_fft,
+            int complex_layout,
+            double d[])
+{
+    int n;
+
+    if (complex_layout) {
+        for (n = 0; n < n_fft; n += 2) {
+            ref_complex_product(b, c, realsize, n, d);
+        }
+    } else {
+        for (n = 0; n < n_fft; n += 8) {
+            ref_block_product(b, c, realsize, n, d);
+        }
+    }
+}
+
+static void
+check_convolve(const char name[],
+               convolve_fn convolve,
+               convolve_fn convolve_add,
+               convolve_sum_fn convolve_sum,
+               int realsize,
+               int complex_layout)
+{
+    static double b[MAX_PAIRS][MAX_FFT], c[MAX_PAIRS][MAX_FFT], d[MAX_FFT];
+    void *bp[MAX_PAIRS], *cp[MAX_PAIRS];
+    double ref[MAX_FFT];
+    char fname[100];
+    int n_blocks, n_fft, n_pairs, n, p;
+
+    for (p = 0; p < MAX_PAIRS; p++) {
+        bp[p] = b[p];
+        cp[p] = c[p];
+    }
+    for (n_blocks = 1; n_blocks <= MAX_BLOCKS; n_blocks++) {
+        n_fft = n_blocks << 3;
+        for (p = 0; p < MAX_PAIRS; p++) {
+            fill(b[p], realsize, n_fft);
+            fill(c[p], realsize, n_fft);
+        }
+
+        memset(ref, 0, sizeof(ref));
+        ref_product(b[0], c[0], realsize, n_fft, complex_layout, ref);
+        fill(d, realsize, n_fft);
+        convolve(b[0], c[0], d, n_blocks);
+        sprintf(fname, "%sconvolve", name);
+        check(fname, realsize, n_blocks, d, ref, n_fft, 2);
+
+        /* in-place, as used by convolver_convolve_inplace() */
+        memcpy(d, b[0], n_fft * realsize);
+        convolve(d, c[0], d, n_blocks);
+        sprintf(fname, "%sconvolve_inplace", name);
+        check(fname, realsize, n_blocks, d, ref, n_fft, 2);
+
+        fill(d, realsize, n_fft);
+        for (n = 0; n < n_fft; n++) {
+            ref[n] = get(d, realsize, n);
+        }
+        ref_product(b[0], c[0], realsize, n_fft, complex_layout, ref);
+        convolve_add(b[0], c[0], d, n_blocks);
+        sprintf(fname, "%sconvolve_add", name);
+        check(fname, realsize, n_blocks, d, ref, n_fft, 3);
+
+        for (n_pairs = 1; n_pairs <= MAX_PAIRS; n_pairs++) {
+            memset(ref, 0, sizeof(ref));
+            for (p = 0; p < n_pairs; p++) {
+                ref_product(b[p], c[p], realsize, n_fft, complex_layout, ref);
+            }
+            fill(d, realsize, n_fft);
+            convolve_sum(bp, cp, n_pairs, d, n_blocks);
+            sprintf(fname, "%sconvolve_sum(%d)", name, n_pairs);
+            check(fname, realsize, n_blocks, d, ref, n_fft, 2 * n_pairs);
+        }
+    }
+}
+
+/* the float sums which accumulate in double, checked with the tolerance of
+   a double sum rounded once to float */
+static void
+check_convolve_sum_mixed(const char name[],
+                         convolve_sum_fn convolve_sum,
+                         int complex_layout)
+{
+    static float b[MAX_PAIRS][MAX_FFT], c[MAX_PAIRS][MAX_FFT], d[MAX_FFT];
+    void *bp[MAX_PAIRS], *cp[MAX_PAIRS];
+    double ref[MAX_FFT];
+    char fname[100];
+    int n_blocks, n_fft, n, p;
+
+    for (p = 0; p < MAX_PAIRS; p++) {
+        bp[p] = b[p];
+        cp[p] = c[p];
+    }
+    for (n_blocks = 1; n_blocks <= MAX_BLOCKS; n_blocks++) {
+        n_fft = n_blocks << 3;
+        for (p = 0; p < MAX_PAIRS; p++) {
+            fill(b[p], 4, n_fft);
+            fill(c[p], 4, n_fft);
+        }
+        memset(ref, 0, sizeof(ref));
+        for (p = 0; p < MAX_PAIRS; p++) {
+            ref_product(b[p], c[p], 4, n_fft, complex_layout, ref);
+        }
+        convolve_sum(bp, cp, MAX_PAIRS, d, n_blocks);
+        sprintf(fname, "%sconvolve_sum_mixed", name);
+        n_checks++;
+        for (n = 0; n < n_fft; n++) {
+            if (!(fabs((double)d[n] - ref[n]) <= 1e-6 * fabs(ref[n]) + 1e-12)) {
+                fprintf(stderr, "%sf, size %d: element %d is %.9g, expected "
+                        "%.9g.\n", fname, n_blocks, n, (double)d[n], ref[n]);
+                n_failed++;
+                break;
+            }
+        }
+    }
+}
+
+static void
+check_dirac(void (*dirac_convolve)(void *input_cbuf,
+                                   void *output_cbuf,
+                                   double fraction,
+                                   int loop_counter),
+            int realsize)
+{
+    static double b[MAX_FFT], d[MAX_FFT];
+    double ref[MAX_FFT], fraction = 1.0 / 48.0;
+    int n_blocks, n_fft, n;
+
+    for (n_blocks = 1; n_blocks <= MAX_BLOCKS; n_blocks++) {
+        n_fft = n_blocks << 3;
+        fill(b, realsize, n_fft);
+        for (n = 0; n < n_fft; n++) {
+            ref[n] = get(b, realsize, n) * ((n & 1) != 0 ? -fraction :
+                                            fraction);
+        }
+        dirac_convolve(b, d, fraction, n_blocks);
+        check("dirac_convolve", realsize, n_blocks, d, ref, n_fft, 1);
+        dirac_convolve(b, b, fraction, n_blocks);
+        check("dirac_convolve_inplace", realsize, n_blocks, b, ref, n_fft, 1);
+    }
+}
+
+/* index in FFTW's halfcomplex format of element 'k' of the internal format */
+static int
+halfcomplex_index(int k,
+                  int n_fft)
+{
+    int n = (k >> 3) << 2, i = k & 3;
+
+    if ((k & 4) == 0) {
+        return n + i;
+    }
+    return n + i == 0 ? n_fft >> 1 : n_fft - n - i;
+}
+
+static void
+check_mixnscale(mixnscale_fn mixnscale_input,
+                mixnscale_fn mixnscale_output,
+                int realsize)
+{
+    static double in[3][MAX_FFT], d[MAX_FFT];
+    void *inp[3] = { in[0], in[1], in[2] };
+    double ref[MAX_FFT], scales[3], s;
+    int n_blocks, n_fft, n_bufs, n, i;
+
+    for (n_blocks = 1; n_blocks <= MAX_BLOCKS; n_blocks++) {
+        n_fft = n_blocks << 3;
+        for (n_bufs = 1; n_bufs <= 3; n_bufs++) {
+            for (i = 0; i < n_bufs; i++) {
+                fill(in[i], realsize, n_fft);
+                scales[i] = n_bufs == 1 ? 1.0 : noise();
+            }
+            s = 0;
+            for (i = 0; i < n_bufs; i++) {
+                s += fabs(scales[i]);
+            }
+
+            /* halfcomplex to internal */
+            for (n = 0; n < n_fft; n++) {
+                ref[n] = 0;
+                for (i = 0; i < n_bufs; i++) {
+                    ref[n] += get(in[i], realsize,
+                                  halfcomplex_index(n, n_fft)) * scales[i];
+                }
+            }
+            mixnscale_input(inp, d, scales, n_bufs, n_blocks);
+            check("mixnscale_input", realsize, n_blocks, d, ref, n_fft, s);
+
+            /* internal to halfcomplex */
+            for (n = 0; n < n_fft; n++) {
+                ref[halfcomplex_index(n, n_fft)] = 0;
+                for (i = 0; i < n_bufs; i++) {
+                    ref[halfcomplex_index(n, n_fft)] +=
+                        get(in[i], realsize, n) * scales[i];
+                }
+            }
+            mixnscale_output(inp, d, scales, n_bufs, n_blocks);
+            check("mixnscale_output", realsize, n_blocks, d, ref, n_fft, s);
+        }
+    }
+}
+
+static double
+fp16_value(uint16_t h)
+{
+    int e = (h >> 10) & 0x1F, m = h & 0x3FF;
+    double x;
+
+    x = e == 0 ? ldexp((double)m, -24) : ldexp((double)(m | 0x400), e - 25);
+    return (h & 0x8000) != 0 ? -x : x;
+}
+
+static void
+check_widen(void)
+{
+    static uint16_t h[MAX_FFT];
+    static float d[MAX_FFT];
+    double ref[MAX_FFT], scale = 1.0 / 3.0;
+    uint32_t u;
+    float f;
+    int n_blocks, n_fft, n;
+
+    for (n_blocks = 1; n_blocks <= MAX_BLOCKS; n_blocks++) {
+        n_fft = n_blocks << 3;
+        /* all exponents but the one of Inf and NaN, including subnormals */
+        for (n = 0; n < n_fft; n++) {
+            seed = seed * 1664525 + 1013904223;
+            h[n] = (uint16_t)(seed >> 16);
+            if (((h[n] >> 10) & 0x1F) == 0x1F) {
+                h[n] &= ~0x4000;
+            }
+            ref[n] = (double)((float)fp16_value(h[n]) * (float)scale);
+        }
+        convolver_neon_widen_fp16f(h, d, scale, n_blocks);
+        check("widen_fp16", 4, n_blocks, d, ref, n_fft, 0);
+
+        for (n = 0; n < n_fft; n++) {
+            f = (float)noise();
+            memcpy(&u, &f, 4);
+            h[n] = (uint16_t)(u >> 16);
+            u = (uint32_t)h[n] << 16;
+            memcpy(&f, &u, 4);
+            ref[n] = (double)(f * (float)scale);
+        }
+        convolver_neon_widen_bf16f(h, d, scale, n_blocks);
+        check("widen_bf16", 4, n_blocks, d, ref, n_fft, 0);
+    }
+}
+
+static void
+check_direct(void (*direct_convolve)(void *input,
+                                     void *coeffs,
+                                     int n_taps,
+                                     void *output,
+                                     int n_samples),
+             int realsize)
+{
+    static double x[MAX_TAPS + MAX_SAMPLES], h[MAX_TAPS], y[MAX_SAMPLES];
+    double ref[MAX_SAMPLES];
+    uint8_t *input;
+    int n_taps, n_samples, n, i;
+
+    for (n_taps = 1; n_taps <= MAX_TAPS; n_taps += 4) {
+        for (n_samples = 1; n_samples <= MAX_SAMPLES; n_samples += 3) {
+            /* the input starts after the n_taps - 1 samples of history */
+            fill(x, realsize, n_taps - 1 + n_samples);
+            fill(h, realsize, n_taps);
+            input = (uint8_t *)x + (n_taps - 1) * realsize;
+            for (n = 0; n < n_samples; n++) {
+                ref[n] = 0;
+                for (i = 0; i < n_taps; i++) {
+                    ref[n] += get(h, realsize, i) *
+                        get(x, realsize, n_taps - 1 + n - i);
+                }
+            }
+            direct_convolve(input, h, n_taps, y, n_samples);
+            check("direct_convolve", realsize, n_samples, y, ref, n_samples,
+                  n_taps);
+        }
+    }
+}
+
+static void
+check_raw2real(void)
+{
+    static int16_t s16[2 * MAX_SAMPLES];
+    static int32_t s32[2 * MAX_SAMPLES];
+    static float f32[2 * MAX_SAMPLES], r[MAX_SAMPLES];
+    double ref[MAX_SAMPLES];
+    int spacing, n_samples, expected, n, i;
+
+    for (spacing = 1; spacing <= 3; spacing++) {
+        for (n_samples = 1; n_samples <= MAX_SAMPLES; n_samples++) {
+            for (i = 0; i < 2 * MAX_SAMPLES; i++) {
+                seed = seed * 1664525 + 1013904223;
+                s16[i] = (int16_t)(seed >> 16);
+                s32[i] = (int32_t)seed;
+                f32[i] = (float)noise();
+            }
+            /* whole groups of 8, the last sample is left for the generic
+               code with spacing 2, nothing at all with larger spacings */
+            if (spacing == 1) {
+                expected = n_samples & ~7;
+            } else if (spacing == 2) {
+                expected = (n_samples - 1) & ~7;
+            } else {
+                expected = 0;
+            }
+
+            n = convolver_neon_raw2realf(r, s16, 2, 0, spacing, n_samples);
+            for (i = 0; i < expected; i++) {
+                ref[i] = (double)s16[i * spacing];
+            }
+            n_checks++;
+            if (n != expected) {
+                fprintf(stderr, "raw2real int16, spacing %d: %d of %d "
+                        "samples converted, expected %d.\n", spacing, n,
+                        n_samples, expected);
+                n_failed++;
+            }
+            check("raw2real_int16", 4, n_samples, r, ref, expected, 0);
+
+            n = convolver_neon_raw2realf(r, s32, 4, 0, spacing, n_samples);
+            for (i = 0; i < expected; i++) {
+                ref[i] = (double)(float)s32[i * spacing];
+            }
+            n_checks++;
+            if (n != expected) {
+                fprintf(stderr, "raw2real int32, spacing %d: %d of %d "
+                        "samples converted, expected %d.\n", spacing, n,
+                        n_samples, expected);
+                n_failed++;
+            }
+            check("raw2real_int32", 4, n_samples, r, ref, expected, 0);
+
+            n = convolver_neon_raw2realf(r, f32, 4, 1, spacing, n_samples);
+            for (i = 0; i < expected; i++) {
+                ref[i] = (double)f32[i * spacing];
+            }
+            n_checks++;
+            if (n != expected) {
+                fprintf(stderr, "raw2real float, spacing %d: %d of %d "
+                        "samples converted, expected %d.\n", spacing, n,
+                        n_samples, expected);
+                n_failed++;
+            }
+            check("raw2real_float", 4, n_samples, r, ref, expected, 0);
+        }
+    }
+}
+
+/* rounding of dither_funs.h without dither, false if the sample would be
+   clipped */
+static int
+ref_real2int(double x,
+             int bits,
+             int32_t *sample)
+{
+    double rmin = -(double)((uint64_t)1 << (bits - 1));
+    double rmax = (double)(((uint64_t)1 << (bits - 1)) - 1);
+
+    x += 0.5;
+    if (x < 0) {
+        if (x <= rmin) {
+            return 0;
+        }
+        *sample = (int32_t)x - 1;
+    } else {
+        if (x > rmax) {
+            return 0;
+        }
+        *sample = (int32_t)x;
+    }
+    return 1;
+}
+
+static void
+check_real2raw(void)
+{
+    static const int bits[3] = { 16, 24, 32 }, bytes[3] = { 2, 4, 4 };
+    static float r[MAX_SAMPLES];
+    static int32_t raw[3 * MAX_SAMPLES];
+    int32_t sample[MAX_SAMPLES], largest, ref_largest, v;
+    double max;
+    int t, spacing, n_samples, expected, n, i, k;
+
+    for (t = 0; t < 3; t++) {
+        max = (double)((uint64_t)1 << (bits[t] - 1));
+        for (spacing = 1; spacing <= 3; spacing++) {
+            for (n_samples = 1; n_samples <= MAX_SAMPLES; n_samples += 5) {
+                /* exact halves, to check the rounding, and random values */
+                for (i = 0; i < n_samples; i++) {
+                    k = (int)(noise() * 1000.0);
+                    switch (i % 3) {
+                    case 0:
+                        r[i] = (float)k + 0.5f;
+                        break;
+                    case 1:
+                        r[i] = (float)k - 0.5f;
+                        break;
+                    default:
+                        r[i] = (float)(noise() * max * 0.99);
+                        break;
+                    }
+                }
+                /* a sample to be clipped, in every other run */
+                if ((n_samples & 1) != 0) {
+                    k = (int)((noise() + 1.0) * 0.5 * (n_samples - 1));
+                    r[k] = (float)((n_samples & 2) != 0 ? 1.5 * max :
+                                   -1.01 * max);
+                }
+                /* conversion stops at the group of four with the clipping */
+                expected = n_samples & ~3;
+                ref_largest = 0;
+                for (i = 0; i < expected; i++) {
+                    if (!ref_real2int((double)r[i], bits[t], &sample[i])) {
+                        expected = i & ~3;
+                        break;
+                    }
+                }
+                for (i = 0; i < expected; i++) {
+                    v = sample[i] < 0 ? -sample[i] : sample[i];
+                    ref_largest = v > ref_largest ? v : ref_largest;
+                }
+                memset(raw, 0x55, sizeof(raw));
+                largest = 0;
+                n = convolver_neon_real2rawf(raw, r, bits[t], bytes[t],
+                                             spacing, n_samples, 1e30,
+                                             &largest);
+                n_checks++;
+                if (n != expected || largest != ref_largest) {
+                    fprintf(stderr, "real2raw %d bits, spacing %d: %d of %d "
+                            "samples converted with largest %d, expected %d "
+                            "with largest %d.\n", bits[t], spacing, n,
+                            n_samples, largest, expected, ref_largest);
+                    n_failed++;
+                    continue;
+                }
+                for (i = 0; i < n; i++) {
+                    v = bytes[t] == 2 ?
+                        (int32_t)((int16_t *)raw)[i * spacing] :
+                        raw[i * spacing];
+                    if (v != (bytes[t] == 2 ? (int16_t)sample[i] :
+                              sample[i]))
+                    {
+                        fprintf(stderr, "real2raw %d bits, spacing %d: "
+                                "sample %d (%.3f) is %d, expected %d.\n",
+                                bits[t], spacing, i, (double)r[i], v,
+                                sample[i]);
+                        n_failed++;
+                        break;
+                    }
+                }
+            }
+        }
+    }
+
+    /* a sample above the limit stops the conversion as well */
+    for (i = 0; i < 16; i++) {
+        r[i] = 100;
+    }
+    r[9] = 2000;
+    largest = 0;
+    n = convolver_neon_real2rawf(raw, r, 16, 2, 1, 16, 1000.0, &largest);
+    n_checks++;
+    if (n != 8) {
+        fprintf(stderr, "real2raw: %d samples converted before a sample "
+                "above the limit, expected 8.\n", n);
+        n_failed++;
+    }
+}
+
+int
+main(void)
+{
+    check_convolve("", convolver_neon_convolvef, convolver_neon_convolve_addf,
+                   convolver_neon_convolve_sumf, 4, 0);
+    check_convolve("", convolver_neon_convolved, convolver_neon_convolve_addd,
+                   convolver_neon_convolve_sumd, 8, 0);
+    check_convolve("complex_", convolver_neon_complex_convolvef,
+                   convolver_neon_complex_convolve_addf,
+                   convolver_neon_complex_convolve_sumf, 4, 1);
+    check_convolve("complex_", convolver_neon_complex_convolved,
+                   convolver_neon_complex_convolve_addd,
+                   convolver_neon_complex_convolve_sumd, 8, 1);
+    check_convolve_sum_mixed("", convolver_neon_convolve_sum_mixedf, 0);
+    check_convolve_sum_mixed("complex_",
+                             convolver_neon_complex_convolve_sum_mixedf, 1);
+    check_dirac(convolver_neon_dirac_convolvef, 4);
+    check_dirac(convolver_neon_dirac_convolved, 8);
+    check_mixnscale(convolver_neon_mixnscale_inputf,
+                    convolver_neon_mixnscale_outputf, 4);
+    check_mixnscale(convolver_neon_mixnscale_inputd,
+                    convolver_neon_mixnscale_outputd, 8);
+    check_widen();
+    check_direct(convolver_neon_direct_convolvef, 4);
+    check_direct(convolver_neon_direct_convolved, 8);
+    check_raw2real();
+    check_real2raw();
+
+    if (n_failed != 0) {
+        fprintf(stderr, "neon_check: %d of %d checks failed.\n", n_failed,
+                n_checks);
+        return 1;
+    }
+#ifndef __aarch64__
+    printf("neon_check: %d checks passed with emulated intrinsics only, "
+           "run 'make check-neon-qemu' to check the NEON code.\n", n_checks);
+#else
+    printf("neon_check: %d checks passed.\n", n_checks);
+#endif
+    return 0;
+}
@@ -0,0 +1,594 @@
+/*
+ * (c) Copyright 2026 -- Anders Torger
+ *
+ * This program is open source. For license terms, see the LICENSE file.
+ *
+ */
+
+/*
+ * Scalar emulation of the AArch64 NEON intrinsics used by convolver_neon.c,
+ * so that tests/neon_check can be run on other machines. The vectors are
+ * plain structs and each intrinsic is done lane by lane with the same
+ * rounding as the instruction (fused multiply-add, truncating conversions).
+ * It is only meant for the tests, not for running BruteFIR.
+ */
+#ifndef _ARM_NEON_EMU_H_
+#define _ARM_NEON_EMU_H_
+
+#include <stdint.h>
+#include <string.h>
+#include <math.h>
+
+typedef struct { float v[2]; } float32x2_t;
+typedef struct { float v[4]; } float32x4_t;
+typedef struct { double v[2]; } float64x2_t;
+typedef struct { uint16_t v[4]; } float16x4_t;
+typedef struct { int16_t v[4]; } int16x4_t;
+typedef struct { int16_t v[8]; } int16x8_t;
+typedef struct { int32_t v[2]; } int32x2_t;
+typedef struct { int32_t v[4]; } int32x4_t;
+typedef struct { int64_t v[2]; } int64x2_t;
+typedef struct { uint16_t v[4]; } uint16x4_t;
+typedef struct { uint32_t v[4]; } uint32x4_t;
+typedef struct { uint64_t v[2]; } uint64x2_t;
+typedef struct { float32x4_t val[2]; } float32x4x2_t;
+typedef struct { float64x2_t val[2]; } float64x2x2_t;
+typedef struct { int16x8_t val[2]; } int16x8x2_t;
+typedef struct { int32x4_t val[2]; } int32x4x2_t;
+
+#define EMU_LANES(x) (int)(sizeof((x).v) / sizeof((x).v[0]))
+#define EMU_FOR(x) for (emu_i = 0; emu_i < EMU_LANES(x); emu_i++)
+
+/* loads and stores */
+
+static inline float32x4_t
+vld1q_f32(const float *p)
+{
+    float32x4_t r;
+    memcpy(r.v, p, sizeof(r.v));
+    return r;
+}
+
+static inline float64x2_t
+vld1q_f64(const double *p)
+{
+    float64x2_t r;
+    memcpy(r.v, p, sizeof(r.v));
+    return r;
+}
+
+static inline int16x8_t
+vld1q_s16(const int16_t *p)
+{
+    int16x8_t r;
+    memcpy(r.v, p, sizeof(r.v));
+    return r;
+}
+
+static inline int32x4_t
+vld1q_s32(const int32_t *p)
+{
+    int32x4_t r;
+    memcpy(r.v, p, sizeof(r.v));
+    return r;
+}
+
+static inline uint16x4_t
+vld1_u16(const uint16_t *p)
+{
+    uint16x4_t r;
+    memcpy(r.v, p, sizeof(r.v));
+    return r;
+}
+
+static inline float32x4x2_t
+vld2q_f32(const float *p)
+{
+    float32x4x2_t r;
+    int emu_i;
+    EMU_FOR(r.val[0]) {
+        r.val[0].v[emu_i] = p[2 * emu_i];
+        r.val[1].v[emu_i] = p[2 * emu_i + 1];
+    }
+    return r;
+}
+
+static inline float64x2x2_t
+vld2q_f64(const double *p)
+{
+    float64x2x2_t r;
+    int emu_i;
+    EMU_FOR(r.val[0]) {
+        r.val[0].v[emu_i] = p[2 * emu_i];
+        r.val[1].v[emu_i] = p[2 * emu_i + 1];
+    }
+    return r;
+}
+
+static inline int16x8x2_t
+vld2q_s16(const int16_t *p)
+{
+    int16x8x2_t r;
+    int emu_i;
+    EMU_FOR(r.val[0]) {
+        r.val[0].v[emu_i] = p[2 * emu_i];
+        r.val[1].v[emu_i] = p[2 * emu_i + 1];
+    }
+    return r;
+}
+
+static inline int32x4x2_t
+vld2q_s32(const int32_t *p)
+{
+    int32x4x2_t r;
+    int emu_i;
+    EMU_FOR(r.val[0]) {
+        r.val[0].v[emu_i] = p[2 * emu_i];
+        r.val[1].v[emu_i] = p[2 * emu_i + 1];
+    }
+    return r;
+}
+
+static inline void
+vst1q_f32(float *p, float32x4_t a)
+{
+    memcpy(p, a.v, sizeof(a.v));
+}
+
+static inline void
+vst1q_f64(double *p, float64x2_t a)
+{
+    memcpy(p, a.v, sizeof(a.v));
+}
+
+static inline void
+vst1q_s32(int32_t *p, int32x4_t a)
+{
+    memcpy(p, a.v, sizeof(a.v));
+}
+
+static inline void
+vst1_s16(int16_t *p, int16x4_t a)
+{
+    memcpy(p, a.v, sizeof(a.v));
+}
+
+static inline void
+vst2q_f32(float *p, float32x4x2_t a)
+{
+    int emu_i;
+    EMU_FOR(a.val[0]) {
+        p[2 * emu_i] = a.val[0].v[emu_i];
+        p[2 * emu_i + 1] = a.val[1].v[emu_i];
+    }
+}
+
+static inline void
+vst2q_f64(double *p, float64x2x2_t a)
+{
+    int emu_i;
+    EMU_FOR(a.val[0]) {
+        p[2 * emu_i] = a.val[0].v[emu_i];
+        p[2 * emu_i + 1] = a.val[1].v[emu_i];
+    }
+}
+
+/* arithmetic */
+
+static inline float32x4_t
+vdupq_n_f32(float x)
+{
+    float32x4_t r;
+    int emu_i;
+    EMU_FOR(r) r.v[emu_i] = x;
+    return r;
+}
+
+static inline float64x2_t
+vdupq_n_f64(double x)
+{
+    float64x2_t r;
+    int emu_i;
+    EMU_FOR(r) r.v[emu_i] = x;
+    return r;
+}
+
+static inline int32x4_t
+vdupq_n_s32(int32_t x)
+{
+    int32x4_t r;
+    int emu_i;
+    EMU_FOR(r) r.v[emu_i] = x;
+    return r;
+}
+
+static inline float32x4_t
+vmulq_f32(float32x4_t a, float32x4_t b)
+{
+    int emu_i;
+    EMU_FOR(a) a.v[emu_i] *= b.v[emu_i];
+    return a;
+}
+
+static inline float32x4_t
+vmulq_n_f32(float32x4_t a, float b)
+{
+    int emu_i;
+    EMU_FOR(a) a.v[emu_i] *= b;
+    return a;
+}
+
+static inline float64x2_t
+vmulq_f64(float64x2_t a, float64x2_t b)
+{
+    int emu_i;
+    EMU_FOR(a) a.v[emu_i] *= b.v[emu_i];
+    return a;
+}
+
+static inline float64x2_t
+vaddq_f64(float64x2_t a, float64x2_t b)
+{
+    int emu_i;
+    EMU_FOR(a) a.v[emu_i] += b.v[emu_i];
+    return a;
+}
+
+static inline int64x2_t
+vaddq_s64(int64x2_t a, int64x2_t b)
+{
+    int emu_i;
+    EMU_FOR(a) a.v[emu_i] += b.v[emu_i];
+    return a;
+}
+
+static inline float32x4_t
+vfmaq_f32(float32x4_t a, float32x4_t b, float32x4_t c)
+{
+    int emu_i;
+    EMU_FOR(a) a.v[emu_i] = fmaf(b.v[emu_i], c.v[emu_i], a.v[emu_i]);
+    return a;
+}
+
+static inline float32x4_t
+vfmsq_f32(float32x4_t a, float32x4_t b, float32x4_t c)
+{
+    int emu_i;
+    EMU_FOR(a) a.v[emu_i] = fmaf(-b.v[emu_i], c.v[emu_i], a.v[emu_i]);
+    return a;
+}
+
+static inline float32x4_t
+vfmaq_n_f32(float32x4_t a, float32x4_t b, float c)
+{
+    int emu_i;
+    EMU_FOR(a) a.v[emu_i] = fmaf(b.v[emu_i], c, a.v[emu_i]);
+    return a;
+}
+
+static inline float64x2_t
+vfmaq_f64(float64x2_t a, float64x2_t b, float64x2_t c)
+{
+    int emu_i;
+    EMU_FOR(a) a.v[emu_i] = fma(b.v[emu_i], c.v[emu_i], a.v[emu_i]);
+    return a;
+}
+
+static inline float64x2_t
+vfmsq_f64(float64x2_t a, float64x2_t b, float64x2_t c)
+{
+    int emu_i;
+    EMU_FOR(a) a.v[emu_i] = fma(-b.v[emu_i], c.v[emu_i], a.v[emu_i]);
+    return a;
+}
+
+static inline float64x2_t
+vfmaq_n_f64(float64x2_t a, float64x2_t b, double c)
+{
+    int emu_i;
+    EMU_FOR(a) a.v[emu_i] = fma(b.v[emu_i], c, a.v[emu_i]);
+    return a;
+}
+
+static inline int32x4_t
+vabsq_s32(int32x4_t a)
+{
+    int emu_i;
+    EMU_FOR(a) a.v[emu_i] = a.v[emu_i] < 0 ? -a.v[emu_i] : a.v[emu_i];
+    return a;
+}
+
+static inline int32x4_t
+vmaxq_s32(int32x4_t a, int32x4_t b)
+{
+    int emu_i;
+    EMU_FOR(a) a.v[emu_i] = b.v[emu_i] > a.v[emu_i] ? b.v[emu_i] : a.v[emu_i];
+    return a;
+}
+
+static inline int32_t
+vmaxvq_s32(int32x4_t a)
+{
+    int32_t m = a.v[0];
+    int emu_i;
+    EMU_FOR(a) m = a.v[emu_i] > m ? a.v[emu_i] : m;
+    return m;
+}
+
+static inline uint32_t
+vminvq_u32(uint32x4_t a)
+{
+    uint32_t m = a.v[0];
+    int emu_i;
+    EMU_FOR(a) m = a.v[emu_i] < m ? a.v[emu_i] : m;
+    return m;
+}
+
+/* comparisons, all ones in the lanes where true */
+
+static inline uint64x2_t
+vcaleq_f64(float64x2_t a, float64x2_t b)
+{
+    uint64x2_t r;
+    int emu_i;
+    EMU_FOR(r) r.v[emu_i] = fabs(a.v[emu_i]) <= fabs(b.v[emu_i]) ? ~0ULL : 0;
+    return r;
+}
+
+static inline uint64x2_t
+vcgtq_f64(float64x2_t a, float64x2_t b)
+{
+    uint64x2_t r;
+    int emu_i;
+    EMU_FOR(r) r.v[emu_i] = a.v[emu_i] > b.v[emu_i] ? ~0ULL : 0;
+    return r;
+}
+
+static inline uint64x2_t
+vcleq_f64(float64x2_t a, float64x2_t b)
+{
+    uint64x2_t r;
+    int emu_i;
+    EMU_FOR(r) r.v[emu_i] = a.v[emu_i] <= b.v[emu_i] ? ~0ULL : 0;
+    return r;
+}
+
+static inline uint64x2_t
+vcltzq_f64(float64x2_t a)
+{
+    uint64x2_t r;
+    int emu_i;
+    EMU_FOR(r) r.v[emu_i] = a.v[emu_i] < 0 ? ~0ULL : 0;
+    return r;
+}
+
+static inline uint64x2_t
+vandq_u64(uint64x2_t a, uint64x2_t b)
+{
+    int emu_i;
+    EMU_FOR(a) a.v[emu_i] &= b.v[emu_i];
+    return a;
+}
+
+/* permutations */
+
+static inline float32x4_t
+vrev64q_f32(float32x4_t a)
+{
+    float32x4_t r;
+    r.v[0] = a.v[1];
+    r.v[1] = a.v[0];
+    r.v[2] = a.v[3];
+    r.v[3] = a.v[2];
+    return r;
+}
+
+static inline float32x4_t
+vextq_f32(float32x4_t a, float32x4_t b, int n)
+{
+    float t[8];
+    float32x4_t r;
+    memcpy(t, a.v, sizeof(a.v));
+    memcpy(&t[4], b.v, sizeof(b.v));
+    memcpy(r.v, &t[n], sizeof(r.v));
+    return r;
+}
+
+static inline float64x2_t
+vextq_f64(float64x2_t a, float64x2_t b, int n)
+{
+    double t[4];
+    float64x2_t r;
+    memcpy(t, a.v, sizeof(a.v));
+    memcpy(&t[2], b.v, sizeof(b.v));
+    memcpy(r.v, &t[n], sizeof(r.v));
+    return r;
+}
+
+static inline float32x2_t
+vget_low_f32(float32x4_t a)
+{
+    float32x2_t r;
+    memcpy(r.v, a.v, sizeof(r.v));
+    return r;
+}
+
+static inline int16x4_t
+vget_low_s16(int16x8_t a)
+{
+    int16x4_t r;
+    memcpy(r.v, a.v, sizeof(r.v));
+    return r;
+}
+
+static inline int32x4_t
+vcombine_s32(int32x2_t a, int32x2_t b)
+{
+    int32x4_t r;
+    memcpy(r.v, a.v, sizeof(a.v));
+    memcpy(&r.v[2], b.v, sizeof(b.v));
+    return r;
+}
+
+/* conversions */
+
+static inline int32x4_t
+vmovl_s16(int16x4_t a)
+{
+    int32x4_t r;
+    int emu_i;
+    EMU_FOR(r) r.v[emu_i] = a.v[emu_i];
+    return r;
+}
+
+static inline int32x4_t
+vmovl_high_s16(int16x8_t a)
+{
+    int32x4_t r;
+    int emu_i;
+    EMU_FOR(r) r.v[emu_i] = a.v[emu_i + 4];
+    return r;
+}
+
+static inline int16x4_t
+vmovn_s32(int32x4_t a)
+{
+    int16x4_t r;
+    int emu_i;
+    EMU_FOR(r) r.v[emu_i] = (int16_t)a.v[emu_i];
+    return r;
+}
+
+static inline int32x2_t
+vmovn_s64(int64x2_t a)
+{
+    int32x2_t r;
+    int emu_i;
+    EMU_FOR(r) r.v[emu_i] = (int32_t)a.v[emu_i];
+    return r;
+}
+
+static inline uint32x4_t
+vshll_n_u16(uint16x4_t a, int n)
+{
+    uint32x4_t r;
+    int emu_i;
+    EMU_FOR(r) r.v[emu_i] = (uint32_t)a.v[emu_i] << n;
+    return r;
+}
+
+static inline float32x4_t
+vcvtq_f32_s32(int32x4_t a)
+{
+    float32x4_t r;
+    int emu_i;
+    EMU_FOR(r) r.v[emu_i] = (float)a.v[emu_i];
+    return r;
+}
+
+static inline int64x2_t
+vcvtq_s64_f64(float64x2_t a)
+{
+    int64x2_t r;
+    int emu_i;
+    EMU_FOR(r) r.v[emu_i] = (int64_t)a.v[emu_i];
+    return r;
+}
+
+static inline float32x2_t
+vcvt_f32_f64(float64x2_t a)
+{
+    float32x2_t r;
+    int emu_i;
+    EMU_FOR(r) r.v[emu_i] = (float)a.v[emu_i];
+    return r;
+}
+
+static inline float32x4_t
+vcvt_high_f32_f64(float32x2_t low, float64x2_t a)
+{
+    float32x4_t r;
+    r.v[0] = low.v[0];
+    r.v[1] = low.v[1];
+    r.v[2] = (float)a.v[0];
+    r.v[3] = (float)a.v[1];
+    return r;
+}
+
+static inline float64x2_t
+vcvt_f64_f32(float32x2_t a)
+{
+    float64x2_t r;
+    int emu_i;
+    EMU_FOR(r) r.v[emu_i] = a.v[emu_i];
+    return r;
+}
+
+static inline float64x2_t
+vcvt_high_f64_f32(float32x4_t a)
+{
+    float64x2_t r;
+    int emu_i;
+    EMU_FOR(r) r.v[emu_i] = a.v[emu_i + 2];
+    return r;
+}
+
+static inline float32x4_t
+vcvt_f32_f16(float16x4_t a)
+{
+    float32x4_t r;
+    int emu_i, e, m;
+    float f;
+    EMU_FOR(r) {
+        e = (a.v[emu_i] >> 10) & 0x1F;
+        m = a.v[emu_i] & 0x3FF;
+        if (e == 0x1F) {
+            f = m == 0 ? INFINITY : NAN;
+        } else if (e == 0) {
+            f = ldexpf((float)m, -24);
+        } else {
+            f = ldexpf((float)(m | 0x400), e - 25);
+        }
+        r.v[emu_i] = (a.v[emu_i] & 0x8000) != 0 ? -f : f;
+    }
+    return r;
+}
+
+/* reinterpretations */
+
+static inline float16x4_t
+vreinterpret_f16_u16(uint16x4_t a)
+{
+    float16x4_t r;
+    memcpy(r.v, a.v, sizeof(r.v));
+    return r;
+}
+
+static inline float32x4_t
+vreinterpretq_f32_u32(uint32x4_t a)
+{
+    float32x4_t r;
+    memcpy(r.v, a.v, sizeof(r.v));
+    return r;
+}
+
+static inline uint32x4_t
+vreinterpretq_u32_u64(uint64x2_t a)
+{
+    uint32x4_t r;
+    memcpy(r.v, a.v, sizeof(r.v));
+    return r;
+}
+
+static inline int64x2_t
+vreinterpretq_s64_u64(uint64x2_t a)
+{
+    int64x2_t r;
+    memcpy(r.v, a.v, sizeof(r.v));
+    return r;
+}
+
+#undef EMU_FOR
+#undef EMU_LANES
+
+#endif
@@ -0,0 +1,58 @@
+#!/bin/sh
+#
+# Non-uniform partitioning must give the same output as uniform partitioning,
+# and both the reference convolution computed by firtest. Covers block counts
+# which do not fill the last level, filter delays which shift the input of
+# the tail, a coefficient set shorter than the filter, and both float and
+# double precision.
+#
+. ./common.sh
+
+"$FIRTEST" noise "$WORK/in.raw" 8192 2 1 || exit 1
+
+# config <float bits> <filter length> <partitioning> <delay>
+config() {
+    cat <<EOF
+float_bits: $1;
+filter_length: $2;
+partitioning: $3;
+
+coeff 0 { filename: "$WORK/c0.txt"; format: "text"; };
+coeff 1 { filename: "$WORK/c1.txt"; format: "text"; };
+
+filter 0 { from_inputs: 0; to_outputs: 0; coeff: 0; delay: $4; };
+filter 1 { from_inputs: 0, 1//0.5; to_outputs: 1; coeff: 1; };
+EOF
+}
+
+failed=0
+for bits in 32 64; do
+    if [ $bits = 32 ]; then
+        tolerance=1e-5
+    else
+        tolerance=1e-12
+    fi
+    # <partition length> <blocks> <filter delay in blocks>
+    for case in "64 13 0" "64 13 3" "32 16 1" "32 23 5" "16 40 0"; do
+        set -- $case
+        taps=$(($1 * ($2 - $3)))
+        "$FIRTEST" coeffs "$WORK/c0.txt" $taps 2 || exit 1
+        "$FIRTEST" coeffs "$WORK/c1.txt" $(($1 * $2 * 2 / 3)) 3 || exit 1
+        echo "float_bits $bits, filter_length $1,$2, delay $3:"
+        if run nonuniform 2 2 $bits $1,$2 '"non-uniform"' $3 &&
+            grep -q "Non-uniform partitioning" "$WORK/nonuniform.log" &&
+            run uniform 2 2 $bits $1,$2 '"uniform"' $3 &&
+            reference ref 2 2 0:0:1:$(($1 * $3)):c0.txt 1:0:1:0:c1.txt \
+                      1:1:0.5:0:c1.txt &&
+            "$FIRTEST" compare "$WORK/nonuniform.raw" "$WORK/ref.raw" \
+                       $tolerance &&
+            "$FIRTEST" compare "$WORK/uniform.raw" "$WORK/ref.raw" $tolerance
+        then
+            echo "  passed"
+        else
+            echo "  FAILED"
+            failed=1
+        fi
+    done
+done
+exit $failed
@@ -0,0 +1,72 @@
+#!/bin/sh
+#
+# With processing_margin, the partitions after the first are summed a period
+# ahead, which must give the same output as summing all partitions when the
+# block arrives. The file module does not use a clock, so the start-up fill
+# is the same in both runs and the outputs can be compared sample by sample.
+# Covers coefficient sets shorter than the filter and with zero partitions, a
+# filter feeding another filter, and coefficient and delay changes made by
+# the CLI while running, which must not use sums made for the previous
+# setting. Without the changes the output must be the reference convolution
+# computed by firtest.
+#
+. ./common.sh
+
+"$FIRTEST" noise "$WORK/in.raw" 16384 2 1 || exit 1
+"$FIRTEST" coeffs "$WORK/c0.txt" 1000 2 || exit 1
+"$FIRTEST" coeffs "$WORK/c1.txt" 300 3 || exit 1
+# three zero partitions of 64 before the set
+awk 'BEGIN { for (n = 0; n < 192; n++) print 0 }' > "$WORK/c2.txt"
+cat "$WORK/c1.txt" >> "$WORK/c2.txt"
+
+# config <float bits> <processing margin> <settings> <script>
+config() {
+    cat <<EOF
+float_bits: $1;
+filter_length: 64,16;
+processing_margin: $2;
+$3
+
+logic: "cli" { script: "$4"; };
+
+coeff 0 { filename: "$WORK/c0.txt"; format: "text"; };
+coeff 1 { filename: "$WORK/c1.txt"; format: "text"; };
+coeff 2 { filename: "$WORK/c2.txt"; format: "text"; };
+
+filter 0 { from_inputs: 0, 1//0.5; to_outputs: 0; coeff: 0; };
+filter 1 { from_inputs: 1; to_filters: 2; coeff: 2; };
+filter 2 { from_filters: 1; to_outputs: 1; coeff: 1; delay: 2; };
+EOF
+}
+
+SCRIPT='cfc 0 1; cfd 0 3;; sleep b37;; cfc 0 2;; sleep b21;;
+        cfd 0 0;; sleep b29;; cfc 0 0;; sleep b41'
+
+reference ref 2 2 0:0:1:0:c0.txt 0:1:0.5:0:c0.txt 1:1:1:128:c2.txt+c1.txt ||
+    exit 1
+
+failed=0
+for bits in 32 64; do
+    if [ $bits = 32 ]; then
+        tolerance=1e-5
+    else
+        tolerance=1e-12
+    fi
+    for settings in "" "interleaved_partitions: true;" \
+        'partitioning: "non-uniform";'
+    do
+        echo "float_bits $bits${settings:+, $settings}"
+        if run static 2 2 $bits 32 "$settings" "sleep b1000" &&
+            "$FIRTEST" compare "$WORK/static.raw" "$WORK/ref.raw" $tolerance &&
+            run ahead 2 2 $bits 32 "$settings" "$SCRIPT" &&
+            run normal 2 2 $bits false "$settings" "$SCRIPT" &&
+            "$FIRTEST" compare "$WORK/ahead.raw" "$WORK/normal.raw" $tolerance
+        then
+            echo "  passed"
+        else
+            echo "  FAILED"
+            failed=1
+        fi
+    done
+done
+exit $failed
@@ -0,0 +1,218 @@
+/*
+ * (c) Copyright 2026 -- Anders Torger
+ *
+ * This program is open source. For license terms, see the LICENSE file.
+ *
+ */
+
+/*
+ * Check of the built-in FFT in fft_radix4.c against a plain DFT in FFTW's
+ * halfcomplex format, for all power of two sizes which go through the
+ * different paths (the scalar tails, the vectorised stages, and the final
+ * radix-2 stage of odd orders), in place and not. A plan is also executed by
+ * several threads at once, which must give the same result as one thread.
+ * Built with 'make tests/radix4_check'.
+ */
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <stdint.h>
+#include <math.h>
+#include <pthread.h>
+
+#include "fft_radix4.h"
+
+#define MAX_ORDER 12
+#define THREADS_LENGTH 4096
+#define N_THREADS 4
+#define N_THREAD_LOOPS 2000
+
+static int n_checks = 0;
+static int n_failed = 0;
+static uint32_t seed = 1;
+
+static double
+noise(void)
+{
+    seed = seed * 1664525 + 1013904223;
+    return (double)(seed >> 8) / (double)(1 << 23) - 1.0;
+}
+
+static double
+get(void *buf,
+    int realsize,
+    int n)
+{
+    return realsize == 4 ? (double)((float *)buf)[n] : ((double *)buf)[n];
+}
+
+static void
+set(void *buf,
+    int realsize,
+    int n,
+    double x)
+{
+    if (realsize == 4) {
+        ((float *)buf)[n] = (float)x;
+    } else {
+        ((double *)buf)[n] = x;
+    }
+}
+
+/* unnormalised DFT, R2HC forward or HC2R inverse */
+static void
+ref_dft(void *in,
+        int realsize,
+        int length,
+        int invert,
+        double out[])
+{
+    double re, im, a;
+    int n, k;
+
+    if (!invert) {
+        for (k = 0; k <= length / 2; k++) {
+            re = im = 0;
+            for (n = 0; n < length; n++) {
+                a = 2.0 * M_PI * (double)((int64_t)n * k % length) /
+                    (double)length;
+                re += get(in, realsize, n) * cos(a);
+                im -= get(in, realsize, n) * sin(a);
+            }
+            out[k] = re;
+            if (k != 0 && k != length / 2) {
+                out[length - k] = im;
+            }
+        }
+        return;
+    }
+    for (n = 0; n < length; n++) {
+        re = get(in, realsize, 0);
+        if (length > 1) {
+            re += get(in, realsize, length / 2) * ((n & 1) ? -1.0 : 1.0);
+        }
+        for (k = 1; k < length / 2; k++) {
+            a = 2.0 * M_PI * (double)((int64_t)n * k % length) /
+                (double)length;
+            re += 2.0 * (get(in, realsize, k) * cos(a) -
+                         get(in, realsize, length - k) * sin(a));
+        }
+        out[n] = re;
+    }
+}
+
+static void
+check_size(int length,
+           int realsize,
+           int invert,
+           int inplace)
+{
+    void *plan, *in, *out;
+    double *ref, tolerance;
+    int n;
+
+    n_checks++;
+    in = malloc(length * realsize);
+    out = inplace ? in : malloc(length * realsize);
+    ref = malloc(length * sizeof(double));
+    for (n = 0; n < length; n++) {
+        set(in, realsize, n, noise());
+    }
+    ref_dft(in, realsize, length, invert, ref);
+    plan = fft_radix4_plan(length, invert, realsize);
+    fft_radix4_execute(plan, in, out);
+    /* the error grows with the sum of the magnitudes */
+    tolerance = (realsize == 4 ? 1e-6 : 1e-14) * (double)length;
+    for (n = 0; n < length; n++) {
+        if (!(fabs(get(out, realsize, n) - ref[n]) <= tolerance)) {
+            fprintf(stderr, "%s%s, length %d%s: element %d is %.9g, "
+                    "expected %.9g.\n", invert ? "inverse" : "forward",
+                    realsize == 4 ? "f" : "d", length,
+                    inplace ? " in place" : "", n, get(out, realsize, n),
+                    ref[n]);
+            n_failed++;
+            break;
+        }
+    }
+    fft_radix4_destroy(plan);
+    free(in);
+    if (!inplace) {
+        free(out);
+    }
+    free(ref);
+}
+
+static void *threads_plan;
+static float threads_input[THREADS_LENGTH];
+static float threads_output[THREADS_LENGTH];
+
+static void *
+run_thread(void *arg)
+{
+    float *out;
+    int n, n_differ = 0;
+
+    out = malloc(sizeof(threads_output));
+    for (n = 0; n < N_THREAD_LOOPS; n++) {
+        fft_radix4_execute(threads_plan, threads_input, out);
+        if (memcmp(out, threads_output, sizeof(threads_output)) != 0) {
+            n_differ++;
+        }
+    }
+    free(out);
+    return (void *)(intptr_t)n_differ;
+}
+
+static void
+check_threads(void)
+{
+    pthread_t threads[N_THREADS];
+    void *ret;
+    int n, n_differ = 0;
+
+    n_checks++;
+    threads_plan = fft_radix4_plan(THREADS_LENGTH, 0, 4);
+    for (n = 0; n < THREADS_LENGTH; n++) {
+        threads_input[n] = (float)noise();
+    }
+    fft_radix4_execute(threads_plan, threads_input, threads_output);
+    for (n = 0; n < N_THREADS; n++) {
+        pthread_create(&threads[n], NULL, run_thread, NULL);
+    }
+    for (n = 0; n < N_THREADS; n++) {
+        pthread_join(threads[n], &ret);
+        n_differ += (int)(intptr_t)ret;
+    }
+    if (n_differ != 0) {
+        fprintf(stderr, "%d of %d transforms differed when run by %d "
+                "threads at once.\n", n_differ, N_THREADS * N_THREAD_LOOPS,
+                N_THREADS);
+        n_failed++;
+    }
+    fft_radix4_destroy(threads_plan);
+}
+
+int
+main(void)
+{
+    int order, realsize, invert, inplace;
+
+    for (order = 1; order <= MAX_ORDER; order++) {
+        for (realsize = 4; realsize <= 8; realsize += 4) {
+            for (invert = 0; invert < 2; invert++) {
+                for (inplace = 0; inplace < 2; inplace++) {
+                    check_size(1 << order, realsize, invert, inplace);
+                }
+            }
+        }
+    }
+    check_threads();
+
+    if (n_failed != 0) {
+        fprintf(stderr, "radix4_check: %d of %d checks failed.\n", n_failed,
+                n_checks);
+        return 1;
+    }
+    printf("radix4_check: %d checks passed.\n", n_checks);
+    return 0;
+}